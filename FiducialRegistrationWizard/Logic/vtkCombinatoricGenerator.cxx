@@ -1,6 +1,9 @@
 #include "vtkCombinatoricGenerator.h"
 #include <vtkObjectFactory.h> //for vtkStandardNewMacro() macro
 
+// std includes
+#include <algorithm>
+
 const int MAIN_SET_INDEX_FOR_PERMUTATION_AND_COMBINATION = 0; // use only the zeroth set in permutation and combination operations
 
 //----------------------------------------------------------------------------
@@ -11,6 +14,8 @@ vtkCombinatoricGenerator::vtkCombinatoricGenerator()
 {
   this->Combinatoric = COMBINATORIC_COMBINATION;
   this->SubsetSize = 1;
+  this->Traversal.Rank = 0;
+  this->Traversal.Valid = false;
   this->InputChangedTime.Modified();
   this->OutputChangedTime.Modified();
 }
@@ -256,7 +261,7 @@ std::vector< std::vector< int > > vtkCombinatoricGenerator::GetOutputSets()
 }
 
 //------------------------------------------------------------------------------
-unsigned int vtkCombinatoricGenerator::ComputeNumberOfOutputSets()
+vtkTypeUInt64 vtkCombinatoricGenerator::ComputeNumberOfOutputSets()
 {
   switch ( this->Combinatoric )
   {
@@ -333,363 +338,565 @@ void vtkCombinatoricGenerator::Update()
     return;
   }
 
+  this->OutputSets.clear();
+
+  // size the output appropriately
+  vtkTypeUInt64 numberOfPossibleOutputSets = this->ComputeNumberOfOutputSets();
+  if ( numberOfPossibleOutputSets < this->OutputSets.max_size() )
+  {
+    this->OutputSets.reserve( numberOfPossibleOutputSets );
+  }
+
+  // store every output set of a traversal
+  TraversalState state;
+  vtkTypeUInt64 numberOfComputedOutputSets = 0;
+  for ( bool hasOutputSet = this->InitializeTraversalState( state ); hasOutputSet; hasOutputSet = this->AdvanceTraversalState( state ) )
+  {
+    unsigned int outputSetSize = state.Indices.size();
+    this->OutputSets.push_back( std::vector< int >( state.Elements.begin(), state.Elements.begin() + outputSetSize ) );
+    numberOfComputedOutputSets++;
+  }
+
+  // sanity check
+  if ( numberOfComputedOutputSets != numberOfPossibleOutputSets )
+  {
+    vtkGenericWarningMacro( "Number of computed output sets " << numberOfComputedOutputSets << " does not match the " <<
+                            "number of possible output sets " << numberOfPossibleOutputSets << ". " <<
+                            "This is a bug and results are likely to contain errors. Please report this issue." );
+  }
+
+  this->OutputChangedTime.Modified();
+}
+
+//------------------------------------------------------------------------------
+bool vtkCombinatoricGenerator::UpdateNeeded()
+{
+  return ( this->InputChangedTime > this->OutputChangedTime );
+}
+
+//------------------------------------------------------------------------------
+// TRAVERSAL
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+bool vtkCombinatoricGenerator::InitTraversal()
+{
+  this->TraversalStartedTime.Modified();
+  return this->InitializeTraversalState( this->Traversal );
+}
+
+//------------------------------------------------------------------------------
+bool vtkCombinatoricGenerator::GoToNextOutputSet()
+{
+  if ( !this->Traversal.Valid )
+  {
+    return false;
+  }
+
+  if ( this->TraversalInputChanged() )
+  {
+    vtkWarningMacro( "Inputs changed during the traversal of the output sets. InitTraversal must be called again." );
+    this->Traversal.Valid = false;
+    return false;
+  }
+
+  return this->AdvanceTraversalState( this->Traversal );
+}
+
+//------------------------------------------------------------------------------
+bool vtkCombinatoricGenerator::GoToOutputSet( vtkTypeUInt64 rank )
+{
+  this->TraversalStartedTime.Modified();
+  return this->SetTraversalStateToRank( this->Traversal, rank );
+}
+
+//------------------------------------------------------------------------------
+vtkTypeUInt64 vtkCombinatoricGenerator::GetCurrentOutputSetRank()
+{
+  if ( !this->Traversal.Valid )
+  {
+    vtkWarningMacro( "There is no current output set. Returning 0." );
+    return 0;
+  }
+
+  return this->Traversal.Rank;
+}
+
+//------------------------------------------------------------------------------
+const int* vtkCombinatoricGenerator::GetCurrentOutputSet()
+{
+  if ( !this->Traversal.Valid || this->Traversal.Elements.empty() )
+  {
+    return NULL;
+  }
+
+  return &( this->Traversal.Elements[ 0 ] );
+}
+
+//------------------------------------------------------------------------------
+bool vtkCombinatoricGenerator::TraversalInputChanged()
+{
+  return ( this->InputChangedTime > this->TraversalStartedTime );
+}
+
+//------------------------------------------------------------------------------
+bool vtkCombinatoricGenerator::InitializeTraversalState( TraversalState& state )
+{
+  state.Rank = 0;
+  state.Valid = false;
+
+  if ( this->InputSets.size() == 0 )
+  {
+    vtkGenericWarningMacro( "There is no input. Output will be empty." );
+    return false;
+  }
+
   switch ( this->Combinatoric )
   {
     case COMBINATORIC_CARTESIAN_PRODUCT:
     {
-      this->UpdateCartesianProducts();
+      state.Valid = this->InitializeCartesianProductTraversal( state );
       break;
     }
     case COMBINATORIC_PERMUTATION:
     {
-      this->UpdatePermutations();
+      if ( this->InputSets.size() > 1 )
+      {
+        vtkGenericWarningMacro( "There are multiple inputs. Only the set with index = " << MAIN_SET_INDEX_FOR_PERMUTATION_AND_COMBINATION << " will be used for this operation." );
+      }
+      state.Valid = this->InitializePermutationTraversal( state );
       break;
     }
     case COMBINATORIC_COMBINATION:
     {
-      this->UpdateCombinations();
+      if ( this->InputSets.size() > 1 )
+      {
+        vtkGenericWarningMacro( "There are multiple inputs. Only the first input will be used for this operation." );
+      }
+      state.Valid = this->InitializeCombinationTraversal( state );
       break;
     }
     default:
     {
-      vtkErrorMacro( "Unknown combinatoric. Cannot update." );
+      vtkErrorMacro( "Unknown combinatoric. Cannot traverse output sets." );
       break;
     }
   }
 
-  this->OutputChangedTime.Modified();
+  return state.Valid;
 }
 
 //------------------------------------------------------------------------------
-bool vtkCombinatoricGenerator::UpdateNeeded()
+bool vtkCombinatoricGenerator::AdvanceTraversalState( TraversalState& state )
 {
-  return ( this->InputChangedTime > this->OutputChangedTime );
+  bool advanced = false;
+  switch ( this->Combinatoric )
+  {
+    case COMBINATORIC_CARTESIAN_PRODUCT:
+    {
+      advanced = this->AdvanceCartesianProductTraversal( state );
+      break;
+    }
+    case COMBINATORIC_PERMUTATION:
+    {
+      advanced = this->AdvancePermutationTraversal( state );
+      break;
+    }
+    case COMBINATORIC_COMBINATION:
+    {
+      advanced = this->AdvanceCombinationTraversal( state );
+      break;
+    }
+    default:
+    {
+      vtkErrorMacro( "Unknown combinatoric. Cannot traverse output sets." );
+      break;
+    }
+  }
+
+  if ( !advanced )
+  {
+    state.Valid = false;
+    return false;
+  }
+
+  state.Rank++;
+  return true;
 }
 
 //------------------------------------------------------------------------------
-void vtkCombinatoricGenerator::UpdateCartesianProducts()
+bool vtkCombinatoricGenerator::SetTraversalStateToRank( TraversalState& state, vtkTypeUInt64 rank )
 {
-  // error/warning checking
-  if ( !this->OutputSets.empty() )
+  state.Valid = false;
+
+  vtkTypeUInt64 numberOfOutputSets = this->ComputeNumberOfOutputSets();
+  if ( numberOfOutputSets == VTK_TYPE_UINT64_MAX )
   {
-    vtkGenericWarningMacro( "Output is not empty. Clearing contents." );
-    this->OutputSets.clear();
+    vtkErrorMacro( "There are too many output sets to look them up by rank." );
+    return false;
   }
 
-  if ( this->InputSets.size() == 0 )
+  if ( rank >= numberOfOutputSets )
   {
-    vtkGenericWarningMacro( "There is no input. Output will be empty." );
-    return;
+    vtkErrorMacro( "There is no output set with rank " << rank << ", number of output sets = " << numberOfOutputSets << "." );
+    return false;
   }
-  
-  // size the output appropriately
-  unsigned int numberOfPossibleCartesianProducts = this->NumberOfPossibleCartesianProducts();
-  this->OutputSets.reserve( numberOfPossibleCartesianProducts );
-
-  // prepare the recursive call
-  unsigned int numberOfComputedCartesianProducts = 0;
-  std::vector< int > currentProduct; // starts empty
-  this->UpdateCartesianProductsHelper( currentProduct, numberOfComputedCartesianProducts );
 
-  // sanity check
-  if ( numberOfComputedCartesianProducts != numberOfPossibleCartesianProducts )
+  switch ( this->Combinatoric )
   {
-    vtkGenericWarningMacro( "Number of computed cartesian products " << numberOfComputedCartesianProducts << " does not match the " <<
-                            "number of possible cartesian products " << numberOfPossibleCartesianProducts << ". " <<
-                            "This is a bug and results are likely to contain errors. Please report this issue." );
+    case COMBINATORIC_CARTESIAN_PRODUCT:
+    {
+      this->SetCartesianProductTraversalToRank( state, rank );
+      break;
+    }
+    case COMBINATORIC_PERMUTATION:
+    {
+      this->SetPermutationTraversalToRank( state, rank );
+      break;
+    }
+    case COMBINATORIC_COMBINATION:
+    {
+      this->SetCombinationTraversalToRank( state, rank );
+      break;
+    }
+    default:
+    {
+      vtkErrorMacro( "Unknown combinatoric. Cannot traverse output sets." );
+      return false;
+    }
   }
+
+  state.Rank = rank;
+  state.Valid = true;
+  return true;
 }
 
 //------------------------------------------------------------------------------
-unsigned int vtkCombinatoricGenerator::NumberOfPossibleCartesianProducts()
+// CARTESIAN PRODUCT
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+vtkTypeUInt64 vtkCombinatoricGenerator::NumberOfPossibleCartesianProducts()
 {
   if ( this->InputSets.size() == 0 )
   {
     return 0;
   }
 
-  int numberOfCartesianProducts = 1;
+  vtkTypeUInt64 numberOfCartesianProducts = 1;
   for ( unsigned int setIndex = 0; setIndex < this->InputSets.size(); setIndex++ )
   {
-    numberOfCartesianProducts *= this->InputSets[ setIndex ].size();
+    vtkTypeUInt64 setSize = this->InputSets[ setIndex ].size();
+    if ( setSize == 0 )
+    {
+      return 0;
+    }
+    if ( numberOfCartesianProducts > VTK_TYPE_UINT64_MAX / setSize )
+    {
+      numberOfCartesianProducts = VTK_TYPE_UINT64_MAX; // keep looking for empty sets
+      continue;
+    }
+    numberOfCartesianProducts *= setSize;
   }
   return numberOfCartesianProducts;
 }
 
 //------------------------------------------------------------------------------
-// Recursive function to iterate through all input sets, and generate the cartesian products.
-// Elements are added to the currentProduct variable in each function call.
-void vtkCombinatoricGenerator::UpdateCartesianProductsHelper( std::vector< int >& currentProduct, unsigned int& cartesianProductCount )
+// Cartesian products are traversed like the digits of a counter, the last input set changes fastest.
+// Indices[ i ] is the position of the current element in the i'th input set.
+bool vtkCombinatoricGenerator::InitializeCartesianProductTraversal( TraversalState& state )
 {
-  unsigned int numberOfInputSetsProcessed = currentProduct.size();
-
-  // base case, we've iterated through all input sets. So copy the current product to the output
-  if ( numberOfInputSetsProcessed >= this->InputSets.size() )
+  unsigned int numberOfInputSets = this->InputSets.size();
+  for ( unsigned int setIndex = 0; setIndex < numberOfInputSets; setIndex++ )
   {
-    std::vector< int > currentProductCopy( numberOfInputSetsProcessed ); // initialize with size numberOfInputSetsProcessed
-    for ( unsigned int elementIndex = 0; elementIndex < numberOfInputSetsProcessed; elementIndex++ )
+    if ( this->InputSets[ setIndex ].empty() )
     {
-      currentProductCopy[ elementIndex ] = currentProduct[ elementIndex ];
+      return false;
     }
-    this->OutputSets.push_back( currentProductCopy );
-    cartesianProductCount++;
-    return;
   }
 
-  // recursive case, we need to iterate through all products containing each element
-  int inputSetIndex = numberOfInputSetsProcessed;
-  for ( unsigned int elementIndex = 0; elementIndex < this->InputSets[ inputSetIndex ].size(); elementIndex++ )
+  state.Indices.assign( numberOfInputSets, 0 );
+  state.Elements.resize( numberOfInputSets );
+  for ( unsigned int setIndex = 0; setIndex < numberOfInputSets; setIndex++ )
   {
-    currentProduct.push_back( this->InputSets[ inputSetIndex ][ elementIndex ] );
-    this->UpdateCartesianProductsHelper( currentProduct, cartesianProductCount );
-    currentProduct.pop_back();
+    state.Elements[ setIndex ] = this->InputSets[ setIndex ][ 0 ];
   }
+  return true;
 }
 
 //------------------------------------------------------------------------------
-void vtkCombinatoricGenerator::UpdateCombinations()
+bool vtkCombinatoricGenerator::AdvanceCartesianProductTraversal( TraversalState& state )
 {
-  // error/warning checking
-  if ( !this->OutputSets.empty() )
-  {
-    vtkGenericWarningMacro( "Output is not empty. Clearing contents." );
-    this->OutputSets.clear();
-  }
-  
-  if ( this->InputSets.size() == 0 )
-  {
-    vtkGenericWarningMacro( "There is no input. Output will be empty." );
-    return;
-  }
-  
-  if ( this->InputSets.size() > 1 )
+  for ( int setIndex = ( int ) state.Indices.size() - 1; setIndex >= 0; setIndex-- )
   {
-    vtkGenericWarningMacro( "There are multiple inputs. Only the first input will be used for this operation." );
+    const std::vector< int >& inputSet = this->InputSets[ setIndex ];
+    state.Indices[ setIndex ]++;
+    if ( state.Indices[ setIndex ] < ( int ) inputSet.size() )
+    {
+      state.Elements[ setIndex ] = inputSet[ state.Indices[ setIndex ] ];
+      return true;
+    }
+    // this set wraps around, carry over to the previous set
+    state.Indices[ setIndex ] = 0;
+    state.Elements[ setIndex ] = inputSet[ 0 ];
   }
+  return false;
+}
 
-  // size the output appropriately
-  unsigned int numberOfPossibleCombinations = this->NumberOfPossibleCombinations();
-  this->OutputSets.reserve( numberOfPossibleCombinations );
-
-  // prepare the recursive call
-  unsigned int inputElementIndex = 0; // Traverse the input set from first element to last
-  std::vector< int > initialSubset; // empty at the start
-  initialSubset.reserve( this->SubsetSize ); // reserve enough space for output sets
-  unsigned int numberOfComputedCombinations = 0;
-  this->UpdateCombinationsHelper( inputElementIndex, initialSubset, numberOfComputedCombinations );
-
-  // sanity check
-  if ( numberOfComputedCombinations != numberOfPossibleCombinations )
+//------------------------------------------------------------------------------
+void vtkCombinatoricGenerator::SetCartesianProductTraversalToRank( TraversalState& state, vtkTypeUInt64 rank )
+{
+  unsigned int numberOfInputSets = this->InputSets.size();
+  state.Indices.resize( numberOfInputSets );
+  state.Elements.resize( numberOfInputSets );
+  for ( int setIndex = ( int ) numberOfInputSets - 1; setIndex >= 0; setIndex-- )
   {
-    vtkGenericWarningMacro( "Number of computed combinations " << numberOfComputedCombinations << " does not match the " <<
-                            "number of possible combinations " << numberOfPossibleCombinations << ". " <<
-                            "This is a bug and results are likely to contain errors. Please report this issue." );
+    const std::vector< int >& inputSet = this->InputSets[ setIndex ];
+    vtkTypeUInt64 setSize = inputSet.size();
+    state.Indices[ setIndex ] = ( int ) ( rank % setSize );
+    state.Elements[ setIndex ] = inputSet[ state.Indices[ setIndex ] ];
+    rank /= setSize;
   }
 }
 
+//------------------------------------------------------------------------------
+// COMBINATION
+//------------------------------------------------------------------------------
+
 //------------------------------------------------------------------------------
 // conventionally N choose K combinations,
 // ( N = input set size, K = subset size )
 // The number of combinations is N! / (K! * (N-K)!)
 // See: https://en.wikipedia.org/wiki/Combination
-unsigned int vtkCombinatoricGenerator::NumberOfPossibleCombinations()
+vtkTypeUInt64 vtkCombinatoricGenerator::NumberOfPossibleCombinations()
 {
   if ( this->InputSets.size() == 0 )
   {
     return 0;
   }
 
-  int setSize = this->GetInputSetSize( MAIN_SET_INDEX_FOR_PERMUTATION_AND_COMBINATION );
-  int setSizeFactorial = Factorial( setSize );
-
-  int subsetSize = this->SubsetSize;
-  if ( setSize < subsetSize )
-  {
-    vtkWarningMacro( "Set size " << setSize << " must be greater than subset size " << subsetSize << ". Will set subset size to " << setSize << " for this computation." );
-    subsetSize = setSize;
-  }
-  int subsetSizeFactorial = Factorial( subsetSize );    
-  
-  int setSizeMinusSubsetSize = setSize - subsetSize;
-  int setSizeMinusSubsetSizeFactorial = Factorial( setSizeMinusSubsetSize );
-
-  int numberOfCombinations = setSizeFactorial / ( subsetSizeFactorial * setSizeMinusSubsetSizeFactorial );
-  return numberOfCombinations;
+  unsigned int setSize = this->InputSets[ MAIN_SET_INDEX_FOR_PERMUTATION_AND_COMBINATION ].size();
+  return vtkCombinatoricGenerator::BinomialCoefficient( setSize, this->SubsetSize );
 }
 
 //------------------------------------------------------------------------------
-// this recursive function traverses the input set from beginning to end,
-// and creates all combinations of the input list containing exactly N (SubsetSize) elements.
-// The combination will either contain element at index elementIndex, or it won't.
-void vtkCombinatoricGenerator::UpdateCombinationsHelper( unsigned int elementIndex, std::vector< int >& currentSubset, unsigned int& combinationCount )
+// Combinations are traversed in lexicographic order of the element positions in the input set.
+// Indices holds the (increasing) positions of the elements in the current combination.
+bool vtkCombinatoricGenerator::InitializeCombinationTraversal( TraversalState& state )
 {
-  unsigned int currentSubsetSize = currentSubset.size();
-  unsigned int maximumSubsetSize = this->SubsetSize;
-
-  // Base cases
-  // The subset is complete, and should be added to the output
-  if ( currentSubsetSize == maximumSubsetSize )
+  const std::vector< int >& inputSet = this->InputSets[ MAIN_SET_INDEX_FOR_PERMUTATION_AND_COMBINATION ];
+  unsigned int setSize = inputSet.size();
+  unsigned int subsetSize = this->SubsetSize;
+  if ( setSize < subsetSize )
   {
-    std::vector< int > currentSubsetCopy( maximumSubsetSize ); // initialize with size maximumSubsetSize
-    for ( unsigned int elementIndex = 0; elementIndex < maximumSubsetSize; elementIndex++ )
-    {
-      int element = currentSubset[ elementIndex ];
-      currentSubsetCopy[ elementIndex ] = element;
-    }
-    this->OutputSets.push_back( currentSubsetCopy );
-    combinationCount++;
-    return;
+    vtkWarningMacro( "Set size " << setSize << " is smaller than subset size " << subsetSize << ". There are no combinations." );
+    return false;
   }
 
-  // We're out of elements in the input set, so return without adding the subset to the output
-  if ( elementIndex == this->GetInputSetSize( MAIN_SET_INDEX_FOR_PERMUTATION_AND_COMBINATION ) )
+  // the first combination contains the first subsetSize elements
+  state.Indices.resize( subsetSize );
+  state.Elements.resize( subsetSize );
+  for ( unsigned int position = 0; position < subsetSize; position++ )
   {
-    return;
+    state.Indices[ position ] = position;
+    state.Elements[ position ] = inputSet[ position ];
   }
-
-  // Recursive cases
-  // *Does* contain the input set element at elementIndex:
-  currentSubset.push_back( this->GetInputElement( MAIN_SET_INDEX_FOR_PERMUTATION_AND_COMBINATION, elementIndex ) );
-  this->UpdateCombinationsHelper( elementIndex + 1, currentSubset, combinationCount );
-  currentSubset.pop_back(); // housekeeping
-
-  // *Does not* contain the input set element at elementIndex:
-  this->UpdateCombinationsHelper( elementIndex + 1, currentSubset, combinationCount );
+  return true;
 }
 
 //------------------------------------------------------------------------------
-void vtkCombinatoricGenerator::UpdatePermutations()
+bool vtkCombinatoricGenerator::AdvanceCombinationTraversal( TraversalState& state )
 {
-  // error/warning checking
-  if ( !this->OutputSets.empty() )
+  const std::vector< int >& inputSet = this->InputSets[ MAIN_SET_INDEX_FOR_PERMUTATION_AND_COMBINATION ];
+  int setSize = inputSet.size();
+  int subsetSize = state.Indices.size();
+
+  // find the last position that can still move forward
+  int position = subsetSize - 1;
+  while ( position >= 0 && state.Indices[ position ] == setSize - subsetSize + position )
   {
-    vtkGenericWarningMacro( "Output is not empty. Clearing contents." );
-    this->OutputSets.clear();
+    position--;
   }
-  
-  if ( this->InputSets.size() == 0 )
+  if ( position < 0 )
   {
-    vtkGenericWarningMacro( "There is no input. Output will be empty." );
-    return;
+    return false; // this was the last combination
   }
 
-  if ( this->InputSets.size() > 1 )
+  // move it forward, and put all following positions right after it
+  state.Indices[ position ]++;
+  state.Elements[ position ] = inputSet[ state.Indices[ position ] ];
+  for ( int followingPosition = position + 1; followingPosition < subsetSize; followingPosition++ )
   {
-    vtkGenericWarningMacro( "There are multiple inputs. Only the set with index = " << MAIN_SET_INDEX_FOR_PERMUTATION_AND_COMBINATION << " will be used for this operation." );
+    state.Indices[ followingPosition ] = state.Indices[ followingPosition - 1 ] + 1;
+    state.Elements[ followingPosition ] = inputSet[ state.Indices[ followingPosition ] ];
   }
+  return true;
+}
 
-  // size the output appropriately
-  unsigned int numberOfPossiblePermutations = this->NumberOfPossiblePermutations();
-  this->OutputSets.reserve( numberOfPossiblePermutations );
+//------------------------------------------------------------------------------
+// In lexicographic order, the combinations with a given element at a given position form a
+// contiguous block. The block sizes are binomial coefficients, so the blocks before the rank
+// can be skipped one position at a time.
+void vtkCombinatoricGenerator::SetCombinationTraversalToRank( TraversalState& state, vtkTypeUInt64 rank )
+{
+  const std::vector< int >& inputSet = this->InputSets[ MAIN_SET_INDEX_FOR_PERMUTATION_AND_COMBINATION ];
+  unsigned int setSize = inputSet.size();
+  unsigned int subsetSize = this->SubsetSize;
+  state.Indices.resize( subsetSize );
+  state.Elements.resize( subsetSize );
 
-  // prepare the recursive call
-  unsigned int numberOfComputedPermutations = 0; // variable is modified in place by the function below.
-  std::vector< int > workingCopyOfMainInputSet;
-  workingCopyOfMainInputSet.resize( this->GetInputSetSize( MAIN_SET_INDEX_FOR_PERMUTATION_AND_COMBINATION ) );
-  for ( unsigned int elementIndex = 0; elementIndex < this->GetInputSetSize( MAIN_SET_INDEX_FOR_PERMUTATION_AND_COMBINATION ); elementIndex++ )
+  unsigned int candidateIndex = 0;
+  for ( unsigned int position = 0; position < subsetSize; position++ )
   {
-    workingCopyOfMainInputSet[ elementIndex ] = this->GetInputElement( MAIN_SET_INDEX_FOR_PERMUTATION_AND_COMBINATION, elementIndex );
-  }
-  unsigned int initialSubsetSize = 0; // nothing has been processed yet, start at 0
-  this->UpdatePermutationsHelper( initialSubsetSize, workingCopyOfMainInputSet, numberOfComputedPermutations );
-
-  // sanity check
-  if ( numberOfComputedPermutations != numberOfPossiblePermutations )
-  {
-    vtkGenericWarningMacro( "Number of computed permutations " << numberOfComputedPermutations << " does not match the " <<
-                            "number of possible permutations " << numberOfPossiblePermutations << ". " <<
-                            "This is a bug and results are likely to contain errors. Please report this issue." );
+    // number of combinations that have candidateIndex at this position (given the previous positions)
+    vtkTypeUInt64 numberOfCombinationsInBlock = vtkCombinatoricGenerator::BinomialCoefficient( setSize - 1 - candidateIndex, subsetSize - 1 - position );
+    while ( rank >= numberOfCombinationsInBlock )
+    {
+      rank -= numberOfCombinationsInBlock;
+      candidateIndex++;
+      numberOfCombinationsInBlock = vtkCombinatoricGenerator::BinomialCoefficient( setSize - 1 - candidateIndex, subsetSize - 1 - position );
+    }
+    state.Indices[ position ] = candidateIndex;
+    state.Elements[ position ] = inputSet[ candidateIndex ];
+    candidateIndex++;
   }
 }
 
+//------------------------------------------------------------------------------
+// PERMUTATION
+//------------------------------------------------------------------------------
+
 //------------------------------------------------------------------------------
 // we're actually interested in the number of K-permutations on a set of N elements
 // ( N = input set size, K = subset size )
 // The number of K-permutations is N! / ( N - K )!
 // See: https://en.wikipedia.org/wiki/Permutation#k-permutations_of_n
-unsigned int vtkCombinatoricGenerator::NumberOfPossiblePermutations()
+vtkTypeUInt64 vtkCombinatoricGenerator::NumberOfPossiblePermutations()
 {
-
   if ( this->InputSets.size() == 0 )
   {
     return 0;
   }
 
-  int setSize = this->GetInputSetSize( MAIN_SET_INDEX_FOR_PERMUTATION_AND_COMBINATION );
-  int setSizeFactorial = Factorial( setSize );
-
-  int subsetSize = this->SubsetSize;
+  unsigned int setSize = this->InputSets[ MAIN_SET_INDEX_FOR_PERMUTATION_AND_COMBINATION ].size();
+  unsigned int subsetSize = this->SubsetSize;
   if ( setSize < subsetSize )
   {
-    vtkWarningMacro( "Input set size " << setSize << " must be greater than subset size " << subsetSize << ". Will set subset size to " << setSize << " for this computation." );
-    subsetSize = setSize;
+    return 0;
   }
 
-  int setSizeMinusSubsetSize = setSize - subsetSize;
-  int setSizeMinusSubsetSizeFactorial = Factorial( setSizeMinusSubsetSize );
-
-  int numberOfPermutations = setSizeFactorial / setSizeMinusSubsetSizeFactorial;
+  vtkTypeUInt64 numberOfPermutations = 1;
+  for ( unsigned int factor = setSize - subsetSize + 1; factor <= setSize; factor++ )
+  {
+    if ( numberOfPermutations > VTK_TYPE_UINT64_MAX / factor )
+    {
+      return VTK_TYPE_UINT64_MAX;
+    }
+    numberOfPermutations *= factor;
+  }
   return numberOfPermutations;
 }
 
 //------------------------------------------------------------------------------
-// This recursive function generates all possible N-permutations (N == SubsetSize) of the base set.
-// (Note: Base set is a working copy of the input set. This was done to abstract some of the input storage details out from this method.)
-// Output sets are constructed by one element at a time each time this function is called.
-// The permutation is actually done in-place on the InputSet
-void vtkCombinatoricGenerator::UpdatePermutationsHelper( unsigned int currentSubsetSize, std::vector< int >& baseSet, unsigned int& permutationCount )
+// Permutations are generated by swapping, in place, each position of a working copy of the input set
+// with itself or one of the following positions. Indices[ i ] is the position swapped into position i.
+// The swaps are traversed like the digits of a counter (the last position changes fastest), and moving
+// to the next permutation only undoes and redoes the swaps of the positions that change.
+bool vtkCombinatoricGenerator::InitializePermutationTraversal( TraversalState& state )
 {
-  // Base case, subset is complete... just copy to the output
-  unsigned int maximumSubsetSize = this->SubsetSize;
-  if ( currentSubsetSize == maximumSubsetSize )
+  const std::vector< int >& inputSet = this->InputSets[ MAIN_SET_INDEX_FOR_PERMUTATION_AND_COMBINATION ];
+  unsigned int setSize = inputSet.size();
+  unsigned int subsetSize = this->SubsetSize;
+  if ( setSize < subsetSize )
   {
-    std::vector< int > baseSetCopyUpToSubsetSize( maximumSubsetSize ); // initialize with size maximumSubsetSize
-    for ( unsigned int elementIndex = 0; elementIndex < maximumSubsetSize; elementIndex++ )
-    {
-      int element = baseSet[ elementIndex ];
-      baseSetCopyUpToSubsetSize[ elementIndex ] = element;
-    }
-    this->OutputSets.push_back( baseSetCopyUpToSubsetSize );
-    permutationCount++;
-    return;
+    vtkWarningMacro( "Input set size " << setSize << " is smaller than subset size " << subsetSize << ". There are no permutations." );
+    return false;
   }
 
-  // Recursive case, try keeping element where it is, and...
-  this->UpdatePermutationsHelper( currentSubsetSize + 1, baseSet, permutationCount );
-  
-  // also generate permutations by swapping the front value with each of the
-  // following values. This will be done in-place on the input set.
-  for ( unsigned int swapIndex = currentSubsetSize + 1; swapIndex < baseSet.size(); swapIndex++ )
+  // the first permutation keeps every element where it is
+  state.Elements = inputSet;
+  state.Indices.resize( subsetSize );
+  for ( unsigned int position = 0; position < subsetSize; position++ )
   {
-    // get the relevant indices and values _before_ swapping
-    unsigned int frontIndex = currentSubsetSize;
-    int frontElement = baseSet[ currentSubsetSize ];
-    int swapElement = baseSet[ swapIndex ];
+    state.Indices[ position ] = position;
+  }
+  return true;
+}
 
-    // swap the values
-    baseSet[ swapIndex ] = frontElement;
-    baseSet[ frontIndex ] = swapElement;
+//------------------------------------------------------------------------------
+bool vtkCombinatoricGenerator::AdvancePermutationTraversal( TraversalState& state )
+{
+  int setSize = state.Elements.size();
+  for ( int position = ( int ) state.Indices.size() - 1; position >= 0; position-- )
+  {
+    // undo the swap at this position (the swaps of all following positions are already undone)
+    std::swap( state.Elements[ position ], state.Elements[ state.Indices[ position ] ] );
+    if ( state.Indices[ position ] + 1 < setSize )
+    {
+      state.Indices[ position ]++;
+      std::swap( state.Elements[ position ], state.Elements[ state.Indices[ position ] ] );
+      return true;
+    }
+    // this position wraps around, carry over to the previous position
+    state.Indices[ position ] = position;
+  }
+  return false;
+}
 
-    // recursive step
-    this->UpdatePermutationsHelper( currentSubsetSize + 1, baseSet, permutationCount );
+//------------------------------------------------------------------------------
+void vtkCombinatoricGenerator::SetPermutationTraversalToRank( TraversalState& state, vtkTypeUInt64 rank )
+{
+  const std::vector< int >& inputSet = this->InputSets[ MAIN_SET_INDEX_FOR_PERMUTATION_AND_COMBINATION ];
+  unsigned int setSize = inputSet.size();
+  int subsetSize = this->SubsetSize;
+  state.Indices.resize( subsetSize );
+  for ( int position = subsetSize - 1; position >= 0; position-- )
+  {
+    vtkTypeUInt64 numberOfSwapCandidates = setSize - position;
+    state.Indices[ position ] = position + ( int ) ( rank % numberOfSwapCandidates );
+    rank /= numberOfSwapCandidates;
+  }
 
-    baseSet[ frontIndex ] = frontElement;
-    baseSet[ swapIndex ] = swapElement;
+  state.Elements = inputSet;
+  for ( int position = 0; position < subsetSize; position++ )
+  {
+    std::swap( state.Elements[ position ], state.Elements[ state.Indices[ position ] ] );
   }
 }
 
 //------------------------------------------------------------------------------
-unsigned int vtkCombinatoricGenerator::Factorial( unsigned int x )
+// Computed as a running product, C( n-k+i, i ) = C( n-k+i-1, i-1 ) * ( n-k+i ) / i,
+// which avoids the overflow of the factorials.
+vtkTypeUInt64 vtkCombinatoricGenerator::BinomialCoefficient( unsigned int n, unsigned int k )
 {
-  if ( x == 0 )
+  if ( k > n )
   {
-    return 1;
+    return 0;
   }
 
-  unsigned int factorial = 1;
-  for ( unsigned int multiplier = 2; multiplier <= x; multiplier++ )
+  k = std::min( k, n - k );
+  vtkTypeUInt64 binomialCoefficient = 1;
+  for ( unsigned int i = 1; i <= k; i++ )
   {
-    factorial *= multiplier;
+    // divide out the common factor first, so that the multiplication only overflows if the result does
+    vtkTypeUInt64 factor = n - k + i;
+    vtkTypeUInt64 divisor = i;
+    vtkTypeUInt64 a = binomialCoefficient;
+    vtkTypeUInt64 b = divisor;
+    while ( b != 0 )
+    {
+      vtkTypeUInt64 remainder = a % b;
+      a = b;
+      b = remainder;
+    }
+    vtkTypeUInt64 commonFactor = a;
+    binomialCoefficient /= commonFactor;
+    factor /= ( divisor / commonFactor );
+    if ( binomialCoefficient > VTK_TYPE_UINT64_MAX / factor )
+    {
+      return VTK_TYPE_UINT64_MAX;
+    }
+    binomialCoefficient *= factor;
   }
-  return factorial;
+  return binomialCoefficient;
 }
@@ -73,8 +73,8 @@ class VTK_SLICER_FIDUCIALREGISTRATIONWIZARD_MODULE_LOGIC_EXPORT vtkCombinatoricG
     //  1, 3
     //  2, 1
     //  2, 3
-    //  3, 1
     //  3, 2
+    //  3, 1
     void SetCombinatoricToPermutation();
     
     // Accessor for the combinatoric, return a string result
@@ -103,7 +103,7 @@ class VTK_SLICER_FIDUCIALREGISTRATIONWIZARD_MODULE_LOGIC_EXPORT vtkCombinatoricG
     int GetInputElement( unsigned int setIndex, unsigned int elementIndex );
 
     // Output accessors
-    unsigned int ComputeNumberOfOutputSets(); // returns the number of sets that *would* be computed on update
+    vtkTypeUInt64 ComputeNumberOfOutputSets(); // returns the number of sets that *would* be computed on update (VTK_TYPE_UINT64_MAX if it does not fit)
     std::vector< std::vector< int > > GetOutputSets(); // returns a deep copy
     unsigned int GetOutputSetSize();
     int GetOutputElement( unsigned int setIndex, unsigned int elementIndex );
@@ -111,6 +111,29 @@ class VTK_SLICER_FIDUCIALREGISTRATIONWIZARD_MODULE_LOGIC_EXPORT vtkCombinatoricG
     // logic
     void Update();
 
+    // Traversal of the output sets one at a time, without computing and storing all of them.
+    // The output sets are visited in the same order as they are stored by Update().
+    // Each step modifies the current output set in place, in O(subset size) (O(number of input sets)
+    // for cartesian products), so memory use does not depend on the number of output sets. E.g.:
+    //  for ( bool hasSet = generator->InitTraversal(); hasSet; hasSet = generator->GoToNextOutputSet() )
+    //  {
+    //    const int* outputSet = generator->GetCurrentOutputSet();
+    //  }
+    // Changing the inputs ends the traversal; InitTraversal must be called again.
+    // Returns false if there are no output sets.
+    bool InitTraversal();
+    // Move to the next output set. Returns false if the current output set was the last one.
+    bool GoToNextOutputSet();
+    // Move to the output set at the given position (rank) in the output order, so that the output sets
+    // can be processed in independent chunks. Only possible if ComputeNumberOfOutputSets() fits in 64 bits.
+    // Returns false if there is no output set with the given rank.
+    bool GoToOutputSet( vtkTypeUInt64 rank );
+    // Position of the current output set in the output order
+    vtkTypeUInt64 GetCurrentOutputSetRank();
+    // The elements of the current output set (GetOutputSetSize() elements, or NULL if there is no current set).
+    // The contents change when the traversal moves to another output set.
+    const int* GetCurrentOutputSet();
+
   protected:
     vtkCombinatoricGenerator();
     ~vtkCombinatoricGenerator();
@@ -133,22 +156,45 @@ class VTK_SLICER_FIDUCIALREGISTRATIONWIZARD_MODULE_LOGIC_EXPORT vtkCombinatoricG
     vtkTimeStamp OutputChangedTime;
     bool UpdateNeeded();
 
+    // State of a traversal over the output sets.
+    // Indices are the positions of the current output set elements in the input set(s). For permutations,
+    // Indices[ i ] is the element swapped into position i, and Elements is a working copy of the whole
+    // input set whose first SubsetSize elements are the current output set.
+    struct TraversalState
+    {
+      std::vector< int > Indices;
+      std::vector< int > Elements;
+      vtkTypeUInt64 Rank;
+      bool Valid;
+    };
+    TraversalState Traversal;
+    vtkTimeStamp TraversalStartedTime;
+    bool TraversalInputChanged();
+
+    bool InitializeTraversalState( TraversalState& state );
+    bool AdvanceTraversalState( TraversalState& state );
+    bool SetTraversalStateToRank( TraversalState& state, vtkTypeUInt64 rank );
+
     // logic methods for cartesian product computation
-    void UpdateCartesianProducts();
-    void UpdateCartesianProductsHelper( std::vector< int >& currentProduct, unsigned int& cartesianProductCount ); // recursive helper
-    unsigned int NumberOfPossibleCartesianProducts();
+    bool InitializeCartesianProductTraversal( TraversalState& state );
+    bool AdvanceCartesianProductTraversal( TraversalState& state );
+    void SetCartesianProductTraversalToRank( TraversalState& state, vtkTypeUInt64 rank );
+    vtkTypeUInt64 NumberOfPossibleCartesianProducts();
 
     // logic methods for combination computation
-    void UpdateCombinations();
-    void UpdateCombinationsHelper( unsigned int inputElementIndex, std::vector< int >& currentSubset, unsigned int& combinationCount ); // recursive helper
-    unsigned int NumberOfPossibleCombinations();
-    
+    bool InitializeCombinationTraversal( TraversalState& state );
+    bool AdvanceCombinationTraversal( TraversalState& state );
+    void SetCombinationTraversalToRank( TraversalState& state, vtkTypeUInt64 rank );
+    vtkTypeUInt64 NumberOfPossibleCombinations();
+
     // logic methods for permutation computation
-    void UpdatePermutations();
-    void UpdatePermutationsHelper( unsigned int currentSubsetSize, std::vector< int >& baseSet, unsigned int& permutationCount ); // recursive helper
-    unsigned int NumberOfPossiblePermutations();
-    
-    unsigned int Factorial( unsigned int x );
+    bool InitializePermutationTraversal( TraversalState& state );
+    bool AdvancePermutationTraversal( TraversalState& state );
+    void SetPermutationTraversalToRank( TraversalState& state, vtkTypeUInt64 rank );
+    vtkTypeUInt64 NumberOfPossiblePermutations();
+
+    // returns VTK_TYPE_UINT64_MAX if the result does not fit
+    static vtkTypeUInt64 BinomialCoefficient( unsigned int n, unsigned int k );
 
     vtkCombinatoricGenerator(const vtkCombinatoricGenerator&); // Not implemented.
     void operator=(const vtkCombinatoricGenerator&); // Not implemented.
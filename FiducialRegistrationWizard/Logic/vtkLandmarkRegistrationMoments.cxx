@@ -0,0 +1,269 @@
+#include "vtkLandmarkRegistrationMoments.h"
+
+#include <vtkMath.h>
+#include <vtkMatrix4x4.h>
+
+//------------------------------------------------------------------------------
+vtkLandmarkRegistrationMoments::vtkLandmarkRegistrationMoments()
+{
+  this->Reset();
+}
+
+//------------------------------------------------------------------------------
+void vtkLandmarkRegistrationMoments::Reset()
+{
+  this->NumberOfPointPairs = 0;
+  this->SourceSumOfSquares = 0.0;
+  this->TargetSumOfSquares = 0.0;
+  for ( int row = 0; row < 3; row++ )
+  {
+    this->SourceReference[ row ] = 0.0;
+    this->TargetReference[ row ] = 0.0;
+    this->SourceSum[ row ] = 0.0;
+    this->TargetSum[ row ] = 0.0;
+    for ( int column = 0; column < 3; column++ )
+    {
+      this->CrossSum[ row ][ column ] = 0.0;
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+void vtkLandmarkRegistrationMoments::AddPointPair( const double sourcePoint[ 3 ], const double targetPoint[ 3 ] )
+{
+  if ( this->NumberOfPointPairs == 0 )
+  {
+    // start from exact zeros, so that sums do not keep the round-off of removed pairs
+    this->Reset();
+    for ( int row = 0; row < 3; row++ )
+    {
+      this->SourceReference[ row ] = sourcePoint[ row ];
+      this->TargetReference[ row ] = targetPoint[ row ];
+    }
+  }
+
+  double source[ 3 ];
+  double target[ 3 ];
+  for ( int row = 0; row < 3; row++ )
+  {
+    source[ row ] = sourcePoint[ row ] - this->SourceReference[ row ];
+    target[ row ] = targetPoint[ row ] - this->TargetReference[ row ];
+  }
+
+  this->NumberOfPointPairs++;
+  this->SourceSumOfSquares += vtkMath::Dot( source, source );
+  this->TargetSumOfSquares += vtkMath::Dot( target, target );
+  for ( int row = 0; row < 3; row++ )
+  {
+    this->SourceSum[ row ] += source[ row ];
+    this->TargetSum[ row ] += target[ row ];
+    for ( int column = 0; column < 3; column++ )
+    {
+      this->CrossSum[ row ][ column ] += source[ row ] * target[ column ];
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+void vtkLandmarkRegistrationMoments::RemovePointPair( const double sourcePoint[ 3 ], const double targetPoint[ 3 ] )
+{
+  if ( this->NumberOfPointPairs <= 0 )
+  {
+    vtkGenericWarningMacro( "There are no point pairs to remove." );
+    return;
+  }
+
+  double source[ 3 ];
+  double target[ 3 ];
+  for ( int row = 0; row < 3; row++ )
+  {
+    source[ row ] = sourcePoint[ row ] - this->SourceReference[ row ];
+    target[ row ] = targetPoint[ row ] - this->TargetReference[ row ];
+  }
+
+  this->NumberOfPointPairs--;
+  this->SourceSumOfSquares -= vtkMath::Dot( source, source );
+  this->TargetSumOfSquares -= vtkMath::Dot( target, target );
+  for ( int row = 0; row < 3; row++ )
+  {
+    this->SourceSum[ row ] -= source[ row ];
+    this->TargetSum[ row ] -= target[ row ];
+    for ( int column = 0; column < 3; column++ )
+    {
+      this->CrossSum[ row ][ column ] -= source[ row ] * target[ column ];
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+double vtkLandmarkRegistrationMoments::ComputeRootMeanSquareError( int mode ) const
+{
+  if ( this->NumberOfPointPairs <= 0 )
+  {
+    return 0.0;
+  }
+
+  return sqrt( this->ComputeSumOfSquaredErrors( mode ) / this->NumberOfPointPairs );
+}
+
+//------------------------------------------------------------------------------
+// For a rotation R, the sum of squared errors is sum |s|^2 + sum |t|^2 - 2 * sum ( t . R s ) over the
+// centered points. Horn showed that the maximum of sum ( t . R s ) over all rotations is the largest
+// eigenvalue of his 4x4 matrix. With the scale of vtkLandmarkTransform, c = sqrt( sum |t|^2 / sum |s|^2 ),
+// the similarity error is c^2 * sum |s|^2 + sum |t|^2 - 2 * c * eigenvalue.
+double vtkLandmarkRegistrationMoments::ComputeSumOfSquaredErrors( int mode ) const
+{
+  if ( mode != VTK_LANDMARK_RIGIDBODY && mode != VTK_LANDMARK_SIMILARITY )
+  {
+    vtkGenericWarningMacro( "Registration mode " << mode << " is not supported. Returning 0." );
+    return 0.0;
+  }
+
+  double sourceCentroid[ 3 ];
+  double targetCentroid[ 3 ];
+  double sourceSumOfSquares = 0.0;
+  double targetSumOfSquares = 0.0;
+  double maximumEigenvalue = 0.0;
+  double quaternion[ 4 ];
+  if ( !this->ComputeCenteredMoments( sourceCentroid, targetCentroid, sourceSumOfSquares, targetSumOfSquares, maximumEigenvalue, quaternion ) )
+  {
+    return 0.0;
+  }
+
+  double sumOfSquaredErrors = 0.0;
+  if ( mode == VTK_LANDMARK_SIMILARITY && sourceSumOfSquares > 0.0 )
+  {
+    double scale = sqrt( targetSumOfSquares / sourceSumOfSquares );
+    sumOfSquaredErrors = 2.0 * targetSumOfSquares - 2.0 * scale * maximumEigenvalue;
+  }
+  else
+  {
+    sumOfSquaredErrors = sourceSumOfSquares + targetSumOfSquares - 2.0 * maximumEigenvalue;
+  }
+
+  // the difference of the sums can be slightly negative because of round-off, for perfectly matching points
+  return vtkMath::Max( sumOfSquaredErrors, 0.0 );
+}
+
+//------------------------------------------------------------------------------
+bool vtkLandmarkRegistrationMoments::ComputeSourceToTargetMatrix( int mode, vtkMatrix4x4* sourceToTargetMatrix ) const
+{
+  if ( sourceToTargetMatrix == NULL )
+  {
+    vtkGenericWarningMacro( "Source to target matrix is null." );
+    return false;
+  }
+
+  if ( mode != VTK_LANDMARK_RIGIDBODY && mode != VTK_LANDMARK_SIMILARITY )
+  {
+    vtkGenericWarningMacro( "Registration mode " << mode << " is not supported." );
+    return false;
+  }
+
+  double sourceCentroid[ 3 ];
+  double targetCentroid[ 3 ];
+  double sourceSumOfSquares = 0.0;
+  double targetSumOfSquares = 0.0;
+  double maximumEigenvalue = 0.0;
+  double quaternion[ 4 ];
+  if ( !this->ComputeCenteredMoments( sourceCentroid, targetCentroid, sourceSumOfSquares, targetSumOfSquares, maximumEigenvalue, quaternion ) )
+  {
+    return false;
+  }
+
+  double w = quaternion[ 0 ];
+  double x = quaternion[ 1 ];
+  double y = quaternion[ 2 ];
+  double z = quaternion[ 3 ];
+  double rotation[ 3 ][ 3 ];
+  rotation[ 0 ][ 0 ] = w * w + x * x - y * y - z * z;
+  rotation[ 0 ][ 1 ] = 2.0 * ( x * y - w * z );
+  rotation[ 0 ][ 2 ] = 2.0 * ( x * z + w * y );
+  rotation[ 1 ][ 0 ] = 2.0 * ( x * y + w * z );
+  rotation[ 1 ][ 1 ] = w * w - x * x + y * y - z * z;
+  rotation[ 1 ][ 2 ] = 2.0 * ( y * z - w * x );
+  rotation[ 2 ][ 0 ] = 2.0 * ( x * z - w * y );
+  rotation[ 2 ][ 1 ] = 2.0 * ( y * z + w * x );
+  rotation[ 2 ][ 2 ] = w * w - x * x - y * y + z * z;
+
+  double scale = 1.0;
+  if ( mode == VTK_LANDMARK_SIMILARITY && sourceSumOfSquares > 0.0 )
+  {
+    scale = sqrt( targetSumOfSquares / sourceSumOfSquares );
+  }
+
+  sourceToTargetMatrix->Identity();
+  for ( int row = 0; row < 3; row++ )
+  {
+    double rotatedSourceCentroid = 0.0;
+    for ( int column = 0; column < 3; column++ )
+    {
+      sourceToTargetMatrix->SetElement( row, column, scale * rotation[ row ][ column ] );
+      rotatedSourceCentroid += rotation[ row ][ column ] * sourceCentroid[ column ];
+    }
+    sourceToTargetMatrix->SetElement( row, 3, targetCentroid[ row ] - scale * rotatedSourceCentroid );
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------------
+bool vtkLandmarkRegistrationMoments::ComputeCenteredMoments( double sourceCentroid[ 3 ], double targetCentroid[ 3 ],
+                                                             double& sourceSumOfSquares, double& targetSumOfSquares,
+                                                             double& maximumEigenvalue, double quaternion[ 4 ] ) const
+{
+  int numberOfPointPairs = this->NumberOfPointPairs;
+  if ( numberOfPointPairs <= 0 )
+  {
+    return false;
+  }
+
+  // centroids relative to the reference points
+  double sourceMean[ 3 ];
+  double targetMean[ 3 ];
+  for ( int row = 0; row < 3; row++ )
+  {
+    sourceMean[ row ] = this->SourceSum[ row ] / numberOfPointPairs;
+    targetMean[ row ] = this->TargetSum[ row ] / numberOfPointPairs;
+    sourceCentroid[ row ] = this->SourceReference[ row ] + sourceMean[ row ];
+    targetCentroid[ row ] = this->TargetReference[ row ] + targetMean[ row ];
+  }
+
+  // sums of the points relative to their centroids
+  sourceSumOfSquares = vtkMath::Max( this->SourceSumOfSquares - numberOfPointPairs * vtkMath::Dot( sourceMean, sourceMean ), 0.0 );
+  targetSumOfSquares = vtkMath::Max( this->TargetSumOfSquares - numberOfPointPairs * vtkMath::Dot( targetMean, targetMean ), 0.0 );
+  double M[ 3 ][ 3 ];
+  for ( int row = 0; row < 3; row++ )
+  {
+    for ( int column = 0; column < 3; column++ )
+    {
+      M[ row ][ column ] = this->CrossSum[ row ][ column ] - numberOfPointPairs * sourceMean[ row ] * targetMean[ column ];
+    }
+  }
+
+  // Horn's symmetric 4x4 matrix, built the same way as in vtkLandmarkTransform
+  double N[ 4 ][ 4 ];
+  N[ 0 ][ 0 ] = M[ 0 ][ 0 ] + M[ 1 ][ 1 ] + M[ 2 ][ 2 ];
+  N[ 1 ][ 1 ] = M[ 0 ][ 0 ] - M[ 1 ][ 1 ] - M[ 2 ][ 2 ];
+  N[ 2 ][ 2 ] = -M[ 0 ][ 0 ] + M[ 1 ][ 1 ] - M[ 2 ][ 2 ];
+  N[ 3 ][ 3 ] = -M[ 0 ][ 0 ] - M[ 1 ][ 1 ] + M[ 2 ][ 2 ];
+  N[ 0 ][ 1 ] = N[ 1 ][ 0 ] = M[ 1 ][ 2 ] - M[ 2 ][ 1 ];
+  N[ 0 ][ 2 ] = N[ 2 ][ 0 ] = M[ 2 ][ 0 ] - M[ 0 ][ 2 ];
+  N[ 0 ][ 3 ] = N[ 3 ][ 0 ] = M[ 0 ][ 1 ] - M[ 1 ][ 0 ];
+  N[ 1 ][ 2 ] = N[ 2 ][ 1 ] = M[ 0 ][ 1 ] + M[ 1 ][ 0 ];
+  N[ 1 ][ 3 ] = N[ 3 ][ 1 ] = M[ 2 ][ 0 ] + M[ 0 ][ 2 ];
+  N[ 2 ][ 3 ] = N[ 3 ][ 2 ] = M[ 1 ][ 2 ] + M[ 2 ][ 1 ];
+
+  // eigenvalues are sorted in decreasing order, eigenvectors are in the columns
+  double eigenvalues[ 4 ];
+  double eigenvectors[ 4 ][ 4 ];
+  double* NRows[ 4 ] = { N[ 0 ], N[ 1 ], N[ 2 ], N[ 3 ] };
+  double* eigenvectorRows[ 4 ] = { eigenvectors[ 0 ], eigenvectors[ 1 ], eigenvectors[ 2 ], eigenvectors[ 3 ] };
+  vtkMath::JacobiN( NRows, 4, eigenvalues, eigenvectorRows );
+
+  maximumEigenvalue = eigenvalues[ 0 ];
+  for ( int row = 0; row < 4; row++ )
+  {
+    quaternion[ row ] = eigenvectors[ row ][ 0 ];
+  }
+  return true;
+}
@@ -0,0 +1,68 @@
+#ifndef __vtkLandmarkRegistrationMoments_h
+#define __vtkLandmarkRegistrationMoments_h
+
+// vtk includes
+#include <vtkLandmarkTransform.h> // for VTK_LANDMARK_RIGIDBODY and VTK_LANDMARK_SIMILARITY
+
+class vtkMatrix4x4;
+
+// export
+#include "vtkSlicerFiducialRegistrationWizardModuleLogicExport.h"
+
+// Running sums (first and second moments) of a set of corresponding point pairs.
+// The optimal rigid or similarity registration of the pairs, and its root mean square error,
+// are computed from the sums in closed form (Horn's quaternion method, as in vtkLandmarkTransform),
+// without storing the points. Point pairs can be added or removed in constant time, so the
+// registration of a correspondence that changes one pair at a time does not need to be recomputed
+// from all points. This is a lightweight value class (not a vtkObject), so that it can be kept
+// on the stack and copied without allocations.
+class VTK_SLICER_FIDUCIALREGISTRATIONWIZARD_MODULE_LOGIC_EXPORT vtkLandmarkRegistrationMoments
+{
+  public:
+    vtkLandmarkRegistrationMoments();
+
+    // Remove all point pairs
+    void Reset();
+
+    void AddPointPair( const double sourcePoint[ 3 ], const double targetPoint[ 3 ] );
+    // The point pair must have been added before. Moving a point is removing its old pair and adding the new one.
+    void RemovePointPair( const double sourcePoint[ 3 ], const double targetPoint[ 3 ] );
+
+    int GetNumberOfPointPairs() const { return this->NumberOfPointPairs; }
+
+    // Root mean square distance between the target points and the registered source points,
+    // for the best registration. Mode is VTK_LANDMARK_RIGIDBODY or VTK_LANDMARK_SIMILARITY.
+    // Returns 0 if there are no point pairs. Errors close to zero are only accurate to about 1e-8 times
+    // the spread of the points, because the error is the difference of sums of squares.
+    double ComputeRootMeanSquareError( int mode = VTK_LANDMARK_RIGIDBODY ) const;
+
+    // Sum of squared distances between the target points and the registered source points, for the best
+    // registration. Unlike the root mean square error, it can only grow when point pairs are added.
+    double ComputeSumOfSquaredErrors( int mode = VTK_LANDMARK_RIGIDBODY ) const;
+
+    // Best registration from source to target points. Returns false if there are no point pairs
+    // or the mode is not supported.
+    bool ComputeSourceToTargetMatrix( int mode, vtkMatrix4x4* sourceToTargetMatrix ) const;
+
+  private:
+    // Centered sums, and the largest eigenvalue and eigenvector (quaternion) of Horn's 4x4 matrix.
+    // Returns false if there are no point pairs.
+    bool ComputeCenteredMoments( double sourceCentroid[ 3 ], double targetCentroid[ 3 ],
+                                 double& sourceSumOfSquares, double& targetSumOfSquares,
+                                 double& maximumEigenvalue, double quaternion[ 4 ] ) const;
+
+    int NumberOfPointPairs;
+
+    // Points are accumulated relative to the first added pair, to limit the loss of precision
+    // when the coordinates are far from the origin compared to the spread of the points.
+    double SourceReference[ 3 ];
+    double TargetReference[ 3 ];
+
+    double SourceSum[ 3 ];
+    double TargetSum[ 3 ];
+    double SourceSumOfSquares;
+    double TargetSumOfSquares;
+    double CrossSum[ 3 ][ 3 ]; // sum of source[ row ] * target[ column ]
+};
+
+#endif
@@ -4,6 +4,8 @@
 #include <vtkMath.h>
 #include <vtkObjectFactory.h> //for vtkStandardNewMacro() macro
 
+#include <algorithm>
+
 //----------------------------------------------------------------------------
 vtkStandardNewMacro( vtkPointDistanceMatrix );
 
@@ -12,9 +14,11 @@ vtkPointDistanceMatrix::vtkPointDistanceMatrix()
 {
   this->PointList1 = NULL;
   this->PointList2 = NULL;
-  this->DistanceMatrix = vtkSmartPointer< vtkDoubleArray >::New();
+  this->NumberOfList1Points = 0;
+  this->NumberOfList2Points = 0;
   this->MaximumDistance = VTK_DOUBLE_MIN;
   this->MinimumDistance = VTK_DOUBLE_MAX;
+  this->SortedDistancesValid = false;
 }
 
 //------------------------------------------------------------------------------
@@ -42,29 +46,25 @@ double vtkPointDistanceMatrix::GetDistance( int pointList1Index, int pointList2I
     Update();
   }
 
-  if ( this->DistanceMatrix->GetNumberOfTuples() == 0 )
+  if ( this->DistanceMatrix.empty() )
   {
     vtkWarningMacro("Matrix has no contents. Returning 0.");
     return 0.0;
   }
 
-  int tupleIndex = pointList1Index;
-  int numberOfTuples = this->DistanceMatrix->GetNumberOfTuples();
-  if ( tupleIndex < 0 || tupleIndex >= numberOfTuples )
+  if ( pointList1Index < 0 || pointList1Index >= this->NumberOfList1Points )
   {
-    vtkWarningMacro("Point index of first list " << tupleIndex << " is outside the range 0 to " << (numberOfTuples - 1) << ". Returning 0.");
+    vtkWarningMacro("Point index of first list " << pointList1Index << " is outside the range 0 to " << (this->NumberOfList1Points - 1) << ". Returning 0.");
     return 0.0;
   }
 
-  int componentIndex = pointList2Index;
-  int numberOfComponents = this->DistanceMatrix->GetNumberOfComponents();
-  if ( componentIndex < 0 || componentIndex >= numberOfComponents )
+  if ( pointList2Index < 0 || pointList2Index >= this->NumberOfList2Points )
   {
-    vtkWarningMacro("Point index of secondList list " << componentIndex << " is outside the range 0 to " << (numberOfComponents - 1) << ". Returning 0.");
+    vtkWarningMacro("Point index of secondList list " << pointList2Index << " is outside the range 0 to " << (this->NumberOfList2Points - 1) << ". Returning 0.");
     return 0.0;
   }
 
-  return this->DistanceMatrix->GetComponent( tupleIndex, componentIndex );
+  return this->DistanceMatrix[ pointList1Index * this->NumberOfList2Points + pointList2Index ];
 }
 
 //------------------------------------------------------------------------------
@@ -81,23 +81,65 @@ void vtkPointDistanceMatrix::GetDistances( vtkDoubleArray* outputArray )
     return;
   }
 
-  if ( this->DistanceMatrix->GetNumberOfTuples() == 0 )
+  if ( this->DistanceMatrix.empty() )
   {
     vtkWarningMacro("Matrix has no contents.");
     return;
   }
 
   outputArray->Reset();
-  int numberOfTuples = this->DistanceMatrix->GetNumberOfTuples(); // aka point list 1 index
-  int numberOfComponents = this->DistanceMatrix->GetNumberOfComponents(); // aka point list 2 index
-  for ( int tupleIndex = 0; tupleIndex < numberOfTuples; tupleIndex++ )
+  outputArray->SetNumberOfComponents( 1 );
+  outputArray->SetNumberOfTuples( ( vtkIdType ) this->DistanceMatrix.size() );
+  for ( size_t distanceIndex = 0; distanceIndex < this->DistanceMatrix.size(); distanceIndex++ )
   {
-    for ( int componentIndex = 0; componentIndex < numberOfComponents; componentIndex++ )
-    {
-      double currentDistance = this->DistanceMatrix->GetComponent( tupleIndex, componentIndex );
-      outputArray->InsertNextTuple1( currentDistance );
-    }
+    outputArray->SetValue( ( vtkIdType ) distanceIndex, this->DistanceMatrix[ distanceIndex ] );
+  }
+}
+
+//------------------------------------------------------------------------------
+const double* vtkPointDistanceMatrix::GetDistancesFromList1Point( int list1Index )
+{
+  if ( this->UpdateNeeded() )
+  {
+    this->Update();
+  }
+
+  if ( !this->IsList1IndexValid( list1Index ) )
+  {
+    return NULL;
+  }
+
+  return &this->DistanceMatrix[ list1Index * this->NumberOfList2Points ];
+}
+
+//------------------------------------------------------------------------------
+const double* vtkPointDistanceMatrix::GetSortedDistancesFromList1Point( int list1Index )
+{
+  if ( this->UpdateNeeded() )
+  {
+    this->Update();
+  }
+
+  if ( !this->IsList1IndexValid( list1Index ) )
+  {
+    return NULL;
   }
+
+  this->UpdateSortedDistances();
+  return &this->SortedDistancesFromList1Points[ list1Index * this->NumberOfList2Points ];
+}
+
+//------------------------------------------------------------------------------
+bool vtkPointDistanceMatrix::IsAnyDistanceInRange( double minimumDistance, double maximumDistance )
+{
+  if ( this->UpdateNeeded() )
+  {
+    this->Update();
+  }
+
+  this->UpdateSortedDistances();
+  std::vector< double >::const_iterator firstDistanceInRange = std::lower_bound( this->SortedDistances.begin(), this->SortedDistances.end(), minimumDistance );
+  return ( firstDistanceInRange != this->SortedDistances.end() && *firstDistanceInRange <= maximumDistance );
 }
 
 //------------------------------------------------------------------------------
@@ -117,9 +159,12 @@ void vtkPointDistanceMatrix::SetPointList2( vtkPoints* points )
 //------------------------------------------------------------------------------
 void vtkPointDistanceMatrix::ResetDistances()
 {
-  this->DistanceMatrix->Reset();
+  this->NumberOfList1Points = 0;
+  this->NumberOfList2Points = 0;
+  this->DistanceMatrix.clear();
   this->MaximumDistance = VTK_DOUBLE_MIN;
   this->MinimumDistance = VTK_DOUBLE_MAX;
+  this->SortedDistancesValid = false;
 }
 
 //------------------------------------------------------------------------------
@@ -131,22 +176,39 @@ void vtkPointDistanceMatrix::Update()
     return;
   }
 
-  int pointList2Length = this->PointList2->GetNumberOfPoints();
-  this->DistanceMatrix->SetNumberOfComponents( pointList2Length );
+  this->ResetDistances();
   int pointList1Length = this->PointList1->GetNumberOfPoints();
-  this->DistanceMatrix->SetNumberOfTuples( pointList1Length );
+  int pointList2Length = this->PointList2->GetNumberOfPoints();
+  this->NumberOfList1Points = pointList1Length;
+  this->NumberOfList2Points = pointList2Length;
+  this->DistanceMatrix.resize( pointList1Length * pointList2Length );
+
+  // read the coordinates only once
+  std::vector< double > pointList1Coordinates( pointList1Length * 3 );
+  for ( int pointList1Index = 0; pointList1Index < pointList1Length; pointList1Index++ )
+  {
+    this->PointList1->GetPoint( pointList1Index, &pointList1Coordinates[ pointList1Index * 3 ] );
+  }
+  std::vector< double > pointList2Coordinates( pointList2Length * 3 );
+  for ( int pointList2Index = 0; pointList2Index < pointList2Length; pointList2Index++ )
+  {
+    this->PointList2->GetPoint( pointList2Index, &pointList2Coordinates[ pointList2Index * 3 ] );
+  }
 
+  // distances of a list to itself are symmetric, only compute the upper triangle and mirror it
+  bool symmetric = ( this->PointList1 == this->PointList2 );
   for ( int pointList1Index = 0; pointList1Index < pointList1Length; pointList1Index++ )
   {
-    for ( int pointList2Index = 0; pointList2Index < pointList2Length; pointList2Index++ )
+    int firstPointList2Index = ( symmetric ? pointList1Index : 0 );
+    for ( int pointList2Index = firstPointList2Index; pointList2Index < pointList2Length; pointList2Index++ )
     {
-      double pointInList1[ 3 ];
-      this->PointList1->GetPoint( pointList1Index, pointInList1 );
-      double pointInList2[ 3 ];
-      this->PointList2->GetPoint( pointList2Index, pointInList2 );
-      double distanceSquared = vtkMath::Distance2BetweenPoints( pointInList1, pointInList2 );
+      double distanceSquared = vtkMath::Distance2BetweenPoints( &pointList1Coordinates[ pointList1Index * 3 ], &pointList2Coordinates[ pointList2Index * 3 ] );
       double distance = sqrt( distanceSquared );
-      this->DistanceMatrix->SetComponent( pointList1Index, pointList2Index, distance );
+      this->DistanceMatrix[ pointList1Index * pointList2Length + pointList2Index ] = distance;
+      if ( symmetric )
+      {
+        this->DistanceMatrix[ pointList2Index * pointList2Length + pointList1Index ] = distance;
+      }
       if ( distance > this->MaximumDistance )
       {
         this->MaximumDistance = distance;
@@ -162,6 +224,57 @@ void vtkPointDistanceMatrix::Update()
   this->MatrixUpdateTime.Modified();
 }
 
+//------------------------------------------------------------------------------
+void vtkPointDistanceMatrix::UpdateSortedDistances()
+{
+  if ( this->SortedDistancesValid )
+  {
+    return;
+  }
+
+  int pointList1Length = this->NumberOfList1Points;
+  int pointList2Length = this->NumberOfList2Points;
+  this->SortedDistancesFromList1Points = this->DistanceMatrix;
+  for ( int pointList1Index = 0; pointList1Index < pointList1Length; pointList1Index++ )
+  {
+    double* distances = &this->SortedDistancesFromList1Points[ pointList1Index * pointList2Length ];
+    std::sort( distances, distances + pointList2Length );
+  }
+
+  // distances of a list to itself are symmetric, and the distance of each point to itself is zero
+  this->SortedDistances.clear();
+  bool symmetric = ( this->PointList1 == this->PointList2 );
+  for ( int pointList1Index = 0; pointList1Index < pointList1Length; pointList1Index++ )
+  {
+    int firstPointList2Index = ( symmetric ? pointList1Index + 1 : 0 );
+    for ( int pointList2Index = firstPointList2Index; pointList2Index < pointList2Length; pointList2Index++ )
+    {
+      this->SortedDistances.push_back( this->DistanceMatrix[ pointList1Index * pointList2Length + pointList2Index ] );
+    }
+  }
+  std::sort( this->SortedDistances.begin(), this->SortedDistances.end() );
+
+  this->SortedDistancesValid = true;
+}
+
+//------------------------------------------------------------------------------
+bool vtkPointDistanceMatrix::IsList1IndexValid( int list1Index )
+{
+  if ( this->DistanceMatrix.empty() )
+  {
+    vtkWarningMacro( "Matrix has no contents." );
+    return false;
+  }
+
+  if ( list1Index < 0 || list1Index >= this->NumberOfList1Points )
+  {
+    vtkWarningMacro( "Point index of first list " << list1Index << " is outside the range 0 to " << ( this->NumberOfList1Points - 1 ) << "." );
+    return false;
+  }
+
+  return true;
+}
+
 //------------------------------------------------------------------------------
 bool vtkPointDistanceMatrix::UpdateNeeded()
 {
@@ -6,16 +6,20 @@
 #include <vtkPoints.h>
 #include <vtkTimeStamp.h>
 
+#include <vector>
+
 // export
 #include "vtkSlicerFiducialRegistrationWizardModuleLogicExport.h"
 
 // At its most basic level, this is a Wrapper class for storing a matrix of
-// point to point distances in a vtkDoubleArray.
+// point to point distances in a contiguous array (one row per point in list 1).
 // The purpose is to improve the abstraction of storing distances, instead of
 // memorizing how distances are accessed etc... One can use this class to
 // encapsulate that functionality.
 // The contents of the matrix are automatically re-generated when either input
-// point list is changed.
+// point list is changed. If both lists are the same, each distance is only computed once.
+// The distances are also available in ascending order (per point in list 1, and for the whole matrix),
+// for range queries. They are sorted on the first request after an update.
 class VTK_SLICER_FIDUCIALREGISTRATIONWIZARD_MODULE_LOGIC_EXPORT vtkPointDistanceMatrix : public vtkObject //vtkAlgorithm?
 {
   public:
@@ -28,11 +32,20 @@ class VTK_SLICER_FIDUCIALREGISTRATIONWIZARD_MODULE_LOGIC_EXPORT vtkPointDistance
     vtkPoints* GetPointList2();
     double GetDistance( int list1Index, int list2Index );
     void GetDistances( vtkDoubleArray* outputArray );
+    // Distances from a point in list 1 to all points in list 2. Valid until the next update.
+    const double* GetDistancesFromList1Point( int list1Index );
+    // The same distances in ascending order. Valid until the next update.
+    const double* GetSortedDistancesFromList1Point( int list1Index );
     vtkGetMacro( MaximumDistance, int );
     vtkGetMacro( MinimumDistance, int );
 
     void SetPointList1( vtkPoints* points );
     void SetPointList2( vtkPoints* points );
+
+    // Whether any pair of points (one from each list, two different points if both lists are the same)
+    // is within minimumDistance .. maximumDistance of each other.
+    // Can be used to quickly reject a distance that has no counterpart in the matrix. Found by binary search.
+    bool IsAnyDistanceInRange( double minimumDistance, double maximumDistance );
     
     void Update();
 
@@ -45,15 +58,24 @@ class VTK_SLICER_FIDUCIALREGISTRATIONWIZARD_MODULE_LOGIC_EXPORT vtkPointDistance
     vtkPoints* PointList2;
 
     // outputs
-    vtkSmartPointer< vtkDoubleArray > DistanceMatrix;
+    int NumberOfList1Points;
+    int NumberOfList2Points;
+    std::vector< double > DistanceMatrix; // NumberOfList1Points x NumberOfList2Points
     vtkTimeStamp MatrixUpdateTime;
     double MaximumDistance;
     double MinimumDistance;
 
+    // index for the range queries
+    std::vector< double > SortedDistancesFromList1Points; // each row of the matrix in ascending order
+    std::vector< double > SortedDistances; // all distances in ascending order (each pair only once if both lists are the same)
+    bool SortedDistancesValid;
+
     bool UpdateNeeded();
     bool InputsContainErrors( bool verbose=true );
+    bool IsList1IndexValid( int list1Index );
 
     void ResetDistances();
+    void UpdateSortedDistances();
 
 		vtkPointDistanceMatrix(const vtkPointDistanceMatrix&); // Not implemented.
 		void operator=(const vtkPointDistanceMatrix&); // Not implemented.
@@ -1,20 +1,116 @@
 #include "vtkPointMatcher.h"
 #include "vtkPointDistanceMatrix.h"
 #include "vtkCombinatoricGenerator.h"
+#include "vtkLandmarkRegistrationMoments.h"
 #include <vtkDoubleArray.h>
 #include <vtkGeneralTransform.h>
 #include <vtkIterativeClosestPointTransform.h>
 #include <vtkLandmarkTransform.h>
+#include <vtkMatrix4x4.h>
 #include <vtkPointLocator.h>
 #include <vtkPolyData.h>
 #include <vtkSmartPointer.h>
+#include <vtkStaticPointLocator.h>
 #include <vtkTransform.h>
 #include <vtkTransformPolyDataFilter.h>
 #include <vtkMath.h>
 
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
 #define RESET_VALUE_COMPUTED_ROOT_MEAN_DISTANCE_ERROR VTK_DOUBLE_MAX
 #define MINIMUM_NUMBER_OF_POINTS_NEEDED_TO_MATCH 3
 #define MAXIMUM_NUMBER_OF_POINTS_NEEDED_FOR_DETERMINISTIC_MATCH 5
+#define MAXIMUM_NUMBER_OF_BRANCH_AND_BOUND_CANDIDATE_UPDATES 100000000 // keeps the search interactive on inputs that do not match
+#define NUMBER_OF_BRANCH_AND_BOUND_TOLERANCE_RELAXATIONS 4
+#define BRANCH_AND_BOUND_UNDECIDED -1
+#define BRANCH_AND_BOUND_SKIPPED -2
+#define MINIMUM_NUMBER_OF_SUBSET_PAIRS_PER_THREAD 4 // fewer are not worth starting a thread for
+#define NUMBER_OF_SUBSET_PAIR_CHUNKS_PER_THREAD 4 // to balance the load when pruning makes some chunks faster
+#define MAXIMUM_NUMBER_OF_ICP_ITERATIONS 50 // same as vtkIterativeClosestPointTransform
+#define NUMBER_OF_ICP_ITERATIONS_BETWEEN_CHECKS 5
+#define ICP_ABANDON_RESIDUAL_MULTIPLE 3.0 // the residual of an unfinished run is compared leniently, it still decreases
+
+//------------------------------------------------------------------------------
+// State of the branch and bound correspondence search. Distances are copied out of
+// vtkPointDistanceMatrix into flat arrays owned by the state, because the search reads them in its innermost loop.
+struct vtkPointMatcher::BranchAndBoundState
+{
+  int NumberOfSourcePoints;
+  int NumberOfTargetPoints;
+  int SubsetSize;
+  int MaximumNumberOfSkippedSourcePoints;
+  double PairwiseDistanceTolerance;
+  double AmbiguityDistance;
+
+  std::vector< double > SourceDistances; // NumberOfSourcePoints x NumberOfSourcePoints
+  std::vector< double > TargetDistances; // NumberOfTargetPoints x NumberOfTargetPoints
+  std::vector< double > SourcePriorities; // to break ties when choosing the next source point to match
+
+  // For each (undecided source point, target point) candidate pair:
+  // sum of squared pairwise distance residuals against the already assigned pairs, and
+  // number of assigned pairs for which the residual exceeds the pairwise distance tolerance
+  // (plus one if the target point is already assigned). Candidates without violations are feasible.
+  std::vector< double > CandidateCosts;
+  std::vector< int > CandidateViolations;
+
+  std::vector< int > Correspondences; // target point index for each source point, or BRANCH_AND_BOUND_UNDECIDED/SKIPPED
+  int NumberOfAssignedPoints;
+  int NumberOfSkippedPoints;
+  double AssignedCost; // sum of squared pairwise distance residuals among the assigned pairs
+
+  std::vector< double > SourceCoordinates; // NumberOfSourcePoints x 3
+  std::vector< double > TargetCoordinates; // NumberOfTargetPoints x 3
+  vtkLandmarkRegistrationMoments AssignedMoments; // of the assigned pairs, updated as pairs are assigned and unassigned
+
+  double BestDistanceError; // registration error of the best complete correspondence
+  std::vector< int > BestCorrespondences;
+  bool MatchingAmbiguous;
+  // If true then BestCorrespondences is the accepted correspondence and BestDistanceError is kept,
+  // the search only looks for another correspondence that makes it ambiguous
+  bool AmbiguityCheck;
+  int NumberOfRemainingNodes;
+  std::vector< double > MinimumCandidateCosts; // scratch space for the lower bound
+};
+
+//------------------------------------------------------------------------------
+// Best matching of a range of candidate subsets, and the best error found so far by all threads.
+struct vtkPointMatcher::SubsetMatchingResult
+{
+  SubsetMatchingResult()
+    : BestDistanceError( RESET_VALUE_COMPUTED_ROOT_MEAN_DISTANCE_ERROR )
+    , SecondBestDistanceError( RESET_VALUE_COMPUTED_ROOT_MEAN_DISTANCE_ERROR )
+    , MatchedSourcePoints( vtkSmartPointer< vtkPoints >::New() )
+    , MatchedTargetPoints( vtkSmartPointer< vtkPoints >::New() )
+    , SharedBestDistanceError( NULL )
+  {
+  }
+
+  double BestDistanceError;
+  double SecondBestDistanceError; // smallest error of the other candidates (that were not skipped)
+  vtkSmartPointer< vtkPoints > MatchedSourcePoints;
+  vtkSmartPointer< vtkPoints > MatchedTargetPoints;
+  std::atomic< double >* SharedBestDistanceError;
+};
+
+//------------------------------------------------------------------------------
+// Result of one ICP run.
+struct vtkPointMatcher::ICPRunResult
+{
+  ICPRunResult()
+    : MatchingSuccessful( false )
+    , DistanceError( RESET_VALUE_COMPUTED_ROOT_MEAN_DISTANCE_ERROR )
+    , MatchedSourcePoints( vtkSmartPointer< vtkPoints >::New() )
+    , MatchedTargetPoints( vtkSmartPointer< vtkPoints >::New() )
+  {
+  }
+
+  bool MatchingSuccessful; // false if the run was abandoned or the points could not be matched
+  double DistanceError;
+  vtkSmartPointer< vtkPoints > MatchedSourcePoints;
+  vtkSmartPointer< vtkPoints > MatchedTargetPoints;
+};
 
 //----------------------------------------------------------------------------
 vtkStandardNewMacro( vtkPointMatcher );
@@ -31,6 +127,8 @@ vtkPointMatcher::vtkPointMatcher()
   this->AmbiguityDistanceErrorMultiple = 0.05;
   this->AmbiguityDistanceError = 0.0;
   this->MatchingAmbiguous = false;
+  this->NumberOfThreads = 0;
+  this->GeneralMatchingMethod = vtkPointMatcher::GeneralMatchingAllMethods;
   // outputs are never null
   this->OutputSourcePoints = vtkSmartPointer< vtkPoints >::New();
   this->OutputTargetPoints = vtkSmartPointer< vtkPoints >::New();
@@ -59,7 +157,7 @@ vtkPointMatcher::~vtkPointMatcher()
 void vtkPointMatcher::PrintSelf( std::ostream &os, vtkIndent indent )
 {
   Superclass::PrintSelf( os, indent );
-  
+
   os << indent << "MaximumDifferenceInNumberOfPoints: " << this->MaximumDifferenceInNumberOfPoints << std::endl;
   os << indent << "ComputedDistanceError: " << this->ComputedDistanceError << std::endl;
   os << indent << "TolerableDistanceErrorMultiple: " << this->TolerableDistanceErrorMultiple << std::endl;
@@ -67,6 +165,8 @@ void vtkPointMatcher::PrintSelf( std::ostream &os, vtkIndent indent )
   os << indent << "AmbiguityDistanceErrorMultiple: " << this->AmbiguityDistanceErrorMultiple << std::endl;
   os << indent << "AmbiguityDistanceError: " << this->AmbiguityDistanceError << std::endl;
   os << indent << "MatchingAmbiguous: " << this->MatchingAmbiguous << std::endl;
+  os << indent << "NumberOfThreads: " << this->NumberOfThreads << std::endl;
+  os << indent << "GeneralMatchingMethod: " << this->GeneralMatchingMethod << std::endl;
 }
 
 //------------------------------------------------------------------------------
@@ -129,7 +229,7 @@ bool vtkPointMatcher::IsMatchingWithinTolerance()
   {
     this->Update();
   }
-  
+
   return ( this->ComputedDistanceError <= this->TolerableDistanceError );
 }
 
@@ -183,7 +283,7 @@ void vtkPointMatcher::Update()
     vtkWarningMacro( "Cannot update - inputs are invalid.." );
     return;
   }
-  
+
   double maximumDistanceInTargetPoints = vtkPointMatcher::ComputeMaximumDistanceInPointSet( this->InputTargetPoints );
   this->ComputedDistanceError = RESET_VALUE_COMPUTED_ROOT_MEAN_DISTANCE_ERROR;
   this->TolerableDistanceError = maximumDistanceInTargetPoints * this->TolerableDistanceErrorMultiple;
@@ -217,7 +317,7 @@ void vtkPointMatcher::Update()
   {
     this->HandleMatchFailure();
   }
-  
+
   this->OutputChangedTime.Modified();
 }
 
@@ -233,16 +333,120 @@ bool vtkPointMatcher::MatchPointsExhaustively()
                                                           this->InputSourcePoints, this->InputTargetPoints,
                                                           this->AmbiguityDistanceError, this->MatchingAmbiguous,
                                                           this->ComputedDistanceError, this->TolerableDistanceError,
-                                                          this->OutputSourcePoints, this->OutputTargetPoints );
+                                                          this->OutputSourcePoints, this->OutputTargetPoints,
+                                                          this->NumberOfThreads );
   return true; // search is exhaustive, so it *will* find the best match
 }
 
+//------------------------------------------------------------------------------
+bool vtkPointMatcher::MatchPointsUsingBranchAndBound()
+{
+  int numberOfSourcePoints = this->InputSourcePoints->GetNumberOfPoints();
+  int numberOfTargetPoints = this->InputTargetPoints->GetNumberOfPoints();
+  int smallerPointListSize = vtkMath::Min( numberOfSourcePoints, numberOfTargetPoints );
+  int minimumSubsetSize = vtkMath::Max( ( smallerPointListSize - ( int )this->MaximumDifferenceInNumberOfPoints ), MINIMUM_NUMBER_OF_POINTS_NEEDED_TO_MATCH );
+  int maximumSubsetSize = smallerPointListSize;
+
+  // The distance between two points can change by the localization error of both points.
+  // Use at most the same leniency for the localization error as the outlier removal of the other methods.
+  // Tight tolerances prune the search much earlier, so start with a fraction of it and relax it until a match is found.
+  double maximumPairwiseDistanceTolerance = 2.0 * sqrt( this->Distance2ForOutlierRemovalAfterInitialRegistration() );
+
+  // Every visited partial correspondence costs in the order of numberOfSourcePoints * numberOfTargetPoints operations
+  int numberOfRemainingNodes = vtkMath::Max( MAXIMUM_NUMBER_OF_BRANCH_AND_BOUND_CANDIDATE_UPDATES / ( numberOfSourcePoints * numberOfTargetPoints ), 1 );
+
+  // Proving that there is no correspondence of all points (e.g. because of an outlier) can take the longest at the
+  // most relaxed tolerance, so the budget is shared by the subset sizes. Nodes that a subset size does not use
+  // are left for the smaller subsets.
+  bool searchStopped = false;
+  std::vector< int > correspondences;
+  vtkSmartPointer< vtkPoints > matchedSourcePoints = vtkSmartPointer< vtkPoints >::New();
+  vtkSmartPointer< vtkPoints > matchedTargetPoints = vtkSmartPointer< vtkPoints >::New();
+  for ( int subsetSize = maximumSubsetSize; subsetSize >= minimumSubsetSize; subsetSize-- )
+  {
+    int numberOfRemainingSubsetSizes = subsetSize - minimumSubsetSize + 1;
+    int numberOfRemainingNodesForSubsetSize = numberOfRemainingNodes / numberOfRemainingSubsetSizes;
+    numberOfRemainingNodes -= numberOfRemainingNodesForSubsetSize;
+    double pairwiseDistanceTolerance = maximumPairwiseDistanceTolerance / pow( 2.0, NUMBER_OF_BRANCH_AND_BOUND_TOLERANCE_RELAXATIONS );
+    for ( int relaxationIndex = 0; relaxationIndex <= NUMBER_OF_BRANCH_AND_BOUND_TOLERANCE_RELAXATIONS; relaxationIndex++, pairwiseDistanceTolerance *= 2.0 )
+    {
+      if ( numberOfRemainingNodesForSubsetSize <= 0 )
+      {
+        searchStopped = true;
+        break;
+      }
+
+      bool matchingAmbiguous = false;
+      bool matchingFound = vtkPointMatcher::UpdateBestMatchingUsingBranchAndBound( subsetSize,
+                                                                                   this->InputSourcePoints, this->InputTargetPoints,
+                                                                                   pairwiseDistanceTolerance, this->AmbiguityDistanceError, matchingAmbiguous,
+                                                                                   numberOfRemainingNodesForSubsetSize,
+                                                                                   matchedSourcePoints, matchedTargetPoints, correspondences );
+      if ( !matchingFound )
+      {
+        continue;
+      }
+
+      double distanceError = vtkPointMatcher::ComputeRegistrationRootMeanSquareError( matchedSourcePoints, matchedTargetPoints );
+      if ( distanceError > this->TolerableDistanceError )
+      {
+        continue;
+      }
+
+      // With a relaxed tolerance, a wrong pair can be hidden in the registration error of many correct pairs.
+      // Like after the initial registration of the other methods, a pair that is that far off is an outlier.
+      if ( vtkPointMatcher::ComputeMaximumRegistrationDistance2( matchedSourcePoints, matchedTargetPoints ) > this->Distance2ForOutlierRemovalAfterInitialRegistration() )
+      {
+        continue;
+      }
+
+      // Alternatives within the ambiguity distance were only visited if they are within the pairwise distance tolerance
+      if ( !matchingAmbiguous )
+      {
+        numberOfRemainingNodes += numberOfRemainingNodesForSubsetSize;
+        matchingAmbiguous = vtkPointMatcher::IsMatchingAmbiguousUsingBranchAndBound( subsetSize,
+                                                                                     this->InputSourcePoints, this->InputTargetPoints,
+                                                                                     correspondences, distanceError, this->AmbiguityDistanceError,
+                                                                                     numberOfRemainingNodes );
+      }
+
+      this->MatchingAmbiguous = matchingAmbiguous;
+      this->ComputedDistanceError = distanceError;
+      this->OutputSourcePoints->DeepCopy( matchedSourcePoints );
+      this->OutputTargetPoints->DeepCopy( matchedTargetPoints );
+      return true;
+    }
+    numberOfRemainingNodes += numberOfRemainingNodesForSubsetSize;
+  }
+
+  if ( searchStopped )
+  {
+    vtkWarningMacro( "Branch and bound search was stopped before it found a matching, because it took too long." );
+  }
+  return false;
+}
+
 //------------------------------------------------------------------------------
 bool vtkPointMatcher::MatchPointsGenerally()
 {
+  if ( this->GeneralMatchingMethod == vtkPointMatcher::GeneralMatchingBranchAndBound )
+  {
+    return this->MatchPointsUsingBranchAndBound();
+  }
+  else if ( this->GeneralMatchingMethod == vtkPointMatcher::GeneralMatchingICP )
+  {
+    return this->MatchPointsGenerallyUsingICP();
+  }
+
   bool matchingSuccessful = false;
 
   // try any algorithms here in turn until one is successful
+  matchingSuccessful = this->MatchPointsUsingBranchAndBound();
+  if ( matchingSuccessful )
+  {
+    return true;
+  }
+
   matchingSuccessful = this->MatchPointsGenerallyUsingMaximumDistancesAndCentroid();
   if ( matchingSuccessful )
   {
@@ -298,7 +502,7 @@ bool vtkPointMatcher::MatchPointsGenerallyUsingMaximumDistancesAndCentroid()
     vtkWarningMacro( "Unable to extract maximum distances and centroids from source list" );
     return false;
   }
-  
+
   vtkSmartPointer< vtkPoints > targetFeatures = vtkSmartPointer< vtkPoints >::New();
   featureExtractionSuccessful = vtkPointMatcher::ExtractMaximumDistanceAndCentroidFeatures( this->InputTargetPoints, targetFeatures );
   if ( featureExtractionSuccessful == false )
@@ -347,7 +551,8 @@ bool vtkPointMatcher::MatchPointsGenerallyUsingSubsample( vtkPoints* unmatchedRe
                                                           unmatchedReducedSourcePoints, unmatchedReducedTargetPoints,
                                                           this->AmbiguityDistanceError, matchingAmbiguous,
                                                           bestDistanceError, tolerableDistanceErrorForSubsets,
-                                                          initiallyMatchedReducedSourcePoints, initiallyMatchedReducedTargetPoints );
+                                                          initiallyMatchedReducedSourcePoints, initiallyMatchedReducedTargetPoints,
+                                                          this->NumberOfThreads );
 
   // Compute initial registration based on this correspondence
   vtkSmartPointer< vtkLandmarkTransform > initialRegistrationTransform = vtkSmartPointer< vtkLandmarkTransform >::New();
@@ -448,98 +653,233 @@ bool vtkPointMatcher::MatchPointsGenerallyUsingICP()
     315
   };
 
-  vtkSmartPointer< vtkPolyData > unmatchedSourcePointsPolyData = vtkSmartPointer< vtkPolyData >::New();
-  bool polyDataGenerated = vtkPointMatcher::GeneratePolyDataFromPoints( this->InputSourcePoints, unmatchedSourcePointsPolyData );
+  vtkSmartPointer< vtkPolyData > unmatchedTargetPointsPolyData = vtkSmartPointer< vtkPolyData >::New();
+  bool polyDataGenerated = vtkPointMatcher::GeneratePolyDataFromPoints( this->InputTargetPoints, unmatchedTargetPointsPolyData );
   if ( !polyDataGenerated )
   {
-    vtkGenericWarningMacro( "Unable to generate poly data from source points" );
+    vtkGenericWarningMacro( "Unable to generate poly data from target points" );
     return false;
   }
 
-  vtkSmartPointer< vtkPolyData > unmatchedTargetPointsPolyData = vtkSmartPointer< vtkPolyData >::New();
-  polyDataGenerated = vtkPointMatcher::GeneratePolyDataFromPoints( this->InputTargetPoints, unmatchedTargetPointsPolyData );
-  if ( !polyDataGenerated )
+  // The locator is built once, and then only read by all runs
+  vtkSmartPointer< vtkStaticPointLocator > targetPointLocator = vtkSmartPointer< vtkStaticPointLocator >::New();
+  targetPointLocator->SetDataSet( unmatchedTargetPointsPolyData );
+  targetPointLocator->BuildLocator();
+
+  // The runs are taken by the threads from a shared counter. Runs are independent of each other,
+  // results are kept per run and combined in run order below, like in a single sequential pass.
+  const int numberOfRuns = numberOfAxes * numberOfAngles;
+  int numberOfThreads = this->NumberOfThreads;
+  if ( numberOfThreads <= 0 )
   {
-    vtkGenericWarningMacro( "Unable to generate poly data from target points" );
-    return false;
+    numberOfThreads = std::max( static_cast< int >( std::thread::hardware_concurrency() ), 1 );
   }
+  numberOfThreads = std::min( numberOfThreads, numberOfRuns );
 
-  // re-used variables
-  vtkSmartPointer< vtkTransform > initialAlignmentTransform = vtkSmartPointer< vtkTransform >::New();
-  vtkSmartPointer< vtkTransformPolyDataFilter > initialAlignmentransformFilter = vtkSmartPointer< vtkTransformPolyDataFilter >::New();
-  vtkSmartPointer< vtkIterativeClosestPointTransform > icpTransform = vtkSmartPointer< vtkIterativeClosestPointTransform >::New();
-  icpTransform->GetLandmarkTransform()->SetModeToRigidBody();
-  icpTransform->StartByMatchingCentroidsOn();
-  vtkSmartPointer< vtkGeneralTransform > concatenatedAlignment = vtkSmartPointer< vtkGeneralTransform >::New();
   double thresholdDistance2ForOutlier = this->Distance2ForOutlierRemovalAfterInitialRegistration();
-  vtkSmartPointer< vtkPoints > matchedSourcePoints = vtkSmartPointer< vtkPoints >::New();
-  vtkSmartPointer< vtkPoints > matchedTargetPoints = vtkSmartPointer< vtkPoints >::New();
-  vtkSmartPointer< vtkPoints > bestMatchedSourcePoints = vtkSmartPointer< vtkPoints >::New();
-  vtkSmartPointer< vtkPoints > bestMatchedTargetPoints = vtkSmartPointer< vtkPoints >::New();
-  double bestDistanceError = VTK_DOUBLE_MAX;
-  bool matchingAmbiguous;
-  for ( int axisIndex = 0; axisIndex < numberOfAxes; axisIndex++ )
-  {
-    double axis[ 3 ];
-    axis[ 0 ] = axes[ axisIndex * 3 ];
-    axis[ 1 ] = axes[ axisIndex * 3 + 1 ];
-    axis[ 2 ] = axes[ axisIndex * 3 + 2 ];
-    for ( int angleIndex = 0; angleIndex < numberOfAngles; angleIndex++ )
+  std::vector< ICPRunResult > runResults( numberOfRuns );
+  std::atomic< int > nextRunIndex( 0 );
+  auto runICP = [&]()
+  {
+    // the input points are copied, so that each thread only accesses its own point lists
+    vtkSmartPointer< vtkPoints > unmatchedSourcePoints = vtkSmartPointer< vtkPoints >::New();
+    unmatchedSourcePoints->DeepCopy( this->InputSourcePoints );
+    vtkSmartPointer< vtkPoints > unmatchedTargetPoints = vtkSmartPointer< vtkPoints >::New();
+    unmatchedTargetPoints->DeepCopy( this->InputTargetPoints );
+    vtkSmartPointer< vtkTransform > initialAlignmentTransform = vtkSmartPointer< vtkTransform >::New();
+    for ( int runIndex = nextRunIndex++; runIndex < numberOfRuns; runIndex = nextRunIndex++ )
     {
+      int axisIndex = runIndex / numberOfAngles;
+      int angleIndex = runIndex % numberOfAngles;
+      double axis[ 3 ];
+      axis[ 0 ] = axes[ axisIndex * 3 ];
+      axis[ 1 ] = axes[ axisIndex * 3 + 1 ];
+      axis[ 2 ] = axes[ axisIndex * 3 + 2 ];
       double angle = angles[ angleIndex ];
       initialAlignmentTransform->Identity();
       initialAlignmentTransform->RotateWXYZ( angle, axis );
-  
-      initialAlignmentransformFilter->SetTransform( initialAlignmentTransform );
-      initialAlignmentransformFilter->SetInputData( unmatchedSourcePointsPolyData );
-      initialAlignmentransformFilter->Update();
 
-      vtkPolyData* initiallyAlignedSourcePointsPolyData = vtkPolyData::SafeDownCast( initialAlignmentransformFilter->GetOutput() );
-      if ( initiallyAlignedSourcePointsPolyData == NULL )
-      {
-        vtkGenericWarningMacro( "Initially aligned points poly data is null." );
-        return false;
-      }
+      ICPRunResult& runResult = runResults[ runIndex ];
+      vtkPointMatcher::UpdateICPRunFromInitialAlignment( initialAlignmentTransform->GetMatrix(),
+                                                         unmatchedSourcePoints, unmatchedTargetPoints, targetPointLocator,
+                                                         thresholdDistance2ForOutlier, this->MaximumDifferenceInNumberOfPoints,
+                                                         this->TolerableDistanceError, this->AmbiguityDistanceError, runResult );
+    }
+  };
 
-      icpTransform->SetSource( initiallyAlignedSourcePointsPolyData );
-      icpTransform->SetTarget( unmatchedTargetPointsPolyData );
-      icpTransform->Update();
-
-      concatenatedAlignment->Identity();
-      concatenatedAlignment->PostMultiply();
-      concatenatedAlignment->Concatenate( initialAlignmentTransform );
-      concatenatedAlignment->Concatenate( icpTransform );
-      bool matchingSuccessful = vtkPointMatcher::ComputePointMatchingBasedOnRegistration( concatenatedAlignment,
-                                                                                          this->InputSourcePoints, this->InputTargetPoints,
-                                                                                          thresholdDistance2ForOutlier, this->MaximumDifferenceInNumberOfPoints,
-                                                                                          matchedSourcePoints, matchedTargetPoints );
-      if ( !matchingSuccessful )
-      {
-        continue;
-      }
+  std::vector< std::thread > icpThreads;
+  for ( int threadIndex = 1; threadIndex < numberOfThreads; threadIndex++ )
+  {
+    icpThreads.emplace_back( runICP );
+  }
+  runICP();
+  for ( std::thread& icpThread : icpThreads )
+  {
+    icpThread.join();
+  }
 
-      double currentDistanceError = vtkPointMatcher::ComputeRegistrationRootMeanSquareError( matchedSourcePoints, matchedTargetPoints );
-      vtkPointMatcher::UpdateAmbiguityFlag( currentDistanceError, bestDistanceError, this->AmbiguityDistanceError, matchingAmbiguous );
-      if ( currentDistanceError == bestDistanceError )
-      {
-        bestMatchedSourcePoints->DeepCopy( matchedSourcePoints );
-        bestMatchedTargetPoints->DeepCopy( matchedTargetPoints );
-      }
+  double bestDistanceError = VTK_DOUBLE_MAX;
+  bool matchingAmbiguous = false;
+  ICPRunResult* bestRunResult = NULL;
+  for ( int runIndex = 0; runIndex < numberOfRuns; runIndex++ )
+  {
+    ICPRunResult& runResult = runResults[ runIndex ];
+    if ( !runResult.MatchingSuccessful )
+    {
+      continue;
+    }
+
+    vtkPointMatcher::UpdateAmbiguityFlag( runResult.DistanceError, bestDistanceError, this->AmbiguityDistanceError, matchingAmbiguous );
+    if ( runResult.DistanceError == bestDistanceError )
+    {
+      bestRunResult = &runResult;
     }
   }
 
-  if ( bestDistanceError > this->TolerableDistanceError )
+  if ( bestRunResult == NULL || bestDistanceError > this->TolerableDistanceError )
   {
     return false;
   }
-  
+
   this->MatchingAmbiguous = matchingAmbiguous;
   this->ComputedDistanceError = bestDistanceError;
-  this->OutputSourcePoints->DeepCopy( bestMatchedSourcePoints );
-  this->OutputTargetPoints->DeepCopy( bestMatchedTargetPoints );
+  this->OutputSourcePoints->DeepCopy( bestRunResult->MatchedSourcePoints );
+  this->OutputTargetPoints->DeepCopy( bestRunResult->MatchedTargetPoints );
   return true;
 }
 
+//------------------------------------------------------------------------------
+// Point to point ICP, like vtkIterativeClosestPointTransform (rigid, starting by matching the centroids).
+// Unlike vtkIterativeClosestPointTransform it uses a locator that is built once for all runs, and
+// it can stop early:
+// - When the closest points no longer change, further iterations would not move the points.
+// - Every few iterations, the residual of the closest points (without the largest distances, that
+//   can belong to unmatched points) is compared with the tolerable error (plus the ambiguity distance).
+//   Errors above it cannot affect the result, so a run that is still far from it is abandoned.
+//   The comparison does not depend on the other runs, so the result does not depend on the order of the runs.
+void vtkPointMatcher::UpdateICPRunFromInitialAlignment( vtkMatrix4x4* initialAlignmentMatrix,
+                                                        vtkPoints* unmatchedSourcePoints,
+                                                        vtkPoints* unmatchedTargetPoints,
+                                                        vtkAbstractPointLocator* targetPointLocator,
+                                                        double thresholdDistance2ForOutlier,
+                                                        unsigned int maximumOutlierCount,
+                                                        double tolerableDistanceError,
+                                                        double ambiguityDistance,
+                                                        ICPRunResult& result )
+{
+  result.MatchingSuccessful = false;
+
+  int numberOfSourcePoints = unmatchedSourcePoints->GetNumberOfPoints();
+  int numberOfTargetPoints = unmatchedTargetPoints->GetNumberOfPoints();
+  if ( numberOfSourcePoints == 0 || numberOfTargetPoints == 0 )
+  {
+    vtkGenericWarningMacro( "There are no points to register." );
+    return;
+  }
+
+  // align the source points, then match their centroid with the target centroid
+  vtkSmartPointer< vtkMatrix4x4 > sourceToTargetMatrix = vtkSmartPointer< vtkMatrix4x4 >::New();
+  sourceToTargetMatrix->DeepCopy( initialAlignmentMatrix );
+  std::vector< double > alignedSourceCoordinates( numberOfSourcePoints * 3 );
+  double sourceCentroid[ 3 ] = { 0.0, 0.0, 0.0 };
+  for ( int sourcePointIndex = 0; sourcePointIndex < numberOfSourcePoints; sourcePointIndex++ )
+  {
+    double sourcePoint[ 4 ] = { 0.0, 0.0, 0.0, 1.0 };
+    unmatchedSourcePoints->GetPoint( sourcePointIndex, sourcePoint );
+    sourceToTargetMatrix->MultiplyPoint( sourcePoint, sourcePoint );
+    for ( int axis = 0; axis < 3; axis++ )
+    {
+      alignedSourceCoordinates[ sourcePointIndex * 3 + axis ] = sourcePoint[ axis ];
+      sourceCentroid[ axis ] += sourcePoint[ axis ] / numberOfSourcePoints;
+    }
+  }
+  double targetCentroid[ 3 ] = { 0.0, 0.0, 0.0 };
+  vtkPointMatcher::ComputeCentroidOfPoints( unmatchedTargetPoints, targetCentroid );
+  for ( int axis = 0; axis < 3; axis++ )
+  {
+    double translation = targetCentroid[ axis ] - sourceCentroid[ axis ];
+    for ( int sourcePointIndex = 0; sourcePointIndex < numberOfSourcePoints; sourcePointIndex++ )
+    {
+      alignedSourceCoordinates[ sourcePointIndex * 3 + axis ] += translation;
+    }
+    for ( int column = 0; column < 4; column++ )
+    {
+      sourceToTargetMatrix->SetElement( axis, column, sourceToTargetMatrix->GetElement( axis, column ) + translation * sourceToTargetMatrix->GetElement( 3, column ) );
+    }
+  }
+
+  // at most maximumOutlierCount points are left unmatched, leave out their distances from the residual
+  int numberOfResidualPoints = std::max( numberOfSourcePoints - ( int )maximumOutlierCount, 1 );
+  std::vector< vtkIdType > closestTargetPointIndices( numberOfSourcePoints, -1 );
+  std::vector< double > closestDistances2( numberOfSourcePoints );
+  vtkLandmarkRegistrationMoments moments;
+  vtkSmartPointer< vtkMatrix4x4 > iterationMatrix = vtkSmartPointer< vtkMatrix4x4 >::New();
+  for ( int iteration = 0; iteration < MAXIMUM_NUMBER_OF_ICP_ITERATIONS; iteration++ )
+  {
+    bool closestPointsChanged = false;
+    moments.Reset();
+    for ( int sourcePointIndex = 0; sourcePointIndex < numberOfSourcePoints; sourcePointIndex++ )
+    {
+      const double* alignedSourcePoint = &alignedSourceCoordinates[ sourcePointIndex * 3 ];
+      vtkIdType closestTargetPointIndex = targetPointLocator->FindClosestPoint( alignedSourcePoint );
+      double closestTargetPoint[ 3 ];
+      unmatchedTargetPoints->GetPoint( closestTargetPointIndex, closestTargetPoint );
+      closestPointsChanged |= ( closestTargetPointIndex != closestTargetPointIndices[ sourcePointIndex ] );
+      closestTargetPointIndices[ sourcePointIndex ] = closestTargetPointIndex;
+      closestDistances2[ sourcePointIndex ] = vtkMath::Distance2BetweenPoints( alignedSourcePoint, closestTargetPoint );
+      moments.AddPointPair( alignedSourcePoint, closestTargetPoint );
+    }
+    if ( !closestPointsChanged )
+    {
+      break; // converged
+    }
+
+    if ( iteration > 0 && iteration % NUMBER_OF_ICP_ITERATIONS_BETWEEN_CHECKS == 0 )
+    {
+      std::nth_element( closestDistances2.begin(), closestDistances2.begin() + ( numberOfResidualPoints - 1 ), closestDistances2.end() );
+      double sumOfDistances2 = 0.0;
+      for ( int residualPointIndex = 0; residualPointIndex < numberOfResidualPoints; residualPointIndex++ )
+      {
+        sumOfDistances2 += closestDistances2[ residualPointIndex ];
+      }
+      double residual = sqrt( sumOfDistances2 / numberOfResidualPoints );
+      double maximumDistanceError = tolerableDistanceError + ambiguityDistance;
+      if ( residual > ICP_ABANDON_RESIDUAL_MULTIPLE * maximumDistanceError )
+      {
+        return;
+      }
+    }
+
+    // move the points to their closest points
+    moments.ComputeSourceToTargetMatrix( VTK_LANDMARK_RIGIDBODY, iterationMatrix );
+    for ( int sourcePointIndex = 0; sourcePointIndex < numberOfSourcePoints; sourcePointIndex++ )
+    {
+      double* alignedSourcePoint = &alignedSourceCoordinates[ sourcePointIndex * 3 ];
+      double point[ 4 ] = { alignedSourcePoint[ 0 ], alignedSourcePoint[ 1 ], alignedSourcePoint[ 2 ], 1.0 };
+      iterationMatrix->MultiplyPoint( point, point );
+      alignedSourcePoint[ 0 ] = point[ 0 ];
+      alignedSourcePoint[ 1 ] = point[ 1 ];
+      alignedSourcePoint[ 2 ] = point[ 2 ];
+    }
+    vtkMatrix4x4::Multiply4x4( iterationMatrix, sourceToTargetMatrix, sourceToTargetMatrix );
+  }
+
+  vtkSmartPointer< vtkTransform > sourceToTargetTransform = vtkSmartPointer< vtkTransform >::New();
+  sourceToTargetTransform->SetMatrix( sourceToTargetMatrix );
+  bool matchingSuccessful = vtkPointMatcher::ComputePointMatchingBasedOnRegistration( sourceToTargetTransform,
+                                                                                      unmatchedSourcePoints, unmatchedTargetPoints,
+                                                                                      thresholdDistance2ForOutlier, maximumOutlierCount,
+                                                                                      result.MatchedSourcePoints, result.MatchedTargetPoints,
+                                                                                      targetPointLocator );
+  if ( !matchingSuccessful )
+  {
+    return;
+  }
+
+  result.DistanceError = vtkPointMatcher::ComputeRegistrationRootMeanSquareError( result.MatchedSourcePoints, result.MatchedTargetPoints );
+  result.MatchingSuccessful = true;
+}
+
 //------------------------------------------------------------------------------
 bool vtkPointMatcher::InputsValid( bool verbose )
 {
@@ -619,7 +959,8 @@ void vtkPointMatcher::UpdateBestMatchingForSubsetsOfPoints( int minimumSubsetSiz
                                                             double& currentBestDistanceError,
                                                             double tolerableDistanceError,
                                                             vtkPoints* outputMatchedSourcePoints,
-                                                            vtkPoints* outputMatchedTargetPoints )
+                                                            vtkPoints* outputMatchedTargetPoints,
+                                                            int numberOfThreads )
 {
   // lots of error checking
   if ( maximumSubsetSize < MINIMUM_NUMBER_OF_POINTS_NEEDED_TO_MATCH )
@@ -684,7 +1025,8 @@ void vtkPointMatcher::UpdateBestMatchingForSubsetsOfPoints( int minimumSubsetSiz
                                                                  unmatchedSourcePoints, unmatchedTargetPoints,
                                                                  ambiguityDistanceError, matchingAmbiguous,
                                                                  currentBestDistanceError,
-                                                                 outputMatchedSourcePoints, outputMatchedTargetPoints );
+                                                                 outputMatchedSourcePoints, outputMatchedTargetPoints,
+                                                                 numberOfThreads );
     if ( currentBestDistanceError <= tolerableDistanceError )
     {
       // suitable solution has been found, no need to continue searching
@@ -702,7 +1044,8 @@ void vtkPointMatcher::UpdateBestMatchingForNSizedSubsetsOfPoints(
   bool& matchingAmbiguous,
   double& currentBestDistanceError,
   vtkPoints* outputMatchedSourcePoints,
-  vtkPoints* outputMatchedTargetPoints )
+  vtkPoints* outputMatchedTargetPoints,
+  int numberOfThreads )
 {
   if ( unmatchedSourcePoints == NULL )
   {
@@ -730,7 +1073,140 @@ void vtkPointMatcher::UpdateBestMatchingForNSizedSubsetsOfPoints(
     return;
   }
 
-  // generate sets of indices for all possible combinations of both input sets
+  if ( outputMatchedSourcePoints == NULL || outputMatchedTargetPoints == NULL )
+  {
+    vtkGenericWarningMacro( "Output matched points are null." );
+    return;
+  }
+
+  // every pair of (source combination, target combination) is a candidate,
+  // indexed by sourceCombinationRank * numberOfTargetCombinations + targetCombinationRank
+  vtkSmartPointer< vtkCombinatoricGenerator > combinationCounter = vtkSmartPointer< vtkCombinatoricGenerator >::New();
+  combinationCounter->SetCombinatoricToCombination();
+  combinationCounter->SetSubsetSize( subsetSize );
+  combinationCounter->SetNumberOfInputSets( 1 );
+  for ( int pointIndex = 0; pointIndex < numberOfUnmatchedSourcePoints; pointIndex++ )
+  {
+    combinationCounter->AddInputElement( 0, pointIndex );
+  }
+  vtkTypeUInt64 numberOfSourceCombinations = combinationCounter->ComputeNumberOfOutputSets();
+  combinationCounter->ClearInputSet( 0 );
+  for ( int pointIndex = 0; pointIndex < numberOfUnmatchedTargetPoints; pointIndex++ )
+  {
+    combinationCounter->AddInputElement( 0, pointIndex );
+  }
+  vtkTypeUInt64 numberOfTargetCombinations = combinationCounter->ComputeNumberOfOutputSets();
+  vtkTypeUInt64 numberOfSubsetPairs = numberOfSourceCombinations * numberOfTargetCombinations;
+
+  // the subset pairs are split into ranked chunks, that are taken by the threads from a shared counter
+  if ( numberOfThreads <= 0 )
+  {
+    numberOfThreads = std::max( static_cast< int >( std::thread::hardware_concurrency() ), 1 );
+  }
+  vtkTypeUInt64 maximumUsefulNumberOfThreads = std::max< vtkTypeUInt64 >( numberOfSubsetPairs / MINIMUM_NUMBER_OF_SUBSET_PAIRS_PER_THREAD, 1 );
+  numberOfThreads = static_cast< int >( std::min< vtkTypeUInt64 >( numberOfThreads, maximumUsefulNumberOfThreads ) );
+  vtkTypeUInt64 numberOfChunks = std::min< vtkTypeUInt64 >( numberOfSubsetPairs, numberOfThreads * NUMBER_OF_SUBSET_PAIR_CHUNKS_PER_THREAD );
+
+  // The best error is shared, so that all threads skip candidates that cannot be the best or
+  // ambiguous with the best. Results are kept per chunk and combined in chunk order below, so
+  // that the result does not depend on how the chunks were scheduled.
+  std::atomic< double > sharedBestDistanceError( currentBestDistanceError );
+  std::vector< SubsetMatchingResult > chunkResults( numberOfChunks );
+  std::atomic< vtkTypeUInt64 > nextChunkIndex( 0 );
+  auto matchChunks = [&]()
+  {
+    for ( vtkTypeUInt64 chunkIndex = nextChunkIndex++; chunkIndex < numberOfChunks; chunkIndex = nextChunkIndex++ )
+    {
+      SubsetMatchingResult& chunkResult = chunkResults[ chunkIndex ];
+      chunkResult.SharedBestDistanceError = &sharedBestDistanceError;
+      vtkTypeUInt64 firstSubsetPairIndex = chunkIndex * numberOfSubsetPairs / numberOfChunks;
+      vtkTypeUInt64 lastSubsetPairIndex = ( chunkIndex + 1 ) * numberOfSubsetPairs / numberOfChunks - 1;
+      vtkPointMatcher::UpdateBestMatchingForRangeOfSubsetsOfPoints( subsetSize, unmatchedSourcePoints, unmatchedTargetPoints,
+                                                                    firstSubsetPairIndex, lastSubsetPairIndex,
+                                                                    ambiguityDistanceError, chunkResult );
+    }
+  };
+
+  std::vector< std::thread > matchingThreads;
+  for ( int threadIndex = 1; threadIndex < numberOfThreads; threadIndex++ )
+  {
+    matchingThreads.emplace_back( matchChunks );
+  }
+  matchChunks();
+  for ( std::thread& matchingThread : matchingThreads )
+  {
+    matchingThread.join();
+  }
+
+  // Combine the chunks in order. Like in a single sequential pass, a later candidate replaces an
+  // earlier one with the same error. The matching is ambiguous if the second best error (of all
+  // candidates, including the best error from before this search) is within the ambiguity distance of the best.
+  double bestDistanceError = currentBestDistanceError;
+  double secondBestDistanceError = RESET_VALUE_COMPUTED_ROOT_MEAN_DISTANCE_ERROR;
+  SubsetMatchingResult* bestChunkResult = NULL;
+  for ( vtkTypeUInt64 chunkIndex = 0; chunkIndex < numberOfChunks; chunkIndex++ )
+  {
+    SubsetMatchingResult& chunkResult = chunkResults[ chunkIndex ];
+    if ( chunkResult.BestDistanceError == RESET_VALUE_COMPUTED_ROOT_MEAN_DISTANCE_ERROR )
+    {
+      continue; // no candidate in this chunk
+    }
+    if ( chunkResult.BestDistanceError <= bestDistanceError )
+    {
+      secondBestDistanceError = std::min( secondBestDistanceError, bestDistanceError );
+      bestDistanceError = chunkResult.BestDistanceError;
+      bestChunkResult = &chunkResult;
+    }
+    else
+    {
+      secondBestDistanceError = std::min( secondBestDistanceError, chunkResult.BestDistanceError );
+    }
+    secondBestDistanceError = std::min( secondBestDistanceError, chunkResult.SecondBestDistanceError );
+  }
+
+  if ( secondBestDistanceError == RESET_VALUE_COMPUTED_ROOT_MEAN_DISTANCE_ERROR )
+  {
+    // no other candidate to compare with
+    if ( bestChunkResult != NULL )
+    {
+      matchingAmbiguous = false;
+    }
+  }
+  else if ( bestChunkResult != NULL )
+  {
+    matchingAmbiguous = ( secondBestDistanceError - bestDistanceError <= ambiguityDistanceError );
+  }
+  else if ( secondBestDistanceError - bestDistanceError <= ambiguityDistanceError )
+  {
+    // the previous best matching is still the best, but it is ambiguous with a new candidate
+    matchingAmbiguous = true;
+  }
+
+  if ( bestChunkResult != NULL )
+  {
+    currentBestDistanceError = bestDistanceError;
+    outputMatchedSourcePoints->DeepCopy( bestChunkResult->MatchedSourcePoints );
+    outputMatchedTargetPoints->DeepCopy( bestChunkResult->MatchedTargetPoints );
+  }
+}
+
+//------------------------------------------------------------------------------
+// Searches the subset pairs with indices firstSubsetPairIndex .. lastSubsetPairIndex (inclusive),
+// in the same order as a sequential search over all source and target combinations would.
+void vtkPointMatcher::UpdateBestMatchingForRangeOfSubsetsOfPoints(
+  int subsetSize,
+  vtkPoints* unmatchedSourcePoints,
+  vtkPoints* unmatchedTargetPoints,
+  vtkTypeUInt64 firstSubsetPairIndex,
+  vtkTypeUInt64 lastSubsetPairIndex,
+  double ambiguityDistanceError,
+  SubsetMatchingResult& result )
+{
+  int numberOfUnmatchedSourcePoints = unmatchedSourcePoints->GetNumberOfPoints();
+  int numberOfUnmatchedTargetPoints = unmatchedTargetPoints->GetNumberOfPoints();
+
+  // traverse the sets of indices for the combinations of both input sets,
+  // without storing all of them
   vtkSmartPointer< vtkCombinatoricGenerator > sourcePointsCombinationGenerator = vtkSmartPointer< vtkCombinatoricGenerator >::New();
   sourcePointsCombinationGenerator->SetCombinatoricToCombination();
   sourcePointsCombinationGenerator->SetSubsetSize( subsetSize );
@@ -739,8 +1215,6 @@ void vtkPointMatcher::UpdateBestMatchingForNSizedSubsetsOfPoints(
   {
     sourcePointsCombinationGenerator->AddInputElement( 0, pointIndex );
   }
-  sourcePointsCombinationGenerator->Update();
-  std::vector< std::vector< int > > sourcePointsCombinationIndices = sourcePointsCombinationGenerator->GetOutputSets();
 
   vtkSmartPointer< vtkCombinatoricGenerator > targetPointsCombinationGenerator = vtkSmartPointer< vtkCombinatoricGenerator >::New();
   targetPointsCombinationGenerator->SetCombinatoricToCombination();
@@ -750,37 +1224,56 @@ void vtkPointMatcher::UpdateBestMatchingForNSizedSubsetsOfPoints(
   {
     targetPointsCombinationGenerator->AddInputElement( 0, pointIndex );
   }
-  targetPointsCombinationGenerator->Update();
-  std::vector< std::vector< int > > targetPointsCombinationIndices = targetPointsCombinationGenerator->GetOutputSets();
+
+  // start at the first subset pair of the range
+  vtkTypeUInt64 numberOfTargetCombinations = targetPointsCombinationGenerator->ComputeNumberOfOutputSets();
+  if ( !sourcePointsCombinationGenerator->GoToOutputSet( firstSubsetPairIndex / numberOfTargetCombinations ) ||
+       !targetPointsCombinationGenerator->GoToOutputSet( firstSubsetPairIndex % numberOfTargetCombinations ) )
+  {
+    vtkGenericWarningMacro( "Subset pair " << firstSubsetPairIndex << " does not exist." );
+    return;
+  }
 
   // these will store the actual combinations of points themselves (not indices)
   vtkSmartPointer< vtkPoints > unmatchedSourcePointsCombination = vtkSmartPointer< vtkPoints >::New();
   unmatchedSourcePointsCombination->SetNumberOfPoints( subsetSize );
   vtkSmartPointer< vtkPoints > unmatchedTargetPointsCombination = vtkSmartPointer< vtkPoints >::New();
   unmatchedTargetPointsCombination->SetNumberOfPoints( subsetSize );
-  // iterate over all combinations of both input point sets
-  for ( unsigned int sourcePointsCombinationIndex = 0; sourcePointsCombinationIndex < sourcePointsCombinationIndices.size(); sourcePointsCombinationIndex++ )
+  bool sourcePointsCombinationChanged = true;
+  for ( vtkTypeUInt64 subsetPairIndex = firstSubsetPairIndex; subsetPairIndex <= lastSubsetPairIndex; subsetPairIndex++ )
   {
-    for ( unsigned int targetPointsCombinationIndex = 0; targetPointsCombinationIndex < targetPointsCombinationIndices.size(); targetPointsCombinationIndex++ )
+    // store appropriate contents in the unmatchedSourcePointsCombination and unmatchedTargetPointsCombination variables
+    if ( sourcePointsCombinationChanged )
     {
-      // store appropriate contents in the unmatchedSourcePointsCombination and unmatchedTargetPointsCombination variables
+      const int* sourcePointsCombinationIndices = sourcePointsCombinationGenerator->GetCurrentOutputSet();
       for ( vtkIdType combinationPointIndex = 0; combinationPointIndex < subsetSize; combinationPointIndex++ )
       {
-        vtkIdType sourcePointIndex = ( vtkIdType ) sourcePointsCombinationIndices[ sourcePointsCombinationIndex ][ combinationPointIndex ];
+        vtkIdType sourcePointIndex = ( vtkIdType ) sourcePointsCombinationIndices[ combinationPointIndex ];
         double sourcePoint[ 3 ];
         unmatchedSourcePoints->GetPoint( sourcePointIndex, sourcePoint );
         unmatchedSourcePointsCombination->SetPoint( combinationPointIndex, sourcePoint );
-
-        vtkIdType targetPointIndex = ( vtkIdType ) targetPointsCombinationIndices[ targetPointsCombinationIndex ][ combinationPointIndex ];
-        double targetPoint[ 3 ];
-        unmatchedTargetPoints->GetPoint( targetPointIndex, targetPoint );
-        unmatchedTargetPointsCombination->SetPoint( combinationPointIndex, targetPoint );
       }
-      // finally see how good this particular combination is
-      vtkPointMatcher::UpdateBestMatchingForSubsetOfPoints( unmatchedSourcePointsCombination, unmatchedTargetPointsCombination,
-                                                            ambiguityDistanceError, matchingAmbiguous,
-                                                            currentBestDistanceError,
-                                                            outputMatchedSourcePoints, outputMatchedTargetPoints );
+      sourcePointsCombinationChanged = false;
+    }
+    const int* targetPointsCombinationIndices = targetPointsCombinationGenerator->GetCurrentOutputSet();
+    for ( vtkIdType combinationPointIndex = 0; combinationPointIndex < subsetSize; combinationPointIndex++ )
+    {
+      vtkIdType targetPointIndex = ( vtkIdType ) targetPointsCombinationIndices[ combinationPointIndex ];
+      double targetPoint[ 3 ];
+      unmatchedTargetPoints->GetPoint( targetPointIndex, targetPoint );
+      unmatchedTargetPointsCombination->SetPoint( combinationPointIndex, targetPoint );
+    }
+
+    // finally see how good this particular combination is
+    vtkPointMatcher::UpdateBestMatchingForSubsetOfPoints( unmatchedSourcePointsCombination, unmatchedTargetPointsCombination,
+                                                          ambiguityDistanceError, result );
+
+    // move to the next subset pair, the target combination changes fastest
+    if ( !targetPointsCombinationGenerator->GoToNextOutputSet() )
+    {
+      sourcePointsCombinationGenerator->GoToNextOutputSet();
+      targetPointsCombinationGenerator->InitTraversal();
+      sourcePointsCombinationChanged = true;
     }
   }
 }
@@ -790,14 +1283,13 @@ void vtkPointMatcher::UpdateBestMatchingForNSizedSubsetsOfPoints(
 // we have two input point lists. We want to reorder the second list such that the 
 // point-to-point distances are as close as possible to those in the first.
 // We will permute over all possibilities (and only ever keep the best result.)
+// Permutations whose distances show that they cannot be registered within the ambiguity
+// distance of the best error found by any thread are skipped without registering them.
 void vtkPointMatcher::UpdateBestMatchingForSubsetOfPoints(
   vtkPoints* sourceSubset, 
   vtkPoints* targetSubset,
   double ambiguityDistanceError,
-  bool& matchingAmbiguous,
-  double& currentBestDistanceError,
-  vtkPoints* outputMatchedSourcePoints,
-  vtkPoints* outputMatchedTargetPoints )
+  SubsetMatchingResult& result )
 {
   // error checking
   if ( sourceSubset == NULL )
@@ -819,7 +1311,28 @@ void vtkPointMatcher::UpdateBestMatchingForSubsetOfPoints(
     return;
   }
 
-  // compute the permutations, store them in a vtkIntArray.
+  // coordinates and pairwise distances within both subsets, read once for all permutations
+  std::vector< double > sourceCoordinates( numberOfPoints * 3 );
+  std::vector< double > targetCoordinates( numberOfPoints * 3 );
+  for ( int pointIndex = 0; pointIndex < numberOfPoints; pointIndex++ )
+  {
+    sourceSubset->GetPoint( pointIndex, &sourceCoordinates[ pointIndex * 3 ] );
+    targetSubset->GetPoint( pointIndex, &targetCoordinates[ pointIndex * 3 ] );
+  }
+  std::vector< double > sourceDistances( numberOfPoints * numberOfPoints );
+  std::vector< double > targetDistances( numberOfPoints * numberOfPoints );
+  for ( int pointIndex1 = 0; pointIndex1 < numberOfPoints; pointIndex1++ )
+  {
+    for ( int pointIndex2 = 0; pointIndex2 < numberOfPoints; pointIndex2++ )
+    {
+      sourceDistances[ pointIndex1 * numberOfPoints + pointIndex2 ] =
+        sqrt( vtkMath::Distance2BetweenPoints( &sourceCoordinates[ pointIndex1 * 3 ], &sourceCoordinates[ pointIndex2 * 3 ] ) );
+      targetDistances[ pointIndex1 * numberOfPoints + pointIndex2 ] =
+        sqrt( vtkMath::Distance2BetweenPoints( &targetCoordinates[ pointIndex1 * 3 ], &targetCoordinates[ pointIndex2 * 3 ] ) );
+    }
+  }
+
+  // traverse the permutations one at a time
   vtkSmartPointer< vtkCombinatoricGenerator > combinatoricGenerator = vtkSmartPointer< vtkCombinatoricGenerator >::New();
   combinatoricGenerator->SetCombinatoricToPermutation();
   combinatoricGenerator->SetSubsetSize( numberOfPoints );
@@ -828,36 +1341,532 @@ void vtkPointMatcher::UpdateBestMatchingForSubsetOfPoints(
   {
     combinatoricGenerator->AddInputElement( 0, pointIndex );
   }
-  combinatoricGenerator->Update();
-  std::vector< std::vector< int > > targetSubsetIndexPermutations = combinatoricGenerator->GetOutputSets();
 
   // iterate over all permutations - look for the most 'suitable'
   // point matching that gives distances most similar to the reference
+  vtkLandmarkRegistrationMoments moments;
+  for ( bool hasPermutation = combinatoricGenerator->InitTraversal(); hasPermutation; hasPermutation = combinatoricGenerator->GoToNextOutputSet() )
+  {
+    const int* targetSubsetIndexPermutation = combinatoricGenerator->GetCurrentOutputSet();
+
+    // The optimal rigid registration maps the source centroid to the target centroid, so the registration
+    // residual vectors e_i sum to zero, and sum over pairs of |e_i - e_j|^2 = n^2 * RMSE^2.
+    // Each pairwise distance residual is at most |e_i - e_j|, so sum of squared pairwise distance residuals <= n^2 * RMSE^2.
+    // If that sum is larger than allowed for the best error (plus the ambiguity distance), the registration cannot be better.
+    double maximumDistanceError = result.SharedBestDistanceError->load() + ambiguityDistanceError;
+    double maximumSumOfSquaredResiduals = maximumDistanceError * maximumDistanceError * numberOfPoints * numberOfPoints;
+    double sumOfSquaredResiduals = 0.0;
+    for ( int pointIndex1 = 0; pointIndex1 < numberOfPoints && sumOfSquaredResiduals <= maximumSumOfSquaredResiduals; pointIndex1++ )
+    {
+      for ( int pointIndex2 = pointIndex1 + 1; pointIndex2 < numberOfPoints; pointIndex2++ )
+      {
+        double sourceDistance = sourceDistances[ pointIndex1 * numberOfPoints + pointIndex2 ];
+        double targetDistance = targetDistances[ targetSubsetIndexPermutation[ pointIndex1 ] * numberOfPoints + targetSubsetIndexPermutation[ pointIndex2 ] ];
+        sumOfSquaredResiduals += ( sourceDistance - targetDistance ) * ( sourceDistance - targetDistance );
+      }
+    }
+    if ( sumOfSquaredResiduals > maximumSumOfSquaredResiduals )
+    {
+      continue;
+    }
 
-  // create + allocate the permuted compare list once outside
-  // the loop to avoid allocation/deallocation time costs.
-  vtkSmartPointer< vtkPoints > permutedTargetSubset = vtkSmartPointer< vtkPoints >::New();
-  permutedTargetSubset->SetNumberOfPoints( numberOfPoints );
-  int numberOfPermutations = targetSubsetIndexPermutations.size();
-  for ( int permutationIndex = 0; permutationIndex < numberOfPermutations; permutationIndex++ )
-  {
-    // fill permutedTargetSubset with points from targetSubset,
-    // in the order indicate by the permuted indices
+    // register the points in the order indicated by the permuted indices
+    moments.Reset();
     for ( int pointIndex = 0; pointIndex < numberOfPoints; pointIndex++ )
     {
-      int permutedPointIndex = targetSubsetIndexPermutations[ permutationIndex][ pointIndex ];
-      double* permutedPoint = targetSubset->GetPoint( permutedPointIndex );
-      permutedTargetSubset->SetPoint( pointIndex, permutedPoint );
+      moments.AddPointPair( &sourceCoordinates[ pointIndex * 3 ], &targetCoordinates[ targetSubsetIndexPermutation[ pointIndex ] * 3 ] );
+    }
+    double distanceError = moments.ComputeRootMeanSquareError();
+
+    // a later candidate replaces an earlier one with the same error
+    if ( distanceError <= result.BestDistanceError )
+    {
+      result.SecondBestDistanceError = std::min( result.SecondBestDistanceError, result.BestDistanceError );
+      result.BestDistanceError = distanceError;
+      result.MatchedSourcePoints->DeepCopy( sourceSubset );
+      result.MatchedTargetPoints->SetNumberOfPoints( numberOfPoints );
+      for ( int pointIndex = 0; pointIndex < numberOfPoints; pointIndex++ )
+      {
+        result.MatchedTargetPoints->SetPoint( pointIndex, &targetCoordinates[ targetSubsetIndexPermutation[ pointIndex ] * 3 ] );
+      }
+
+      double sharedBestDistanceError = result.SharedBestDistanceError->load();
+      while ( distanceError < sharedBestDistanceError &&
+              !result.SharedBestDistanceError->compare_exchange_weak( sharedBestDistanceError, distanceError ) )
+      {
+      }
+    }
+    else
+    {
+      result.SecondBestDistanceError = std::min( result.SecondBestDistanceError, distanceError );
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+// Correspondences are built one source point at a time. Each source point is either assigned
+// to an unused target point, or skipped (left unmatched) while the number of skipped points
+// still allows subsetSize pairs. Since distances are preserved by rigid transforms, a correct
+// correspondence has small residuals between the source and target distances of all pairs.
+// A partial correspondence is pruned when:
+// - a pair of assigned points has a distance residual larger than pairwiseDistanceTolerance, or
+// - its residuals plus a lower bound for the points that are still to be assigned (the smallest
+//   residuals that each of them could have against the assigned points) show that it cannot
+//   be registered better than the best complete correspondence found so far (by more than the
+//   ambiguity distance, so that ambiguous correspondences are still detected).
+// Complete correspondences are compared by their registration error, like in the exhaustive search.
+// At most numberOfRemainingNodes partial correspondences are visited. If the search is stopped
+// before it is complete, no correspondence is returned.
+bool vtkPointMatcher::UpdateBestMatchingUsingBranchAndBound( int subsetSize,
+                                                             vtkPoints* unmatchedSourcePoints,
+                                                             vtkPoints* unmatchedTargetPoints,
+                                                             double pairwiseDistanceTolerance,
+                                                             double ambiguityDistance,
+                                                             bool& matchingAmbiguous,
+                                                             int& numberOfRemainingNodes,
+                                                             vtkPoints* outputMatchedSourcePoints,
+                                                             vtkPoints* outputMatchedTargetPoints,
+                                                             std::vector< int >& outputCorrespondences )
+{
+  if ( unmatchedSourcePoints == NULL )
+  {
+    vtkGenericWarningMacro( "Unmatched source points are null." );
+    return false;
+  }
+
+  if ( unmatchedTargetPoints == NULL )
+  {
+    vtkGenericWarningMacro( "Unmatched target points are null." );
+    return false;
+  }
+
+  if ( outputMatchedSourcePoints == NULL || outputMatchedTargetPoints == NULL )
+  {
+    vtkGenericWarningMacro( "Output matched points are null." );
+    return false;
+  }
+
+  int numberOfSourcePoints = unmatchedSourcePoints->GetNumberOfPoints();
+  int numberOfTargetPoints = unmatchedTargetPoints->GetNumberOfPoints();
+  if ( subsetSize < MINIMUM_NUMBER_OF_POINTS_NEEDED_TO_MATCH || subsetSize > numberOfSourcePoints || subsetSize > numberOfTargetPoints )
+  {
+    vtkGenericWarningMacro( "Cannot match subsets of " << subsetSize << " points between lists of " << numberOfSourcePoints << " and " << numberOfTargetPoints << " points." );
+    return false;
+  }
+
+  BranchAndBoundState state;
+  vtkPointMatcher::InitializeBranchAndBoundState( state, subsetSize, unmatchedSourcePoints, unmatchedTargetPoints,
+                                                  pairwiseDistanceTolerance, ambiguityDistance, numberOfRemainingNodes );
+  vtkPointMatcher::UpdateBestMatchingUsingBranchAndBoundHelper( state );
+  numberOfRemainingNodes = vtkMath::Max( state.NumberOfRemainingNodes, 0 );
+
+  // If the search was stopped, a better or an ambiguous correspondence may not have been visited yet
+  if ( state.NumberOfRemainingNodes < 0 || state.BestCorrespondences.empty() )
+  {
+    return false;
+  }
+
+  outputMatchedSourcePoints->Reset();
+  outputMatchedTargetPoints->Reset();
+  for ( int sourcePointIndex = 0; sourcePointIndex < numberOfSourcePoints; sourcePointIndex++ )
+  {
+    int targetPointIndex = state.BestCorrespondences[ sourcePointIndex ];
+    if ( targetPointIndex < 0 )
+    {
+      continue;
     }
-    double distanceError = vtkPointMatcher::ComputeRegistrationRootMeanSquareError( sourceSubset, permutedTargetSubset );
+    double sourcePoint[ 3 ];
+    unmatchedSourcePoints->GetPoint( sourcePointIndex, sourcePoint );
+    outputMatchedSourcePoints->InsertNextPoint( sourcePoint );
+    double targetPoint[ 3 ];
+    unmatchedTargetPoints->GetPoint( targetPointIndex, targetPoint );
+    outputMatchedTargetPoints->InsertNextPoint( targetPoint );
+  }
+  outputCorrespondences = state.BestCorrespondences;
+  matchingAmbiguous = state.MatchingAmbiguous;
+  return true;
+}
 
-    vtkPointMatcher::UpdateAmbiguityFlag( distanceError, currentBestDistanceError, ambiguityDistanceError, matchingAmbiguous );
-    if ( distanceError == currentBestDistanceError )
+//------------------------------------------------------------------------------
+// The search of UpdateBestMatchingUsingBranchAndBound only visits correspondences whose pairwise distance
+// residuals are within its tolerance, but a correspondence that registers within the ambiguity distance of
+// the best one can have larger residuals. This search visits them without the tolerance, pruning only by
+// the cost of registering within the ambiguity distance of the accepted correspondence.
+// Another correspondence that registers better than that makes the matching ambiguous too.
+// If the search is stopped before it is complete, the matching is considered ambiguous.
+bool vtkPointMatcher::IsMatchingAmbiguousUsingBranchAndBound( int subsetSize,
+                                                              vtkPoints* unmatchedSourcePoints,
+                                                              vtkPoints* unmatchedTargetPoints,
+                                                              const std::vector< int >& correspondences,
+                                                              double distanceError,
+                                                              double ambiguityDistance,
+                                                              int& numberOfRemainingNodes )
+{
+  BranchAndBoundState state;
+  vtkPointMatcher::InitializeBranchAndBoundState( state, subsetSize, unmatchedSourcePoints, unmatchedTargetPoints,
+                                                  VTK_DOUBLE_MAX, ambiguityDistance, numberOfRemainingNodes );
+  state.AmbiguityCheck = true;
+  state.BestDistanceError = distanceError;
+  state.BestCorrespondences = correspondences;
+
+  vtkPointMatcher::UpdateBestMatchingUsingBranchAndBoundHelper( state );
+  numberOfRemainingNodes = vtkMath::Max( state.NumberOfRemainingNodes, 0 );
+  return state.MatchingAmbiguous || state.NumberOfRemainingNodes < 0;
+}
+
+//------------------------------------------------------------------------------
+void vtkPointMatcher::InitializeBranchAndBoundState( BranchAndBoundState& state,
+                                                     int subsetSize,
+                                                     vtkPoints* unmatchedSourcePoints,
+                                                     vtkPoints* unmatchedTargetPoints,
+                                                     double pairwiseDistanceTolerance,
+                                                     double ambiguityDistance,
+                                                     int numberOfRemainingNodes )
+{
+  int numberOfSourcePoints = unmatchedSourcePoints->GetNumberOfPoints();
+  int numberOfTargetPoints = unmatchedTargetPoints->GetNumberOfPoints();
+  state.NumberOfSourcePoints = numberOfSourcePoints;
+  state.NumberOfTargetPoints = numberOfTargetPoints;
+  state.SubsetSize = subsetSize;
+  state.MaximumNumberOfSkippedSourcePoints = numberOfSourcePoints - subsetSize;
+  state.PairwiseDistanceTolerance = pairwiseDistanceTolerance;
+  state.AmbiguityDistance = ambiguityDistance;
+
+  vtkSmartPointer< vtkPointDistanceMatrix > sourceDistanceMatrix = vtkSmartPointer< vtkPointDistanceMatrix >::New();
+  sourceDistanceMatrix->SetPointList1( unmatchedSourcePoints );
+  sourceDistanceMatrix->SetPointList2( unmatchedSourcePoints );
+  sourceDistanceMatrix->Update();
+  state.SourceDistances.resize( numberOfSourcePoints * numberOfSourcePoints );
+  state.SourcePriorities.assign( numberOfSourcePoints, 0.0 );
+  for ( int sourcePointIndex1 = 0; sourcePointIndex1 < numberOfSourcePoints; sourcePointIndex1++ )
+  {
+    const double* distances = sourceDistanceMatrix->GetDistancesFromList1Point( sourcePointIndex1 );
+    std::copy( distances, distances + numberOfSourcePoints, &state.SourceDistances[ sourcePointIndex1 * numberOfSourcePoints ] );
+    for ( int sourcePointIndex2 = 0; sourcePointIndex2 < numberOfSourcePoints; sourcePointIndex2++ )
     {
-      outputMatchedSourcePoints->DeepCopy( sourceSubset );
-      outputMatchedTargetPoints->DeepCopy( permutedTargetSubset );
+      // points far from the others constrain the remaining points the most, so match them first
+      state.SourcePriorities[ sourcePointIndex1 ] += distances[ sourcePointIndex2 ];
     }
   }
+
+  vtkSmartPointer< vtkPointDistanceMatrix > targetDistanceMatrix = vtkSmartPointer< vtkPointDistanceMatrix >::New();
+  targetDistanceMatrix->SetPointList1( unmatchedTargetPoints );
+  targetDistanceMatrix->SetPointList2( unmatchedTargetPoints );
+  targetDistanceMatrix->Update();
+  state.TargetDistances.resize( numberOfTargetPoints * numberOfTargetPoints );
+  for ( int targetPointIndex = 0; targetPointIndex < numberOfTargetPoints; targetPointIndex++ )
+  {
+    const double* distances = targetDistanceMatrix->GetDistancesFromList1Point( targetPointIndex );
+    std::copy( distances, distances + numberOfTargetPoints, &state.TargetDistances[ targetPointIndex * numberOfTargetPoints ] );
+  }
+
+  state.CandidateCosts.assign( numberOfSourcePoints * numberOfTargetPoints, 0.0 );
+  state.CandidateViolations.assign( numberOfSourcePoints * numberOfTargetPoints, 0 );
+  if ( pairwiseDistanceTolerance < VTK_DOUBLE_MAX )
+  {
+    vtkPointMatcher::RuleOutCandidatesInBranchAndBound( state, sourceDistanceMatrix, targetDistanceMatrix );
+  }
+  state.Correspondences.assign( numberOfSourcePoints, BRANCH_AND_BOUND_UNDECIDED );
+  state.NumberOfAssignedPoints = 0;
+  state.NumberOfSkippedPoints = 0;
+  state.AssignedCost = 0.0;
+  state.SourceCoordinates.resize( numberOfSourcePoints * 3 );
+  for ( int sourcePointIndex = 0; sourcePointIndex < numberOfSourcePoints; sourcePointIndex++ )
+  {
+    unmatchedSourcePoints->GetPoint( sourcePointIndex, &state.SourceCoordinates[ sourcePointIndex * 3 ] );
+  }
+  state.TargetCoordinates.resize( numberOfTargetPoints * 3 );
+  for ( int targetPointIndex = 0; targetPointIndex < numberOfTargetPoints; targetPointIndex++ )
+  {
+    unmatchedTargetPoints->GetPoint( targetPointIndex, &state.TargetCoordinates[ targetPointIndex * 3 ] );
+  }
+  state.AssignedMoments.Reset();
+  state.BestDistanceError = VTK_DOUBLE_MAX;
+  state.MatchingAmbiguous = false;
+  state.AmbiguityCheck = false;
+  state.NumberOfRemainingNodes = numberOfRemainingNodes;
+  state.MinimumCandidateCosts.reserve( numberOfSourcePoints );
+}
+
+//------------------------------------------------------------------------------
+// In a complete correspondence, a source point is paired with SubsetSize - 1 other source points, and the
+// target point it is assigned to must have a point at (about) the same distance for each of them. A candidate
+// target point that has such a point for fewer source points cannot be part of any correspondence.
+// Source distances that do not occur in the target point set at all are dropped first, then the remaining
+// ones are compared with the distances of each candidate target point in a single pass over both sorted lists.
+// The ruled out candidates get a violation that is never removed, so the search never considers them.
+void vtkPointMatcher::RuleOutCandidatesInBranchAndBound( BranchAndBoundState& state,
+                                                         vtkPointDistanceMatrix* sourceDistanceMatrix,
+                                                         vtkPointDistanceMatrix* targetDistanceMatrix )
+{
+  int numberOfSourcePoints = state.NumberOfSourcePoints;
+  int numberOfTargetPoints = state.NumberOfTargetPoints;
+  double tolerance = state.PairwiseDistanceTolerance;
+  std::vector< double > matchableSourceDistances;
+  matchableSourceDistances.reserve( numberOfSourcePoints );
+  for ( int sourcePointIndex = 0; sourcePointIndex < numberOfSourcePoints; sourcePointIndex++ )
+  {
+    // the first sorted distance is the zero distance of the point to itself
+    const double* sortedSourceDistances = sourceDistanceMatrix->GetSortedDistancesFromList1Point( sourcePointIndex );
+    matchableSourceDistances.clear();
+    for ( int sortedIndex = 1; sortedIndex < numberOfSourcePoints; sortedIndex++ )
+    {
+      double sourceDistance = sortedSourceDistances[ sortedIndex ];
+      if ( targetDistanceMatrix->IsAnyDistanceInRange( sourceDistance - tolerance, sourceDistance + tolerance ) )
+      {
+        matchableSourceDistances.push_back( sourceDistance );
+      }
+    }
+    int numberOfMatchableSourceDistances = matchableSourceDistances.size();
+
+    for ( int targetPointIndex = 0; targetPointIndex < numberOfTargetPoints; targetPointIndex++ )
+    {
+      const double* sortedTargetDistances = targetDistanceMatrix->GetSortedDistancesFromList1Point( targetPointIndex );
+      int numberOfMatchingDistances = 0;
+      int sortedTargetIndex = 0;
+      for ( int sourceDistanceIndex = 0; sourceDistanceIndex < numberOfMatchableSourceDistances; sourceDistanceIndex++ )
+      {
+        double sourceDistance = matchableSourceDistances[ sourceDistanceIndex ];
+        while ( sortedTargetIndex < numberOfTargetPoints && sortedTargetDistances[ sortedTargetIndex ] < sourceDistance - tolerance )
+        {
+          sortedTargetIndex++;
+        }
+        if ( sortedTargetIndex < numberOfTargetPoints && sortedTargetDistances[ sortedTargetIndex ] <= sourceDistance + tolerance )
+        {
+          numberOfMatchingDistances++;
+        }
+      }
+      if ( numberOfMatchingDistances < state.SubsetSize - 1 )
+      {
+        state.CandidateViolations[ sourcePointIndex * numberOfTargetPoints + targetPointIndex ]++;
+      }
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+void vtkPointMatcher::UpdateBestMatchingUsingBranchAndBoundHelper( BranchAndBoundState& state )
+{
+  if ( state.AmbiguityCheck && state.MatchingAmbiguous )
+  {
+    return;
+  }
+  state.NumberOfRemainingNodes--;
+  if ( state.NumberOfRemainingNodes < 0 )
+  {
+    // out of time, the search is incomplete and its result is discarded
+    return;
+  }
+
+  // Base case, the correspondence is complete
+  if ( state.NumberOfAssignedPoints == state.SubsetSize )
+  {
+    // Distances are also preserved by reflections, so the registration error has to be computed to rule out mirrored correspondences
+    double distanceError = state.AssignedMoments.ComputeRootMeanSquareError();
+    if ( state.AmbiguityCheck )
+    {
+      if ( distanceError < state.BestDistanceError + state.AmbiguityDistance && state.Correspondences != state.BestCorrespondences )
+      {
+        state.MatchingAmbiguous = true;
+      }
+      return;
+    }
+    bool bestSoFar = ( distanceError < state.BestDistanceError );
+    vtkPointMatcher::UpdateAmbiguityFlag( distanceError, state.BestDistanceError, state.AmbiguityDistance, state.MatchingAmbiguous );
+    if ( bestSoFar )
+    {
+      state.BestCorrespondences = state.Correspondences;
+    }
+    return;
+  }
+
+  // Adding pairs can only increase the registration sum of squared errors, so the sum of the assigned pairs
+  // is a lower bound for the sum of the complete correspondence (which is K times its squared registration error)
+  if ( state.NumberOfAssignedPoints >= MINIMUM_NUMBER_OF_POINTS_NEEDED_TO_MATCH && state.BestDistanceError != VTK_DOUBLE_MAX )
+  {
+    double maximumDistanceError = state.BestDistanceError + state.AmbiguityDistance;
+    if ( state.AssignedMoments.ComputeSumOfSquaredErrors() > maximumDistanceError * maximumDistanceError * state.SubsetSize )
+    {
+      return;
+    }
+  }
+
+  // Compute the lower bound, and choose the undecided source point with the fewest candidate target points to branch on
+  int numberOfTargetPoints = state.NumberOfTargetPoints;
+  int branchSourcePointIndex = -1;
+  int branchNumberOfCandidates = VTK_INT_MAX;
+  state.MinimumCandidateCosts.clear();
+  for ( int sourcePointIndex = 0; sourcePointIndex < state.NumberOfSourcePoints; sourcePointIndex++ )
+  {
+    if ( state.Correspondences[ sourcePointIndex ] != BRANCH_AND_BOUND_UNDECIDED )
+    {
+      continue;
+    }
+    const double* candidateCosts = &state.CandidateCosts[ sourcePointIndex * numberOfTargetPoints ];
+    const int* candidateViolations = &state.CandidateViolations[ sourcePointIndex * numberOfTargetPoints ];
+    int numberOfCandidates = 0;
+    double minimumCandidateCost = VTK_DOUBLE_MAX;
+    for ( int targetPointIndex = 0; targetPointIndex < numberOfTargetPoints; targetPointIndex++ )
+    {
+      if ( candidateViolations[ targetPointIndex ] > 0 )
+      {
+        continue;
+      }
+      numberOfCandidates++;
+      minimumCandidateCost = vtkMath::Min( minimumCandidateCost, candidateCosts[ targetPointIndex ] );
+    }
+    if ( numberOfCandidates > 0 )
+    {
+      state.MinimumCandidateCosts.push_back( minimumCandidateCost );
+    }
+    if ( numberOfCandidates < branchNumberOfCandidates ||
+         ( numberOfCandidates == branchNumberOfCandidates && state.SourcePriorities[ sourcePointIndex ] > state.SourcePriorities[ branchSourcePointIndex ] ) )
+    {
+      branchSourcePointIndex = sourcePointIndex;
+      branchNumberOfCandidates = numberOfCandidates;
+    }
+  }
+
+  int numberOfPointsToAssign = state.SubsetSize - state.NumberOfAssignedPoints;
+  if ( ( int )state.MinimumCandidateCosts.size() < numberOfPointsToAssign )
+  {
+    // too few of the remaining source points can be matched
+    return;
+  }
+
+  std::nth_element( state.MinimumCandidateCosts.begin(), state.MinimumCandidateCosts.begin() + ( numberOfPointsToAssign - 1 ), state.MinimumCandidateCosts.end() );
+  double lowerBoundCost = state.AssignedCost;
+  for ( int pointIndex = 0; pointIndex < numberOfPointsToAssign; pointIndex++ )
+  {
+    lowerBoundCost += state.MinimumCandidateCosts[ pointIndex ];
+  }
+  double maximumCost = vtkPointMatcher::MaximumPairwiseDistanceCostInBranchAndBound( state );
+  if ( lowerBoundCost > maximumCost )
+  {
+    return;
+  }
+
+  // Recursive cases, assign the source point to each of its candidates, cheapest first...
+  std::vector< std::pair< double, int > > candidates;
+  candidates.reserve( branchNumberOfCandidates );
+  const double* branchCandidateCosts = &state.CandidateCosts[ branchSourcePointIndex * numberOfTargetPoints ];
+  const int* branchCandidateViolations = &state.CandidateViolations[ branchSourcePointIndex * numberOfTargetPoints ];
+  for ( int targetPointIndex = 0; targetPointIndex < numberOfTargetPoints; targetPointIndex++ )
+  {
+    if ( branchCandidateViolations[ targetPointIndex ] == 0 )
+    {
+      candidates.push_back( std::make_pair( branchCandidateCosts[ targetPointIndex ], targetPointIndex ) );
+    }
+  }
+  std::sort( candidates.begin(), candidates.end() );
+  for ( unsigned int candidateIndex = 0; candidateIndex < candidates.size(); candidateIndex++ )
+  {
+    if ( state.AssignedCost + candidates[ candidateIndex ].first > maximumCost )
+    {
+      break; // the remaining candidates are even more expensive
+    }
+    int targetPointIndex = candidates[ candidateIndex ].second;
+    vtkPointMatcher::AssignPointInBranchAndBound( state, branchSourcePointIndex, targetPointIndex );
+    vtkPointMatcher::UpdateBestMatchingUsingBranchAndBoundHelper( state );
+    vtkPointMatcher::UnassignPointInBranchAndBound( state, branchSourcePointIndex, targetPointIndex );
+    // the best correspondence may have improved, update the bound for the remaining candidates
+    maximumCost = vtkPointMatcher::MaximumPairwiseDistanceCostInBranchAndBound( state );
+  }
+
+  // ... and leave it unmatched
+  if ( state.NumberOfSkippedPoints < state.MaximumNumberOfSkippedSourcePoints )
+  {
+    state.Correspondences[ branchSourcePointIndex ] = BRANCH_AND_BOUND_SKIPPED;
+    state.NumberOfSkippedPoints++;
+    vtkPointMatcher::UpdateBestMatchingUsingBranchAndBoundHelper( state );
+    state.NumberOfSkippedPoints--;
+    state.Correspondences[ branchSourcePointIndex ] = BRANCH_AND_BOUND_UNDECIDED;
+  }
+}
+
+//------------------------------------------------------------------------------
+// For the optimal rigid registration of K corresponding points with residual vectors r_i (which sum to zero),
+// each pairwise distance residual is at most |r_i - r_k|, and the sum of |r_i - r_k|^2 over all pairs is
+// K^2 times the squared registration error. So the sum of squared pairwise distance residuals of any subset
+// of the pairs is at most K^2 times the squared registration error of the complete correspondence.
+double vtkPointMatcher::MaximumPairwiseDistanceCostInBranchAndBound( BranchAndBoundState& state )
+{
+  if ( state.BestDistanceError == VTK_DOUBLE_MAX )
+  {
+    return VTK_DOUBLE_MAX;
+  }
+  // correspondences within the ambiguity distance of the best one must still be visited to detect ambiguity
+  double maximumDistanceError = state.BestDistanceError + state.AmbiguityDistance;
+  return maximumDistanceError * maximumDistanceError * state.SubsetSize * state.SubsetSize;
+}
+
+//------------------------------------------------------------------------------
+void vtkPointMatcher::AssignPointInBranchAndBound( BranchAndBoundState& state, int sourcePointIndex, int targetPointIndex )
+{
+  int numberOfSourcePoints = state.NumberOfSourcePoints;
+  int numberOfTargetPoints = state.NumberOfTargetPoints;
+  state.AssignedCost += state.CandidateCosts[ sourcePointIndex * numberOfTargetPoints + targetPointIndex ];
+  state.Correspondences[ sourcePointIndex ] = targetPointIndex;
+  state.NumberOfAssignedPoints++;
+  state.AssignedMoments.AddPointPair( &state.SourceCoordinates[ sourcePointIndex * 3 ], &state.TargetCoordinates[ targetPointIndex * 3 ] );
+
+  // add the residuals against the new pair to the candidates of the undecided source points,
+  // and make the target point unavailable to them
+  for ( int otherSourcePointIndex = 0; otherSourcePointIndex < numberOfSourcePoints; otherSourcePointIndex++ )
+  {
+    if ( state.Correspondences[ otherSourcePointIndex ] != BRANCH_AND_BOUND_UNDECIDED )
+    {
+      continue;
+    }
+    double sourceDistance = state.SourceDistances[ otherSourcePointIndex * numberOfSourcePoints + sourcePointIndex ];
+    const double* targetDistances = &state.TargetDistances[ targetPointIndex * numberOfTargetPoints ];
+    double* candidateCosts = &state.CandidateCosts[ otherSourcePointIndex * numberOfTargetPoints ];
+    int* candidateViolations = &state.CandidateViolations[ otherSourcePointIndex * numberOfTargetPoints ];
+    for ( int otherTargetPointIndex = 0; otherTargetPointIndex < numberOfTargetPoints; otherTargetPointIndex++ )
+    {
+      double residual = sourceDistance - targetDistances[ otherTargetPointIndex ];
+      candidateCosts[ otherTargetPointIndex ] += residual * residual;
+      if ( fabs( residual ) > state.PairwiseDistanceTolerance )
+      {
+        candidateViolations[ otherTargetPointIndex ]++;
+      }
+    }
+    candidateViolations[ targetPointIndex ]++;
+  }
+}
+
+//------------------------------------------------------------------------------
+void vtkPointMatcher::UnassignPointInBranchAndBound( BranchAndBoundState& state, int sourcePointIndex, int targetPointIndex )
+{
+  // exact reverse of AssignPointInBranchAndBound, the undecided source points are the same as when it was called
+  int numberOfSourcePoints = state.NumberOfSourcePoints;
+  int numberOfTargetPoints = state.NumberOfTargetPoints;
+  for ( int otherSourcePointIndex = 0; otherSourcePointIndex < numberOfSourcePoints; otherSourcePointIndex++ )
+  {
+    if ( state.Correspondences[ otherSourcePointIndex ] != BRANCH_AND_BOUND_UNDECIDED )
+    {
+      continue;
+    }
+    double sourceDistance = state.SourceDistances[ otherSourcePointIndex * numberOfSourcePoints + sourcePointIndex ];
+    const double* targetDistances = &state.TargetDistances[ targetPointIndex * numberOfTargetPoints ];
+    double* candidateCosts = &state.CandidateCosts[ otherSourcePointIndex * numberOfTargetPoints ];
+    int* candidateViolations = &state.CandidateViolations[ otherSourcePointIndex * numberOfTargetPoints ];
+    for ( int otherTargetPointIndex = 0; otherTargetPointIndex < numberOfTargetPoints; otherTargetPointIndex++ )
+    {
+      double residual = sourceDistance - targetDistances[ otherTargetPointIndex ];
+      candidateCosts[ otherTargetPointIndex ] -= residual * residual;
+      if ( fabs( residual ) > state.PairwiseDistanceTolerance )
+      {
+        candidateViolations[ otherTargetPointIndex ]--;
+      }
+    }
+    candidateViolations[ targetPointIndex ]--;
+  }
+
+  state.AssignedMoments.RemovePointPair( &state.SourceCoordinates[ sourcePointIndex * 3 ], &state.TargetCoordinates[ targetPointIndex * 3 ] );
+  state.NumberOfAssignedPoints--;
+  state.Correspondences[ sourcePointIndex ] = BRANCH_AND_BOUND_UNDECIDED;
+  state.AssignedCost -= state.CandidateCosts[ sourcePointIndex * numberOfTargetPoints + targetPointIndex ];
 }
 
 //------------------------------------------------------------------------------
@@ -926,54 +1935,62 @@ double vtkPointMatcher::ComputeRegistrationRootMeanSquareError( vtkPoints* sourc
     return RESET_VALUE_COMPUTED_ROOT_MEAN_DISTANCE_ERROR;
   }
 
-  vtkSmartPointer< vtkLandmarkTransform > landmarkTransform = vtkSmartPointer< vtkLandmarkTransform >::New();
-  landmarkTransform->SetSourceLandmarks( sourcePoints );
-  landmarkTransform->SetTargetLandmarks( targetPoints );
-  landmarkTransform->SetModeToRigidBody();
-  landmarkTransform->Update();
-
-  vtkSmartPointer< vtkPolyData > sourcePointsPolyData = vtkSmartPointer< vtkPolyData >::New();
-  sourcePointsPolyData->SetPoints( sourcePoints );
-
-  vtkSmartPointer< vtkTransformPolyDataFilter > transformFilter = vtkSmartPointer< vtkTransformPolyDataFilter >::New();
-  transformFilter->SetTransform( landmarkTransform );
-  transformFilter->SetInputData( sourcePointsPolyData );
-  transformFilter->Update();
-
-  vtkPolyData* transformedSourcePointsPolyData = transformFilter->GetOutput();
-  if ( transformedSourcePointsPolyData == NULL )
+  int numberOfPoints = targetPoints->GetNumberOfPoints();
+  if ( sourcePoints->GetNumberOfPoints() != numberOfPoints )
   {
-    vtkGenericWarningMacro( "Transformed source points poly data is null Returning default value " << RESET_VALUE_COMPUTED_ROOT_MEAN_DISTANCE_ERROR << "." );
+    vtkGenericWarningMacro( "Point lists are not of same size " << sourcePoints->GetNumberOfPoints() << " and " << numberOfPoints << ". Returning default value " << RESET_VALUE_COMPUTED_ROOT_MEAN_DISTANCE_ERROR << "." );
     return RESET_VALUE_COMPUTED_ROOT_MEAN_DISTANCE_ERROR;
   }
 
-  vtkPoints* transformedSourcePoints = transformedSourcePointsPolyData->GetPoints();
-  if ( transformedSourcePoints == NULL )
+  // closed form rigid registration error, same as registering with vtkLandmarkTransform and measuring the distances
+  vtkLandmarkRegistrationMoments moments;
+  for ( int pointIndex = 0; pointIndex < numberOfPoints; pointIndex++ )
   {
-    vtkGenericWarningMacro( "Transformed source point list is null. Returning default value " << RESET_VALUE_COMPUTED_ROOT_MEAN_DISTANCE_ERROR << "." );
-    return RESET_VALUE_COMPUTED_ROOT_MEAN_DISTANCE_ERROR;
+    double sourcePoint[ 3 ];
+    sourcePoints->GetPoint( pointIndex, sourcePoint );
+    double targetPoint[ 3 ];
+    targetPoints->GetPoint( pointIndex, targetPoint );
+    moments.AddPointPair( sourcePoint, targetPoint );
+  }
+  return moments.ComputeRootMeanSquareError( VTK_LANDMARK_RIGIDBODY );
+}
+
+//------------------------------------------------------------------------------
+double vtkPointMatcher::ComputeMaximumRegistrationDistance2( vtkPoints* sourcePoints, vtkPoints* targetPoints )
+{
+  if ( sourcePoints == NULL || targetPoints == NULL || sourcePoints->GetNumberOfPoints() != targetPoints->GetNumberOfPoints() )
+  {
+    vtkGenericWarningMacro( "Point lists are null or not of same size. Returning default value " << VTK_DOUBLE_MAX << "." );
+    return VTK_DOUBLE_MAX;
   }
 
   int numberOfPoints = targetPoints->GetNumberOfPoints();
-  if ( transformedSourcePoints->GetNumberOfPoints() != numberOfPoints )
+  vtkLandmarkRegistrationMoments moments;
+  for ( int pointIndex = 0; pointIndex < numberOfPoints; pointIndex++ )
   {
-    vtkGenericWarningMacro( "Point lists are not of same size " << transformedSourcePoints->GetNumberOfPoints() << " and " << numberOfPoints << ". Returning default value " << RESET_VALUE_COMPUTED_ROOT_MEAN_DISTANCE_ERROR << "." );
-    return RESET_VALUE_COMPUTED_ROOT_MEAN_DISTANCE_ERROR;
+    double sourcePoint[ 3 ];
+    sourcePoints->GetPoint( pointIndex, sourcePoint );
+    double targetPoint[ 3 ];
+    targetPoints->GetPoint( pointIndex, targetPoint );
+    moments.AddPointPair( sourcePoint, targetPoint );
+  }
+  vtkSmartPointer< vtkMatrix4x4 > sourceToTargetMatrix = vtkSmartPointer< vtkMatrix4x4 >::New();
+  if ( !moments.ComputeSourceToTargetMatrix( VTK_LANDMARK_RIGIDBODY, sourceToTargetMatrix ) )
+  {
+    return VTK_DOUBLE_MAX;
   }
 
-  double sumOfSquaredDistances = 0.0;
+  double maximumDistance2 = 0.0;
   for ( int pointIndex = 0; pointIndex < numberOfPoints; pointIndex++ )
   {
-    double transformedSourcePoint[ 3 ];
-    transformedSourcePoints->GetPoint( pointIndex, transformedSourcePoint );
+    double sourcePoint[ 4 ] = { 0.0, 0.0, 0.0, 1.0 };
+    sourcePoints->GetPoint( pointIndex, sourcePoint );
+    sourceToTargetMatrix->MultiplyPoint( sourcePoint, sourcePoint );
     double targetPoint[ 3 ];
     targetPoints->GetPoint( pointIndex, targetPoint );
-    double squaredDistance = vtkMath::Distance2BetweenPoints( transformedSourcePoint, targetPoint );
-    sumOfSquaredDistances += squaredDistance;
+    maximumDistance2 = vtkMath::Max( maximumDistance2, vtkMath::Distance2BetweenPoints( sourcePoint, targetPoint ) );
   }
-  double meanOfSquaredDistances = sumOfSquaredDistances / numberOfPoints;
-  double rootMeanSquareistanceErrors = sqrt( meanOfSquaredDistances );
-  return rootMeanSquareistanceErrors;
+  return maximumDistance2;
 }
 
 //------------------------------------------------------------------------------
@@ -983,7 +2000,8 @@ bool vtkPointMatcher::ComputePointMatchingBasedOnRegistration( vtkAbstractTransf
                                                                double thresholdDistance2ForOutlier,
                                                                unsigned int maximumOutlierCount,
                                                                vtkPoints* matchedSourcePoints,
-                                                               vtkPoints* matchedTargetPoints )
+                                                               vtkPoints* matchedTargetPoints,
+                                                               vtkAbstractPointLocator* targetPointLocator )
 {
   if ( registration == NULL )
   {
@@ -1038,20 +2056,25 @@ bool vtkPointMatcher::ComputePointMatchingBasedOnRegistration( vtkAbstractTransf
     return false;
   }
 
-  vtkSmartPointer< vtkPolyData > unmatchedTargetPointsPolyData = vtkSmartPointer< vtkPolyData >::New();
-  bool polyDataGenerated = vtkPointMatcher::GeneratePolyDataFromPoints( unmatchedTargetPoints, unmatchedTargetPointsPolyData );
-  if ( !polyDataGenerated )
+  vtkSmartPointer< vtkAbstractPointLocator > pointLocator = targetPointLocator;
+  if ( pointLocator == NULL )
   {
-    vtkGenericWarningMacro( "Unable to generate poly data from points" );
-    return false;
+    vtkSmartPointer< vtkPolyData > unmatchedTargetPointsPolyData = vtkSmartPointer< vtkPolyData >::New();
+    bool polyDataGenerated = vtkPointMatcher::GeneratePolyDataFromPoints( unmatchedTargetPoints, unmatchedTargetPointsPolyData );
+    if ( !polyDataGenerated )
+    {
+      vtkGenericWarningMacro( "Unable to generate poly data from points" );
+      return false;
+    }
+    vtkSmartPointer< vtkPointLocator > newPointLocator = vtkSmartPointer< vtkPointLocator >::New();
+    newPointLocator->SetDataSet( unmatchedTargetPointsPolyData );
+    newPointLocator->BuildLocator();
+    pointLocator = newPointLocator.GetPointer();
   }
 
   // create the matched list, while removing outliers
   matchedSourcePoints->Reset();
   matchedTargetPoints->Reset();
-  vtkSmartPointer< vtkPointLocator > pointLocator = vtkSmartPointer< vtkPointLocator >::New();
-  pointLocator->SetDataSet( unmatchedTargetPointsPolyData );
-  pointLocator->BuildLocator();
   int numberOfSourcePoints = registeredUnmatchedSourcePoints->GetNumberOfPoints();
   unsigned int outlierCount = 0;
   for ( int sourcePointIndex = 0; sourcePointIndex < numberOfSourcePoints; sourcePointIndex++ )
@@ -1085,7 +2108,7 @@ bool vtkPointMatcher::ComputePointMatchingBasedOnRegistration( vtkAbstractTransf
   {
     return false;
   }
-  
+
   return true;
 }
 
@@ -1217,8 +2240,20 @@ void vtkPointMatcher::ComputeUniquenessesForPoints( vtkPoints* points, vtkDouble
   pointDistanceMatrix->SetPointList2( points ); // distances to self
   pointDistanceMatrix->Update();
 
-  vtkSmartPointer< vtkDoubleArray > allDistancesArray = vtkSmartPointer< vtkDoubleArray >::New();
-  pointDistanceMatrix->GetDistances( allDistancesArray );
+  // sorted once, so that the uniqueness of each distance is a binary search instead of a scan over all distances
+  vtkSmartPointer< vtkDoubleArray > sortedDistancesArray = vtkSmartPointer< vtkDoubleArray >::New();
+  pointDistanceMatrix->GetDistances( sortedDistancesArray );
+  int numberOfDistances = sortedDistancesArray->GetNumberOfTuples();
+  double* sortedDistances = sortedDistancesArray->GetPointer( 0 );
+  std::sort( sortedDistances, sortedDistances + numberOfDistances );
+  vtkSmartPointer< vtkDoubleArray > cumulativeDistancesArray = vtkSmartPointer< vtkDoubleArray >::New();
+  cumulativeDistancesArray->SetNumberOfTuples( numberOfDistances );
+  double cumulativeDistance = 0.0;
+  for ( int distanceIndex = 0; distanceIndex < numberOfDistances; distanceIndex++ )
+  {
+    cumulativeDistance += sortedDistances[ distanceIndex ];
+    cumulativeDistancesArray->SetValue( distanceIndex, cumulativeDistance );
+  }
   double maximumDistance = pointDistanceMatrix->GetMaximumDistance();
 
   uniquenesses->Reset();
@@ -1228,10 +2263,11 @@ void vtkPointMatcher::ComputeUniquenessesForPoints( vtkPoints* points, vtkDouble
     // heuristic measure for point uniqueness:
     // sum of point-to-point distance uniquenesses
     double sumOfDistanceUniquenesses = 0;
+    const double* distancesFromPoint = pointDistanceMatrix->GetDistancesFromList1Point( pointIndex );
     for ( int otherPointIndex = 0; otherPointIndex < numberOfPoints; otherPointIndex++ )
     {
-      double currentDistance = pointDistanceMatrix->GetDistance( pointIndex, otherPointIndex );
-      sumOfDistanceUniquenesses += vtkPointMatcher::ComputeUniquenessForDistance( currentDistance, maximumDistance, allDistancesArray );
+      double currentDistance = distancesFromPoint[ otherPointIndex ];
+      sumOfDistanceUniquenesses += vtkPointMatcher::ComputeUniquenessForDistance( currentDistance, maximumDistance, sortedDistancesArray, cumulativeDistancesArray );
     }
     double pointUniqueness = sumOfDistanceUniquenesses;
     uniquenesses->InsertNextTuple1( pointUniqueness );
@@ -1239,9 +2275,9 @@ void vtkPointMatcher::ComputeUniquenessesForPoints( vtkPoints* points, vtkDouble
 }
 
 //------------------------------------------------------------------------------
-double vtkPointMatcher::ComputeUniquenessForDistance( double distance, double maximumDistance, vtkDoubleArray* allDistancesArray )
+double vtkPointMatcher::ComputeUniquenessForDistance( double distance, double maximumDistance, vtkDoubleArray* sortedDistancesArray, vtkDoubleArray* cumulativeDistancesArray )
 {
-  if ( allDistancesArray == NULL )
+  if ( sortedDistancesArray == NULL || cumulativeDistancesArray == NULL )
   {
     vtkGenericWarningMacro( "Distances array is null" );
     return 0.0;
@@ -1253,19 +2289,18 @@ double vtkPointMatcher::ComputeUniquenessForDistance( double distance, double ma
     maximumDistance = 1.0;
   }
 
-  double distanceUniqueness = 0.0;
-  int numberOfDistances = allDistancesArray->GetNumberOfTuples();
-  for ( int distanceIndex = 0; distanceIndex < numberOfDistances; distanceIndex++ )
+  // Other distances larger than the distance are treated as uniqueness 0. Each of the others contributes
+  // the heuristic measure 1 - ( distance - otherDistance ) / maximumDistance (bounded between 0..1),
+  // so their sum only depends on how many there are and on their sum.
+  int numberOfDistances = sortedDistancesArray->GetNumberOfTuples();
+  const double* sortedDistances = sortedDistancesArray->GetPointer( 0 );
+  int numberOfSmallerDistances = std::upper_bound( sortedDistances, sortedDistances + numberOfDistances, distance ) - sortedDistances;
+  if ( numberOfSmallerDistances == 0 )
   {
-    double otherDistance = allDistancesArray->GetComponent( distanceIndex, 0 );
-    if ( distance < otherDistance )
-    {
-      // treat uniqueness as 0
-      continue;
-    }
-    double heuristicMeasure = 1.0 - ( abs( distance - otherDistance ) / maximumDistance ); // will be bounded between 0..1
-    distanceUniqueness += heuristicMeasure;
+    return 0.0;
   }
+  double sumOfSmallerDistances = cumulativeDistancesArray->GetValue( numberOfSmallerDistances - 1 );
+  double distanceUniqueness = numberOfSmallerDistances * ( 1.0 - distance / maximumDistance ) + sumOfSmallerDistances / maximumDistance;
   return distanceUniqueness;
 }
 
@@ -1373,7 +2408,7 @@ bool vtkPointMatcher::ExtractMaximumDistanceAndCentroidFeatures( vtkPoints* poin
   pointDistanceMatrix->SetPointList1( points );
   pointDistanceMatrix->SetPointList2( points );
   pointDistanceMatrix->Update();
-  
+
   // first pair of distances
   int pointFeatureIndex1 = 0;
   int pointFeatureIndex2 = 0;
@@ -5,8 +5,13 @@
 #include <vtkTimeStamp.h>
 #include <vtkSmartPointer.h>
 
+#include <vector>
+
+class vtkAbstractPointLocator;
 class vtkAbstractTransform;
+class vtkMatrix4x4;
 class vtkDoubleArray;
+class vtkPointDistanceMatrix;
 class vtkPoints;
 class vtkPolyData;
 
@@ -52,6 +57,25 @@ class VTK_SLICER_FIDUCIALREGISTRATIONWIZARD_MODULE_LOGIC_EXPORT vtkPointMatcher
     vtkGetMacro( AmbiguityDistanceErrorMultiple, double );
     vtkSetMacro( AmbiguityDistanceErrorMultiple, double );
 
+    // Number of threads used to search over subsets of points, and over the starting orientations of ICP.
+    // Values of 0 or less (default) use one thread per core.
+    // The matching result does not depend on the number of threads.
+    vtkGetMacro( NumberOfThreads, int );
+    vtkSetMacro( NumberOfThreads, int );
+
+    // Methods used when there are too many points for an exhaustive search.
+    // By default (GeneralMatchingAllMethods) the methods are tried in turn until one is successful:
+    // branch and bound, then subsamples of distinctive points, then ICP.
+    // A single method can be selected, e.g. to check it on its own.
+    enum
+    {
+      GeneralMatchingAllMethods = 0,
+      GeneralMatchingBranchAndBound,
+      GeneralMatchingICP
+    };
+    vtkGetMacro( GeneralMatchingMethod, int );
+    vtkSetMacro( GeneralMatchingMethod, int );
+
     // Output Accessors
     // these points will be ordered pairs and the lists will be the same length as one another
     vtkPoints* GetOutputSourcePoints();
@@ -88,6 +112,10 @@ class VTK_SLICER_FIDUCIALREGISTRATIONWIZARD_MODULE_LOGIC_EXPORT vtkPointMatcher
 
     double ComputedDistanceError;
 
+    int NumberOfThreads;
+
+    int GeneralMatchingMethod;
+
     vtkSmartPointer< vtkPoints > OutputSourcePoints;
     vtkSmartPointer< vtkPoints > OutputTargetPoints;
 
@@ -102,6 +130,7 @@ class VTK_SLICER_FIDUCIALREGISTRATIONWIZARD_MODULE_LOGIC_EXPORT vtkPointMatcher
     // all the bool methods below return 'true' on successful registration
     // otherwise they return false
     bool MatchPointsExhaustively();
+    bool MatchPointsUsingBranchAndBound();
     bool MatchPointsGenerally();
     bool MatchPointsGenerallyUsingUniqueDistances();
     bool MatchPointsGenerallyUsingMaximumDistancesAndCentroid();
@@ -116,27 +145,71 @@ class VTK_SLICER_FIDUCIALREGISTRATIONWIZARD_MODULE_LOGIC_EXPORT vtkPointMatcher
                                                       vtkPoints* unmatchedPointList1, vtkPoints* unmatchedPointList2,
                                                       double ambiguityDistance, bool& matchingAmbiguous, 
                                                       double& computedDistanceError, double tolerableDistanceError,
-                                                      vtkPoints* outputMatchedPointList1, vtkPoints* outputMatchedPointList2 );
+                                                      vtkPoints* outputMatchedPointList1, vtkPoints* outputMatchedPointList2,
+                                                      int numberOfThreads );
     static void UpdateBestMatchingForNSizedSubsetsOfPoints( int subsetSize,
                                                             vtkPoints* unmatchedPointList1, vtkPoints* unmatchedPointList2,
                                                             double ambiguityDistance, bool& matchingAmbiguous, 
                                                             double& computedDistanceError,
-                                                            vtkPoints* outputMatchedPointList1, vtkPoints* outputMatchedPointList2 );
+                                                            vtkPoints* outputMatchedPointList1, vtkPoints* outputMatchedPointList2,
+                                                            int numberOfThreads );
+    // Best matching found in a range of candidate subsets, searched by one thread
+    struct SubsetMatchingResult;
+    static void UpdateBestMatchingForRangeOfSubsetsOfPoints( int subsetSize,
+                                                             vtkPoints* unmatchedPointList1, vtkPoints* unmatchedPointList2,
+                                                             vtkTypeUInt64 firstSubsetPairIndex, vtkTypeUInt64 lastSubsetPairIndex,
+                                                             double ambiguityDistance, SubsetMatchingResult& result );
     static void UpdateBestMatchingForSubsetOfPoints( vtkPoints* unmatchedPointList1, vtkPoints* unmatchedPointList2,
-                                                     double ambiguityDistance, bool& matchingAmbiguous, 
-                                                     double& computedDistanceError,
-                                                     vtkPoints* outputMatchedPointList1, vtkPoints* outputMatchedPointList2 );
+                                                     double ambiguityDistance, SubsetMatchingResult& result );
+    // Branch and bound search over correspondences of exactly subsetSize point pairs.
+    // Partial correspondences are built one source point at a time, and are pruned as soon as
+    // the residuals of their pairwise distances (plus a lower bound for the points that are
+    // still to be matched) show that they cannot beat the best complete correspondence found so far.
+    struct BranchAndBoundState;
+    static bool UpdateBestMatchingUsingBranchAndBound( int subsetSize,
+                                                       vtkPoints* unmatchedSourcePoints, vtkPoints* unmatchedTargetPoints,
+                                                       double pairwiseDistanceTolerance, double ambiguityDistance, bool& matchingAmbiguous,
+                                                       int& numberOfRemainingNodes,
+                                                       vtkPoints* outputMatchedSourcePoints, vtkPoints* outputMatchedTargetPoints,
+                                                       std::vector< int >& outputCorrespondences );
+    // Checks the correspondence found by UpdateBestMatchingUsingBranchAndBound for ambiguity without the pairwise distance tolerance
+    static bool IsMatchingAmbiguousUsingBranchAndBound( int subsetSize,
+                                                        vtkPoints* unmatchedSourcePoints, vtkPoints* unmatchedTargetPoints,
+                                                        const std::vector< int >& correspondences, double distanceError, double ambiguityDistance,
+                                                        int& numberOfRemainingNodes );
+    static void InitializeBranchAndBoundState( BranchAndBoundState& state, int subsetSize,
+                                               vtkPoints* unmatchedSourcePoints, vtkPoints* unmatchedTargetPoints,
+                                               double pairwiseDistanceTolerance, double ambiguityDistance, int numberOfRemainingNodes );
+    static void RuleOutCandidatesInBranchAndBound( BranchAndBoundState& state,
+                                                   vtkPointDistanceMatrix* sourceDistanceMatrix, vtkPointDistanceMatrix* targetDistanceMatrix );
+    static void UpdateBestMatchingUsingBranchAndBoundHelper( BranchAndBoundState& state );
+    static double MaximumPairwiseDistanceCostInBranchAndBound( BranchAndBoundState& state );
+    static void AssignPointInBranchAndBound( BranchAndBoundState& state, int sourcePointIndex, int targetPointIndex );
+    static void UnassignPointInBranchAndBound( BranchAndBoundState& state, int sourcePointIndex, int targetPointIndex );
     static void UpdateAmbiguityFlag( double currentDistance, double& bestDistance, double ambiguityDistance, bool& ambiguityFlag );
     static double ComputeRegistrationRootMeanSquareError( vtkPoints* sourcePoints, vtkPoints* targetPoints );
+    // Largest squared distance between a registered source point and its target point
+    static double ComputeMaximumRegistrationDistance2( vtkPoints* sourcePoints, vtkPoints* targetPoints );
+    // Rigid ICP from one of the starting orientations, and the point matching that it leads to.
+    // The locator of the target points is shared by all runs, and is only read.
+    struct ICPRunResult;
+    static void UpdateICPRunFromInitialAlignment( vtkMatrix4x4* initialAlignmentMatrix,
+                                                  vtkPoints* unmatchedSourcePoints, vtkPoints* unmatchedTargetPoints,
+                                                  vtkAbstractPointLocator* targetPointLocator,
+                                                  double thresholdDistance2ForOutlier, unsigned int maximumOutlierCount,
+                                                  double tolerableDistanceError, double ambiguityDistance, ICPRunResult& result );
+    // If a locator of the target points is given, it is used instead of building one.
     static bool ComputePointMatchingBasedOnRegistration( vtkAbstractTransform* registration,
                                                          vtkPoints* unmatchedSourcePoints, vtkPoints* unmatchedTargetPoints,
                                                          double thresholdDistance2ForOutlier, unsigned int maximumOutlierCount,
-                                                         vtkPoints* matchedSourcePoints, vtkPoints* matchedTargetPoints );
+                                                         vtkPoints* matchedSourcePoints, vtkPoints* matchedTargetPoints,
+                                                         vtkAbstractPointLocator* targetPointLocator=NULL );
     static double ComputeMaximumDistanceInPointSet( vtkPoints* points );
     static void CopyFirstNPoints( vtkPoints* inputList, vtkPoints* outputList, int n );
     static void ReorderPointsAccordingToUniqueGeometry( vtkPoints* inputUnsortedPointList, vtkPoints* outputSortedPointList );
     static void ComputeUniquenessesForPoints( vtkPoints* points, vtkDoubleArray* uniquenesses );
-    static double ComputeUniquenessForDistance( double distance, double maximumDistance, vtkDoubleArray* allDistancesArray );
+    // sortedDistancesArray holds all distances in ascending order, and cumulativeDistancesArray the running sums of sortedDistancesArray
+    static double ComputeUniquenessForDistance( double distance, double maximumDistance, vtkDoubleArray* sortedDistancesArray, vtkDoubleArray* cumulativeDistancesArray );
     static bool GeneratePolyDataFromPoints( vtkPoints*, vtkPolyData* );
     static bool ComputeCentroidOfPoints( vtkPoints*, double* centroid );
     static bool ExtractMaximumDistanceAndCentroidFeatures( vtkPoints* points, vtkPoints* features );
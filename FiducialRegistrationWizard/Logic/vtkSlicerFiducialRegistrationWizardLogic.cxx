@@ -35,13 +35,12 @@
 #include <vtkMatrix4x4.h>
 #include <vtkNew.h>
 #include <vtkObjectFactory.h>
-#include <vtkPCAStatistics.h>
 #include <vtkSmartPointer.h>
-#include <vtkTable.h>
 #include <vtkThinPlateSplineTransform.h>
 #include <vtkTransform.h>
 
 // STD includes
+#include <algorithm>
 #include <cassert>
 #include <sstream>
 
@@ -49,6 +48,12 @@
 // Helper methods -------------------------------------------------------------------
 
 double EIGENVALUE_THRESHOLD = 1e-4;
+// Moments of point pairs are recomputed from all point pairs after this many pairs were changed,
+// so that rounding errors of the incremental updates do not accumulate.
+int MAXIMUM_NUMBER_OF_POINT_PAIR_UPDATES = 1000;
+// Automatic update recomputes the point matching on every change of the fiducials, e.g. while a fiducial is dragged.
+// Matching more points may take seconds, so it is only done when the registration is updated manually.
+int MAXIMUM_NUMBER_OF_POINTS_FOR_AUTOMATIC_UPDATE_OF_POINT_MATCHING = 30;
 
 //------------------------------------------------------------------------------
 void MarkupsFiducialNodeToVTKPoints(vtkMRMLMarkupsFiducialNode* markupsFiducialNode, vtkPoints* points)
@@ -67,6 +72,14 @@ void MarkupsFiducialNodeToVTKPoints(vtkMRMLMarkupsFiducialNode* markupsFiducialN
 
 vtkStandardNewMacro(vtkSlicerFiducialRegistrationWizardLogic);
 
+//------------------------------------------------------------------------------
+vtkSlicerFiducialRegistrationWizardLogic::LinearRegistrationState::LinearRegistrationState()
+  : FromPoints(vtkSmartPointer< vtkPoints >::New())
+  , ToPoints(vtkSmartPointer< vtkPoints >::New())
+  , NumberOfPointPairUpdates(0)
+{
+}
+
 //------------------------------------------------------------------------------
 vtkSlicerFiducialRegistrationWizardLogic::vtkSlicerFiducialRegistrationWizardLogic()
   : MarkupsLogic(NULL)
@@ -149,6 +162,10 @@ void vtkSlicerFiducialRegistrationWizardLogic::OnMRMLSceneNodeRemoved(vtkMRMLNod
   {
     vtkDebugMacro("OnMRMLSceneNodeRemoved");
     vtkUnObserveMRMLNodeMacro(node);
+    if (node->GetID() != NULL)
+    {
+      this->LinearRegistrationStates.erase(node->GetID());
+    }
   }
 }
 
@@ -289,15 +306,14 @@ bool vtkSlicerFiducialRegistrationWizardLogic::UpdateCalibration(vtkMRMLNode* no
         << " registration is being used." << std::endl << "Unexpected results may occur.";
       fiducialRegistrationWizardNode->AddToCalibrationStatusMessage(msg.str());
     }
-    const int MAX_NUMBER_OF_POINTS_FOR_POINT_MATCHING_AUTOMATIC = 30; // more than this and it tends to take a long time. Algorithm is at least N!
-    int fromNumberOfPoints = fromPointsUnordered->GetNumberOfPoints();
-    int toNumberOfPoints = toPointsUnordered->GetNumberOfPoints();
-    int numberOfPointsToMatch = std::max(fromNumberOfPoints, toNumberOfPoints);
-    if (numberOfPointsToMatch > MAX_NUMBER_OF_POINTS_FOR_POINT_MATCHING_AUTOMATIC)
+    int numberOfPointsToMatch = std::max(fromPointsUnordered->GetNumberOfPoints(), toPointsUnordered->GetNumberOfPoints());
+    if (fiducialRegistrationWizardNode->GetUpdateMode() == vtkMRMLFiducialRegistrationWizardNode::UPDATE_MODE_AUTOMATIC
+      && numberOfPointsToMatch > MAXIMUM_NUMBER_OF_POINTS_FOR_AUTOMATIC_UPDATE_OF_POINT_MATCHING)
     {
       std::stringstream msg;
-      msg << "Too many points to compute point pairing " << numberOfPointsToMatch << "." << std::endl
-        << "To avoid long computation time, there should be at most " << MAX_NUMBER_OF_POINTS_FOR_POINT_MATCHING_AUTOMATIC << " points." << std::endl
+      msg << "Too many points to compute point pairing automatically on every change (" << numberOfPointsToMatch << ")." << std::endl
+        << "To avoid long computation time, there should be at most " << MAXIMUM_NUMBER_OF_POINTS_FOR_AUTOMATIC_UPDATE_OF_POINT_MATCHING << " points." << std::endl
+        << "Switch to manual update to compute the registration." << std::endl
         << "Aborting registration.";
       fiducialRegistrationWizardNode->AddToCalibrationStatusMessage(msg.str());
       return false;
@@ -352,26 +368,33 @@ bool vtkSlicerFiducialRegistrationWizardLogic::UpdateCalibration(vtkMRMLNode* no
   }
 
   // compute registration
+  double rmsError = VTK_DOUBLE_MAX;
+  bool rmsErrorComputed = false;
   int registrationMode = fiducialRegistrationWizardNode->GetRegistrationMode();
   if (registrationMode == vtkMRMLFiducialRegistrationWizardNode::REGISTRATION_MODE_RIGID ||
     registrationMode == vtkMRMLFiducialRegistrationWizardNode::REGISTRATION_MODE_SIMILARITY)
   {
-    // Compute transformation matrix. We don't set the landmark transform in the node directly because
-    // vtkLandmarkTransform is not fully supported (e.g., it cannot be stored in file).
-    vtkNew<vtkLandmarkTransform> landmarkTransform;
-    landmarkTransform->SetSourceLandmarks(fromPointsOrdered);
-    landmarkTransform->SetTargetLandmarks(toPointsOrdered);
-    if (registrationMode == vtkMRMLFiducialRegistrationWizardNode::REGISTRATION_MODE_RIGID)
+    // Compute transformation matrix from the moments of the point pairs (same result as vtkLandmarkTransform).
+    // Only the moments of the point pairs that changed since the last update are recomputed.
+    std::string nodeID = (fiducialRegistrationWizardNode->GetID() != NULL ? fiducialRegistrationWizardNode->GetID() : "");
+    LinearRegistrationState& linearRegistrationState = this->LinearRegistrationStates[nodeID];
+    vtkSlicerFiducialRegistrationWizardLogic::UpdateLinearRegistrationState(linearRegistrationState, fromPointsOrdered, toPointsOrdered);
+    int landmarkTransformMode = VTK_LANDMARK_RIGIDBODY;
+    if (registrationMode == vtkMRMLFiducialRegistrationWizardNode::REGISTRATION_MODE_SIMILARITY)
     {
-      landmarkTransform->SetModeToRigidBody();
+      landmarkTransformMode = VTK_LANDMARK_SIMILARITY;
     }
-    else
+    // We don't set a landmark transform in the node directly because
+    // vtkLandmarkTransform is not fully supported (e.g., it cannot be stored in file).
+    vtkNew< vtkMatrix4x4 > calculatedTransform;
+    if (!linearRegistrationState.Moments.ComputeSourceToTargetMatrix(landmarkTransformMode, calculatedTransform.GetPointer()))
     {
-      landmarkTransform->SetModeToSimilarity();
+      vtkErrorMacro("vtkSlicerFiducialRegistrationWizardLogic::UpdateCalibration failed to compute the registration matrix");
+      fiducialRegistrationWizardNode->SetCalibrationStatusMessage("Failed to compute the registration matrix.");
+      return false;
     }
-    landmarkTransform->Update();
-    vtkNew< vtkMatrix4x4 > calculatedTransform;
-    landmarkTransform->GetMatrix(calculatedTransform.GetPointer());
+    rmsError = linearRegistrationState.Moments.ComputeRootMeanSquareError(landmarkTransformMode);
+    rmsErrorComputed = true;
 
     // Copy the resulting transform into the outputTransformNode
     if (!outputTransformNode->IsLinear())
@@ -455,8 +478,11 @@ bool vtkSlicerFiducialRegistrationWizardLogic::UpdateCalibration(vtkMRMLNode* no
     return false;
   }
 
+  if (!rmsErrorComputed)
+  {
+    rmsError = this->CalculateRegistrationError(fromPointsOrdered, toPointsOrdered, outputTransform);
+  }
   std::stringstream completeMessage;
-  double rmsError = this->CalculateRegistrationError(fromPointsOrdered, toPointsOrdered, outputTransform);
   completeMessage << "Registration Complete. RMS Error: " << rmsError;
   fiducialRegistrationWizardNode->AddToCalibrationStatusMessage(completeMessage.str());
   fiducialRegistrationWizardNode->SetCalibrationError( rmsError );
@@ -489,51 +515,110 @@ double vtkSlicerFiducialRegistrationWizardLogic::CalculateRegistrationError(vtkP
   return sqrt(sumSquaredError / toPoints->GetNumberOfPoints());
 }
 
+//------------------------------------------------------------------------------
+int vtkSlicerFiducialRegistrationWizardLogic::UpdateLinearRegistrationState(LinearRegistrationState& state, vtkPoints* fromPoints, vtkPoints* toPoints)
+{
+  int numberOfPointPairs = fromPoints->GetNumberOfPoints();
+  int numberOfPreviousPointPairs = state.FromPoints->GetNumberOfPoints();
+  if (numberOfPointPairs < numberOfPreviousPointPairs || state.NumberOfPointPairUpdates >= MAXIMUM_NUMBER_OF_POINT_PAIR_UPDATES)
+  {
+    // Removing a point changes the index of all points after it, so all point pairs are added again
+    state.FromPoints->Reset();
+    state.ToPoints->Reset();
+    state.Moments.Reset();
+    state.NumberOfPointPairUpdates = 0;
+    numberOfPreviousPointPairs = 0;
+  }
+
+  int numberOfChangedPointPairs = 0;
+  for (int i = 0; i < numberOfPreviousPointPairs; i++)
+  {
+    double fromPoint[3] = { 0, 0, 0 };
+    fromPoints->GetPoint(i, fromPoint);
+    double toPoint[3] = { 0, 0, 0 };
+    toPoints->GetPoint(i, toPoint);
+    double previousFromPoint[3] = { 0, 0, 0 };
+    state.FromPoints->GetPoint(i, previousFromPoint);
+    double previousToPoint[3] = { 0, 0, 0 };
+    state.ToPoints->GetPoint(i, previousToPoint);
+    if (std::equal(fromPoint, fromPoint + 3, previousFromPoint) && std::equal(toPoint, toPoint + 3, previousToPoint))
+    {
+      continue;
+    }
+    state.Moments.RemovePointPair(previousFromPoint, previousToPoint);
+    state.Moments.AddPointPair(fromPoint, toPoint);
+    state.FromPoints->SetPoint(i, fromPoint);
+    state.ToPoints->SetPoint(i, toPoint);
+    state.NumberOfPointPairUpdates++;
+    numberOfChangedPointPairs++;
+  }
+  for (int i = numberOfPreviousPointPairs; i < numberOfPointPairs; i++)
+  {
+    double fromPoint[3] = { 0, 0, 0 };
+    fromPoints->GetPoint(i, fromPoint);
+    double toPoint[3] = { 0, 0, 0 };
+    toPoints->GetPoint(i, toPoint);
+    state.Moments.AddPointPair(fromPoint, toPoint);
+    state.FromPoints->InsertNextPoint(fromPoint);
+    state.ToPoints->InsertNextPoint(toPoint);
+    numberOfChangedPointPairs++;
+  }
+
+  if (numberOfChangedPointPairs > 0)
+  {
+    state.FromPoints->Modified();
+    state.ToPoints->Modified();
+  }
+  return numberOfChangedPointPairs;
+}
+
 //------------------------------------------------------------------------------
 bool vtkSlicerFiducialRegistrationWizardLogic::CheckCollinear(vtkPoints* points)
 {
-  // Initialize the x,y,z arrays for computing the PCA statistics
-  vtkSmartPointer< vtkDoubleArray > xArray = vtkSmartPointer< vtkDoubleArray >::New();
-  xArray->SetName("xArray");
-  vtkSmartPointer< vtkDoubleArray > yArray = vtkSmartPointer< vtkDoubleArray >::New();
-  yArray->SetName("yArray");
-  vtkSmartPointer< vtkDoubleArray > zArray = vtkSmartPointer< vtkDoubleArray >::New();
-  zArray->SetName("zArray");
-
-  // Put the fiducial position values into the arrays
+  // Principal component analysis: the eigenvalues of the (sample) covariance matrix of the fiducial positions.
+  // It is computed directly, because it is done on every update of the registration.
+  int numberOfPoints = points->GetNumberOfPoints();
+  if (numberOfPoints < 2)
+  {
+    return true;
+  }
+
+  double mean[3] = { 0, 0, 0 };
   double fiducialPosition[3] = { 0, 0, 0 };
-  for (int i = 0; i < points->GetNumberOfPoints(); i++)
+  for (int i = 0; i < numberOfPoints; i++)
+  {
+    points->GetPoint(i, fiducialPosition);
+    for (int axis = 0; axis < 3; axis++)
+    {
+      mean[axis] += fiducialPosition[axis] / numberOfPoints;
+    }
+  }
+
+  double covariance[3][3] = { { 0, 0, 0 }, { 0, 0, 0 }, { 0, 0, 0 } };
+  for (int i = 0; i < numberOfPoints; i++)
   {
     points->GetPoint(i, fiducialPosition);
-    xArray->InsertNextValue(fiducialPosition[0]);
-    yArray->InsertNextValue(fiducialPosition[1]);
-    zArray->InsertNextValue(fiducialPosition[2]);
-  }
-
-  // Aggregate the arrays
-  vtkSmartPointer< vtkTable > arrayTable = vtkSmartPointer< vtkTable >::New();
-  arrayTable->AddColumn(xArray);
-  arrayTable->AddColumn(yArray);
-  arrayTable->AddColumn(zArray);
-
-  // Setup the principal component analysis
-  vtkSmartPointer< vtkPCAStatistics > pcaStatistics = vtkSmartPointer< vtkPCAStatistics >::New();
-  pcaStatistics->SetInputData(vtkStatisticsAlgorithm::INPUT_DATA, arrayTable);
-  pcaStatistics->SetColumnStatus("xArray", 1);
-  pcaStatistics->SetColumnStatus("yArray", 1);
-  pcaStatistics->SetColumnStatus("zArray", 1);
-  pcaStatistics->SetDeriveOption(true);
-  pcaStatistics->Update();
+    for (int row = 0; row < 3; row++)
+    {
+      for (int column = 0; column < 3; column++)
+      {
+        covariance[row][column] += (fiducialPosition[row] - mean[row]) * (fiducialPosition[column] - mean[column]) / (numberOfPoints - 1);
+      }
+    }
+  }
 
   // Calculate the eigenvalues
-  vtkSmartPointer< vtkDoubleArray > eigenvalues = vtkSmartPointer< vtkDoubleArray >::New();
-  pcaStatistics->GetEigenvalues(eigenvalues); // Eigenvalues are largest to smallest
+  double* covarianceRows[3] = { covariance[0], covariance[1], covariance[2] };
+  double eigenvalues[3] = { 0, 0, 0 };
+  double eigenvectors[3][3] = { { 0, 0, 0 }, { 0, 0, 0 }, { 0, 0, 0 } };
+  double* eigenvectorRows[3] = { eigenvectors[0], eigenvectors[1], eigenvectors[2] };
+  vtkMath::Jacobi(covarianceRows, eigenvalues, eigenvectorRows);
 
   // Test that each eigenvalues is bigger than some threshold
   int goodEigenvalues = 0;
-  for (int i = 0; i < eigenvalues->GetNumberOfTuples(); i++)
+  for (int i = 0; i < 3; i++)
   {
-    if (abs(eigenvalues->GetValue(i)) > EIGENVALUE_THRESHOLD)
+    if (fabs(eigenvalues[i]) > EIGENVALUE_THRESHOLD)
     {
       goodEigenvalues++;
     }
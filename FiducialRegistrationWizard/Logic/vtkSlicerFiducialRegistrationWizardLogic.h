@@ -46,6 +46,7 @@ class vtkMRMLLinearTransformNode;
 #include <cstdlib>
 
 // helper classes
+#include "vtkLandmarkRegistrationMoments.h"
 #include "vtkPointDistanceMatrix.h"
 
 #include "vtkSlicerFiducialRegistrationWizardModuleLogicExport.h"
@@ -104,6 +105,22 @@ private:
   double CalculateRegistrationError( vtkPoints* fromPoints, vtkPoints* toPoints, vtkAbstractTransform* transform );
   bool CheckCollinear( vtkPoints* points );
 
+  // Matched points of the last linear registration of a fiducial registration wizard node, and the moments of the point pairs.
+  // When fiducials are added or moved, only the moments of the changed point pairs are updated, and the registration
+  // is computed from the moments in closed form, so the cost of an update does not grow with the number of fiducials.
+  struct LinearRegistrationState
+  {
+    LinearRegistrationState();
+    vtkSmartPointer< vtkPoints > FromPoints;
+    vtkSmartPointer< vtkPoints > ToPoints;
+    vtkLandmarkRegistrationMoments Moments;
+    int NumberOfPointPairUpdates; // since the moments were last computed from all point pairs
+  };
+  // Update the state to the new matched points. Returns the number of point pairs that were changed.
+  static int UpdateLinearRegistrationState( LinearRegistrationState& state, vtkPoints* fromPoints, vtkPoints* toPoints );
+
+  std::map< std::string, LinearRegistrationState > LinearRegistrationStates; // key is the fiducial registration wizard node ID
+
   std::map< std::string, std::string > OutputMessages;
 
   void SetOutputMessage( std::string nodeID, std::string newOutputMessage ); // The modified event will tell the widget to   (only needs to update when transform is calculated)
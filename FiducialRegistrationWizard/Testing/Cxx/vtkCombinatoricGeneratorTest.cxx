@@ -0,0 +1,173 @@
+/*==============================================================================
+
+Copyright (c) Laboratory for Percutaneous Surgery (PerkLab)
+Queen's University, Kingston, ON, Canada. All Rights Reserved.
+
+See COPYRIGHT.txt
+or http://www.slicer.org/copyright/copyright.txt for details.
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+==============================================================================*/
+
+// FiducialRegistrationWizard includes
+#include <vtkCombinatoricGenerator.h>
+
+// VTK includes
+#include <vtkNew.h>
+
+// STD includes
+#include <iostream>
+#include <vector>
+
+//----------------------------------------------------------------------------
+bool CompareOutputSet(const std::vector<int>& expectedOutputSet, const int* actualOutputSet, unsigned int outputSetSize)
+{
+  if (actualOutputSet == NULL || expectedOutputSet.size() != outputSetSize)
+  {
+    std::cerr << "Output set is missing or has an unexpected size" << std::endl;
+    return false;
+  }
+  for (unsigned int elementIndex = 0; elementIndex < outputSetSize; ++elementIndex)
+  {
+    if (expectedOutputSet[elementIndex] != actualOutputSet[elementIndex])
+    {
+      std::cerr << "Output set element " << elementIndex << " is " << actualOutputSet[elementIndex]
+        << " instead of " << expectedOutputSet[elementIndex] << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+// The traversal must visit the output sets of Update() in the same order, and moving to a rank must give the same set
+bool TestTraversal(vtkCombinatoricGenerator* generator)
+{
+  std::cout << "Traversal of " << generator->GetCombinatoricAsString() << std::endl;
+
+  generator->Update();
+  std::vector<std::vector<int>> outputSets = generator->GetOutputSets();
+  vtkTypeUInt64 numberOfOutputSets = generator->ComputeNumberOfOutputSets();
+  if (numberOfOutputSets != outputSets.size())
+  {
+    std::cerr << "Number of output sets is " << numberOfOutputSets << " instead of " << outputSets.size() << std::endl;
+    return false;
+  }
+  unsigned int outputSetSize = generator->GetOutputSetSize();
+
+  vtkTypeUInt64 outputSetIndex = 0;
+  for (bool hasSet = generator->InitTraversal(); hasSet; hasSet = generator->GoToNextOutputSet(), ++outputSetIndex)
+  {
+    if (outputSetIndex >= outputSets.size())
+    {
+      std::cerr << "Traversal visits more output sets than Update() computes" << std::endl;
+      return false;
+    }
+    if (generator->GetCurrentOutputSetRank() != outputSetIndex)
+    {
+      std::cerr << "Rank of output set " << outputSetIndex << " is " << generator->GetCurrentOutputSetRank() << std::endl;
+      return false;
+    }
+    if (!CompareOutputSet(outputSets[outputSetIndex], generator->GetCurrentOutputSet(), outputSetSize))
+    {
+      std::cerr << "Traversal order differs at output set " << outputSetIndex << std::endl;
+      return false;
+    }
+  }
+  if (outputSetIndex != outputSets.size())
+  {
+    std::cerr << "Traversal visits " << outputSetIndex << " output sets instead of " << outputSets.size() << std::endl;
+    return false;
+  }
+
+  // Ranks in reverse order, so that each one is reached from a different set
+  for (vtkTypeUInt64 rank = numberOfOutputSets; rank-- > 0;)
+  {
+    if (!generator->GoToOutputSet(rank) || generator->GetCurrentOutputSetRank() != rank)
+    {
+      std::cerr << "Could not move to output set " << rank << std::endl;
+      return false;
+    }
+    if (!CompareOutputSet(outputSets[rank], generator->GetCurrentOutputSet(), outputSetSize))
+    {
+      std::cerr << "Output set at rank " << rank << " is different" << std::endl;
+      return false;
+    }
+  }
+  if (generator->GoToOutputSet(numberOfOutputSets))
+  {
+    std::cerr << "Moved to an output set after the last one" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+int vtkCombinatoricGeneratorTest(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
+{
+  // Example of the documentation of permutations
+  vtkNew<vtkCombinatoricGenerator> permutationGenerator;
+  permutationGenerator->SetCombinatoricToPermutation();
+  permutationGenerator->AddInputSet(std::vector<int>({ 1, 2, 3 }));
+  permutationGenerator->SetSubsetSize(2);
+  const int expectedPermutations[6][2] = { { 1, 2 }, { 1, 3 }, { 2, 1 }, { 2, 3 }, { 3, 2 }, { 3, 1 } };
+  int permutationIndex = 0;
+  for (bool hasSet = permutationGenerator->InitTraversal(); hasSet; hasSet = permutationGenerator->GoToNextOutputSet(), ++permutationIndex)
+  {
+    if (permutationIndex >= 6
+      || !CompareOutputSet(std::vector<int>(expectedPermutations[permutationIndex], expectedPermutations[permutationIndex] + 2),
+        permutationGenerator->GetCurrentOutputSet(), 2))
+    {
+      std::cerr << "Permutations are not in the documented order" << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+  if (permutationIndex != 6 || !TestTraversal(permutationGenerator))
+  {
+    return EXIT_FAILURE;
+  }
+
+  // Permutations of a whole set, and of a subset of a larger set
+  vtkNew<vtkCombinatoricGenerator> generator;
+  generator->SetCombinatoricToPermutation();
+  generator->AddInputSet(std::vector<int>({ 4, 8, 15, 16, 23 }));
+  generator->SetSubsetSize(5);
+  if (!TestTraversal(generator))
+  {
+    return EXIT_FAILURE;
+  }
+  generator->SetSubsetSize(3);
+  if (!TestTraversal(generator))
+  {
+    return EXIT_FAILURE;
+  }
+
+  // Combinations
+  generator->SetCombinatoricToCombination();
+  for (unsigned int subsetSize = 1; subsetSize <= 5; ++subsetSize)
+  {
+    generator->SetSubsetSize(subsetSize);
+    if (!TestTraversal(generator))
+    {
+      return EXIT_FAILURE;
+    }
+  }
+
+  // Cartesian product of sets of different sizes
+  vtkNew<vtkCombinatoricGenerator> cartesianProductGenerator;
+  cartesianProductGenerator->SetCombinatoricToCartesianProduct();
+  cartesianProductGenerator->AddInputSet(std::vector<int>({ 1, 2, 3 }));
+  cartesianProductGenerator->AddInputSet(std::vector<int>({ 1, 4 }));
+  cartesianProductGenerator->AddInputSet(std::vector<int>({ 7, 8, 9, 10 }));
+  if (!TestTraversal(cartesianProductGenerator))
+  {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,193 @@
+/*==============================================================================
+
+Copyright (c) Laboratory for Percutaneous Surgery (PerkLab)
+Queen's University, Kingston, ON, Canada. All Rights Reserved.
+
+See COPYRIGHT.txt
+or http://www.slicer.org/copyright/copyright.txt for details.
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+==============================================================================*/
+
+// FiducialRegistrationWizard includes
+#include <vtkLandmarkRegistrationMoments.h>
+
+// VTK includes
+#include <vtkLandmarkTransform.h>
+#include <vtkMath.h>
+#include <vtkMatrix4x4.h>
+#include <vtkMinimalStandardRandomSequence.h>
+#include <vtkNew.h>
+#include <vtkPoints.h>
+#include <vtkTransform.h>
+
+// STD includes
+#include <cmath>
+#include <iostream>
+
+int NUMBER_OF_POINT_PAIRS = 12;
+double epsilon = 1.0e-6;
+// The closed form error of exactly corresponding points is only accurate to about 1e-8 times the spread of the points
+double errorEpsilonMm = 1.0e-5;
+
+//----------------------------------------------------------------------------
+// Registration error computed the reference way: register with vtkLandmarkTransform and measure the distances
+double ComputeReferenceRootMeanSquareError(vtkPoints* sourcePoints, vtkPoints* targetPoints, int mode, vtkMatrix4x4* sourceToTargetMatrix)
+{
+  vtkNew<vtkLandmarkTransform> landmarkTransform;
+  landmarkTransform->SetSourceLandmarks(sourcePoints);
+  landmarkTransform->SetTargetLandmarks(targetPoints);
+  landmarkTransform->SetMode(mode);
+  landmarkTransform->Update();
+  sourceToTargetMatrix->DeepCopy(landmarkTransform->GetMatrix());
+
+  double sumOfSquaredErrors = 0.0;
+  for (int pointIndex = 0; pointIndex < sourcePoints->GetNumberOfPoints(); ++pointIndex)
+  {
+    double registeredSourcePoint[3];
+    landmarkTransform->TransformPoint(sourcePoints->GetPoint(pointIndex), registeredSourcePoint);
+    sumOfSquaredErrors += vtkMath::Distance2BetweenPoints(registeredSourcePoint, targetPoints->GetPoint(pointIndex));
+  }
+  return std::sqrt(sumOfSquaredErrors / sourcePoints->GetNumberOfPoints());
+}
+
+//----------------------------------------------------------------------------
+bool CompareWithLandmarkTransform(vtkLandmarkRegistrationMoments& moments, vtkPoints* sourcePoints, vtkPoints* targetPoints, int mode)
+{
+  vtkNew<vtkMatrix4x4> expectedSourceToTargetMatrix;
+  double expectedRootMeanSquareError = ComputeReferenceRootMeanSquareError(sourcePoints, targetPoints, mode, expectedSourceToTargetMatrix);
+  double actualRootMeanSquareError = moments.ComputeRootMeanSquareError(mode);
+  std::cout << "Mode " << mode << " expected error: " << expectedRootMeanSquareError << " actual error: " << actualRootMeanSquareError << std::endl;
+  if (std::fabs(expectedRootMeanSquareError - actualRootMeanSquareError) > errorEpsilonMm)
+  {
+    std::cerr << "Registration error is different from vtkLandmarkTransform" << std::endl;
+    return false;
+  }
+
+  vtkNew<vtkMatrix4x4> actualSourceToTargetMatrix;
+  if (!moments.ComputeSourceToTargetMatrix(mode, actualSourceToTargetMatrix))
+  {
+    std::cerr << "Could not compute registration matrix" << std::endl;
+    return false;
+  }
+  for (int row = 0; row < 4; ++row)
+  {
+    for (int column = 0; column < 4; ++column)
+    {
+      if (std::fabs(expectedSourceToTargetMatrix->GetElement(row, column) - actualSourceToTargetMatrix->GetElement(row, column)) > epsilon)
+      {
+        std::cerr << "Registration matrix element (" << row << ", " << column << ") is different from vtkLandmarkTransform: "
+          << actualSourceToTargetMatrix->GetElement(row, column) << " instead of " << expectedSourceToTargetMatrix->GetElement(row, column) << std::endl;
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool TestRegistration(double scale, double noiseMm)
+{
+  std::cout << "=================================================================" << std::endl;
+  std::cout << "Starting registration test..." << std::endl;
+  std::cout << "Scale: " << scale << " noise: " << noiseMm << " mm" << std::endl;
+
+  vtkNew<vtkTransform> sourceToTargetTransform;
+  sourceToTargetTransform->Translate(120.0, -35.5, 800.0);
+  sourceToTargetTransform->RotateWXYZ(37.0, 0.3, -1.0, 0.6);
+  sourceToTargetTransform->Scale(scale, scale, scale);
+
+  vtkNew<vtkMinimalStandardRandomSequence> randomSequence;
+  randomSequence->SetSeed(12345);
+
+  // Points far from the origin compared to their spread
+  vtkNew<vtkPoints> sourcePoints;
+  vtkNew<vtkPoints> targetPoints;
+  vtkLandmarkRegistrationMoments moments;
+  for (int pointIndex = 0; pointIndex < NUMBER_OF_POINT_PAIRS; ++pointIndex)
+  {
+    double sourcePoint[3] = { 0.0, 0.0, 0.0 };
+    for (int axis = 0; axis < 3; ++axis)
+    {
+      sourcePoint[axis] = 500.0 + 100.0 * randomSequence->GetNextValue();
+    }
+    double targetPoint[3] = { 0.0, 0.0, 0.0 };
+    sourceToTargetTransform->TransformPoint(sourcePoint, targetPoint);
+    for (int axis = 0; axis < 3; ++axis)
+    {
+      targetPoint[axis] += (2.0 * randomSequence->GetNextValue() - 1.0) * noiseMm;
+    }
+    sourcePoints->InsertNextPoint(sourcePoint);
+    targetPoints->InsertNextPoint(targetPoint);
+    moments.AddPointPair(sourcePoint, targetPoint);
+  }
+
+  if (moments.GetNumberOfPointPairs() != NUMBER_OF_POINT_PAIRS)
+  {
+    std::cerr << "Unexpected number of point pairs: " << moments.GetNumberOfPointPairs() << std::endl;
+    return false;
+  }
+
+  int mode = (scale == 1.0 ? VTK_LANDMARK_RIGIDBODY : VTK_LANDMARK_SIMILARITY);
+  if (!CompareWithLandmarkTransform(moments, sourcePoints, targetPoints, mode))
+  {
+    return false;
+  }
+  if (noiseMm == 0.0 && moments.ComputeRootMeanSquareError(mode) > errorEpsilonMm)
+  {
+    std::cerr << "Registration error of exactly corresponding points is too large: " << moments.ComputeRootMeanSquareError(mode) << std::endl;
+    return false;
+  }
+
+  // Removing a pair must give the same result as accumulating the remaining pairs from scratch
+  moments.RemovePointPair(sourcePoints->GetPoint(0), targetPoints->GetPoint(0));
+  moments.RemovePointPair(sourcePoints->GetPoint(5), targetPoints->GetPoint(5));
+  vtkNew<vtkPoints> remainingSourcePoints;
+  vtkNew<vtkPoints> remainingTargetPoints;
+  for (int pointIndex = 0; pointIndex < NUMBER_OF_POINT_PAIRS; ++pointIndex)
+  {
+    if (pointIndex != 0 && pointIndex != 5)
+    {
+      remainingSourcePoints->InsertNextPoint(sourcePoints->GetPoint(pointIndex));
+      remainingTargetPoints->InsertNextPoint(targetPoints->GetPoint(pointIndex));
+    }
+  }
+  if (!CompareWithLandmarkTransform(moments, remainingSourcePoints, remainingTargetPoints, mode))
+  {
+    std::cerr << "Registration after removing point pairs is incorrect" << std::endl;
+    return false;
+  }
+
+  moments.Reset();
+  if (moments.GetNumberOfPointPairs() != 0 || moments.ComputeRootMeanSquareError(mode) != 0.0)
+  {
+    std::cerr << "Moments were not reset" << std::endl;
+    return false;
+  }
+
+  std::cout << "Registration test completed successfully." << std::endl;
+  return true;
+}
+
+//----------------------------------------------------------------------------
+int vtkLandmarkRegistrationMomentsTest(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
+{
+  double scales[2] = { 1.0, 1.7 };
+  double noisesMm[3] = { 0.0, 0.5, 5.0 };
+  for (double scale : scales)
+  {
+    for (double noiseMm : noisesMm)
+    {
+      if (!TestRegistration(scale, noiseMm))
+      {
+        return EXIT_FAILURE;
+      }
+    }
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,179 @@
+/*==============================================================================
+
+Copyright (c) Laboratory for Percutaneous Surgery (PerkLab)
+Queen's University, Kingston, ON, Canada. All Rights Reserved.
+
+See COPYRIGHT.txt
+or http://www.slicer.org/copyright/copyright.txt for details.
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+==============================================================================*/
+
+// FiducialRegistrationWizard includes
+#include <vtkPointDistanceMatrix.h>
+
+// VTK includes
+#include <vtkMath.h>
+#include <vtkMinimalStandardRandomSequence.h>
+#include <vtkNew.h>
+#include <vtkPoints.h>
+
+// STD includes
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+int NUMBER_OF_RANGE_QUERIES = 200;
+
+//----------------------------------------------------------------------------
+void GenerateRandomPoints(vtkMinimalStandardRandomSequence* randomSequence, int numberOfPoints, vtkPoints* points)
+{
+  points->Reset();
+  for (int pointIndex = 0; pointIndex < numberOfPoints; ++pointIndex)
+  {
+    double point[3] = { 0.0, 0.0, 0.0 };
+    for (int axis = 0; axis < 3; ++axis)
+    {
+      point[axis] = 100.0 * randomSequence->GetNextValue();
+    }
+    points->InsertNextPoint(point);
+  }
+  points->Modified();
+}
+
+//----------------------------------------------------------------------------
+// Each sorted row must hold the distances of the row in ascending order
+bool CheckSortedRows(vtkPointDistanceMatrix* distanceMatrix, vtkPoints* points1, vtkPoints* points2)
+{
+  for (int list1Index = 0; list1Index < points1->GetNumberOfPoints(); ++list1Index)
+  {
+    std::vector<double> expectedDistances;
+    for (int list2Index = 0; list2Index < points2->GetNumberOfPoints(); ++list2Index)
+    {
+      double point1[3] = { 0.0, 0.0, 0.0 };
+      points1->GetPoint(list1Index, point1);
+      double point2[3] = { 0.0, 0.0, 0.0 };
+      points2->GetPoint(list2Index, point2);
+      double expectedDistance = std::sqrt(vtkMath::Distance2BetweenPoints(point1, point2));
+      if (std::fabs(distanceMatrix->GetDistancesFromList1Point(list1Index)[list2Index] - expectedDistance) > 1.0e-9)
+      {
+        std::cerr << "Distance (" << list1Index << ", " << list2Index << ") is " << distanceMatrix->GetDistancesFromList1Point(list1Index)[list2Index]
+          << " instead of " << expectedDistance << std::endl;
+        return false;
+      }
+      expectedDistances.push_back(distanceMatrix->GetDistancesFromList1Point(list1Index)[list2Index]);
+    }
+    std::sort(expectedDistances.begin(), expectedDistances.end());
+    const double* sortedDistances = distanceMatrix->GetSortedDistancesFromList1Point(list1Index);
+    for (int list2Index = 0; list2Index < points2->GetNumberOfPoints(); ++list2Index)
+    {
+      if (sortedDistances[list2Index] != expectedDistances[list2Index])
+      {
+        std::cerr << "Sorted distance " << list2Index << " of row " << list1Index << " is " << sortedDistances[list2Index]
+          << " instead of " << expectedDistances[list2Index] << std::endl;
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+// Range queries must give the same answer as checking all pairs of points.
+// If both lists are the same, the distance of a point to itself is not a pair.
+bool CheckRangeQueries(vtkPointDistanceMatrix* distanceMatrix, vtkPoints* points1, vtkPoints* points2, vtkMinimalStandardRandomSequence* randomSequence)
+{
+  bool sameLists = (points1 == points2);
+  for (int queryIndex = 0; queryIndex < NUMBER_OF_RANGE_QUERIES; ++queryIndex)
+  {
+    double minimumDistance = 150.0 * randomSequence->GetNextValue();
+    double maximumDistance = minimumDistance + 2.0 * randomSequence->GetNextValue();
+    if (queryIndex % 10 == 0)
+    {
+      // Ranges that start or end exactly at a distance of the matrix
+      int list1Index = queryIndex % points1->GetNumberOfPoints();
+      int list2Index = (list1Index + 1) % points2->GetNumberOfPoints();
+      minimumDistance = distanceMatrix->GetDistance(list1Index, list2Index);
+      maximumDistance = (queryIndex % 20 == 0 ? minimumDistance : minimumDistance + 1.0);
+      if (queryIndex % 20 != 0)
+      {
+        std::swap(minimumDistance, maximumDistance);
+        minimumDistance -= 2.0;
+      }
+    }
+
+    bool expectedInRange = false;
+    for (int list1Index = 0; list1Index < points1->GetNumberOfPoints(); ++list1Index)
+    {
+      for (int list2Index = 0; list2Index < points2->GetNumberOfPoints(); ++list2Index)
+      {
+        if (sameLists && list1Index == list2Index)
+        {
+          continue;
+        }
+        double distance = distanceMatrix->GetDistance(list1Index, list2Index);
+        expectedInRange = expectedInRange || (distance >= minimumDistance && distance <= maximumDistance);
+      }
+    }
+    if (distanceMatrix->IsAnyDistanceInRange(minimumDistance, maximumDistance) != expectedInRange)
+    {
+      std::cerr << "Distance in range " << minimumDistance << " .. " << maximumDistance << " is "
+        << (expectedInRange ? "not found" : "found") << std::endl;
+      return false;
+    }
+  }
+  if (sameLists && distanceMatrix->IsAnyDistanceInRange(0.0, 0.0))
+  {
+    std::cerr << "Distance of a point to itself is found in range" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+int vtkPointDistanceMatrixTest(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
+{
+  vtkNew<vtkMinimalStandardRandomSequence> randomSequence;
+  randomSequence->SetSeed(42);
+
+  vtkNew<vtkPoints> points1;
+  GenerateRandomPoints(randomSequence, 7, points1);
+  vtkNew<vtkPoints> points2;
+  GenerateRandomPoints(randomSequence, 9, points2);
+
+  // Two different lists
+  vtkNew<vtkPointDistanceMatrix> distanceMatrix;
+  distanceMatrix->SetPointList1(points1);
+  distanceMatrix->SetPointList2(points2);
+  distanceMatrix->Update();
+  if (!CheckSortedRows(distanceMatrix, points1, points2) || !CheckRangeQueries(distanceMatrix, points1, points2, randomSequence))
+  {
+    return EXIT_FAILURE;
+  }
+
+  // Distances within one list
+  vtkNew<vtkPointDistanceMatrix> symmetricDistanceMatrix;
+  symmetricDistanceMatrix->SetPointList1(points2);
+  symmetricDistanceMatrix->SetPointList2(points2);
+  symmetricDistanceMatrix->Update();
+  if (!CheckSortedRows(symmetricDistanceMatrix, points2, points2) || !CheckRangeQueries(symmetricDistanceMatrix, points2, points2, randomSequence))
+  {
+    return EXIT_FAILURE;
+  }
+
+  // Sorted distances must be updated when the points change
+  GenerateRandomPoints(randomSequence, 9, points2);
+  if (!CheckSortedRows(symmetricDistanceMatrix, points2, points2) || !CheckRangeQueries(symmetricDistanceMatrix, points2, points2, randomSequence))
+  {
+    std::cerr << "Distances were not updated after the points changed" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
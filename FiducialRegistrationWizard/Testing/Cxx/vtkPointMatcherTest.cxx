@@ -0,0 +1,498 @@
+/*==============================================================================
+
+Copyright (c) Laboratory for Percutaneous Surgery (PerkLab)
+Queen's University, Kingston, ON, Canada. All Rights Reserved.
+
+See COPYRIGHT.txt
+or http://www.slicer.org/copyright/copyright.txt for details.
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+==============================================================================*/
+
+// FiducialRegistrationWizard includes
+#include <vtkLandmarkRegistrationMoments.h>
+#include <vtkPointMatcher.h>
+
+// VTK includes
+#include <vtkMath.h>
+#include <vtkMinimalStandardRandomSequence.h>
+#include <vtkNew.h>
+#include <vtkPoints.h>
+#include <vtkTransform.h>
+
+// STD includes
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+int NUMBER_OF_THREADS = 4;
+double POINT_SPREAD_MM = 200.0;
+double TOLERABLE_DISTANCE_ERROR_MULTIPLE = 0.05;
+double AMBIGUITY_DISTANCE_ERROR_MULTIPLE = 0.025;
+// Outliers closer than this to a transformed source point could be matched correctly
+double MINIMUM_OUTLIER_DISTANCE_MM = 40.0;
+
+//----------------------------------------------------------------------------
+// Random source points, and target points that are the transformed source points with noise, in shuffled order.
+// The first numberOfSourceOutliers source points have no target point, and numberOfTargetOutliers random target points
+// have no source point. Target outliers are not close to any transformed source point.
+void GeneratePointSets(int numberOfPoints, int numberOfSourceOutliers, int numberOfTargetOutliers, double noiseMm, int seed,
+  vtkTransform* sourceToTargetTransform, vtkPoints* sourcePoints, vtkPoints* targetPoints)
+{
+  vtkNew<vtkMinimalStandardRandomSequence> randomSequence;
+  randomSequence->SetSeed(seed);
+
+  sourceToTargetTransform->Identity();
+  sourceToTargetTransform->Translate(10.0, -20.0, 35.0);
+  sourceToTargetTransform->RotateWXYZ(70.0, 0.3, -0.5, 0.8);
+
+  sourcePoints->Reset();
+  std::vector<std::vector<double>> unorderedTargetPoints;
+  for (int pointIndex = 0; pointIndex < numberOfPoints; ++pointIndex)
+  {
+    double sourcePoint[3] = { 0.0, 0.0, 0.0 };
+    for (int axis = 0; axis < 3; ++axis)
+    {
+      sourcePoint[axis] = POINT_SPREAD_MM * (randomSequence->GetNextValue() - 0.5);
+    }
+    sourcePoints->InsertNextPoint(sourcePoint);
+    if (pointIndex < numberOfSourceOutliers)
+    {
+      continue;
+    }
+    double targetPoint[3] = { 0.0, 0.0, 0.0 };
+    sourceToTargetTransform->TransformPoint(sourcePoint, targetPoint);
+    for (int axis = 0; axis < 3; ++axis)
+    {
+      targetPoint[axis] += (2.0 * randomSequence->GetNextValue() - 1.0) * noiseMm;
+    }
+    unorderedTargetPoints.push_back(std::vector<double>(targetPoint, targetPoint + 3));
+  }
+  for (int outlierIndex = 0; outlierIndex < numberOfTargetOutliers; ++outlierIndex)
+  {
+    std::vector<double> targetPoint(3);
+    bool closeToSourcePoint = true;
+    while (closeToSourcePoint)
+    {
+      for (int axis = 0; axis < 3; ++axis)
+      {
+        targetPoint[axis] = POINT_SPREAD_MM * (randomSequence->GetNextValue() - 0.5);
+      }
+      closeToSourcePoint = false;
+      for (vtkIdType pointIndex = 0; pointIndex < sourcePoints->GetNumberOfPoints(); ++pointIndex)
+      {
+        double transformedSourcePoint[3] = { 0.0, 0.0, 0.0 };
+        sourceToTargetTransform->TransformPoint(sourcePoints->GetPoint(pointIndex), transformedSourcePoint);
+        if (vtkMath::Distance2BetweenPoints(transformedSourcePoint, targetPoint.data()) < MINIMUM_OUTLIER_DISTANCE_MM * MINIMUM_OUTLIER_DISTANCE_MM)
+        {
+          closeToSourcePoint = true;
+          break;
+        }
+      }
+    }
+    unorderedTargetPoints.push_back(targetPoint);
+  }
+
+  // Fisher-Yates shuffle
+  for (int pointIndex = static_cast<int>(unorderedTargetPoints.size()) - 1; pointIndex > 0; --pointIndex)
+  {
+    int otherPointIndex = static_cast<int>(randomSequence->GetNextValue() * (pointIndex + 1)) % (pointIndex + 1);
+    std::swap(unorderedTargetPoints[pointIndex], unorderedTargetPoints[otherPointIndex]);
+  }
+  targetPoints->Reset();
+  for (const std::vector<double>& targetPoint : unorderedTargetPoints)
+  {
+    targetPoints->InsertNextPoint(targetPoint.data());
+  }
+}
+
+//----------------------------------------------------------------------------
+void ConfigurePointMatcher(vtkPointMatcher* pointMatcher, vtkPoints* sourcePoints, vtkPoints* targetPoints,
+  unsigned int maximumDifferenceInNumberOfPoints, int generalMatchingMethod, int numberOfThreads)
+{
+  pointMatcher->SetInputSourcePoints(sourcePoints);
+  pointMatcher->SetInputTargetPoints(targetPoints);
+  pointMatcher->SetMaximumDifferenceInNumberOfPoints(maximumDifferenceInNumberOfPoints);
+  pointMatcher->SetTolerableDistanceErrorMultiple(TOLERABLE_DISTANCE_ERROR_MULTIPLE);
+  pointMatcher->SetAmbiguityDistanceErrorMultiple(AMBIGUITY_DISTANCE_ERROR_MULTIPLE);
+  pointMatcher->SetGeneralMatchingMethod(generalMatchingMethod);
+  pointMatcher->SetNumberOfThreads(numberOfThreads);
+  pointMatcher->Update();
+}
+
+//----------------------------------------------------------------------------
+// The matched point pairs, the distance error and the ambiguity flag must be exactly the same
+bool CompareMatchings(vtkPointMatcher* expectedPointMatcher, vtkPointMatcher* actualPointMatcher)
+{
+  vtkPoints* expectedSourcePoints = expectedPointMatcher->GetOutputSourcePoints();
+  vtkPoints* expectedTargetPoints = expectedPointMatcher->GetOutputTargetPoints();
+  vtkPoints* actualSourcePoints = actualPointMatcher->GetOutputSourcePoints();
+  vtkPoints* actualTargetPoints = actualPointMatcher->GetOutputTargetPoints();
+  if (expectedSourcePoints->GetNumberOfPoints() != actualSourcePoints->GetNumberOfPoints()
+    || expectedTargetPoints->GetNumberOfPoints() != actualTargetPoints->GetNumberOfPoints())
+  {
+    std::cerr << "Number of matched points is different: " << actualSourcePoints->GetNumberOfPoints()
+      << " instead of " << expectedSourcePoints->GetNumberOfPoints() << std::endl;
+    return false;
+  }
+  for (vtkIdType pointIndex = 0; pointIndex < expectedSourcePoints->GetNumberOfPoints(); ++pointIndex)
+  {
+    for (int axis = 0; axis < 3; ++axis)
+    {
+      if (expectedSourcePoints->GetPoint(pointIndex)[axis] != actualSourcePoints->GetPoint(pointIndex)[axis]
+        || expectedTargetPoints->GetPoint(pointIndex)[axis] != actualTargetPoints->GetPoint(pointIndex)[axis])
+      {
+        std::cerr << "Matched point pair " << pointIndex << " is different" << std::endl;
+        return false;
+      }
+    }
+  }
+  if (expectedPointMatcher->GetComputedDistanceError() != actualPointMatcher->GetComputedDistanceError())
+  {
+    std::cerr << "Distance error is different: " << actualPointMatcher->GetComputedDistanceError()
+      << " instead of " << expectedPointMatcher->GetComputedDistanceError() << std::endl;
+    return false;
+  }
+  if (expectedPointMatcher->IsMatchingAmbiguous() != actualPointMatcher->IsMatchingAmbiguous())
+  {
+    std::cerr << "Ambiguity flag is different: " << actualPointMatcher->IsMatchingAmbiguous() << std::endl;
+    return false;
+  }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+// All matched point pairs must be corresponding points
+bool CheckMatchedPointPairs(vtkPointMatcher* pointMatcher, vtkTransform* sourceToTargetTransform, int expectedNumberOfPointPairs, double noiseMm)
+{
+  vtkPoints* matchedSourcePoints = pointMatcher->GetOutputSourcePoints();
+  vtkPoints* matchedTargetPoints = pointMatcher->GetOutputTargetPoints();
+  if (matchedSourcePoints->GetNumberOfPoints() != expectedNumberOfPointPairs || matchedTargetPoints->GetNumberOfPoints() != expectedNumberOfPointPairs)
+  {
+    std::cerr << "Unexpected number of matched point pairs: " << matchedSourcePoints->GetNumberOfPoints()
+      << " instead of " << expectedNumberOfPointPairs << std::endl;
+    return false;
+  }
+  // Noise is at most noiseMm along each axis
+  double maximumDistanceMm = std::sqrt(3.0) * noiseMm + 1.0e-6;
+  for (vtkIdType pointIndex = 0; pointIndex < matchedSourcePoints->GetNumberOfPoints(); ++pointIndex)
+  {
+    double transformedSourcePoint[3] = { 0.0, 0.0, 0.0 };
+    sourceToTargetTransform->TransformPoint(matchedSourcePoints->GetPoint(pointIndex), transformedSourcePoint);
+    double distanceMm = std::sqrt(vtkMath::Distance2BetweenPoints(transformedSourcePoint, matchedTargetPoints->GetPoint(pointIndex)));
+    if (distanceMm > maximumDistanceMm)
+    {
+      std::cerr << "Matched point pair " << pointIndex << " is not a corresponding pair, distance: " << distanceMm << " mm" << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+// Branch and bound must find the corresponding points of shuffled, noisy point sets with outliers
+bool TestBranchAndBound(int numberOfPoints, int numberOfSourceOutliers, int numberOfTargetOutliers, double noiseMm, int seed)
+{
+  std::cout << "Branch and bound with " << numberOfPoints << " points, " << numberOfSourceOutliers << " source outliers, "
+    << numberOfTargetOutliers << " target outliers, noise " << noiseMm << " mm" << std::endl;
+
+  vtkNew<vtkTransform> sourceToTargetTransform;
+  vtkNew<vtkPoints> sourcePoints;
+  vtkNew<vtkPoints> targetPoints;
+  GeneratePointSets(numberOfPoints, numberOfSourceOutliers, numberOfTargetOutliers, noiseMm, seed, sourceToTargetTransform, sourcePoints, targetPoints);
+
+  vtkNew<vtkPointMatcher> pointMatcher;
+  ConfigurePointMatcher(pointMatcher, sourcePoints, targetPoints, 2, vtkPointMatcher::GeneralMatchingBranchAndBound, 1);
+  if (!pointMatcher->IsMatchingWithinTolerance())
+  {
+    std::cerr << "Branch and bound did not find a matching within tolerance, distance error: " << pointMatcher->GetComputedDistanceError() << std::endl;
+    return false;
+  }
+  // Random points can be close to each other, so the matching may be reported as ambiguous, but it must be correct
+  return CheckMatchedPointPairs(pointMatcher, sourceToTargetTransform, numberOfPoints - numberOfSourceOutliers, noiseMm);
+}
+
+//----------------------------------------------------------------------------
+// Points in a plane that are mirror-symmetric to a line in the plane. The mirroring is the same as a rotation
+// by 180 degrees around the line, so both correspondences can be registered and the matching is ambiguous.
+bool TestBranchAndBoundSymmetricPoints()
+{
+  std::cout << "Branch and bound with mirror-symmetric points" << std::endl;
+
+  const int numberOfPointPairs = 6;
+  vtkNew<vtkMinimalStandardRandomSequence> randomSequence;
+  randomSequence->SetSeed(7);
+  vtkNew<vtkPoints> sourcePoints;
+  for (int pointPairIndex = 0; pointPairIndex < numberOfPointPairs; ++pointPairIndex)
+  {
+    double x = 20.0 + 80.0 * randomSequence->GetNextValue();
+    double y = POINT_SPREAD_MM * (randomSequence->GetNextValue() - 0.5);
+    sourcePoints->InsertNextPoint(x, y, 0.0);
+    sourcePoints->InsertNextPoint(-x, y, 0.0);
+  }
+
+  vtkNew<vtkTransform> sourceToTargetTransform;
+  sourceToTargetTransform->Translate(10.0, -20.0, 35.0);
+  sourceToTargetTransform->RotateWXYZ(70.0, 0.3, -0.5, 0.8);
+  vtkNew<vtkPoints> targetPoints;
+  for (vtkIdType pointIndex = sourcePoints->GetNumberOfPoints() - 1; pointIndex >= 0; --pointIndex)
+  {
+    double targetPoint[3] = { 0.0, 0.0, 0.0 };
+    sourceToTargetTransform->TransformPoint(sourcePoints->GetPoint(pointIndex), targetPoint);
+    targetPoints->InsertNextPoint(targetPoint);
+  }
+
+  vtkNew<vtkPointMatcher> pointMatcher;
+  ConfigurePointMatcher(pointMatcher, sourcePoints, targetPoints, 0, vtkPointMatcher::GeneralMatchingBranchAndBound, 1);
+  if (!pointMatcher->IsMatchingWithinTolerance())
+  {
+    std::cerr << "Branch and bound did not find a matching of symmetric points within tolerance" << std::endl;
+    return false;
+  }
+  if (!pointMatcher->IsMatchingAmbiguous())
+  {
+    std::cerr << "Matching of mirror-symmetric points is not reported as ambiguous" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+// The ambiguity flag of branch and bound must be the same as comparing the registration errors of all correspondences.
+// The ambiguity distance is larger than the tolerable distance error, so the second best correspondence can violate the
+// pairwise distance tolerance and still be within the ambiguity distance.
+bool TestBranchAndBoundAmbiguity(double ambiguityDistanceErrorMultiple, int seed)
+{
+  std::cout << "Branch and bound ambiguity with ambiguity distance error multiple " << ambiguityDistanceErrorMultiple << std::endl;
+
+  const int numberOfPoints = 6;
+  vtkNew<vtkTransform> sourceToTargetTransform;
+  vtkNew<vtkPoints> sourcePoints;
+  vtkNew<vtkPoints> targetPoints;
+  GeneratePointSets(numberOfPoints, 0, 0, 2.0, seed, sourceToTargetTransform, sourcePoints, targetPoints);
+
+  vtkNew<vtkPointMatcher> pointMatcher;
+  ConfigurePointMatcher(pointMatcher, sourcePoints, targetPoints, 0, vtkPointMatcher::GeneralMatchingBranchAndBound, 1);
+  pointMatcher->SetAmbiguityDistanceErrorMultiple(ambiguityDistanceErrorMultiple);
+  pointMatcher->Update();
+  if (!pointMatcher->IsMatchingWithinTolerance())
+  {
+    std::cerr << "Branch and bound did not find a matching within tolerance, distance error: " << pointMatcher->GetComputedDistanceError() << std::endl;
+    return false;
+  }
+
+  std::vector<int> targetPointIndices(numberOfPoints);
+  for (int pointIndex = 0; pointIndex < numberOfPoints; ++pointIndex)
+  {
+    targetPointIndices[pointIndex] = pointIndex;
+  }
+  double bestDistanceError = VTK_DOUBLE_MAX;
+  double secondBestDistanceError = VTK_DOUBLE_MAX;
+  do
+  {
+    vtkLandmarkRegistrationMoments moments;
+    for (int pointIndex = 0; pointIndex < numberOfPoints; ++pointIndex)
+    {
+      moments.AddPointPair(sourcePoints->GetPoint(pointIndex), targetPoints->GetPoint(targetPointIndices[pointIndex]));
+    }
+    double distanceError = moments.ComputeRootMeanSquareError();
+    secondBestDistanceError = std::min(secondBestDistanceError, std::max(bestDistanceError, distanceError));
+    bestDistanceError = std::min(bestDistanceError, distanceError);
+  } while (std::next_permutation(targetPointIndices.begin(), targetPointIndices.end()));
+
+  bool expectedAmbiguous = (secondBestDistanceError - bestDistanceError < pointMatcher->GetAmbiguityDistanceError());
+  if (pointMatcher->IsMatchingAmbiguous() != expectedAmbiguous)
+  {
+    std::cerr << "Ambiguity flag is " << pointMatcher->IsMatchingAmbiguous() << ", best distance error: " << bestDistanceError
+      << ", second best distance error: " << secondBestDistanceError << ", ambiguity distance: " << pointMatcher->GetAmbiguityDistanceError() << std::endl;
+    return false;
+  }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+// Point sets that do not correspond must be rejected, the search is stopped when its budget is used up
+bool TestBranchAndBoundUnrelatedPoints(int numberOfPoints, int seed)
+{
+  std::cout << "Branch and bound with " << numberOfPoints << " unrelated points" << std::endl;
+
+  vtkNew<vtkTransform> sourceToTargetTransform;
+  vtkNew<vtkPoints> sourcePoints;
+  vtkNew<vtkPoints> unusedTargetPoints;
+  GeneratePointSets(numberOfPoints, 0, 0, 0.0, seed, sourceToTargetTransform, sourcePoints, unusedTargetPoints);
+  vtkNew<vtkPoints> targetPoints;
+  GeneratePointSets(numberOfPoints, 0, 0, 0.0, seed + 1000, sourceToTargetTransform, targetPoints, unusedTargetPoints);
+
+  vtkNew<vtkPointMatcher> pointMatcher;
+  ConfigurePointMatcher(pointMatcher, sourcePoints, targetPoints, 2, vtkPointMatcher::GeneralMatchingBranchAndBound, 1);
+  if (pointMatcher->IsMatchingWithinTolerance())
+  {
+    std::cerr << "Unrelated points were matched, distance error: " << pointMatcher->GetComputedDistanceError() << std::endl;
+    return false;
+  }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+// ICP runs are distributed over the threads, the result must not depend on the number of threads
+bool TestICPThreads(int numberOfPoints, int numberOfOutliers, double noiseMm, int seed)
+{
+  std::cout << "ICP with " << numberOfPoints << " points, " << numberOfOutliers << " outliers, noise " << noiseMm << " mm" << std::endl;
+
+  vtkNew<vtkTransform> sourceToTargetTransform;
+  vtkNew<vtkPoints> sourcePoints;
+  vtkNew<vtkPoints> targetPoints;
+  GeneratePointSets(numberOfPoints, numberOfOutliers, numberOfOutliers, noiseMm, seed, sourceToTargetTransform, sourcePoints, targetPoints);
+
+  vtkNew<vtkPointMatcher> singleThreadPointMatcher;
+  ConfigurePointMatcher(singleThreadPointMatcher, sourcePoints, targetPoints, 2 * numberOfOutliers,
+    vtkPointMatcher::GeneralMatchingICP, 1);
+  if (!singleThreadPointMatcher->IsMatchingWithinTolerance())
+  {
+    std::cerr << "ICP did not find a matching within tolerance" << std::endl;
+    return false;
+  }
+  vtkNew<vtkPointMatcher> multiThreadPointMatcher;
+  ConfigurePointMatcher(multiThreadPointMatcher, sourcePoints, targetPoints, 2 * numberOfOutliers,
+    vtkPointMatcher::GeneralMatchingICP, NUMBER_OF_THREADS);
+  if (!CompareMatchings(singleThreadPointMatcher, multiThreadPointMatcher))
+  {
+    std::cerr << "ICP matching with " << NUMBER_OF_THREADS << " threads is different from matching with one thread" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+// The matching of the same inputs with one thread and with several threads must be exactly the same
+bool CompareSingleAndMultiThreadMatchings(vtkPoints* sourcePoints, vtkPoints* targetPoints,
+  unsigned int maximumDifferenceInNumberOfPoints, int generalMatchingMethod)
+{
+  vtkNew<vtkPointMatcher> singleThreadPointMatcher;
+  ConfigurePointMatcher(singleThreadPointMatcher, sourcePoints, targetPoints, maximumDifferenceInNumberOfPoints, generalMatchingMethod, 1);
+  vtkNew<vtkPointMatcher> multiThreadPointMatcher;
+  ConfigurePointMatcher(multiThreadPointMatcher, sourcePoints, targetPoints, maximumDifferenceInNumberOfPoints, generalMatchingMethod, NUMBER_OF_THREADS);
+  if (!CompareMatchings(singleThreadPointMatcher, multiThreadPointMatcher))
+  {
+    std::cerr << "Matching with " << NUMBER_OF_THREADS << " threads is different from matching with one thread" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+// Small point sets are matched exhaustively with the subset pairs distributed over the threads
+bool TestExhaustiveMatchingThreads(int numberOfPoints, int numberOfOutliers, int seed)
+{
+  std::cout << "Exhaustive matching with " << numberOfPoints << " points, " << numberOfOutliers << " outliers" << std::endl;
+
+  vtkNew<vtkTransform> sourceToTargetTransform;
+  vtkNew<vtkPoints> sourcePoints;
+  vtkNew<vtkPoints> targetPoints;
+  GeneratePointSets(numberOfPoints, numberOfOutliers, numberOfOutliers, 1.0, seed, sourceToTargetTransform, sourcePoints, targetPoints);
+  return CompareSingleAndMultiThreadMatchings(sourcePoints, targetPoints, 2 * numberOfOutliers, vtkPointMatcher::GeneralMatchingAllMethods);
+}
+
+//----------------------------------------------------------------------------
+// A rectangle and a point above its center can be matched in two ways with exactly the same error (the second one
+// is rotated by 180 degrees around the axis of the pyramid). The tie must be broken the same way by any number of
+// threads, and the matching must be reported as ambiguous.
+bool TestTiedMatchingThreads(bool withOutlier)
+{
+  std::cout << "Matching of tied correspondences" << (withOutlier ? " with an outlier" : "") << std::endl;
+
+  vtkNew<vtkPoints> sourcePoints;
+  sourcePoints->InsertNextPoint(-60.0, -30.0, 0.0);
+  sourcePoints->InsertNextPoint(60.0, -30.0, 0.0);
+  sourcePoints->InsertNextPoint(60.0, 30.0, 0.0);
+  sourcePoints->InsertNextPoint(-60.0, 30.0, 0.0);
+  sourcePoints->InsertNextPoint(0.0, 0.0, 50.0);
+
+  vtkNew<vtkTransform> sourceToTargetTransform;
+  sourceToTargetTransform->Translate(-15.0, 40.0, 5.0);
+  sourceToTargetTransform->RotateWXYZ(35.0, 0.6, 0.2, -0.4);
+  vtkNew<vtkPoints> targetPoints;
+  const int shuffledPointIndices[5] = { 2, 4, 0, 3, 1 };
+  for (int pointIndex : shuffledPointIndices)
+  {
+    double targetPoint[3] = { 0.0, 0.0, 0.0 };
+    sourceToTargetTransform->TransformPoint(sourcePoints->GetPoint(pointIndex), targetPoint);
+    targetPoints->InsertNextPoint(targetPoint);
+  }
+  if (withOutlier)
+  {
+    targetPoints->InsertNextPoint(150.0, -120.0, 90.0);
+  }
+
+  vtkNew<vtkPointMatcher> pointMatcher;
+  ConfigurePointMatcher(pointMatcher, sourcePoints, targetPoints, withOutlier ? 1 : 0, vtkPointMatcher::GeneralMatchingAllMethods, 1);
+  if (!pointMatcher->IsMatchingWithinTolerance())
+  {
+    std::cerr << "Tied correspondences were not matched within tolerance" << std::endl;
+    return false;
+  }
+  if (!pointMatcher->IsMatchingAmbiguous())
+  {
+    std::cerr << "Matching of tied correspondences is not reported as ambiguous" << std::endl;
+    return false;
+  }
+  return CompareSingleAndMultiThreadMatchings(sourcePoints, targetPoints, withOutlier ? 1 : 0, vtkPointMatcher::GeneralMatchingAllMethods);
+}
+
+//----------------------------------------------------------------------------
+int vtkPointMatcherTest(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
+{
+  const int numbersOfPoints[3] = { 6, 30, 120 };
+  for (int numberOfPoints : numbersOfPoints)
+  {
+    for (int numberOfOutliers = 0; numberOfOutliers <= 2; ++numberOfOutliers)
+    {
+      if (!TestBranchAndBound(numberOfPoints, numberOfOutliers, numberOfOutliers, 1.0, numberOfPoints + numberOfOutliers))
+      {
+        return EXIT_FAILURE;
+      }
+    }
+  }
+  if (!TestBranchAndBound(30, 2, 1, 1.0, 3) || !TestBranchAndBound(30, 1, 2, 1.0, 4))
+  {
+    return EXIT_FAILURE;
+  }
+  if (!TestBranchAndBoundSymmetricPoints())
+  {
+    return EXIT_FAILURE;
+  }
+  for (int seed = 1; seed <= 20; ++seed)
+  {
+    if (!TestBranchAndBoundAmbiguity(2.0 * TOLERABLE_DISTANCE_ERROR_MULTIPLE, seed))
+    {
+      return EXIT_FAILURE;
+    }
+  }
+  if (!TestBranchAndBoundUnrelatedPoints(8, 1) || !TestBranchAndBoundUnrelatedPoints(100, 2))
+  {
+    return EXIT_FAILURE;
+  }
+
+  for (int seed = 1; seed <= 5; ++seed)
+  {
+    if (!TestICPThreads(30, 1, 1.0, seed) || !TestICPThreads(100, 2, 1.0, seed))
+    {
+      return EXIT_FAILURE;
+    }
+    if (!TestExhaustiveMatchingThreads(5, 0, seed) || !TestExhaustiveMatchingThreads(5, 1, seed))
+    {
+      return EXIT_FAILURE;
+    }
+  }
+  if (!TestTiedMatchingThreads(false) || !TestTiedMatchingThreads(true))
+  {
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -30,6 +30,19 @@
 #include <vtkIntArray.h>
 #include <vtkMatrix4x4.h>
 #include <vtkNew.h>
+#include <vtkPoints.h>
+#include <vtkWeakPointer.h>
+
+// STD includes
+#include <array>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
 
 // Landmark Detection MRML includes
 #include <vtkMRMLLandmarkDetectionNode.h>
@@ -40,7 +53,53 @@
 //----------------------------------------------------------------------------
 vtkStandardNewMacro(vtkSlicerLandmarkDetectionLogic);
 
-typedef std::map<vtkSmartPointer<vtkMRMLLandmarkDetectionNode>, vtkSmartPointer<vtkIGSIOLandmarkDetectionAlgo>> LandmarkDetectionAlgoMap;
+//----------------------------------------------------------------------------
+/// Copy of a control point that has been pushed to the landmark detection algorithm.
+struct ControlPointInfo
+{
+  /// Index of the point in the detected landmark points of the algorithm.
+  vtkIdType AlgoPointId{ -1 };
+  double Position[3]{ 0.0, 0.0, 0.0 };
+  /// Synchronization version that the control point was last seen in.
+  unsigned long Version{ 0 };
+};
+
+//----------------------------------------------------------------------------
+struct LandmarkDetectionInfo
+{
+  /// Guards the algorithm, the control point mirror and the pending landmarks.
+  /// Only needs to be held while the worker thread may access the algorithm, but it is cheap to lock uncontended.
+  std::mutex Mutex;
+
+  vtkSmartPointer<vtkIGSIOLandmarkDetectionAlgo> Algo;
+
+  /// Markups node that the control point mirror was built from.
+  vtkWeakPointer<vtkMRMLMarkupsFiducialNode> SynchronizedMarkupsNode;
+  /// Mirror of the defined control points, keyed by control point ID.
+  std::map<std::string, ControlPointInfo> ControlPoints;
+  /// Control point ID of each point in the detected landmark points of the algorithm.
+  std::vector<std::string> AlgoPointControlPointIds;
+  /// Incremented every time the whole mirror is synchronized. Entries with an older version have been removed from the markups.
+  unsigned long Version{ 0 };
+  /// If true, then the whole mirror needs to be compared with the markups node before the next transform is processed.
+  bool SynchronizationRequired{ true };
+
+  /// Incremented when the detection is reset or stopped. Transforms that were taken from the queue before that
+  /// are discarded by the worker thread. Only modified while both vtkInternal::QueueMutex and Mutex are locked.
+  unsigned long Generation{ 0 };
+  /// Copy of the LandmarkDetectionInProgress flag of the node, for the worker thread.
+  bool DetectionInProgress{ false };
+
+  /// Landmarks detected on the worker thread that are not yet added to the markups node.
+  /// They are kept at the end of the detected landmark points of the algorithm, after the mirrored control points,
+  /// so that the worker rejects new landmarks that are too close to them.
+  std::vector<std::array<double, 3>> PendingLandmarks;
+
+  /// StylusTipToReference matrices waiting to be processed by the worker thread. Guarded by vtkInternal::QueueMutex.
+  std::deque<std::array<double, 16>> QueuedTransforms;
+};
+
+typedef std::map<vtkSmartPointer<vtkMRMLLandmarkDetectionNode>, std::shared_ptr<LandmarkDetectionInfo>> LandmarkDetectionInfoMap;
 
 //----------------------------------------------------------------------------
 class vtkSlicerLandmarkDetectionLogic::vtkInternal
@@ -50,9 +109,35 @@ public:
   ~vtkInternal();
 
   vtkSlicerLandmarkDetectionLogic* External;
-  vtkIGSIOLandmarkDetectionAlgo* GetLandmarkDetectionAlgoFromNode(vtkMRMLLandmarkDetectionNode* landmarkDetectionNode);
-
-  LandmarkDetectionAlgoMap LandmarkDetectionMap;
+  LandmarkDetectionInfo* GetLandmarkDetectionInfoFromNode(vtkMRMLLandmarkDetectionNode* landmarkDetectionNode);
+
+  /// Compare all control points of the markups node with the mirror, and push the differences to the algorithm.
+  void SynchronizeControlPoints(LandmarkDetectionInfo& info, vtkMRMLMarkupsFiducialNode* markupsNode);
+  /// Compare a single control point of the markups node with the mirror, and push the difference to the algorithm.
+  void SynchronizeControlPoint(LandmarkDetectionInfo& info, vtkMRMLMarkupsFiducialNode* markupsNode, int controlPointIndex);
+  /// Remove all points from the mirror and from the algorithm.
+  void ClearControlPoints(LandmarkDetectionInfo& info);
+  /// Remove the pending landmarks from the algorithm and return them.
+  std::vector<std::array<double, 3>> TakePendingLandmarks(LandmarkDetectionInfo& info);
+
+  void StartWorkerThread();
+  void StopWorkerThread();
+  void WorkerThreadMain();
+
+  LandmarkDetectionInfoMap LandmarkDetectionMap;
+
+  /// Guards the structure of LandmarkDetectionMap and the transform queues while the worker thread is running.
+  std::mutex QueueMutex;
+  std::condition_variable QueueCondition;
+  bool TransformsQueued{ false };
+  bool WorkerThreadStopRequested{ false };
+  std::thread WorkerThread;
+
+protected:
+  void UpdateControlPoint(LandmarkDetectionInfo& info, const std::string& controlPointId, const double position[3]);
+  void RemoveControlPoint(LandmarkDetectionInfo& info, std::map<std::string, ControlPointInfo>::iterator controlPointIt);
+  /// Resize the detected landmark points of the algorithm to the specified number of mirrored points, followed by the pending landmarks.
+  void SetNumberOfMirroredPoints(LandmarkDetectionInfo& info, vtkIdType numberOfMirroredPoints);
 };
 
 //----------------------------------------------------------------------------
@@ -67,17 +152,264 @@ vtkSlicerLandmarkDetectionLogic::vtkInternal::vtkInternal(vtkSlicerLandmarkDetec
 //----------------------------------------------------------------------------
 vtkSlicerLandmarkDetectionLogic::vtkInternal::~vtkInternal()
 {
+  this->StopWorkerThread();
 }
 
 //----------------------------------------------------------------------------
-vtkIGSIOLandmarkDetectionAlgo* vtkSlicerLandmarkDetectionLogic::vtkInternal::GetLandmarkDetectionAlgoFromNode(vtkMRMLLandmarkDetectionNode* landmarkDetectionNode)
+LandmarkDetectionInfo* vtkSlicerLandmarkDetectionLogic::vtkInternal::GetLandmarkDetectionInfoFromNode(vtkMRMLLandmarkDetectionNode* landmarkDetectionNode)
 {
   auto landmarkDetectionIt = this->LandmarkDetectionMap.find(landmarkDetectionNode);
   if (landmarkDetectionIt == this->LandmarkDetectionMap.end())
   {
     return nullptr;
   }
-  return landmarkDetectionIt->second;
+  return landmarkDetectionIt->second.get();
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerLandmarkDetectionLogic::vtkInternal::SynchronizeControlPoints(LandmarkDetectionInfo& info, vtkMRMLMarkupsFiducialNode* markupsNode)
+{
+  if (info.SynchronizedMarkupsNode != markupsNode)
+  {
+    this->ClearControlPoints(info);
+    info.SynchronizedMarkupsNode = markupsNode;
+  }
+  info.SynchronizationRequired = false;
+  if (!markupsNode)
+  {
+    return;
+  }
+
+  ++info.Version;
+  for (int i = 0; i < markupsNode->GetNumberOfControlPoints(); ++i)
+  {
+    if (markupsNode->GetNthControlPointPositionStatus(i) != vtkMRMLMarkupsNode::PositionDefined)
+    {
+      continue;
+    }
+    this->UpdateControlPoint(info, markupsNode->GetNthControlPointID(i), markupsNode->GetNthControlPointPosition(i));
+  }
+
+  // Points that were not visited during this synchronization are either removed or undefined
+  for (auto controlPointIt = info.ControlPoints.begin(); controlPointIt != info.ControlPoints.end();)
+  {
+    auto currentControlPointIt = controlPointIt++;
+    if (currentControlPointIt->second.Version != info.Version)
+    {
+      this->RemoveControlPoint(info, currentControlPointIt);
+    }
+  }
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerLandmarkDetectionLogic::vtkInternal::SynchronizeControlPoint(LandmarkDetectionInfo& info, vtkMRMLMarkupsFiducialNode* markupsNode, int controlPointIndex)
+{
+  if (info.SynchronizationRequired || info.SynchronizedMarkupsNode != markupsNode
+    || controlPointIndex < 0 || controlPointIndex >= markupsNode->GetNumberOfControlPoints())
+  {
+    info.SynchronizationRequired = true;
+    return;
+  }
+
+  std::string controlPointId = markupsNode->GetNthControlPointID(controlPointIndex);
+  if (markupsNode->GetNthControlPointPositionStatus(controlPointIndex) == vtkMRMLMarkupsNode::PositionDefined)
+  {
+    this->UpdateControlPoint(info, controlPointId, markupsNode->GetNthControlPointPosition(controlPointIndex));
+    return;
+  }
+
+  auto controlPointIt = info.ControlPoints.find(controlPointId);
+  if (controlPointIt != info.ControlPoints.end())
+  {
+    this->RemoveControlPoint(info, controlPointIt);
+  }
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerLandmarkDetectionLogic::vtkInternal::ClearControlPoints(LandmarkDetectionInfo& info)
+{
+  info.ControlPoints.clear();
+  info.AlgoPointControlPointIds.clear();
+  info.PendingLandmarks.clear();
+  info.Algo->GetDetectedLandmarkPoints_Reference()->Reset();
+  info.SynchronizedMarkupsNode = nullptr;
+  info.SynchronizationRequired = true;
+}
+
+//----------------------------------------------------------------------------
+std::vector<std::array<double, 3>> vtkSlicerLandmarkDetectionLogic::vtkInternal::TakePendingLandmarks(LandmarkDetectionInfo& info)
+{
+  std::vector<std::array<double, 3>> pendingLandmarks;
+  pendingLandmarks.swap(info.PendingLandmarks);
+  if (!pendingLandmarks.empty())
+  {
+    // Pending landmarks will be added back to the mirror from the markups point events if the landmarks are placed
+    this->SetNumberOfMirroredPoints(info, static_cast<vtkIdType>(info.AlgoPointControlPointIds.size()));
+  }
+  return pendingLandmarks;
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerLandmarkDetectionLogic::vtkInternal::UpdateControlPoint(LandmarkDetectionInfo& info, const std::string& controlPointId, const double position[3])
+{
+  vtkPoints* algoPoints = info.Algo->GetDetectedLandmarkPoints_Reference();
+
+  ControlPointInfo& controlPoint = info.ControlPoints[controlPointId];
+  controlPoint.Version = info.Version;
+  if (controlPoint.AlgoPointId < 0)
+  {
+    controlPoint.AlgoPointId = static_cast<vtkIdType>(info.AlgoPointControlPointIds.size());
+    info.AlgoPointControlPointIds.push_back(controlPointId);
+    this->SetNumberOfMirroredPoints(info, controlPoint.AlgoPointId + 1);
+    algoPoints->SetPoint(controlPoint.AlgoPointId, position);
+  }
+  else if (controlPoint.Position[0] != position[0] || controlPoint.Position[1] != position[1] || controlPoint.Position[2] != position[2])
+  {
+    algoPoints->SetPoint(controlPoint.AlgoPointId, position);
+  }
+  else
+  {
+    // No change
+    return;
+  }
+  controlPoint.Position[0] = position[0];
+  controlPoint.Position[1] = position[1];
+  controlPoint.Position[2] = position[2];
+  algoPoints->Modified();
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerLandmarkDetectionLogic::vtkInternal::RemoveControlPoint(LandmarkDetectionInfo& info, std::map<std::string, ControlPointInfo>::iterator controlPointIt)
+{
+  vtkPoints* algoPoints = info.Algo->GetDetectedLandmarkPoints_Reference();
+
+  // Move the last mirrored point of the algorithm into the place of the removed point, so that the other points keep their ids
+  vtkIdType removedAlgoPointId = controlPointIt->second.AlgoPointId;
+  vtkIdType lastAlgoPointId = static_cast<vtkIdType>(info.AlgoPointControlPointIds.size()) - 1;
+  if (removedAlgoPointId >= 0 && removedAlgoPointId <= lastAlgoPointId)
+  {
+    if (removedAlgoPointId != lastAlgoPointId)
+    {
+      std::string movedControlPointId = info.AlgoPointControlPointIds[lastAlgoPointId];
+      algoPoints->SetPoint(removedAlgoPointId, algoPoints->GetPoint(lastAlgoPointId));
+      info.ControlPoints[movedControlPointId].AlgoPointId = removedAlgoPointId;
+      info.AlgoPointControlPointIds[removedAlgoPointId] = movedControlPointId;
+    }
+    info.AlgoPointControlPointIds.pop_back();
+    this->SetNumberOfMirroredPoints(info, lastAlgoPointId);
+    algoPoints->Modified();
+  }
+  info.ControlPoints.erase(controlPointIt);
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerLandmarkDetectionLogic::vtkInternal::SetNumberOfMirroredPoints(LandmarkDetectionInfo& info, vtkIdType numberOfMirroredPoints)
+{
+  vtkPoints* algoPoints = info.Algo->GetDetectedLandmarkPoints_Reference();
+  algoPoints->SetNumberOfPoints(numberOfMirroredPoints);
+  for (const std::array<double, 3>& pendingLandmark : info.PendingLandmarks)
+  {
+    algoPoints->InsertNextPoint(pendingLandmark.data());
+  }
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerLandmarkDetectionLogic::vtkInternal::StartWorkerThread()
+{
+  if (this->WorkerThread.joinable())
+  {
+    return;
+  }
+  this->WorkerThreadStopRequested = false;
+  this->WorkerThread = std::thread(&vtkInternal::WorkerThreadMain, this);
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerLandmarkDetectionLogic::vtkInternal::StopWorkerThread()
+{
+  if (!this->WorkerThread.joinable())
+  {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> queueLock(this->QueueMutex);
+    this->WorkerThreadStopRequested = true;
+  }
+  this->QueueCondition.notify_all();
+  this->WorkerThread.join();
+
+  // Transforms that were not processed are discarded
+  for (auto& landmarkDetectionIt : this->LandmarkDetectionMap)
+  {
+    landmarkDetectionIt.second->QueuedTransforms.clear();
+  }
+  this->TransformsQueued = false;
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerLandmarkDetectionLogic::vtkInternal::WorkerThreadMain()
+{
+  vtkNew<vtkMatrix4x4> stylusTipToReferenceMatrix;
+  while (true)
+  {
+    // Take all queued transforms at once, so that the main thread is only blocked for the time of a swap
+    struct QueuedTransformsForNode
+    {
+      std::shared_ptr<LandmarkDetectionInfo> Info;
+      unsigned long Generation;
+      std::deque<std::array<double, 16>> Transforms;
+    };
+    std::vector<QueuedTransformsForNode> queuedTransformsForNodes;
+    {
+      std::unique_lock<std::mutex> queueLock(this->QueueMutex);
+      this->QueueCondition.wait(queueLock, [this] { return this->WorkerThreadStopRequested || this->TransformsQueued; });
+      if (this->WorkerThreadStopRequested)
+      {
+        return;
+      }
+      for (auto& landmarkDetectionIt : this->LandmarkDetectionMap)
+      {
+        std::shared_ptr<LandmarkDetectionInfo> info = landmarkDetectionIt.second;
+        if (info->QueuedTransforms.empty())
+        {
+          continue;
+        }
+        queuedTransformsForNodes.emplace_back();
+        queuedTransformsForNodes.back().Info = info;
+        queuedTransformsForNodes.back().Generation = info->Generation;
+        queuedTransformsForNodes.back().Transforms.swap(info->QueuedTransforms);
+      }
+      this->TransformsQueued = false;
+    }
+
+    for (QueuedTransformsForNode& queuedTransformsForNode : queuedTransformsForNodes)
+    {
+      LandmarkDetectionInfo& info = *queuedTransformsForNode.Info;
+      std::lock_guard<std::mutex> infoLock(info.Mutex);
+      if (queuedTransformsForNode.Generation != info.Generation || !info.DetectionInProgress)
+      {
+        // The detection was reset or stopped after the transforms were taken from the queue
+        continue;
+      }
+      for (const std::array<double, 16>& stylusTipToReferenceElements : queuedTransformsForNode.Transforms)
+      {
+        stylusTipToReferenceMatrix->DeepCopy(stylusTipToReferenceElements.data());
+        int newLandmarkDetected = 0;
+        if (info.Algo->InsertNextStylusTipToReferenceTransform(stylusTipToReferenceMatrix, newLandmarkDetected) != IGSIO_SUCCESS)
+        {
+          continue;
+        }
+        if (newLandmarkDetected > 0)
+        {
+          // The algorithm appended the landmark to its detected points, where it is kept until it is placed on the main thread
+          vtkPoints* detectedLandmarkPoints = info.Algo->GetDetectedLandmarkPoints_Reference();
+          std::array<double, 3> newLandmarkPosition;
+          detectedLandmarkPoints->GetPoint(detectedLandmarkPoints->GetNumberOfPoints() - 1, newLandmarkPosition.data());
+          info.PendingLandmarks.push_back(newLandmarkPosition);
+        }
+      }
+    }
+  }
 }
 
 //----------------------------------------------------------------------------
@@ -99,6 +431,8 @@ vtkSlicerLandmarkDetectionLogic::~vtkSlicerLandmarkDetectionLogic()
 void vtkSlicerLandmarkDetectionLogic::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os, indent);
+  os << indent << "UseWorkerThread: " << (this->UseWorkerThread ? "true" : "false") << std::endl;
+  os << indent << "MaximumNumberOfQueuedTransforms: " << this->MaximumNumberOfQueuedTransforms << std::endl;
 }
 
 //---------------------------------------------------------------------------
@@ -140,10 +474,15 @@ void vtkSlicerLandmarkDetectionLogic::OnMRMLSceneNodeAdded(vtkMRMLNode* node)
   events->InsertNextValue(vtkCommand::ModifiedEvent);
   events->InsertNextValue(vtkMRMLLandmarkDetectionNode::InputTransformModifiedEvent);
   events->InsertNextValue(vtkMRMLLandmarkDetectionNode::ResetDetectionEvent);
+  events->InsertNextValue(vtkMRMLLandmarkDetectionNode::OutputMarkupsModifiedEvent);
   vtkObserveMRMLNodeEventsMacro(landmarkDetectionNode, events);
 
-  vtkNew<vtkIGSIOLandmarkDetectionAlgo> landmarkDetectionAlgo;
-  this->Internal->LandmarkDetectionMap[landmarkDetectionNode] = vtkNew<vtkIGSIOLandmarkDetectionAlgo>();
+  std::shared_ptr<LandmarkDetectionInfo> info = std::make_shared<LandmarkDetectionInfo>();
+  info->Algo = vtkSmartPointer<vtkIGSIOLandmarkDetectionAlgo>::New();
+  info->DetectionInProgress = landmarkDetectionNode->GetLandmarkDetectionInProgress();
+
+  std::lock_guard<std::mutex> queueLock(this->Internal->QueueMutex);
+  this->Internal->LandmarkDetectionMap[landmarkDetectionNode] = info;
 }
 
 //---------------------------------------------------------------------------
@@ -155,6 +494,9 @@ void vtkSlicerLandmarkDetectionLogic::OnMRMLSceneNodeRemoved(vtkMRMLNode* node)
     return;
   }
   vtkUnObserveMRMLNodeMacro(landmarkDetectionNode);
+
+  // The worker thread keeps its own reference to the detection info while it is processing its transforms
+  std::lock_guard<std::mutex> queueLock(this->Internal->QueueMutex);
   this->Internal->LandmarkDetectionMap.erase(landmarkDetectionNode);
 }
 
@@ -179,17 +521,117 @@ void vtkSlicerLandmarkDetectionLogic::ProcessMRMLNodesEvents(vtkObject* caller,
   {
     this->ResetDetectionForNode(landmarkDetectionNode);
   }
+  else if (event == vtkMRMLLandmarkDetectionNode::OutputMarkupsModifiedEvent)
+  {
+    this->UpdateControlPointsInAlgo(landmarkDetectionNode, callData ? *(static_cast<int*>(callData)) : -1);
+  }
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerLandmarkDetectionLogic::SetUseWorkerThread(bool useWorkerThread)
+{
+  if (this->UseWorkerThread == useWorkerThread)
+  {
+    return;
+  }
+  this->UseWorkerThread = useWorkerThread;
+  if (this->UseWorkerThread)
+  {
+    this->Internal->StartWorkerThread();
+  }
+  else
+  {
+    this->Internal->StopWorkerThread();
+    // Place the landmarks that were already detected by the worker
+    this->ProcessDetectedLandmarks();
+  }
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerLandmarkDetectionLogic::ProcessDetectedLandmarks()
+{
+  // Collect the nodes first, as adding landmarks to the markups may modify the scene
+  std::vector<vtkSmartPointer<vtkMRMLLandmarkDetectionNode>> landmarkDetectionNodes;
+  for (auto& landmarkDetectionIt : this->Internal->LandmarkDetectionMap)
+  {
+    landmarkDetectionNodes.push_back(landmarkDetectionIt.first);
+  }
+
+  for (vtkMRMLLandmarkDetectionNode* landmarkDetectionNode : landmarkDetectionNodes)
+  {
+    LandmarkDetectionInfo* info = this->Internal->GetLandmarkDetectionInfoFromNode(landmarkDetectionNode);
+    if (!info)
+    {
+      continue;
+    }
+
+    std::vector<std::array<double, 3>> detectedLandmarks;
+    {
+      std::lock_guard<std::mutex> infoLock(info->Mutex);
+      detectedLandmarks = this->Internal->TakePendingLandmarks(*info);
+    }
+    if (detectedLandmarks.empty())
+    {
+      continue;
+    }
+
+    for (std::array<double, 3>& detectedLandmark : detectedLandmarks)
+    {
+      this->UpdateDetectedLandmarks(landmarkDetectionNode, detectedLandmark.data());
+    }
+
+    // Make the placed landmarks visible to the worker as soon as possible
+    info = this->Internal->GetLandmarkDetectionInfoFromNode(landmarkDetectionNode);
+    if (info && info->SynchronizationRequired)
+    {
+      std::lock_guard<std::mutex> infoLock(info->Mutex);
+      this->Internal->SynchronizeControlPoints(*info, landmarkDetectionNode->GetOutputMarkupsNode());
+    }
+  }
 }
 
 //----------------------------------------------------------------------------
 void vtkSlicerLandmarkDetectionLogic::ResetDetectionForNode(vtkMRMLLandmarkDetectionNode* landmarkDetectionNode)
 {
-  vtkIGSIOLandmarkDetectionAlgo* algo = this->Internal->GetLandmarkDetectionAlgoFromNode(landmarkDetectionNode);
-  if (!algo)
+  LandmarkDetectionInfo* info = this->Internal->GetLandmarkDetectionInfoFromNode(landmarkDetectionNode);
+  if (!info)
   {
     vtkErrorMacro("ResetDetectionForNode: Could not find algorithm for specified node");
+    return;
   }
-  algo->ResetDetection();
+
+  // Transforms that were collected before the reset should not be processed,
+  // neither the queued ones nor the ones that the worker thread has already taken from the queue
+  std::lock_guard<std::mutex> queueLock(this->Internal->QueueMutex);
+  std::lock_guard<std::mutex> infoLock(info->Mutex);
+  info->QueuedTransforms.clear();
+  ++info->Generation;
+  info->Algo->ResetDetection();
+
+  // Detected landmark points are cleared by the algorithm, existing control points will be pushed again with the next transform
+  this->Internal->ClearControlPoints(*info);
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerLandmarkDetectionLogic::UpdateControlPointsInAlgo(vtkMRMLLandmarkDetectionNode* landmarkDetectionNode, int controlPointIndex/*=-1*/)
+{
+  LandmarkDetectionInfo* info = this->Internal->GetLandmarkDetectionInfoFromNode(landmarkDetectionNode);
+  if (!info)
+  {
+    vtkErrorMacro("UpdateControlPointsInAlgo: Could not find algorithm for specified node");
+    return;
+  }
+
+  if (controlPointIndex < 0)
+  {
+    // Index of the modified point is unknown, the whole mirror is compared before the next transform is processed
+    info->SynchronizationRequired = true;
+    return;
+  }
+
+  std::lock_guard<std::mutex> infoLock(info->Mutex);
+  this->Internal->SynchronizeControlPoint(*info, landmarkDetectionNode->GetOutputMarkupsNode(), controlPointIndex);
 }
 
 //----------------------------------------------------------------------------
@@ -217,11 +659,28 @@ vtkMRMLLandmarkDetectionNode* vtkSlicerLandmarkDetectionLogic::AddLandmarkDetect
 //----------------------------------------------------------------------------
 void vtkSlicerLandmarkDetectionLogic::UpdateLandmarkDetectionAlgo(vtkMRMLLandmarkDetectionNode* landmarkDetectionNode)
 {
-  vtkIGSIOLandmarkDetectionAlgo* algo = this->Internal->GetLandmarkDetectionAlgoFromNode(landmarkDetectionNode);
-  if (!algo)
+  LandmarkDetectionInfo* info = this->Internal->GetLandmarkDetectionInfoFromNode(landmarkDetectionNode);
+  if (!info)
   {
     vtkErrorMacro("UpdateLandmarkDetectionAlgo: Could not find algorithm for specified node");
+    return;
   }
+
+  bool detectionInProgress = landmarkDetectionNode->GetLandmarkDetectionInProgress();
+  if (info->DetectionInProgress && !detectionInProgress)
+  {
+    // Transforms that were collected before the detection was stopped should not be processed,
+    // and landmarks that were detected on the worker thread but not placed yet are discarded
+    std::lock_guard<std::mutex> queueLock(this->Internal->QueueMutex);
+    std::lock_guard<std::mutex> infoLock(info->Mutex);
+    info->QueuedTransforms.clear();
+    ++info->Generation;
+    this->Internal->TakePendingLandmarks(*info);
+  }
+
+  std::lock_guard<std::mutex> infoLock(info->Mutex);
+  info->DetectionInProgress = detectionInProgress;
+  vtkIGSIOLandmarkDetectionAlgo* algo = info->Algo;
   algo->SetAcquisitionRate(landmarkDetectionNode->GetAcquisitionRateHz());
   algo->SetFilterWindowTimeSec(landmarkDetectionNode->GetFilterWindowTimeSec());
   algo->SetDetectionTimeSec(landmarkDetectionNode->GetDetectionTimeSec());
@@ -233,27 +692,20 @@ void vtkSlicerLandmarkDetectionLogic::UpdateLandmarkDetectionAlgo(vtkMRMLLandmar
 //----------------------------------------------------------------------------
 void vtkSlicerLandmarkDetectionLogic::AddTransformToAlgo(vtkMRMLLandmarkDetectionNode* landmarkDetectionNode)
 {
-  vtkIGSIOLandmarkDetectionAlgo* algo = this->Internal->GetLandmarkDetectionAlgoFromNode(landmarkDetectionNode);
-  if (!algo)
+  LandmarkDetectionInfo* info = this->Internal->GetLandmarkDetectionInfoFromNode(landmarkDetectionNode);
+  if (!info)
   {
     vtkErrorMacro("AddTransformToAlgo: Could not find algorithm for specified node");
     return;
   }
 
+  // Existing landmarks are mirrored in the algorithm so that we reject the points that are near to existing ones.
+  // Control points are pushed to the algorithm when the markups is modified, so usually there is nothing to do here.
   vtkMRMLMarkupsFiducialNode* outputFiducials = landmarkDetectionNode->GetOutputMarkupsNode();
-  if (outputFiducials)
+  if (info->SynchronizationRequired || info->SynchronizedMarkupsNode != outputFiducials)
   {
-    // Copy existing landmarks to the algorithm so that we reject the points that are near to existing ones.
-    vtkNew<vtkPoints> definedControlPoints;
-    for (int i = 0; i < outputFiducials->GetNumberOfControlPoints(); ++i)
-    {
-      if (outputFiducials->GetNthControlPointPositionStatus(i) != vtkMRMLMarkupsNode::PositionDefined)
-      {
-        continue;
-      }
-      definedControlPoints->InsertNextPoint(outputFiducials->GetNthControlPointPosition(i));
-    }
-    algo->GetDetectedLandmarkPoints_Reference()->DeepCopy(definedControlPoints);
+    std::lock_guard<std::mutex> infoLock(info->Mutex);
+    this->Internal->SynchronizeControlPoints(*info, outputFiducials);
   }
 
   // Get a matrix from the stylus tip position to the markups node coordinate system.
@@ -267,30 +719,59 @@ void vtkSlicerLandmarkDetectionLogic::AddTransformToAlgo(vtkMRMLLandmarkDetectio
   }
   vtkMRMLTransformNode::GetMatrixTransformBetweenNodes(transformNode, referenceTransformNode, stylusTipToReferenceMatrix);
 
-  int newLandmarkDetected = 0;
-  if (algo->InsertNextStylusTipToReferenceTransform(stylusTipToReferenceMatrix, newLandmarkDetected) != IGSIO_SUCCESS)
+  if (this->UseWorkerThread)
   {
-    vtkErrorMacro("AddTransformToAlgo: Could not add StylusTipToReferenceTransform");
+    // The stationarity analysis is performed on the worker thread
+    {
+      std::lock_guard<std::mutex> queueLock(this->Internal->QueueMutex);
+      std::deque<std::array<double, 16>>& queuedTransforms = info->QueuedTransforms;
+      while (!queuedTransforms.empty() && static_cast<int>(queuedTransforms.size()) >= this->MaximumNumberOfQueuedTransforms)
+      {
+        // The worker cannot keep up, discard the oldest transform
+        queuedTransforms.pop_front();
+      }
+      queuedTransforms.emplace_back();
+      vtkMatrix4x4::DeepCopy(queuedTransforms.back().data(), stylusTipToReferenceMatrix);
+      this->Internal->TransformsQueued = true;
+    }
+    this->Internal->QueueCondition.notify_one();
     return;
   }
 
-  if (newLandmarkDetected > 0)
+  std::vector<std::array<double, 3>> detectedLandmarks;
+  {
+    std::lock_guard<std::mutex> infoLock(info->Mutex);
+    int newLandmarkDetected = 0;
+    if (info->Algo->InsertNextStylusTipToReferenceTransform(stylusTipToReferenceMatrix, newLandmarkDetected) != IGSIO_SUCCESS)
+    {
+      vtkErrorMacro("AddTransformToAlgo: Could not add StylusTipToReferenceTransform");
+      return;
+    }
+    if (newLandmarkDetected > 0)
+    {
+      vtkPoints* detectedLandmarkPoints = info->Algo->GetDetectedLandmarkPoints_Reference();
+      std::array<double, 3> newLandmarkPosition;
+      detectedLandmarkPoints->GetPoint(detectedLandmarkPoints->GetNumberOfPoints() - 1, newLandmarkPosition.data());
+      info->PendingLandmarks.push_back(newLandmarkPosition);
+      detectedLandmarks = this->Internal->TakePendingLandmarks(*info);
+    }
+  }
+
+  for (std::array<double, 3>& detectedLandmark : detectedLandmarks)
   {
-    this->UpdateDetectedLandmarks(landmarkDetectionNode);
+    this->UpdateDetectedLandmarks(landmarkDetectionNode, detectedLandmark.data());
   }
 }
 
 //----------------------------------------------------------------------------
-void vtkSlicerLandmarkDetectionLogic::UpdateDetectedLandmarks(vtkMRMLLandmarkDetectionNode* landmarkDetectionNode)
+void vtkSlicerLandmarkDetectionLogic::UpdateDetectedLandmarks(vtkMRMLLandmarkDetectionNode* landmarkDetectionNode, double newLandmarkPosition[3])
 {
-  vtkIGSIOLandmarkDetectionAlgo* algo = this->Internal->GetLandmarkDetectionAlgoFromNode(landmarkDetectionNode);
-  if (!algo)
+  vtkMRMLMarkupsFiducialNode* outputFiducials = landmarkDetectionNode->GetOutputMarkupsNode();
+  if (!outputFiducials)
   {
-    vtkErrorMacro("UpdateDetectedLandmarks: Could not find algorithm for specified node");
+    vtkErrorMacro("UpdateDetectedLandmarks: Invalid output markups node");
     return;
   }
-
-  vtkMRMLMarkupsFiducialNode* outputFiducials = landmarkDetectionNode->GetOutputMarkupsNode();
   MRMLNodeModifyBlocker blocker(outputFiducials);
 
   int nextLandmarkIndex = -1;
@@ -325,8 +806,6 @@ void vtkSlicerLandmarkDetectionLogic::UpdateDetectedLandmarks(vtkMRMLLandmarkDet
     }
   }
 
-  vtkPoints* detectedLandmarkPoints = algo->GetDetectedLandmarkPoints_Reference();
-  double* newLandmarkPosition = detectedLandmarkPoints->GetPoint(detectedLandmarkPoints->GetNumberOfPoints() - 1);
   if (nextLandmarkIndex >= 0)
   {
     outputFiducials->SetNthControlPointPosition(nextLandmarkIndex, newLandmarkPosition);
@@ -336,7 +815,7 @@ void vtkSlicerLandmarkDetectionLogic::UpdateDetectedLandmarks(vtkMRMLLandmarkDet
     outputFiducials->AddControlPoint(newLandmarkPosition);
   }
 
-  if (detectedLandmarkPoints->GetNumberOfPoints() == outputFiducials->GetMaximumNumberOfControlPoints())
+  if (outputFiducials->GetNumberOfDefinedControlPoints() == outputFiducials->GetMaximumNumberOfControlPoints())
   {
     landmarkDetectionNode->LandmarkDetectionInProgressOff();
   }
@@ -59,6 +59,28 @@ public:
   /// TODO: Kyle
   void ResetDetectionForNode(vtkMRMLLandmarkDetectionNode* landmarkDetectionNode);
 
+  //@{
+  /// If enabled, then the stylus poses of all landmark detection nodes are processed on a shared worker thread
+  /// instead of the main thread. Landmarks detected by the worker are added to the markups nodes in batches
+  /// by ProcessDetectedLandmarks().
+  /// Off by default.
+  void SetUseWorkerThread(bool useWorkerThread);
+  vtkGetMacro(UseWorkerThread, bool);
+  vtkBooleanMacro(UseWorkerThread, bool);
+  //@}
+
+  //@{
+  /// Maximum number of stylus poses that are queued for each landmark detection node when the worker thread is used.
+  /// If the worker cannot keep up with the tracker, then the oldest poses are discarded.
+  /// Default value is 100.
+  vtkSetMacro(MaximumNumberOfQueuedTransforms, int);
+  vtkGetMacro(MaximumNumberOfQueuedTransforms, int);
+  //@}
+
+  /// Add the landmarks that were detected on the worker thread to the output markups nodes.
+  /// Must be called from the main thread, it is called periodically by the module.
+  void ProcessDetectedLandmarks();
+
 protected:
   vtkSlicerLandmarkDetectionLogic();
   ~vtkSlicerLandmarkDetectionLogic() override;
@@ -74,7 +96,13 @@ protected:
 
   void UpdateLandmarkDetectionAlgo(vtkMRMLLandmarkDetectionNode* landmarkDetectionNode);
   void AddTransformToAlgo(vtkMRMLLandmarkDetectionNode* landmarkDetectionNode);
-  void UpdateDetectedLandmarks(vtkMRMLLandmarkDetectionNode* landmarkDetectionNode);
+  /// Push the modified control point of the output markups node to the detected landmarks of the algorithm.
+  /// If the index of the modified point is not known (-1), then all control points are compared before the next transform is processed.
+  void UpdateControlPointsInAlgo(vtkMRMLLandmarkDetectionNode* landmarkDetectionNode, int controlPointIndex = -1);
+  void UpdateDetectedLandmarks(vtkMRMLLandmarkDetectionNode* landmarkDetectionNode, double newLandmarkPosition[3]);
+
+  bool UseWorkerThread{ false };
+  int MaximumNumberOfQueuedTransforms{ 100 };
 
 private:
 
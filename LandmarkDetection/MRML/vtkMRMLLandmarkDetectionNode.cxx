@@ -34,7 +34,14 @@ vtkMRMLLandmarkDetectionNode::vtkMRMLLandmarkDetectionNode()
   vtkNew<vtkIntArray> inputTransformEvents;
   inputTransformEvents->InsertNextTuple1(vtkMRMLTransformNode::TransformModifiedEvent);
   this->AddNodeReferenceRole(this->GetInputTransformNodeReferenceRole(), this->GetInputTransformNodeReferenceMRMLAttributeName(), inputTransformEvents);
-  this->AddNodeReferenceRole(this->GetOutputMarkupsNodeReferenceRole(), this->GetOutputMarkupsNodeReferenceMRMLAttributeName());
+
+  vtkNew<vtkIntArray> outputMarkupsEvents;
+  outputMarkupsEvents->InsertNextTuple1(vtkMRMLMarkupsNode::PointAddedEvent);
+  outputMarkupsEvents->InsertNextTuple1(vtkMRMLMarkupsNode::PointRemovedEvent);
+  outputMarkupsEvents->InsertNextTuple1(vtkMRMLMarkupsNode::PointModifiedEvent);
+  outputMarkupsEvents->InsertNextTuple1(vtkMRMLMarkupsNode::PointPositionDefinedEvent);
+  outputMarkupsEvents->InsertNextTuple1(vtkMRMLMarkupsNode::PointPositionUndefinedEvent);
+  this->AddNodeReferenceRole(this->GetOutputMarkupsNodeReferenceRole(), this->GetOutputMarkupsNodeReferenceMRMLAttributeName(), outputMarkupsEvents);
 }
 
 //----------------------------------------------------------------------------
@@ -125,6 +132,14 @@ void vtkMRMLLandmarkDetectionNode::ProcessMRMLEvents(vtkObject* caller, unsigned
   {
     this->InvokeCustomModifiedEvent(InputTransformModifiedEvent, transformNode);
   }
+
+  vtkMRMLMarkupsFiducialNode* markupsNode = vtkMRMLMarkupsFiducialNode::SafeDownCast(caller);
+  if (markupsNode && markupsNode == this->GetOutputMarkupsNode())
+  {
+    // Indices of the points following a removed point are shifted, so the index of a removed point is not forwarded.
+    void* pointIndex = (eventID == vtkMRMLMarkupsNode::PointRemovedEvent ? nullptr : callData);
+    this->InvokeCustomModifiedEvent(OutputMarkupsModifiedEvent, pointIndex);
+  }
 }
 
 //----------------------------------------------------------------------------
@@ -67,6 +67,7 @@ public:
     InputTransformModifiedEvent,
     LandmarkDetectedEvent,
     ResetDetectionEvent,
+    OutputMarkupsModifiedEvent,
   };
 
   //@{
@@ -78,7 +79,10 @@ public:
   //@}
 
   //@{
-  /// OutputMarkupsNode is the transform node that is used for landmark detection
+  /// OutputMarkupsNode is the markups node that detected landmarks are placed in.
+  /// Control point additions, removals and modifications are forwarded as OutputMarkupsModifiedEvent.
+  /// The call data is a pointer to the index of the modified control point, or nullptr if the index is not known
+  /// (for example if a point was removed, or if the events were compressed by a modify blocker).
   const char* GetOutputMarkupsNodeReferenceRole() { return "outputMarkupsNode"; };
   const char* GetOutputMarkupsNodeReferenceMRMLAttributeName() { return "outputMarkupsNodeRef"; };
   vtkMRMLMarkupsFiducialNode* GetOutputMarkupsNode();
@@ -0,0 +1,339 @@
+/*==============================================================================
+
+  Copyright (c) Laboratory for Percutaneous Surgery (PerkLab)
+  Queen's University, Kingston, ON, Canada. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// Throughput and detection latency benchmark for the landmark detection logic.
+//
+// A synthetic stylus trajectory is generated that pivots around a number of dwell points with tracker noise,
+// and moves between them. The poses are pushed through vtkSlicerLandmarkDetectionLogic at the specified
+// simulated tracker rates, both on the main thread and on the worker thread of the logic. Results are printed as CSV,
+// one row per rate, mode and number of existing landmarks: the processing time of a pose, and the simulated time
+// from the start of a dwell until its landmark is placed.
+// The benchmark fails if a landmark is not detected at each dwell point, within DETECTION_TOLERANCE_MM of the dwell point.
+//
+// Usage:
+//   qSlicerLandmarkDetectionModuleCxxTests vtkLandmarkDetectionBenchmark [numberOfDwellPoints [rateHz ...]]
+// Without arguments a short run is performed (10 dwell points at 60 Hz), for example:
+//   qSlicerLandmarkDetectionModuleCxxTests vtkLandmarkDetectionBenchmark 64 60 120 250 500
+
+// SlicerIGT includes
+#include <vtkSlicerLandmarkDetectionLogic.h>
+
+// Slicer MRML includes
+#include <vtkMRMLCoreTestingMacros.h>
+#include <vtkMRMLLinearTransformNode.h>
+#include <vtkMRMLScene.h>
+
+#include <vtkMRMLLandmarkDetectionNode.h>
+#include <vtkMRMLMarkupsFiducialNode.h>
+
+// VTK includes
+#include <vtkMath.h>
+#include <vtkMinimalStandardRandomSequence.h>
+#include <vtkTransform.h>
+#include <vtkVector.h>
+
+// STD includes
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+namespace
+{
+  const double DWELL_TIME_SEC = 2.0;
+  const double MOVE_TIME_SEC = 0.5;
+  const double PIVOT_ANGLE_DEG = 30.0;
+  const double DWELL_POINT_SPACING_MM = 25.0;
+  const double TIP_NOISE_STDEV_MM = 0.15;
+  const double ORIENTATION_NOISE_STDEV_DEG = 0.2;
+  const int LANDMARK_BUCKET_SIZE = 10;
+  const double DETECTION_TOLERANCE_MM = 2.0;
+  const double WORKER_THREAD_TIMEOUT_SEC = 10.0;
+
+  //----------------------------------------------------------------------------
+  double GetNextGaussian(vtkMinimalStandardRandomSequence* randomSequence, double stdev)
+  {
+    // Box-Muller transform
+    double u1 = std::max(randomSequence->GetNextValue(), 1e-12);
+    double u2 = randomSequence->GetNextValue();
+    return stdev * std::sqrt(-2.0 * std::log(u1)) * std::cos(2.0 * vtkMath::Pi() * u2);
+  }
+
+  //----------------------------------------------------------------------------
+  struct StylusPose
+  {
+    vtkSmartPointer<vtkMatrix4x4> StylusTipToReferenceMatrix;
+    /// Index of the dwell point if the pose is the first pose of a dwell, -1 otherwise.
+    int DwellStartIndex{ -1 };
+  };
+
+  //----------------------------------------------------------------------------
+  struct BucketStatistics
+  {
+    int NumberOfPoses{ 0 };
+    double TotalPoseTimeUs{ 0.0 };
+    double MaximumPoseTimeUs{ 0.0 };
+    int NumberOfDetectedLandmarks{ 0 };
+    double TotalDetectionLatencySec{ 0.0 };
+  };
+
+  //----------------------------------------------------------------------------
+  void GenerateTrajectory(int numberOfDwellPoints, double rateHz, std::vector<vtkVector3d>& dwellPoints, std::vector<StylusPose>& trajectory)
+  {
+    vtkNew<vtkMinimalStandardRandomSequence> randomSequence;
+    randomSequence->SetSeed(12345);
+
+    // Dwell points are placed on a grid so that they are further apart than the minimum landmark distance
+    int gridSize = static_cast<int>(std::ceil(std::cbrt(static_cast<double>(numberOfDwellPoints))));
+    dwellPoints.clear();
+    for (int i = 0; i < numberOfDwellPoints; ++i)
+    {
+      dwellPoints.push_back(vtkVector3d(
+        (i % gridSize) * DWELL_POINT_SPACING_MM,
+        ((i / gridSize) % gridSize) * DWELL_POINT_SPACING_MM,
+        (i / (gridSize * gridSize)) * DWELL_POINT_SPACING_MM));
+    }
+
+    int numberOfDwellPoses = static_cast<int>(DWELL_TIME_SEC * rateHz);
+    int numberOfMovePoses = static_cast<int>(MOVE_TIME_SEC * rateHz);
+    trajectory.clear();
+    trajectory.reserve(numberOfDwellPoints * (numberOfDwellPoses + numberOfMovePoses));
+
+    for (int dwellIndex = 0; dwellIndex < numberOfDwellPoints; ++dwellIndex)
+    {
+      vtkVector3d dwellPoint = dwellPoints[dwellIndex];
+
+      // Pivot around the dwell point around a random axis
+      double pivotAxis[3] = { randomSequence->GetNextValue() - 0.5, randomSequence->GetNextValue() - 0.5, 1.0 };
+      vtkMath::Normalize(pivotAxis);
+      for (int i = 0; i < numberOfDwellPoses; ++i)
+      {
+        double phase = 2.0 * vtkMath::Pi() * static_cast<double>(i) / numberOfDwellPoses;
+        vtkNew<vtkTransform> stylusTipToReference;
+        stylusTipToReference->PostMultiply();
+        stylusTipToReference->RotateWXYZ(PIVOT_ANGLE_DEG * std::sin(phase), pivotAxis);
+        stylusTipToReference->RotateX(GetNextGaussian(randomSequence, ORIENTATION_NOISE_STDEV_DEG));
+        stylusTipToReference->RotateY(GetNextGaussian(randomSequence, ORIENTATION_NOISE_STDEV_DEG));
+        stylusTipToReference->Translate(
+          dwellPoint.GetX() + GetNextGaussian(randomSequence, TIP_NOISE_STDEV_MM),
+          dwellPoint.GetY() + GetNextGaussian(randomSequence, TIP_NOISE_STDEV_MM),
+          dwellPoint.GetZ() + GetNextGaussian(randomSequence, TIP_NOISE_STDEV_MM));
+
+        StylusPose pose;
+        pose.StylusTipToReferenceMatrix = vtkSmartPointer<vtkMatrix4x4>::New();
+        pose.StylusTipToReferenceMatrix->DeepCopy(stylusTipToReference->GetMatrix());
+        pose.DwellStartIndex = (i == 0 ? dwellIndex : -1);
+        trajectory.push_back(pose);
+      }
+
+      // Move to the next dwell point
+      vtkVector3d nextDwellPoint = dwellPoints[(dwellIndex + 1) % numberOfDwellPoints];
+      for (int i = 0; i < numberOfMovePoses; ++i)
+      {
+        double fraction = static_cast<double>(i + 1) / (numberOfMovePoses + 1);
+        vtkNew<vtkTransform> stylusTipToReference;
+        stylusTipToReference->PostMultiply();
+        stylusTipToReference->RotateX(PIVOT_ANGLE_DEG * fraction);
+        stylusTipToReference->Translate(
+          dwellPoint.GetX() + fraction * (nextDwellPoint.GetX() - dwellPoint.GetX()) + GetNextGaussian(randomSequence, TIP_NOISE_STDEV_MM),
+          dwellPoint.GetY() + fraction * (nextDwellPoint.GetY() - dwellPoint.GetY()) + GetNextGaussian(randomSequence, TIP_NOISE_STDEV_MM),
+          dwellPoint.GetZ() + fraction * (nextDwellPoint.GetZ() - dwellPoint.GetZ()) + GetNextGaussian(randomSequence, TIP_NOISE_STDEV_MM));
+
+        StylusPose pose;
+        pose.StylusTipToReferenceMatrix = vtkSmartPointer<vtkMatrix4x4>::New();
+        pose.StylusTipToReferenceMatrix->DeepCopy(stylusTipToReference->GetMatrix());
+        trajectory.push_back(pose);
+      }
+    }
+  }
+
+  //----------------------------------------------------------------------------
+  void AddDetectedLandmarksToStatistics(vtkMRMLMarkupsFiducialNode* landmarkNode, int poseIndex, double rateHz,
+    const std::vector<int>& dwellStartPoseIndices, BucketStatistics& bucket, int& numberOfCountedLandmarks)
+  {
+    // Landmarks are detected in the order of the dwell points
+    for (; numberOfCountedLandmarks < landmarkNode->GetNumberOfDefinedControlPoints(); ++numberOfCountedLandmarks)
+    {
+      if (numberOfCountedLandmarks >= static_cast<int>(dwellStartPoseIndices.size()))
+      {
+        continue;
+      }
+      bucket.NumberOfDetectedLandmarks++;
+      bucket.TotalDetectionLatencySec += (poseIndex - dwellStartPoseIndices[numberOfCountedLandmarks] + 1) / rateHz;
+    }
+  }
+
+  //----------------------------------------------------------------------------
+  int CheckDetectedLandmarks(vtkMRMLMarkupsFiducialNode* landmarkNode, const std::vector<vtkVector3d>& dwellPoints)
+  {
+    CHECK_INT(landmarkNode->GetNumberOfDefinedControlPoints(), static_cast<int>(dwellPoints.size()));
+    for (int i = 0; i < landmarkNode->GetNumberOfControlPoints(); ++i)
+    {
+      double landmarkPosition[3] = { 0.0, 0.0, 0.0 };
+      landmarkNode->GetNthControlPointPosition(i, landmarkPosition);
+      double closestDistanceMm = VTK_DOUBLE_MAX;
+      for (const vtkVector3d& dwellPoint : dwellPoints)
+      {
+        closestDistanceMm = std::min(closestDistanceMm, std::sqrt(vtkMath::Distance2BetweenPoints(landmarkPosition, dwellPoint.GetData())));
+      }
+      if (closestDistanceMm > DETECTION_TOLERANCE_MM)
+      {
+        std::cerr << "Landmark " << i << " at (" << landmarkPosition[0] << ", " << landmarkPosition[1] << ", " << landmarkPosition[2]
+          << ") is " << closestDistanceMm << " mm from the closest dwell point" << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+    return EXIT_SUCCESS;
+  }
+
+  //----------------------------------------------------------------------------
+  int RunBenchmark(vtkMRMLScene* scene, vtkSlicerLandmarkDetectionLogic* logic, int numberOfDwellPoints, double rateHz, bool useWorkerThread)
+  {
+    std::vector<vtkVector3d> dwellPoints;
+    std::vector<StylusPose> trajectory;
+    GenerateTrajectory(numberOfDwellPoints, rateHz, dwellPoints, trajectory);
+
+    std::vector<int> dwellStartPoseIndices;
+    for (int poseIndex = 0; poseIndex < static_cast<int>(trajectory.size()); ++poseIndex)
+    {
+      if (trajectory[poseIndex].DwellStartIndex >= 0)
+      {
+        dwellStartPoseIndices.push_back(poseIndex);
+      }
+    }
+
+    // Poses are pushed faster than real time, so the queue of the worker thread must hold all of them
+    logic->SetUseWorkerThread(useWorkerThread);
+    logic->SetMaximumNumberOfQueuedTransforms(static_cast<int>(trajectory.size()));
+
+    vtkMRMLLinearTransformNode* stylusTipToReferenceNode = vtkMRMLLinearTransformNode::SafeDownCast(scene->AddNewNodeByClass("vtkMRMLLinearTransformNode"));
+    vtkMRMLMarkupsFiducialNode* landmarkNode = vtkMRMLMarkupsFiducialNode::SafeDownCast(scene->AddNewNodeByClass("vtkMRMLMarkupsFiducialNode"));
+    vtkMRMLLandmarkDetectionNode* landmarkDetectionNode = vtkMRMLLandmarkDetectionNode::SafeDownCast(scene->AddNewNodeByClass("vtkMRMLLandmarkDetectionNode"));
+    landmarkDetectionNode->SetAcquisitionRateHz(rateHz);
+    landmarkDetectionNode->SetAndObserveInputTransformNode(stylusTipToReferenceNode);
+    landmarkDetectionNode->SetAndObserveOutputMarkupsNode(landmarkNode);
+    landmarkDetectionNode->LandmarkDetectionInProgressOn();
+
+    std::vector<BucketStatistics> buckets(numberOfDwellPoints / LANDMARK_BUCKET_SIZE + 1);
+    int numberOfCountedLandmarks = 0;
+    for (int poseIndex = 0; poseIndex < static_cast<int>(trajectory.size()); ++poseIndex)
+    {
+      const StylusPose& pose = trajectory[poseIndex];
+
+      int numberOfExistingLandmarks = landmarkNode->GetNumberOfDefinedControlPoints();
+      BucketStatistics& bucket = buckets[std::min(numberOfExistingLandmarks / LANDMARK_BUCKET_SIZE, static_cast<int>(buckets.size()) - 1)];
+
+      auto startTime = std::chrono::steady_clock::now();
+      stylusTipToReferenceNode->SetMatrixTransformToParent(pose.StylusTipToReferenceMatrix);
+      auto stopTime = std::chrono::steady_clock::now();
+      if (useWorkerThread)
+      {
+        // Landmarks detected by the worker are placed by the module timer in the application
+        logic->ProcessDetectedLandmarks();
+      }
+
+      double poseTimeUs = std::chrono::duration<double, std::micro>(stopTime - startTime).count();
+      bucket.NumberOfPoses++;
+      bucket.TotalPoseTimeUs += poseTimeUs;
+      bucket.MaximumPoseTimeUs = std::max(bucket.MaximumPoseTimeUs, poseTimeUs);
+
+      AddDetectedLandmarksToStatistics(landmarkNode, poseIndex, rateHz, dwellStartPoseIndices, bucket, numberOfCountedLandmarks);
+    }
+
+    if (useWorkerThread)
+    {
+      // Wait for the worker to process the remaining poses. The latency of these landmarks is counted until the end of the trajectory.
+      auto waitStartTime = std::chrono::steady_clock::now();
+      while (landmarkNode->GetNumberOfDefinedControlPoints() < numberOfDwellPoints
+        && std::chrono::duration<double>(std::chrono::steady_clock::now() - waitStartTime).count() < WORKER_THREAD_TIMEOUT_SEC)
+      {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        logic->ProcessDetectedLandmarks();
+      }
+      AddDetectedLandmarksToStatistics(landmarkNode, static_cast<int>(trajectory.size()) - 1, rateHz, dwellStartPoseIndices, buckets.back(), numberOfCountedLandmarks);
+    }
+
+    for (int bucketIndex = 0; bucketIndex < static_cast<int>(buckets.size()); ++bucketIndex)
+    {
+      const BucketStatistics& bucket = buckets[bucketIndex];
+      if (bucket.NumberOfPoses == 0)
+      {
+        continue;
+      }
+      std::cout << rateHz
+        << "," << (useWorkerThread ? 1 : 0)
+        << "," << bucketIndex * LANDMARK_BUCKET_SIZE
+        << "," << (bucketIndex + 1) * LANDMARK_BUCKET_SIZE - 1
+        << "," << bucket.NumberOfPoses
+        << "," << bucket.TotalPoseTimeUs / bucket.NumberOfPoses
+        << "," << bucket.MaximumPoseTimeUs
+        << "," << bucket.NumberOfDetectedLandmarks
+        << "," << (bucket.NumberOfDetectedLandmarks > 0 ? bucket.TotalDetectionLatencySec / bucket.NumberOfDetectedLandmarks : -1.0)
+        << std::endl;
+    }
+
+    std::cerr << "Rate " << rateHz << " Hz" << (useWorkerThread ? " (worker thread)" : "") << ": detected "
+      << landmarkNode->GetNumberOfDefinedControlPoints() << " of " << numberOfDwellPoints << " landmarks" << std::endl;
+    int detectionResult = CheckDetectedLandmarks(landmarkNode, dwellPoints);
+
+    landmarkDetectionNode->LandmarkDetectionInProgressOff();
+    scene->RemoveNode(landmarkDetectionNode);
+    scene->RemoveNode(landmarkNode);
+    scene->RemoveNode(stylusTipToReferenceNode);
+    logic->UseWorkerThreadOff();
+    return detectionResult;
+  }
+}
+
+//----------------------------------------------------------------------------
+int vtkLandmarkDetectionBenchmark(int argc, char* argv[])
+{
+  int numberOfDwellPoints = 10;
+  std::vector<double> ratesHz;
+  if (argc > 1)
+  {
+    numberOfDwellPoints = std::max(1, atoi(argv[1]));
+  }
+  for (int i = 2; i < argc; ++i)
+  {
+    ratesHz.push_back(atof(argv[i]));
+  }
+  if (ratesHz.empty())
+  {
+    ratesHz.push_back(60.0);
+  }
+
+  vtkNew<vtkMRMLScene> scene;
+  scene->RegisterNodeClass(vtkNew<vtkMRMLMarkupsFiducialNode>());
+
+  vtkNew<vtkSlicerLandmarkDetectionLogic> logic;
+  logic->SetMRMLScene(scene);
+
+  std::cout << "RateHz,WorkerThread,ExistingLandmarksMin,ExistingLandmarksMax,NumberOfPoses,MeanPoseTimeUs,MaximumPoseTimeUs,NumberOfDetectedLandmarks,MeanDetectionLatencySec" << std::endl;
+  for (double rateHz : ratesHz)
+  {
+    if (rateHz <= 0.0)
+    {
+      std::cerr << "Invalid rate: " << rateHz << std::endl;
+      return EXIT_FAILURE;
+    }
+    CHECK_EXIT_SUCCESS(RunBenchmark(scene, logic, numberOfDwellPoints, rateHz, false));
+    CHECK_EXIT_SUCCESS(RunBenchmark(scene, logic, numberOfDwellPoints, rateHz, true));
+  }
+
+  return EXIT_SUCCESS;
+}
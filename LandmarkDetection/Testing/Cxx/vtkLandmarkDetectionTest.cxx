@@ -32,6 +32,10 @@
 // VTK includes
 #include <vtkTransform.h>
 
+// STD includes
+#include <chrono>
+#include <thread>
+
 int NUMBER_OF_POINTS = 100;
 double epsilon = 1.0e-6;
 
@@ -64,6 +68,19 @@ int TestControlPointPosition(vtkMRMLMarkupsFiducialNode* landmarkNode, int point
   return EXIT_SUCCESS;
 }
 
+//----------------------------------------------------------------------------
+int WaitForDetectedLandmarks(vtkSlicerLandmarkDetectionLogic* logic, vtkMRMLMarkupsFiducialNode* landmarkNode, int expectedNumberOfDefinedControlPoints)
+{
+  // Landmarks are detected asynchronously by the worker thread
+  for (int i = 0; i < 500 && landmarkNode->GetNumberOfDefinedControlPoints() < expectedNumberOfDefinedControlPoints; ++i)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    logic->ProcessDetectedLandmarks();
+  }
+  CHECK_INT(landmarkNode->GetNumberOfDefinedControlPoints(), expectedNumberOfDefinedControlPoints);
+  return EXIT_SUCCESS;
+}
+
 //----------------------------------------------------------------------------
 int vtkLandmarkDetectionTest(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
 {
@@ -175,5 +192,50 @@ int vtkLandmarkDetectionTest(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
     CHECK_EXIT_SUCCESS(TestControlPointPosition(landmarkNode, 2, point2_RAS));
   }
 
+  {
+    // Test detection on the worker thread, with two detectors running simultaneously
+    logic->UseWorkerThreadOn();
+    logic->SetMaximumNumberOfQueuedTransforms(NUMBER_OF_POINTS);
+
+    vtkMRMLLinearTransformNode* markerToReferenceTransforms[2] = { nullptr, nullptr };
+    vtkMRMLMarkupsFiducialNode* landmarkNodes[2] = { nullptr, nullptr };
+    vtkMRMLLandmarkDetectionNode* landmarkDetectionNodes[2] = { nullptr, nullptr };
+    for (int i = 0; i < 2; ++i)
+    {
+      markerToReferenceTransforms[i] = vtkMRMLLinearTransformNode::SafeDownCast(scene->AddNewNodeByClass("vtkMRMLLinearTransformNode"));
+      landmarkNodes[i] = vtkMRMLMarkupsFiducialNode::SafeDownCast(scene->AddNewNodeByClass("vtkMRMLMarkupsFiducialNode"));
+      landmarkDetectionNodes[i] = vtkMRMLLandmarkDetectionNode::SafeDownCast(scene->AddNewNodeByClass("vtkMRMLLandmarkDetectionNode"));
+      landmarkDetectionNodes[i]->SetAndObserveInputTransformNode(markerToReferenceTransforms[i]);
+      landmarkDetectionNodes[i]->SetAndObserveOutputMarkupsNode(landmarkNodes[i]);
+      landmarkDetectionNodes[i]->LandmarkDetectionInProgressOn();
+    }
+
+    double landmark0_RAS[3] = { -50.0, 20.0, 10.0 };
+    double landmark1_RAS[3] = { 30.0, -70.0, 40.0 };
+    CHECK_EXIT_SUCCESS(TestLandmarkDetection(nullptr, markerToReferenceTransforms[0], landmark0_RAS));
+    CHECK_EXIT_SUCCESS(TestLandmarkDetection(nullptr, markerToReferenceTransforms[1], landmark1_RAS));
+    CHECK_EXIT_SUCCESS(WaitForDetectedLandmarks(logic, landmarkNodes[0], 1));
+    CHECK_EXIT_SUCCESS(WaitForDetectedLandmarks(logic, landmarkNodes[1], 1));
+    CHECK_EXIT_SUCCESS(TestControlPointPosition(landmarkNodes[0], 0, landmark0_RAS));
+    CHECK_EXIT_SUCCESS(TestControlPointPosition(landmarkNodes[1], 0, landmark1_RAS));
+
+    // Poses collected before the detection is reset or stopped must not be detected as landmarks,
+    // even if the worker thread has already taken them from the queue
+    double landmark2_RAS[3] = { 60.0, 60.0, -40.0 };
+    CHECK_EXIT_SUCCESS(TestLandmarkDetection(nullptr, markerToReferenceTransforms[0], landmark2_RAS));
+    logic->ResetDetectionForNode(landmarkDetectionNodes[0]);
+    CHECK_EXIT_SUCCESS(TestLandmarkDetection(nullptr, markerToReferenceTransforms[1], landmark2_RAS));
+    landmarkDetectionNodes[1]->LandmarkDetectionInProgressOff();
+    for (int i = 0; i < 20; ++i)
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      logic->ProcessDetectedLandmarks();
+    }
+    CHECK_INT(landmarkNodes[0]->GetNumberOfDefinedControlPoints(), 1);
+    CHECK_INT(landmarkNodes[1]->GetNumberOfDefinedControlPoints(), 1);
+
+    logic->UseWorkerThreadOff();
+  }
+
   return EXIT_SUCCESS;
 }
@@ -18,6 +18,9 @@
 
 ==============================================================================*/
 
+// Qt includes
+#include <QTimer>
+
 // LandmarkDetection Logic includes
 #include <vtkSlicerLandmarkDetectionLogic.h>
 
@@ -31,6 +34,8 @@ class qSlicerLandmarkDetectionModulePrivate
 {
 public:
   qSlicerLandmarkDetectionModulePrivate();
+
+  QTimer DetectedLandmarksTimer;
 };
 
 //-----------------------------------------------------------------------------
@@ -39,6 +44,8 @@ public:
 //-----------------------------------------------------------------------------
 qSlicerLandmarkDetectionModulePrivate::qSlicerLandmarkDetectionModulePrivate()
 {
+  this->DetectedLandmarksTimer.setSingleShot(false);
+  this->DetectedLandmarksTimer.setInterval(50);
 }
 
 //-----------------------------------------------------------------------------
@@ -49,11 +56,16 @@ qSlicerLandmarkDetectionModule::qSlicerLandmarkDetectionModule(QObject* _parent)
   : Superclass(_parent)
   , d_ptr(new qSlicerLandmarkDetectionModulePrivate)
 {
+  Q_D(qSlicerLandmarkDetectionModule);
+
+  connect(&d->DetectedLandmarksTimer, SIGNAL(timeout()), this, SLOT(processDetectedLandmarks()));
 }
 
 //-----------------------------------------------------------------------------
 qSlicerLandmarkDetectionModule::~qSlicerLandmarkDetectionModule()
 {
+  Q_D(qSlicerLandmarkDetectionModule);
+  disconnect(&d->DetectedLandmarksTimer, SIGNAL(timeout()), this, SLOT(processDetectedLandmarks()));
 }
 
 //-----------------------------------------------------------------------------
@@ -98,6 +110,14 @@ QStringList qSlicerLandmarkDetectionModule::dependencies() const
 void qSlicerLandmarkDetectionModule::setup()
 {
   this->Superclass::setup();
+
+  // The worker thread is enabled on the logic, so the timer is started and stopped when the logic is modified
+  vtkSlicerLandmarkDetectionLogic* logic = vtkSlicerLandmarkDetectionLogic::SafeDownCast(this->logic());
+  if (logic)
+  {
+    this->qvtkConnect(logic, vtkCommand::ModifiedEvent, this, SLOT(updateDetectedLandmarksTimer()));
+  }
+  this->updateDetectedLandmarksTimer();
 }
 
 //-----------------------------------------------------------------------------
@@ -112,3 +132,30 @@ vtkMRMLAbstractLogic* qSlicerLandmarkDetectionModule::createLogic()
 {
   return vtkSlicerLandmarkDetectionLogic::New();
 }
+
+//-----------------------------------------------------------------------------
+void qSlicerLandmarkDetectionModule::processDetectedLandmarks()
+{
+  vtkSlicerLandmarkDetectionLogic* logic = vtkSlicerLandmarkDetectionLogic::SafeDownCast(this->logic());
+  if (!logic || !logic->GetUseWorkerThread())
+  {
+    return;
+  }
+  logic->ProcessDetectedLandmarks();
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerLandmarkDetectionModule::updateDetectedLandmarksTimer()
+{
+  Q_D(qSlicerLandmarkDetectionModule);
+  vtkSlicerLandmarkDetectionLogic* logic = vtkSlicerLandmarkDetectionLogic::SafeDownCast(this->logic());
+  bool useWorkerThread = logic && logic->GetUseWorkerThread();
+  if (useWorkerThread && !d->DetectedLandmarksTimer.isActive())
+  {
+    d->DetectedLandmarksTimer.start();
+  }
+  else if (!useWorkerThread && d->DetectedLandmarksTimer.isActive())
+  {
+    d->DetectedLandmarksTimer.stop();
+  }
+}
@@ -21,6 +21,9 @@
 #ifndef __qSlicerLandmarkDetectionModule_h
 #define __qSlicerLandmarkDetectionModule_h
 
+// CTK includes
+#include <ctkVTKObject.h>
+
 // Slicer includes
 #include "qSlicerLoadableModule.h"
 
@@ -34,6 +37,7 @@ qSlicerLandmarkDetectionModule
   : public qSlicerLoadableModule
 {
   Q_OBJECT
+  QVTK_OBJECT
   Q_PLUGIN_METADATA(IID "org.slicer.modules.loadable.qSlicerLoadableModule/1.0");
   Q_INTERFACES(qSlicerLoadableModule);
 
@@ -54,6 +58,12 @@ public:
   QStringList categories()const override;
   QStringList dependencies() const override;
 
+protected slots:
+  /// Add the landmarks detected by the worker thread of the logic to the markups nodes.
+  void processDetectedLandmarks();
+  /// Run the timer that processes the detected landmarks only while the worker thread of the logic is used.
+  void updateDetectedLandmarksTimer();
+
 protected:
 
   /// Initialize the module. Register the volumes reader/writer
@@ -27,25 +27,744 @@
 #include <vtkIGSIOSpinCalibrationAlgo.h>
 
 // VTK includes
+#include <vtkIntArray.h>
 #include <vtkNew.h>
 #include <vtkSmartPointer.h>
 #include <vtkCommand.h>
 #include <vtkMatrix4x4.h>
+#include <vtkWeakPointer.h>
+
+// STD includes
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//----------------------------------------------------------------------------
+/// Pivot or spin calibration that is computed on a background thread.
+/// The calibration algorithm and the matrix are only accessed by the worker thread until Finished is set.
+struct CalibrationJob
+{
+  enum CalibrationType
+  {
+    PivotCalibration,
+    SpinCalibration
+  };
+
+  void Run();
+
+  int Type{ PivotCalibration };
+  vtkSmartPointer<vtkIGSIOPivotCalibrationAlgo> PivotCalibrationAlgo;
+  vtkSmartPointer<vtkIGSIOSpinCalibrationAlgo> SpinCalibrationAlgo;
+  bool SnapRotation{ false };
+  bool AutoOrient{ true };
+
+  /// If true then the calibration was started by auto-calibration of a session
+  /// and the algorithm is given back to the session when the result is processed.
+  bool AutoCalibration{ false };
+  /// Number of poses in the algorithm when the calibration was started.
+  int NumberOfPoses{ 0 };
+
+  /// Initial tool tip to tool transform, replaced by the result when the calibration succeeds.
+  vtkNew<vtkMatrix4x4> ToolTipToToolMatrix;
+  vtkWeakPointer<vtkMRMLTransformNode> OutputTransformNode;
+
+  std::atomic<bool> CancelRequested{ false };
+  std::atomic<bool> Finished{ false };
+
+  /// Guards the progress and the results.
+  std::mutex Mutex;
+  double Progress{ 0.0 };
+  double RMSE{ -1.0 };
+  bool Success{ false };
+  int ErrorCode{ vtkIGSIOAbstractStylusCalibrationAlgo::CALIBRATION_NOT_STARTED };
+};
+
+//----------------------------------------------------------------------------
+void CalibrationJob::Run()
+{
+  // The solver is a single call, so progress can only be reported between its stages.
+  {
+    std::lock_guard<std::mutex> lock(this->Mutex);
+    this->Progress = 0.1;
+  }
+
+  if (!this->CancelRequested)
+  {
+    igsioStatus status = IGSIO_FAIL;
+    int errorCode = vtkIGSIOAbstractStylusCalibrationAlgo::CALIBRATION_FAIL;
+    double rmse = -1.0;
+    if (this->Type == PivotCalibration)
+    {
+      this->PivotCalibrationAlgo->SetPivotPointToMarkerTransformMatrix(this->ToolTipToToolMatrix);
+      status = this->PivotCalibrationAlgo->DoPivotCalibration(nullptr, this->AutoOrient);
+      errorCode = this->PivotCalibrationAlgo->GetErrorCode();
+      rmse = this->PivotCalibrationAlgo->GetPivotCalibrationErrorMm();
+    }
+    else
+    {
+      this->SpinCalibrationAlgo->SetPivotPointToMarkerTransformMatrix(this->ToolTipToToolMatrix);
+      status = this->SpinCalibrationAlgo->DoSpinCalibration(nullptr, this->SnapRotation, this->AutoOrient);
+      errorCode = this->SpinCalibrationAlgo->GetErrorCode();
+      rmse = this->SpinCalibrationAlgo->GetSpinCalibrationErrorMm();
+    }
+
+    std::lock_guard<std::mutex> lock(this->Mutex);
+    this->Success = (status == IGSIO_SUCCESS);
+    this->ErrorCode = errorCode;
+    this->RMSE = this->Success ? rmse : -1.0;
+    this->Progress = 0.9;
+  }
+
+  if (this->Success)
+  {
+    if (this->Type == PivotCalibration)
+    {
+      this->ToolTipToToolMatrix->DeepCopy(this->PivotCalibrationAlgo->GetPivotPointToMarkerTransformMatrix());
+    }
+    else
+    {
+      this->ToolTipToToolMatrix->DeepCopy(this->SpinCalibrationAlgo->GetPivotPointToMarkerTransformMatrix());
+    }
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(this->Mutex);
+    this->Progress = 1.0;
+  }
+  this->Finished = true;
+}
+
+//----------------------------------------------------------------------------
+/// Calibration state of one tool in a multi-tool calibration.
+/// Only accessed on the main thread.
+struct CalibrationSession
+{
+  vtkSmartPointer<vtkMRMLTransformNode> ToolTransformNode;
+
+  /// Pose buffers of the tool. Set to nullptr while the algorithm is used by an auto-calibration job.
+  vtkSmartPointer<vtkIGSIOPivotCalibrationAlgo> PivotCalibrationAlgo;
+  vtkSmartPointer<vtkIGSIOSpinCalibrationAlgo> SpinCalibrationAlgo;
+  /// Poses received while a calibration of the same type is using the previously collected poses.
+  /// While the algorithm is used by an auto-calibration job, the poses are only stored here.
+  std::vector<vtkSmartPointer<vtkMatrix4x4>> PendingPivotPoses;
+  std::vector<vtkSmartPointer<vtkMatrix4x4>> PendingSpinPoses;
+
+  bool PivotCalibrationEnabled{ true };
+  bool SpinCalibrationEnabled{ true };
+
+  /// Calibration results
+  vtkNew<vtkMatrix4x4> ToolTipToToolMatrix;
+  double PivotRMSE{ -1.0 };
+  double SpinRMSE{ -1.0 };
+  std::string ErrorText;
+
+  /// Background calibration of the tool whose result has not been processed yet.
+  std::shared_ptr<CalibrationJob> CurrentJob;
+  /// Cancelled calibrations of the tool that were already being computed by a worker thread.
+  std::vector<std::shared_ptr<CalibrationJob>> CancelledJobs;
+};
 
 //----------------------------------------------------------------------------
 class vtkSlicerPivotCalibrationLogic::vtkInternal
 {
-public:
-  vtkInternal(vtkSlicerPivotCalibrationLogic* external)
+public:
+  vtkInternal(vtkSlicerPivotCalibrationLogic* external)
+  {
+    this->External = external;
+  }
+  ~vtkInternal()
+  {
+    if (this->CurrentJob)
+    {
+      this->CurrentJob->CancelRequested = true;
+    }
+    for (auto sessionIt : this->Sessions)
+    {
+      if (sessionIt.second->CurrentJob)
+      {
+        sessionIt.second->CurrentJob->CancelRequested = true;
+      }
+    }
+    this->StopWorkerThreads();
+  }
+
+  //@{
+  /// Copy the calibration settings from one algorithm to another.
+  /// Settings that depend on the auto-calibration state of the logic are not copied.
+  template<class CalibrationAlgoType>
+  static void CopyCalibrationAlgoSettings(CalibrationAlgoType* sourceAlgo, CalibrationAlgoType* targetAlgo)
+  {
+    targetAlgo->SetMaximumNumberOfPoseBuckets(sourceAlgo->GetMaximumNumberOfPoseBuckets());
+    targetAlgo->SetPoseBucketSize(sourceAlgo->GetPoseBucketSize());
+    targetAlgo->SetMaximumPoseBucketError(sourceAlgo->GetMaximumPoseBucketError());
+    targetAlgo->SetMinimumOrientationDifferenceDegrees(sourceAlgo->GetMinimumOrientationDifferenceDegrees());
+    targetAlgo->SetOrientationDifferenceThresholdDegrees(sourceAlgo->GetOrientationDifferenceThresholdDegrees());
+    targetAlgo->SetPositionDifferenceThresholdMm(sourceAlgo->GetPositionDifferenceThresholdMm());
+  }
+  template<class CalibrationAlgoType>
+  static vtkSmartPointer<CalibrationAlgoType> CreateCalibrationAlgo(CalibrationAlgoType* algo)
+  {
+    vtkSmartPointer<CalibrationAlgoType> newAlgo = vtkSmartPointer<CalibrationAlgoType>::New();
+    CopyCalibrationAlgoSettings<CalibrationAlgoType>(algo, newAlgo);
+    return newAlgo;
+  }
+  //@}
+
+  bool StartJob(std::shared_ptr<CalibrationJob> job, vtkMRMLTransformNode* outputTransformNode);
+  void CancelCurrentJob();
+  /// Removes a job from the queue. Returns false if a worker thread has already taken the job.
+  bool RemoveQueuedJob(std::shared_ptr<CalibrationJob> job);
+  /// Returns true if a calibration of the specified type has the poses that were collected before it was started.
+  bool IsJobUsingPoses(int type);
+  /// Gives the poses of a cancelled or failed calibration back to the logic, followed by the poses received since it was started.
+  /// The job must not be used by a worker thread anymore.
+  void ReturnJobPoses(std::shared_ptr<CalibrationJob> job);
+  /// Returns the poses of cancelled calibrations that have been finished by the worker threads.
+  /// If wait is true then it waits until all cancelled calibrations are finished.
+  void ProcessCancelledJobs(bool wait);
+
+  //@{
+  /// Multi-tool calibration sessions
+  std::shared_ptr<CalibrationSession> GetSession(vtkMRMLTransformNode* toolTransformNode);
+  void AddSessionToolToReferenceMatrix(std::shared_ptr<CalibrationSession> session, vtkMatrix4x4* toolToReferenceMatrix);
+  bool StartSessionJob(std::shared_ptr<CalibrationSession> session, std::shared_ptr<CalibrationJob> job, vtkMRMLTransformNode* outputTransformNode);
+  void CancelSessionJob(std::shared_ptr<CalibrationSession> session);
+  /// Returns the calibration of the specified type that has the poses that were collected before it was started.
+  std::shared_ptr<CalibrationJob> GetSessionJobUsingPoses(std::shared_ptr<CalibrationSession> session, int type);
+  /// Same as ReturnJobPoses, for the calibration of a session.
+  void ReturnSessionJobPoses(std::shared_ptr<CalibrationSession> session, std::shared_ptr<CalibrationJob> job);
+  /// Same as ProcessCancelledJobs, for the cancelled calibrations of a session.
+  void ProcessSessionCancelledJobs(std::shared_ptr<CalibrationSession> session, bool wait);
+  bool ProcessSessionJobResult(std::shared_ptr<CalibrationSession> session);
+  void ClearSessionToolToReferenceMatrices(std::shared_ptr<CalibrationSession> session, bool pivot, bool spin);
+  void UpdateSessionCalibrationSettings(std::shared_ptr<CalibrationSession> session);
+  void UpdateSessionsCalibrationSettings();
+  //@}
+
+  //@{
+  /// Worker thread pool that computes the background calibrations.
+  /// Threads are started on demand, up to MaximumNumberOfCalibrationThreads.
+  void SubmitJob(std::shared_ptr<CalibrationJob> job);
+  void StopWorkerThreads();
+  void WorkerThreadMain();
+  //@}
+
+  vtkSlicerPivotCalibrationLogic* External;
+  vtkSmartPointer<vtkIGSIOPivotCalibrationAlgo> PivotCalibrationAlgo{ vtkSmartPointer<vtkIGSIOPivotCalibrationAlgo>::New() };
+  vtkSmartPointer<vtkIGSIOSpinCalibrationAlgo> SpinCalibrationAlgo{ vtkSmartPointer<vtkIGSIOSpinCalibrationAlgo>::New() };
+
+  /// Background calibration whose result has not been processed yet.
+  std::shared_ptr<CalibrationJob> CurrentJob;
+  /// Cancelled calibrations that were already being computed by a worker thread.
+  std::vector<std::shared_ptr<CalibrationJob>> CancelledJobs;
+  /// Poses received while a calibration of the same type is using the previously collected poses.
+  std::vector<vtkSmartPointer<vtkMatrix4x4>> PendingPivotPoses;
+  std::vector<vtkSmartPointer<vtkMatrix4x4>> PendingSpinPoses;
+
+  /// Error codes of the last calibrations
+  int PivotErrorCode{ vtkIGSIOAbstractStylusCalibrationAlgo::CALIBRATION_NOT_STARTED };
+  int SpinErrorCode{ vtkIGSIOAbstractStylusCalibrationAlgo::CALIBRATION_NOT_STARTED };
+
+  /// Calibration sessions, keyed by tool transform node
+  std::map<vtkSmartPointer<vtkMRMLTransformNode>, std::shared_ptr<CalibrationSession>> Sessions;
+
+  std::vector<std::thread> WorkerThreads;
+  /// Guards the job queue and the worker thread state
+  std::mutex JobQueueMutex;
+  std::condition_variable JobQueueCondition;
+  std::deque<std::shared_ptr<CalibrationJob>> JobQueue;
+  int NumberOfIdleWorkerThreads{ 0 };
+  bool WorkerThreadsStopRequested{ false };
+};
+
+//----------------------------------------------------------------------------
+bool vtkSlicerPivotCalibrationLogic::vtkInternal::StartJob(std::shared_ptr<CalibrationJob> job, vtkMRMLTransformNode* outputTransformNode)
+{
+  if (outputTransformNode)
+  {
+    // Sync logic's matrix with the scene's matrix
+    outputTransformNode->GetMatrixTransformToParent(this->External->ToolTipToToolMatrix);
+  }
+  job->ToolTipToToolMatrix->DeepCopy(this->External->ToolTipToToolMatrix);
+  job->OutputTransformNode = outputTransformNode;
+
+  this->CurrentJob = job;
+  this->SubmitJob(job);
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerPivotCalibrationLogic::vtkInternal::CancelCurrentJob()
+{
+  if (!this->CurrentJob)
+  {
+    return;
+  }
+  std::shared_ptr<CalibrationJob> job = this->CurrentJob;
+  job->CancelRequested = true;
+  this->CurrentJob = nullptr;
+
+  if (this->RemoveQueuedJob(job))
+  {
+    this->ReturnJobPoses(job);
+  }
+  else
+  {
+    // The solver cannot be interrupted, the poses are given back when the worker thread is finished with the job
+    this->CancelledJobs.push_back(job);
+  }
+}
+
+//----------------------------------------------------------------------------
+bool vtkSlicerPivotCalibrationLogic::vtkInternal::RemoveQueuedJob(std::shared_ptr<CalibrationJob> job)
+{
+  std::lock_guard<std::mutex> lock(this->JobQueueMutex);
+  auto jobIt = std::find(this->JobQueue.begin(), this->JobQueue.end(), job);
+  if (jobIt == this->JobQueue.end())
+  {
+    return false;
+  }
+  this->JobQueue.erase(jobIt);
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool vtkSlicerPivotCalibrationLogic::vtkInternal::IsJobUsingPoses(int type)
+{
+  if (this->CurrentJob && this->CurrentJob->Type == type)
+  {
+    return true;
+  }
+  for (std::shared_ptr<CalibrationJob> job : this->CancelledJobs)
+  {
+    if (job->Type == type)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerPivotCalibrationLogic::vtkInternal::ReturnJobPoses(std::shared_ptr<CalibrationJob> job)
+{
+  vtkSlicerPivotCalibrationLogic* logic = this->External;
+  if (job->Type == CalibrationJob::PivotCalibration)
+  {
+    vtkSmartPointer<vtkIGSIOPivotCalibrationAlgo> algo = job->PivotCalibrationAlgo;
+    CopyCalibrationAlgoSettings<vtkIGSIOPivotCalibrationAlgo>(this->PivotCalibrationAlgo, algo);
+    algo->SetValidateInputBufferEnabled(logic->PivotAutoCalibrationEnabled);
+    for (vtkMatrix4x4* pose : this->PendingPivotPoses)
+    {
+      algo->InsertNextCalibrationPoint(pose);
+    }
+    this->PendingPivotPoses.clear();
+    this->PivotCalibrationAlgo = algo;
+  }
+  else
+  {
+    vtkSmartPointer<vtkIGSIOSpinCalibrationAlgo> algo = job->SpinCalibrationAlgo;
+    CopyCalibrationAlgoSettings<vtkIGSIOSpinCalibrationAlgo>(this->SpinCalibrationAlgo, algo);
+    algo->SetValidateInputBufferEnabled(logic->SpinAutoCalibrationEnabled);
+    for (vtkMatrix4x4* pose : this->PendingSpinPoses)
+    {
+      algo->InsertNextCalibrationPoint(pose);
+    }
+    this->PendingSpinPoses.clear();
+    this->SpinCalibrationAlgo = algo;
+  }
+  logic->UpdateMaximumCalibrationError();
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerPivotCalibrationLogic::vtkInternal::ProcessCancelledJobs(bool wait)
+{
+  for (auto jobIt = this->CancelledJobs.begin(); jobIt != this->CancelledJobs.end();)
+  {
+    std::shared_ptr<CalibrationJob> job = *jobIt;
+    while (wait && !job->Finished)
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    if (!job->Finished)
+    {
+      ++jobIt;
+      continue;
+    }
+    jobIt = this->CancelledJobs.erase(jobIt);
+    this->ReturnJobPoses(job);
+  }
+}
+
+//----------------------------------------------------------------------------
+std::shared_ptr<CalibrationSession> vtkSlicerPivotCalibrationLogic::vtkInternal::GetSession(vtkMRMLTransformNode* toolTransformNode)
+{
+  auto sessionIt = this->Sessions.find(toolTransformNode);
+  if (sessionIt == this->Sessions.end())
+  {
+    return nullptr;
+  }
+  return sessionIt->second;
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerPivotCalibrationLogic::vtkInternal::AddSessionToolToReferenceMatrix(std::shared_ptr<CalibrationSession> session, vtkMatrix4x4* toolToReferenceMatrix)
+{
+  vtkSlicerPivotCalibrationLogic* logic = this->External;
+
+  if (session->PivotCalibrationEnabled)
+  {
+    if (!session->PivotCalibrationAlgo)
+    {
+      // Algorithm is used by auto-calibration, add the pose when it is given back
+      vtkNew<vtkMatrix4x4> pose;
+      pose->DeepCopy(toolToReferenceMatrix);
+      session->PendingPivotPoses.push_back(pose.GetPointer());
+    }
+    else
+    {
+      session->PivotCalibrationAlgo->InsertNextCalibrationPoint(toolToReferenceMatrix);
+      if (this->GetSessionJobUsingPoses(session, CalibrationJob::PivotCalibration))
+      {
+        vtkNew<vtkMatrix4x4> pose;
+        pose->DeepCopy(toolToReferenceMatrix);
+        session->PendingPivotPoses.push_back(pose.GetPointer());
+      }
+      else if (logic->PivotAutoCalibrationEnabled && !session->CurrentJob
+        && session->PivotCalibrationAlgo->GetNumberOfCalibrationPoints() >= logic->PivotAutoCalibrationTargetNumberOfPoints)
+      {
+        std::shared_ptr<CalibrationJob> job = std::make_shared<CalibrationJob>();
+        job->Type = CalibrationJob::PivotCalibration;
+        job->AutoCalibration = true;
+        job->PivotCalibrationAlgo = session->PivotCalibrationAlgo;
+        session->PivotCalibrationAlgo = nullptr;
+        this->StartSessionJob(session, job, nullptr);
+      }
+    }
+  }
+
+  if (session->SpinCalibrationEnabled)
+  {
+    if (!session->SpinCalibrationAlgo)
+    {
+      // Algorithm is used by auto-calibration, add the pose when it is given back
+      vtkNew<vtkMatrix4x4> pose;
+      pose->DeepCopy(toolToReferenceMatrix);
+      session->PendingSpinPoses.push_back(pose.GetPointer());
+    }
+    else
+    {
+      session->SpinCalibrationAlgo->InsertNextCalibrationPoint(toolToReferenceMatrix);
+      if (this->GetSessionJobUsingPoses(session, CalibrationJob::SpinCalibration))
+      {
+        vtkNew<vtkMatrix4x4> pose;
+        pose->DeepCopy(toolToReferenceMatrix);
+        session->PendingSpinPoses.push_back(pose.GetPointer());
+      }
+      else if (logic->SpinAutoCalibrationEnabled && !session->CurrentJob
+        && session->SpinCalibrationAlgo->GetNumberOfCalibrationPoints() >= logic->SpinAutoCalibrationTargetNumberOfPoints)
+      {
+        std::shared_ptr<CalibrationJob> job = std::make_shared<CalibrationJob>();
+        job->Type = CalibrationJob::SpinCalibration;
+        job->AutoCalibration = true;
+        job->SpinCalibrationAlgo = session->SpinCalibrationAlgo;
+        session->SpinCalibrationAlgo = nullptr;
+        this->StartSessionJob(session, job, nullptr);
+      }
+    }
+  }
+}
+
+//----------------------------------------------------------------------------
+bool vtkSlicerPivotCalibrationLogic::vtkInternal::StartSessionJob(std::shared_ptr<CalibrationSession> session,
+  std::shared_ptr<CalibrationJob> job, vtkMRMLTransformNode* outputTransformNode)
+{
+  if (outputTransformNode)
+  {
+    outputTransformNode->GetMatrixTransformToParent(session->ToolTipToToolMatrix);
+  }
+  job->ToolTipToToolMatrix->DeepCopy(session->ToolTipToToolMatrix);
+  job->OutputTransformNode = outputTransformNode;
+  job->NumberOfPoses = (job->Type == CalibrationJob::PivotCalibration ?
+    job->PivotCalibrationAlgo->GetNumberOfCalibrationPoints() : job->SpinCalibrationAlgo->GetNumberOfCalibrationPoints());
+
+  session->CurrentJob = job;
+  this->SubmitJob(job);
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerPivotCalibrationLogic::vtkInternal::CancelSessionJob(std::shared_ptr<CalibrationSession> session)
+{
+  std::shared_ptr<CalibrationJob> job = session->CurrentJob;
+  if (!job)
+  {
+    return;
+  }
+  job->CancelRequested = true;
+  session->CurrentJob = nullptr;
+
+  if (this->RemoveQueuedJob(job))
+  {
+    this->ReturnSessionJobPoses(session, job);
+  }
+  else
+  {
+    // The solver cannot be interrupted, the poses are given back when the worker thread is finished with the job
+    session->CancelledJobs.push_back(job);
+  }
+}
+
+//----------------------------------------------------------------------------
+std::shared_ptr<CalibrationJob> vtkSlicerPivotCalibrationLogic::vtkInternal::GetSessionJobUsingPoses(std::shared_ptr<CalibrationSession> session, int type)
+{
+  if (session->CurrentJob && session->CurrentJob->Type == type)
+  {
+    return session->CurrentJob;
+  }
+  for (std::shared_ptr<CalibrationJob> job : session->CancelledJobs)
+  {
+    if (job->Type == type)
+    {
+      return job;
+    }
+  }
+  return nullptr;
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerPivotCalibrationLogic::vtkInternal::ReturnSessionJobPoses(std::shared_ptr<CalibrationSession> session, std::shared_ptr<CalibrationJob> job)
+{
+  // Poses of the job go first, the poses received in the meantime replace the pose buffer that was started for them
+  if (job->Type == CalibrationJob::PivotCalibration)
+  {
+    vtkSmartPointer<vtkIGSIOPivotCalibrationAlgo> algo = job->PivotCalibrationAlgo;
+    for (vtkMatrix4x4* pose : session->PendingPivotPoses)
+    {
+      algo->InsertNextCalibrationPoint(pose);
+    }
+    session->PendingPivotPoses.clear();
+    session->PivotCalibrationAlgo = algo;
+  }
+  else
+  {
+    vtkSmartPointer<vtkIGSIOSpinCalibrationAlgo> algo = job->SpinCalibrationAlgo;
+    for (vtkMatrix4x4* pose : session->PendingSpinPoses)
+    {
+      algo->InsertNextCalibrationPoint(pose);
+    }
+    session->PendingSpinPoses.clear();
+    session->SpinCalibrationAlgo = algo;
+  }
+  this->UpdateSessionCalibrationSettings(session);
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerPivotCalibrationLogic::vtkInternal::ProcessSessionCancelledJobs(std::shared_ptr<CalibrationSession> session, bool wait)
+{
+  for (auto jobIt = session->CancelledJobs.begin(); jobIt != session->CancelledJobs.end();)
+  {
+    std::shared_ptr<CalibrationJob> job = *jobIt;
+    while (wait && !job->Finished)
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    if (!job->Finished)
+    {
+      ++jobIt;
+      continue;
+    }
+    jobIt = session->CancelledJobs.erase(jobIt);
+    this->ReturnSessionJobPoses(session, job);
+  }
+}
+
+//----------------------------------------------------------------------------
+bool vtkSlicerPivotCalibrationLogic::vtkInternal::ProcessSessionJobResult(std::shared_ptr<CalibrationSession> session)
+{
+  vtkSlicerPivotCalibrationLogic* logic = this->External;
+
+  std::shared_ptr<CalibrationJob> job = session->CurrentJob;
+  if (!job || !job->Finished)
+  {
+    return false;
+  }
+  session->CurrentJob = nullptr;
+
+  bool pivot = (job->Type == CalibrationJob::PivotCalibration);
+  if (job->AutoCalibration || !job->Success)
+  {
+    // Auto-calibration keeps collecting into the same poses, and the poses of a failed calibration
+    // can be used for another calibration attempt
+    this->ReturnSessionJobPoses(session, job);
+  }
+  else if (pivot)
+  {
+    session->PendingPivotPoses.clear();
+  }
+  else
+  {
+    session->PendingSpinPoses.clear();
+  }
+
+  session->ErrorText = logic->GetErrorCodeAsString(job->ErrorCode);
+  double rmse = job->Success ? job->RMSE : -1.0;
+  if (pivot)
+  {
+    session->PivotRMSE = rmse;
+  }
+  else
+  {
+    session->SpinRMSE = rmse;
+  }
+
+  if (job->Success)
+  {
+    session->ToolTipToToolMatrix->DeepCopy(job->ToolTipToToolMatrix);
+    if (job->OutputTransformNode)
+    {
+      job->OutputTransformNode->SetMatrixTransformToParent(session->ToolTipToToolMatrix);
+    }
+  }
+
+  if (job->AutoCalibration)
+  {
+    double targetError = pivot ? logic->PivotAutoCalibrationTargetError : logic->SpinAutoCalibrationTargetError;
+    if (!job->Success || rmse > targetError)
+    {
+      // Keep collecting poses, calibration is retried when the next pose is added
+      return true;
+    }
+    if (pivot && logic->PivotAutoCalibrationStopWhenComplete)
+    {
+      session->PivotCalibrationEnabled = false;
+    }
+    else if (!pivot && logic->SpinAutoCalibrationStopWhenComplete)
+    {
+      session->SpinCalibrationEnabled = false;
+    }
+  }
+
+  logic->InvokeEvent(vtkSlicerPivotCalibrationLogic::CalibrationFinishedEvent, session->ToolTransformNode.GetPointer());
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerPivotCalibrationLogic::vtkInternal::ClearSessionToolToReferenceMatrices(std::shared_ptr<CalibrationSession> session, bool pivot, bool spin)
+{
+  // Algorithms that are used by a background calibration are not modified, a new pose buffer is started instead
+  if (pivot)
+  {
+    session->PivotCalibrationAlgo = CreateCalibrationAlgo<vtkIGSIOPivotCalibrationAlgo>(this->PivotCalibrationAlgo);
+    session->PendingPivotPoses.clear();
+  }
+  if (spin)
+  {
+    session->SpinCalibrationAlgo = CreateCalibrationAlgo<vtkIGSIOSpinCalibrationAlgo>(this->SpinCalibrationAlgo);
+    session->PendingSpinPoses.clear();
+  }
+  // Poses that were handed over to a calibration are kept, they are given back if the calibration is cancelled or fails.
+  // Auto-calibration uses the collected poses themselves, so its poses are discarded.
+  auto isClearedAutoCalibration = [pivot, spin](std::shared_ptr<CalibrationJob> job)
+  {
+    return job->AutoCalibration
+      && ((pivot && job->Type == CalibrationJob::PivotCalibration) || (spin && job->Type == CalibrationJob::SpinCalibration));
+  };
+  if (session->CurrentJob && isClearedAutoCalibration(session->CurrentJob))
+  {
+    // Auto-calibration result of the discarded poses is no longer relevant
+    session->CurrentJob->CancelRequested = true;
+    session->CurrentJob = nullptr;
+  }
+  session->CancelledJobs.erase(std::remove_if(session->CancelledJobs.begin(), session->CancelledJobs.end(), isClearedAutoCalibration),
+    session->CancelledJobs.end());
+  this->UpdateSessionCalibrationSettings(session);
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerPivotCalibrationLogic::vtkInternal::UpdateSessionCalibrationSettings(std::shared_ptr<CalibrationSession> session)
+{
+  vtkSlicerPivotCalibrationLogic* logic = this->External;
+  if (session->PivotCalibrationAlgo)
+  {
+    CopyCalibrationAlgoSettings<vtkIGSIOPivotCalibrationAlgo>(this->PivotCalibrationAlgo, session->PivotCalibrationAlgo);
+    session->PivotCalibrationAlgo->SetValidateInputBufferEnabled(logic->PivotAutoCalibrationEnabled);
+    session->PivotCalibrationAlgo->SetMaximumCalibrationErrorMm(logic->PivotAutoCalibrationEnabled ? logic->PivotAutoCalibrationTargetError : -1.0);
+  }
+  if (session->SpinCalibrationAlgo)
+  {
+    CopyCalibrationAlgoSettings<vtkIGSIOSpinCalibrationAlgo>(this->SpinCalibrationAlgo, session->SpinCalibrationAlgo);
+    session->SpinCalibrationAlgo->SetValidateInputBufferEnabled(logic->SpinAutoCalibrationEnabled);
+    session->SpinCalibrationAlgo->SetMaximumCalibrationErrorMm(logic->SpinAutoCalibrationEnabled ? logic->SpinAutoCalibrationTargetError : -1.0);
+  }
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerPivotCalibrationLogic::vtkInternal::UpdateSessionsCalibrationSettings()
+{
+  for (auto sessionIt : this->Sessions)
+  {
+    this->UpdateSessionCalibrationSettings(sessionIt.second);
+  }
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerPivotCalibrationLogic::vtkInternal::SubmitJob(std::shared_ptr<CalibrationJob> job)
+{
+  std::lock_guard<std::mutex> lock(this->JobQueueMutex);
+  this->JobQueue.push_back(job);
+  if (this->NumberOfIdleWorkerThreads < static_cast<int>(this->JobQueue.size())
+    && static_cast<int>(this->WorkerThreads.size()) < std::max(1, this->External->MaximumNumberOfCalibrationThreads))
+  {
+    this->WorkerThreads.push_back(std::thread(&vtkInternal::WorkerThreadMain, this));
+  }
+  this->JobQueueCondition.notify_one();
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerPivotCalibrationLogic::vtkInternal::StopWorkerThreads()
+{
   {
-    this->External = external;
+    std::lock_guard<std::mutex> lock(this->JobQueueMutex);
+    this->WorkerThreadsStopRequested = true;
+  }
+  this->JobQueueCondition.notify_all();
+  for (std::thread& workerThread : this->WorkerThreads)
+  {
+    workerThread.join();
   }
-  ~vtkInternal() = default;
+  this->WorkerThreads.clear();
+}
 
-  vtkSlicerPivotCalibrationLogic* External;
-  vtkNew<vtkIGSIOPivotCalibrationAlgo> PivotCalibrationAlgo;
-  vtkNew<vtkIGSIOSpinCalibrationAlgo> SpinCalibrationAlgo;
-};
+//----------------------------------------------------------------------------
+void vtkSlicerPivotCalibrationLogic::vtkInternal::WorkerThreadMain()
+{
+  std::unique_lock<std::mutex> lock(this->JobQueueMutex);
+  while (true)
+  {
+    ++this->NumberOfIdleWorkerThreads;
+    this->JobQueueCondition.wait(lock, [this] { return this->WorkerThreadsStopRequested || !this->JobQueue.empty(); });
+    --this->NumberOfIdleWorkerThreads;
+    if (this->JobQueue.empty())
+    {
+      // Stop requested and there are no more jobs to process
+      return;
+    }
+    std::shared_ptr<CalibrationJob> job = this->JobQueue.front();
+    this->JobQueue.pop_front();
+
+    lock.unlock();
+    job->Run();
+    lock.lock();
+  }
+}
 
 //----------------------------------------------------------------------------
 vtkStandardNewMacro(vtkSlicerPivotCalibrationLogic);
@@ -89,6 +808,7 @@ vtkSlicerPivotCalibrationLogic::vtkSlicerPivotCalibrationLogic()
 //----------------------------------------------------------------------------
 vtkSlicerPivotCalibrationLogic::~vtkSlicerPivotCalibrationLogic()
 {
+  this->RemoveAllCalibrationSessions();
   delete this->Internal;
   this->ToolTipToToolMatrix->Delete();
   this->SetAndObserveTransformNode(NULL); // Remove the observer
@@ -103,23 +823,33 @@ void vtkSlicerPivotCalibrationLogic::PrintSelf(ostream& os, vtkIndent indent)
 //---------------------------------------------------------------------------
 void vtkSlicerPivotCalibrationLogic::ProcessMRMLNodesEvents(vtkObject* caller, unsigned long event, void* vtkNotUsed(callData))
 {
-  if (caller != NULL)
+  vtkMRMLTransformNode* transformNode = vtkMRMLTransformNode::SafeDownCast(caller);
+  if (transformNode && event == vtkMRMLTransformNode::TransformModifiedEvent && this->RecordingState == true)
   {
-    vtkMRMLTransformNode* transformNode = vtkMRMLTransformNode::SafeDownCast(caller);
-    if (event == vtkMRMLTransformNode::TransformModifiedEvent && this->RecordingState == true && strcmp(transformNode->GetID(), this->ObservedTransformNode->GetID()) == 0)
+    std::shared_ptr<CalibrationSession> session = this->Internal->GetSession(transformNode);
+    if (transformNode != this->ObservedTransformNode && !session)
     {
-      const char* toolValidValue = transformNode->GetAttribute(TOOL_VALID_ATTRIBUTE_NAME);
-      // If the attribute is not present, assume the tool is valid.
-      if (toolValidValue && strcmp(toolValidValue, "1") != 0)
-      {
-        // Tool is not valid, do not use it for calibration
-        return;
-      }
+      return;
+    }
+
+    const char* toolValidValue = transformNode->GetAttribute(TOOL_VALID_ATTRIBUTE_NAME);
+    // If the attribute is not present, assume the tool is valid.
+    if (toolValidValue && strcmp(toolValidValue, "1") != 0)
+    {
+      // Tool is not valid, do not use it for calibration
+      return;
+    }
 
-      vtkNew<vtkMatrix4x4> toolToReferenceMatrix;
-      transformNode->GetMatrixTransformToParent(toolToReferenceMatrix);
+    vtkNew<vtkMatrix4x4> toolToReferenceMatrix;
+    transformNode->GetMatrixTransformToParent(toolToReferenceMatrix);
+    if (transformNode == this->ObservedTransformNode)
+    {
       this->AddToolToReferenceMatrix(toolToReferenceMatrix);
     }
+    if (session)
+    {
+      this->Internal->AddSessionToolToReferenceMatrix(session, toolToReferenceMatrix);
+    }
   }
 }
 
@@ -130,11 +860,296 @@ void vtkSlicerPivotCalibrationLogic::SetAndObserveTransformNode(vtkMRMLTransform
   {
     return;
   }
+  if (transformNode && this->Internal->GetSession(transformNode))
+  {
+    vtkErrorMacro("SetAndObserveTransformNode failed: the transform is already calibrated in a calibration session");
+    return;
+  }
   vtkNew<vtkIntArray> events;
   events->InsertNextValue(vtkMRMLTransformNode::TransformModifiedEvent);
   vtkSetAndObserveMRMLNodeEventsMacro(this->ObservedTransformNode, transformNode, events.GetPointer());
 }
 
+//---------------------------------------------------------------------------
+void vtkSlicerPivotCalibrationLogic::AddCalibrationSession(vtkMRMLTransformNode* toolTransformNode)
+{
+  if (!toolTransformNode)
+  {
+    vtkErrorMacro("AddCalibrationSession failed: invalid tool transform node");
+    return;
+  }
+  if (this->Internal->GetSession(toolTransformNode))
+  {
+    return;
+  }
+  if (toolTransformNode == this->ObservedTransformNode)
+  {
+    vtkErrorMacro("AddCalibrationSession failed: the transform is already calibrated as the observed transform node");
+    return;
+  }
+
+  std::shared_ptr<CalibrationSession> session = std::make_shared<CalibrationSession>();
+  session->ToolTransformNode = toolTransformNode;
+  session->PivotCalibrationAlgo = vtkInternal::CreateCalibrationAlgo<vtkIGSIOPivotCalibrationAlgo>(this->Internal->PivotCalibrationAlgo);
+  session->SpinCalibrationAlgo = vtkInternal::CreateCalibrationAlgo<vtkIGSIOSpinCalibrationAlgo>(this->Internal->SpinCalibrationAlgo);
+  this->Internal->UpdateSessionCalibrationSettings(session);
+  this->Internal->Sessions[toolTransformNode] = session;
+
+  vtkNew<vtkIntArray> events;
+  events->InsertNextValue(vtkMRMLTransformNode::TransformModifiedEvent);
+  vtkObserveMRMLNodeEventsMacro(toolTransformNode, events.GetPointer());
+}
+
+//---------------------------------------------------------------------------
+void vtkSlicerPivotCalibrationLogic::RemoveCalibrationSession(vtkMRMLTransformNode* toolTransformNode)
+{
+  std::shared_ptr<CalibrationSession> session = this->Internal->GetSession(toolTransformNode);
+  if (!session)
+  {
+    return;
+  }
+  this->Internal->CancelSessionJob(session);
+  vtkUnObserveMRMLNodeMacro(toolTransformNode);
+  this->Internal->Sessions.erase(toolTransformNode);
+}
+
+//---------------------------------------------------------------------------
+void vtkSlicerPivotCalibrationLogic::RemoveAllCalibrationSessions()
+{
+  while (!this->Internal->Sessions.empty())
+  {
+    this->RemoveCalibrationSession(this->Internal->Sessions.begin()->first);
+  }
+}
+
+//---------------------------------------------------------------------------
+int vtkSlicerPivotCalibrationLogic::GetNumberOfCalibrationSessions()
+{
+  return static_cast<int>(this->Internal->Sessions.size());
+}
+
+//---------------------------------------------------------------------------
+vtkMRMLTransformNode* vtkSlicerPivotCalibrationLogic::GetNthCalibrationSessionToolTransformNode(int n)
+{
+  if (n < 0 || n >= this->GetNumberOfCalibrationSessions())
+  {
+    vtkErrorMacro("GetNthCalibrationSessionToolTransformNode failed: invalid index " << n);
+    return nullptr;
+  }
+  auto sessionIt = this->Internal->Sessions.begin();
+  std::advance(sessionIt, n);
+  return sessionIt->first;
+}
+
+//---------------------------------------------------------------------------
+void vtkSlicerPivotCalibrationLogic::ClearSessionToolToReferenceMatrices(vtkMRMLTransformNode* toolTransformNode)
+{
+  std::shared_ptr<CalibrationSession> session = this->Internal->GetSession(toolTransformNode);
+  if (!session)
+  {
+    vtkErrorMacro("ClearSessionToolToReferenceMatrices failed: no calibration session for the tool");
+    return;
+  }
+  this->Internal->ClearSessionToolToReferenceMatrices(session, true, true);
+}
+
+//---------------------------------------------------------------------------
+int vtkSlicerPivotCalibrationLogic::GetSessionPivotNumberOfPoses(vtkMRMLTransformNode* toolTransformNode)
+{
+  std::shared_ptr<CalibrationSession> session = this->Internal->GetSession(toolTransformNode);
+  if (!session)
+  {
+    return 0;
+  }
+  if (!session->PivotCalibrationAlgo)
+  {
+    // Poses are used by auto-calibration
+    std::shared_ptr<CalibrationJob> job = this->Internal->GetSessionJobUsingPoses(session, CalibrationJob::PivotCalibration);
+    return (job ? job->NumberOfPoses : 0) + static_cast<int>(session->PendingPivotPoses.size());
+  }
+  return session->PivotCalibrationAlgo->GetNumberOfCalibrationPoints();
+}
+
+//---------------------------------------------------------------------------
+int vtkSlicerPivotCalibrationLogic::GetSessionSpinNumberOfPoses(vtkMRMLTransformNode* toolTransformNode)
+{
+  std::shared_ptr<CalibrationSession> session = this->Internal->GetSession(toolTransformNode);
+  if (!session)
+  {
+    return 0;
+  }
+  if (!session->SpinCalibrationAlgo)
+  {
+    // Poses are used by auto-calibration
+    std::shared_ptr<CalibrationJob> job = this->Internal->GetSessionJobUsingPoses(session, CalibrationJob::SpinCalibration);
+    return (job ? job->NumberOfPoses : 0) + static_cast<int>(session->PendingSpinPoses.size());
+  }
+  return session->SpinCalibrationAlgo->GetNumberOfCalibrationPoints();
+}
+
+//---------------------------------------------------------------------------
+void vtkSlicerPivotCalibrationLogic::SetSessionPivotCalibrationEnabled(vtkMRMLTransformNode* toolTransformNode, bool enabled)
+{
+  std::shared_ptr<CalibrationSession> session = this->Internal->GetSession(toolTransformNode);
+  if (!session)
+  {
+    vtkErrorMacro("SetSessionPivotCalibrationEnabled failed: no calibration session for the tool");
+    return;
+  }
+  session->PivotCalibrationEnabled = enabled;
+}
+
+//---------------------------------------------------------------------------
+bool vtkSlicerPivotCalibrationLogic::GetSessionPivotCalibrationEnabled(vtkMRMLTransformNode* toolTransformNode)
+{
+  std::shared_ptr<CalibrationSession> session = this->Internal->GetSession(toolTransformNode);
+  return session && session->PivotCalibrationEnabled;
+}
+
+//---------------------------------------------------------------------------
+void vtkSlicerPivotCalibrationLogic::SetSessionSpinCalibrationEnabled(vtkMRMLTransformNode* toolTransformNode, bool enabled)
+{
+  std::shared_ptr<CalibrationSession> session = this->Internal->GetSession(toolTransformNode);
+  if (!session)
+  {
+    vtkErrorMacro("SetSessionSpinCalibrationEnabled failed: no calibration session for the tool");
+    return;
+  }
+  session->SpinCalibrationEnabled = enabled;
+}
+
+//---------------------------------------------------------------------------
+bool vtkSlicerPivotCalibrationLogic::GetSessionSpinCalibrationEnabled(vtkMRMLTransformNode* toolTransformNode)
+{
+  std::shared_ptr<CalibrationSession> session = this->Internal->GetSession(toolTransformNode);
+  return session && session->SpinCalibrationEnabled;
+}
+
+//---------------------------------------------------------------------------
+bool vtkSlicerPivotCalibrationLogic::StartSessionPivotCalibration(vtkMRMLTransformNode* toolTransformNode,
+  vtkMRMLTransformNode* outputTransformNode/*=nullptr*/, bool autoOrient/*=true*/)
+{
+  std::shared_ptr<CalibrationSession> session = this->Internal->GetSession(toolTransformNode);
+  if (!session)
+  {
+    vtkErrorMacro("StartSessionPivotCalibration failed: no calibration session for the tool");
+    return false;
+  }
+  if (session->CurrentJob)
+  {
+    vtkErrorMacro("StartSessionPivotCalibration failed: a calibration is already running for the tool");
+    return false;
+  }
+  // Poses of a cancelled calibration must be given back before the collected poses are handed over again
+  this->Internal->ProcessSessionCancelledJobs(session, true);
+
+  std::shared_ptr<CalibrationJob> job = std::make_shared<CalibrationJob>();
+  job->Type = CalibrationJob::PivotCalibration;
+  job->AutoOrient = autoOrient;
+
+  // Hand over the collected poses to the calibration and continue collecting poses into a new buffer
+  job->PivotCalibrationAlgo = session->PivotCalibrationAlgo;
+  session->PivotCalibrationAlgo = vtkInternal::CreateCalibrationAlgo<vtkIGSIOPivotCalibrationAlgo>(job->PivotCalibrationAlgo);
+  this->Internal->UpdateSessionCalibrationSettings(session);
+
+  return this->Internal->StartSessionJob(session, job, outputTransformNode);
+}
+
+//---------------------------------------------------------------------------
+bool vtkSlicerPivotCalibrationLogic::StartSessionSpinCalibration(vtkMRMLTransformNode* toolTransformNode,
+  vtkMRMLTransformNode* outputTransformNode/*=nullptr*/, bool snapRotation/*=false*/, bool autoOrient/*=true*/)
+{
+  std::shared_ptr<CalibrationSession> session = this->Internal->GetSession(toolTransformNode);
+  if (!session)
+  {
+    vtkErrorMacro("StartSessionSpinCalibration failed: no calibration session for the tool");
+    return false;
+  }
+  if (session->CurrentJob)
+  {
+    vtkErrorMacro("StartSessionSpinCalibration failed: a calibration is already running for the tool");
+    return false;
+  }
+  // Poses of a cancelled calibration must be given back before the collected poses are handed over again
+  this->Internal->ProcessSessionCancelledJobs(session, true);
+
+  std::shared_ptr<CalibrationJob> job = std::make_shared<CalibrationJob>();
+  job->Type = CalibrationJob::SpinCalibration;
+  job->SnapRotation = snapRotation;
+  job->AutoOrient = autoOrient;
+
+  // Hand over the collected poses to the calibration and continue collecting poses into a new buffer
+  job->SpinCalibrationAlgo = session->SpinCalibrationAlgo;
+  session->SpinCalibrationAlgo = vtkInternal::CreateCalibrationAlgo<vtkIGSIOSpinCalibrationAlgo>(job->SpinCalibrationAlgo);
+  this->Internal->UpdateSessionCalibrationSettings(session);
+
+  return this->Internal->StartSessionJob(session, job, outputTransformNode);
+}
+
+//---------------------------------------------------------------------------
+void vtkSlicerPivotCalibrationLogic::CancelSessionCalibration(vtkMRMLTransformNode* toolTransformNode)
+{
+  std::shared_ptr<CalibrationSession> session = this->Internal->GetSession(toolTransformNode);
+  if (!session)
+  {
+    return;
+  }
+  this->Internal->CancelSessionJob(session);
+}
+
+//---------------------------------------------------------------------------
+bool vtkSlicerPivotCalibrationLogic::GetSessionCalibrationRunning(vtkMRMLTransformNode* toolTransformNode)
+{
+  std::shared_ptr<CalibrationSession> session = this->Internal->GetSession(toolTransformNode);
+  return session && session->CurrentJob;
+}
+
+//---------------------------------------------------------------------------
+double vtkSlicerPivotCalibrationLogic::GetSessionCalibrationProgress(vtkMRMLTransformNode* toolTransformNode)
+{
+  std::shared_ptr<CalibrationSession> session = this->Internal->GetSession(toolTransformNode);
+  if (!session || !session->CurrentJob)
+  {
+    return 0.0;
+  }
+  std::lock_guard<std::mutex> lock(session->CurrentJob->Mutex);
+  return session->CurrentJob->Progress;
+}
+
+//---------------------------------------------------------------------------
+bool vtkSlicerPivotCalibrationLogic::GetSessionToolTipToToolMatrix(vtkMRMLTransformNode* toolTransformNode, vtkMatrix4x4* matrix)
+{
+  std::shared_ptr<CalibrationSession> session = this->Internal->GetSession(toolTransformNode);
+  if (!session || !matrix)
+  {
+    vtkErrorMacro("GetSessionToolTipToToolMatrix failed: no calibration session for the tool or invalid matrix");
+    return false;
+  }
+  matrix->DeepCopy(session->ToolTipToToolMatrix);
+  return true;
+}
+
+//---------------------------------------------------------------------------
+double vtkSlicerPivotCalibrationLogic::GetSessionPivotRMSE(vtkMRMLTransformNode* toolTransformNode)
+{
+  std::shared_ptr<CalibrationSession> session = this->Internal->GetSession(toolTransformNode);
+  return session ? session->PivotRMSE : -1.0;
+}
+
+//---------------------------------------------------------------------------
+double vtkSlicerPivotCalibrationLogic::GetSessionSpinRMSE(vtkMRMLTransformNode* toolTransformNode)
+{
+  std::shared_ptr<CalibrationSession> session = this->Internal->GetSession(toolTransformNode);
+  return session ? session->SpinRMSE : -1.0;
+}
+
+//---------------------------------------------------------------------------
+std::string vtkSlicerPivotCalibrationLogic::GetSessionErrorText(vtkMRMLTransformNode* toolTransformNode)
+{
+  std::shared_ptr<CalibrationSession> session = this->Internal->GetSession(toolTransformNode);
+  return session ? session->ErrorText : std::string();
+}
+
 //---------------------------------------------------------------------------
 void vtkSlicerPivotCalibrationLogic::AddToolToReferenceMatrix(vtkMatrix4x4* transformMatrix)
 {
@@ -147,6 +1162,12 @@ void vtkSlicerPivotCalibrationLogic::AddToolToReferenceMatrix(vtkMatrix4x4* tran
   if (this->PivotCalibrationEnabled)
   {
     this->Internal->PivotCalibrationAlgo->InsertNextCalibrationPoint(transformMatrix);
+    if (this->Internal->IsJobUsingPoses(CalibrationJob::PivotCalibration))
+    {
+      vtkSmartPointer<vtkMatrix4x4> pose = vtkSmartPointer<vtkMatrix4x4>::New();
+      pose->DeepCopy(transformMatrix);
+      this->Internal->PendingPivotPoses.push_back(pose);
+    }
     this->InvokeEvent(PivotInputTransformAdded);
     if (this->PivotAutoCalibrationEnabled && this->GetPivotNumberOfPoses() >= this->PivotAutoCalibrationTargetNumberOfPoints)
     {
@@ -172,6 +1193,12 @@ void vtkSlicerPivotCalibrationLogic::AddToolToReferenceMatrix(vtkMatrix4x4* tran
   if (this->SpinCalibrationEnabled)
   {
     this->Internal->SpinCalibrationAlgo->InsertNextCalibrationPoint(transformMatrix);
+    if (this->Internal->IsJobUsingPoses(CalibrationJob::SpinCalibration))
+    {
+      vtkSmartPointer<vtkMatrix4x4> pose = vtkSmartPointer<vtkMatrix4x4>::New();
+      pose->DeepCopy(transformMatrix);
+      this->Internal->PendingSpinPoses.push_back(pose);
+    }
     this->InvokeEvent(vtkSlicerPivotCalibrationLogic::SpinInputTransformAdded);
     if (this->SpinAutoCalibrationEnabled && this->GetSpinNumberOfPoses() >= this->SpinAutoCalibrationTargetNumberOfPoints)
     {
@@ -201,32 +1228,35 @@ void vtkSlicerPivotCalibrationLogic::AddToolToReferenceMatrix(vtkMatrix4x4* tran
 //---------------------------------------------------------------------------
 void vtkSlicerPivotCalibrationLogic::ClearToolToReferenceMatrices()
 {
-  this->Internal->PivotCalibrationAlgo->RemoveAllCalibrationPoints();
-  this->Internal->SpinCalibrationAlgo->RemoveAllCalibrationPoints();
+  this->ClearPivotToolToReferenceMatrices();
+  this->ClearSpinToolToReferenceMatrices();
 }
 
 //---------------------------------------------------------------------------
 void vtkSlicerPivotCalibrationLogic::ClearPivotToolToReferenceMatrices()
 {
+  // Poses that were handed over to a running calibration are kept, they are given back if the calibration is cancelled or fails
   this->Internal->PivotCalibrationAlgo->RemoveAllCalibrationPoints();
+  this->Internal->PendingPivotPoses.clear();
 }
 
 //---------------------------------------------------------------------------
 void vtkSlicerPivotCalibrationLogic::ClearSpinToolToReferenceMatrices()
 {
   this->Internal->SpinCalibrationAlgo->RemoveAllCalibrationPoints();
+  this->Internal->PendingSpinPoses.clear();
 }
 
 //---------------------------------------------------------------------------
 int vtkSlicerPivotCalibrationLogic::GetPivotErrorCode()
 {
-  return this->Internal->PivotCalibrationAlgo->GetErrorCode();
+  return this->Internal->PivotErrorCode;
 }
 
 //---------------------------------------------------------------------------
 int vtkSlicerPivotCalibrationLogic::GetSpinErrorCode()
 {
-  return this->Internal->SpinCalibrationAlgo->GetErrorCode();
+  return this->Internal->SpinErrorCode;
 }
 
 //---------------------------------------------------------------------------
@@ -263,6 +1293,7 @@ bool vtkSlicerPivotCalibrationLogic::ComputePivotCalibration(bool autoOrient /*=
   this->Internal->PivotCalibrationAlgo->SetPivotPointToMarkerTransformMatrix(toolTipToToolMatrix);
 
   bool success = this->Internal->PivotCalibrationAlgo->DoPivotCalibration(nullptr, autoOrient) == IGSIO_SUCCESS;
+  this->Internal->PivotErrorCode = this->Internal->PivotCalibrationAlgo->GetErrorCode();
   this->ErrorText = this->GetErrorCodeAsString(this->GetPivotErrorCode());
 
   if (!success)
@@ -290,6 +1321,7 @@ bool vtkSlicerPivotCalibrationLogic::ComputeSpinCalibration(bool snapRotation /*
   this->Internal->SpinCalibrationAlgo->SetPivotPointToMarkerTransformMatrix(toolTipToToolMatrix);
 
   bool success = this->Internal->SpinCalibrationAlgo->DoSpinCalibration(nullptr, snapRotation, autoOrient) == IGSIO_SUCCESS;
+  this->Internal->SpinErrorCode = this->Internal->SpinCalibrationAlgo->GetErrorCode();
   this->ErrorText = this->GetErrorCodeAsString(this->GetSpinErrorCode());
 
   if (!success)
@@ -309,6 +1341,163 @@ bool vtkSlicerPivotCalibrationLogic::ComputeSpinCalibration(bool snapRotation /*
   return true;
 }
 
+//---------------------------------------------------------------------------
+bool vtkSlicerPivotCalibrationLogic::StartPivotCalibration(vtkMRMLTransformNode* outputTransformNode/*=nullptr*/, bool autoOrient/*=true*/)
+{
+  if (this->Internal->CurrentJob)
+  {
+    vtkErrorMacro("StartPivotCalibration failed: a calibration is already running");
+    return false;
+  }
+  // Poses of a cancelled calibration must be given back before the collected poses are handed over again
+  this->Internal->ProcessCancelledJobs(true);
+
+  std::shared_ptr<CalibrationJob> job = std::make_shared<CalibrationJob>();
+  job->Type = CalibrationJob::PivotCalibration;
+  job->AutoOrient = autoOrient;
+
+  // Hand over the collected poses to the calibration and continue collecting poses into a new buffer
+  job->PivotCalibrationAlgo = this->Internal->PivotCalibrationAlgo;
+  this->Internal->PivotCalibrationAlgo = vtkInternal::CreateCalibrationAlgo<vtkIGSIOPivotCalibrationAlgo>(job->PivotCalibrationAlgo);
+  this->Internal->PivotCalibrationAlgo->SetValidateInputBufferEnabled(this->PivotAutoCalibrationEnabled);
+  this->UpdateMaximumCalibrationError();
+
+  return this->Internal->StartJob(job, outputTransformNode);
+}
+
+//---------------------------------------------------------------------------
+bool vtkSlicerPivotCalibrationLogic::StartSpinCalibration(vtkMRMLTransformNode* outputTransformNode/*=nullptr*/, bool snapRotation/*=false*/, bool autoOrient/*=true*/)
+{
+  if (this->Internal->CurrentJob)
+  {
+    vtkErrorMacro("StartSpinCalibration failed: a calibration is already running");
+    return false;
+  }
+  // Poses of a cancelled calibration must be given back before the collected poses are handed over again
+  this->Internal->ProcessCancelledJobs(true);
+
+  std::shared_ptr<CalibrationJob> job = std::make_shared<CalibrationJob>();
+  job->Type = CalibrationJob::SpinCalibration;
+  job->SnapRotation = snapRotation;
+  job->AutoOrient = autoOrient;
+
+  // Hand over the collected poses to the calibration and continue collecting poses into a new buffer
+  job->SpinCalibrationAlgo = this->Internal->SpinCalibrationAlgo;
+  this->Internal->SpinCalibrationAlgo = vtkInternal::CreateCalibrationAlgo<vtkIGSIOSpinCalibrationAlgo>(job->SpinCalibrationAlgo);
+  this->Internal->SpinCalibrationAlgo->SetValidateInputBufferEnabled(this->SpinAutoCalibrationEnabled);
+  this->UpdateMaximumCalibrationError();
+
+  return this->Internal->StartJob(job, outputTransformNode);
+}
+
+//---------------------------------------------------------------------------
+void vtkSlicerPivotCalibrationLogic::CancelCalibration()
+{
+  this->Internal->CancelCurrentJob();
+}
+
+//---------------------------------------------------------------------------
+bool vtkSlicerPivotCalibrationLogic::GetCalibrationRunning()
+{
+  return this->Internal->CurrentJob != nullptr;
+}
+
+//---------------------------------------------------------------------------
+double vtkSlicerPivotCalibrationLogic::GetCalibrationProgress()
+{
+  std::shared_ptr<CalibrationJob> job = this->Internal->CurrentJob;
+  if (!job)
+  {
+    return 0.0;
+  }
+  std::lock_guard<std::mutex> lock(job->Mutex);
+  return job->Progress;
+}
+
+//---------------------------------------------------------------------------
+double vtkSlicerPivotCalibrationLogic::GetCalibrationIntermediateRMSE()
+{
+  std::shared_ptr<CalibrationJob> job = this->Internal->CurrentJob;
+  if (!job)
+  {
+    return -1.0;
+  }
+  std::lock_guard<std::mutex> lock(job->Mutex);
+  return job->RMSE;
+}
+
+//---------------------------------------------------------------------------
+bool vtkSlicerPivotCalibrationLogic::ProcessCalibrationResult()
+{
+  this->Internal->ProcessCancelledJobs(false);
+
+  bool sessionResultProcessed = false;
+  std::vector<std::shared_ptr<CalibrationSession>> sessions;
+  for (auto sessionIt : this->Internal->Sessions)
+  {
+    sessions.push_back(sessionIt.second);
+  }
+  for (std::shared_ptr<CalibrationSession> session : sessions)
+  {
+    // Observers of CalibrationFinishedEvent may remove sessions
+    if (this->Internal->GetSession(session->ToolTransformNode) != session)
+    {
+      continue;
+    }
+    this->Internal->ProcessSessionCancelledJobs(session, false);
+    if (this->Internal->ProcessSessionJobResult(session))
+    {
+      sessionResultProcessed = true;
+    }
+  }
+
+  std::shared_ptr<CalibrationJob> job = this->Internal->CurrentJob;
+  if (!job || !job->Finished)
+  {
+    return sessionResultProcessed;
+  }
+  this->Internal->CurrentJob = nullptr;
+
+  this->ErrorText = this->GetErrorCodeAsString(job->ErrorCode);
+  double rmse = job->Success ? job->RMSE : -1.0;
+  if (job->Type == CalibrationJob::PivotCalibration)
+  {
+    this->Internal->PivotErrorCode = job->ErrorCode;
+    this->SetPivotRMSE(rmse);
+  }
+  else
+  {
+    this->Internal->SpinErrorCode = job->ErrorCode;
+    this->SetSpinRMSE(rmse);
+  }
+
+  if (!job->Success)
+  {
+    vtkErrorMacro("ProcessCalibrationResult: " << this->GetErrorText());
+    // The poses can be used for another calibration attempt
+    this->Internal->ReturnJobPoses(job);
+  }
+  else
+  {
+    if (job->Type == CalibrationJob::PivotCalibration)
+    {
+      this->Internal->PendingPivotPoses.clear();
+    }
+    else
+    {
+      this->Internal->PendingSpinPoses.clear();
+    }
+    this->ToolTipToToolMatrix->DeepCopy(job->ToolTipToToolMatrix);
+    if (job->OutputTransformNode)
+    {
+      job->OutputTransformNode->SetMatrixTransformToParent(this->ToolTipToToolMatrix);
+    }
+  }
+
+  this->InvokeEvent(vtkSlicerPivotCalibrationLogic::CalibrationFinishedEvent);
+  return true;
+}
+
 //---------------------------------------------------------------------------
 void vtkSlicerPivotCalibrationLogic::GetToolTipToToolTranslation(vtkMatrix4x4* translationMatrix)
 {
@@ -395,6 +1584,7 @@ double vtkSlicerPivotCalibrationLogic::GetPivotMinimumOrientationDifferenceDegre
 void vtkSlicerPivotCalibrationLogic::SetPivotMinimumOrientationDifferenceDegrees(double minimumOrientationDifferenceDegrees)
 {
   this->Internal->PivotCalibrationAlgo->SetMinimumOrientationDifferenceDegrees(minimumOrientationDifferenceDegrees);
+  this->Internal->UpdateSessionsCalibrationSettings();
 }
 
 //---------------------------------------------------------------------------
@@ -426,6 +1616,7 @@ void vtkSlicerPivotCalibrationLogic::UpdateMaximumCalibrationError()
 {
   this->Internal->PivotCalibrationAlgo->SetMaximumCalibrationErrorMm(this->PivotAutoCalibrationEnabled ? this->PivotAutoCalibrationTargetError : -1.0);
   this->Internal->SpinCalibrationAlgo->SetMaximumCalibrationErrorMm(this->SpinAutoCalibrationEnabled ? this->SpinAutoCalibrationTargetError : -1.0);
+  this->Internal->UpdateSessionsCalibrationSettings();
 }
 
 //---------------------------------------------------------------------------
@@ -438,6 +1629,7 @@ int vtkSlicerPivotCalibrationLogic::GetPivotPoseBucketSize()
 void vtkSlicerPivotCalibrationLogic::SetPivotPoseBucketSize(int bucketSize)
 {
   this->Internal->PivotCalibrationAlgo->SetPoseBucketSize(bucketSize);
+  this->Internal->UpdateSessionsCalibrationSettings();
 }
 
 //---------------------------------------------------------------------------
@@ -450,6 +1642,7 @@ int vtkSlicerPivotCalibrationLogic::GetPivotMaximumNumberOfPoseBuckets()
 void vtkSlicerPivotCalibrationLogic::SetPivotMaximumNumberOfPoseBuckets(int bucketSize)
 {
   this->Internal->PivotCalibrationAlgo->SetMaximumNumberOfPoseBuckets(bucketSize);
+  this->Internal->UpdateSessionsCalibrationSettings();
 }
 
 //---------------------------------------------------------------------------
@@ -462,6 +1655,7 @@ double vtkSlicerPivotCalibrationLogic::GetPivotMaximumPoseBucketError()
 void vtkSlicerPivotCalibrationLogic::SetPivotMaximumPoseBucketError(double maximumBucketError)
 {
   this->Internal->PivotCalibrationAlgo->SetMaximumPoseBucketError(maximumBucketError);
+  this->Internal->UpdateSessionsCalibrationSettings();
 }
 
 //-----------------------------------------------------------------------------
@@ -474,6 +1668,7 @@ double vtkSlicerPivotCalibrationLogic::GetPivotPositionDifferenceThresholdMm()
 void vtkSlicerPivotCalibrationLogic::SetPivotPositionDifferenceThresholdMm(double thresholdMM)
 {
   this->Internal->PivotCalibrationAlgo->SetPositionDifferenceThresholdMm(thresholdMM);
+  this->Internal->UpdateSessionsCalibrationSettings();
 }
 
 //-----------------------------------------------------------------------------
@@ -486,6 +1681,7 @@ double vtkSlicerPivotCalibrationLogic::GetPivotOrientationDifferenceThresholdDeg
 void vtkSlicerPivotCalibrationLogic::SetPivotOrientationDifferenceThresholdDegrees(double thresholdDegrees)
 {
   this->Internal->PivotCalibrationAlgo->SetOrientationDifferenceThresholdDegrees(thresholdDegrees);
+  this->Internal->UpdateSessionsCalibrationSettings();
 }
 
 //---------------------------------------------------------------------------
@@ -504,6 +1700,7 @@ double vtkSlicerPivotCalibrationLogic::GetSpinMinimumOrientationDifferenceDegree
 void vtkSlicerPivotCalibrationLogic::SetSpinMinimumOrientationDifferenceDegrees(double minimumOrientationDifferenceDegrees)
 {
   this->Internal->SpinCalibrationAlgo->SetMinimumOrientationDifferenceDegrees(minimumOrientationDifferenceDegrees);
+  this->Internal->UpdateSessionsCalibrationSettings();
 }
 
 //---------------------------------------------------------------------------
@@ -516,6 +1713,7 @@ int vtkSlicerPivotCalibrationLogic::GetSpinPoseBucketSize()
 void vtkSlicerPivotCalibrationLogic::SetSpinPoseBucketSize(int bucketSize)
 {
   this->Internal->SpinCalibrationAlgo->SetPoseBucketSize(bucketSize);
+  this->Internal->UpdateSessionsCalibrationSettings();
 }
 
 //---------------------------------------------------------------------------
@@ -528,6 +1726,7 @@ int vtkSlicerPivotCalibrationLogic::GetSpinMaximumNumberOfPoseBuckets()
 void vtkSlicerPivotCalibrationLogic::SetSpinMaximumNumberOfPoseBuckets(int bucketSize)
 {
   this->Internal->SpinCalibrationAlgo->SetMaximumNumberOfPoseBuckets(bucketSize);
+  this->Internal->UpdateSessionsCalibrationSettings();
 }
 
 //---------------------------------------------------------------------------
@@ -540,6 +1739,7 @@ double vtkSlicerPivotCalibrationLogic::GetSpinMaximumPoseBucketError()
 void vtkSlicerPivotCalibrationLogic::SetSpinMaximumPoseBucketError(double maximumBucketError)
 {
   this->Internal->SpinCalibrationAlgo->SetMaximumPoseBucketError(maximumBucketError);
+  this->Internal->UpdateSessionsCalibrationSettings();
 }
 
 //-----------------------------------------------------------------------------
@@ -552,6 +1752,7 @@ double vtkSlicerPivotCalibrationLogic::GetSpinPositionDifferenceThresholdMm()
 void vtkSlicerPivotCalibrationLogic::SetSpinPositionDifferenceThresholdMm(double thresholdMM)
 {
   this->Internal->SpinCalibrationAlgo->SetPositionDifferenceThresholdMm(thresholdMM);
+  this->Internal->UpdateSessionsCalibrationSettings();
 }
 
 //-----------------------------------------------------------------------------
@@ -564,4 +1765,5 @@ double vtkSlicerPivotCalibrationLogic::GetSpinOrientationDifferenceThresholdDegr
 void vtkSlicerPivotCalibrationLogic::SetSpinOrientationDifferenceThresholdDegrees(double thresholdDegrees)
 {
   this->Internal->SpinCalibrationAlgo->SetOrientationDifferenceThresholdDegrees(thresholdDegrees);
+  this->Internal->UpdateSessionsCalibrationSettings();
 }
@@ -50,7 +50,8 @@ public:
     PivotInputTransformAdded,
     SpinInputTransformAdded,
     PivotCalibrationCompleteEvent,
-    SpinCalibrationCompleteEvent
+    SpinCalibrationCompleteEvent,
+    CalibrationFinishedEvent
   };
 
   enum CalibrationErrorCodes
@@ -92,6 +93,97 @@ public:
   // Returns with false on failure
   bool ComputeSpinCalibration(bool snapRotation = false, bool autoOrient = true); // Note: The neede orientation protocol assumes that the shaft of the tool lies along the negative z-axis
 
+  //@{
+  /// Computes calibration results on a background thread, without blocking the main thread.
+  /// The poses collected so far are handed over to the calibration, so the pose buffer of the calibration type is empty after the call.
+  /// If the calibration fails or is cancelled then the poses are given back, before the poses that were collected in the meantime.
+  /// If outputTransformNode is specified then it provides the initial tool tip to tool transform and the result is written into it.
+  /// The result is published by ProcessCalibrationResult.
+  /// Returns with false if a background calibration is already running.
+  bool StartPivotCalibration(vtkMRMLTransformNode* outputTransformNode = nullptr, bool autoOrient = true);
+  bool StartSpinCalibration(vtkMRMLTransformNode* outputTransformNode = nullptr, bool snapRotation = false, bool autoOrient = true);
+  //@}
+
+  /// Cancels the running background calibration. The result of a cancelled calibration is discarded.
+  /// If the calibration is already being computed then its poses are given back by ProcessCalibrationResult when the computation is finished.
+  void CancelCalibration();
+
+  /// Returns true if a background calibration has been started and its result has not been processed yet.
+  bool GetCalibrationRunning();
+
+  //@{
+  /// Progress of the background calibration (between 0.0 and 1.0)
+  /// and the calibration error as soon as the solver provides it (-1.0 until then).
+  /// Can be called while the calibration is running.
+  double GetCalibrationProgress();
+  double GetCalibrationIntermediateRMSE();
+  //@}
+
+  /// Publishes the result of finished background calibrations to the calibration results and the output transform nodes,
+  /// then invokes CalibrationFinishedEvent. Must be called on the main thread, periodically while a calibration is running.
+  /// Returns true if a result was processed.
+  bool ProcessCalibrationResult();
+
+  //@{
+  /// Maximum number of threads that compute background calibrations at the same time.
+  /// Threads are started when calibrations are queued, so lowering the value does not stop threads that are already running.
+  vtkGetMacro(MaximumNumberOfCalibrationThreads, int);
+  vtkSetMacro(MaximumNumberOfCalibrationThreads, int);
+  //@}
+
+  //@{
+  /// Calibration sessions allow calibrating multiple tools at the same time.
+  /// Each session is identified by its tool transform node and has its own pose buffers, auto-calibration state and calibration results.
+  /// Calibration settings (pose buckets, input thresholds, auto-calibration targets) are shared by all sessions.
+  /// Poses are added to a session when its tool transform is modified while the recording state is on.
+  /// The observed transform node (see SetAndObserveTransformNode) cannot be used as a session tool.
+  void AddCalibrationSession(vtkMRMLTransformNode* toolTransformNode);
+  void RemoveCalibrationSession(vtkMRMLTransformNode* toolTransformNode);
+  void RemoveAllCalibrationSessions();
+  int GetNumberOfCalibrationSessions();
+  vtkMRMLTransformNode* GetNthCalibrationSessionToolTransformNode(int n);
+  //@}
+
+  /// Clears all previously acquired poses of a calibration session.
+  void ClearSessionToolToReferenceMatrices(vtkMRMLTransformNode* toolTransformNode);
+
+  //@{
+  /// Returns the number of poses currently cached for a calibration session
+  int GetSessionPivotNumberOfPoses(vtkMRMLTransformNode* toolTransformNode);
+  int GetSessionSpinNumberOfPoses(vtkMRMLTransformNode* toolTransformNode);
+  //@}
+
+  //@{
+  /// Flag that specifies if poses are added to the pivot/spin calibration of a session. On by default.
+  /// Auto-calibration turns it off if the calibration is complete and auto-calibration should stop when complete.
+  void SetSessionPivotCalibrationEnabled(vtkMRMLTransformNode* toolTransformNode, bool enabled);
+  bool GetSessionPivotCalibrationEnabled(vtkMRMLTransformNode* toolTransformNode);
+  void SetSessionSpinCalibrationEnabled(vtkMRMLTransformNode* toolTransformNode, bool enabled);
+  bool GetSessionSpinCalibrationEnabled(vtkMRMLTransformNode* toolTransformNode);
+  //@}
+
+  //@{
+  /// Computes calibration results of a session on a background thread, same way as StartPivotCalibration and StartSpinCalibration.
+  /// Calibrations of different sessions are computed in parallel.
+  /// If auto-calibration is enabled then sessions start the calibration automatically when enough poses have been gathered.
+  /// Results are published by ProcessCalibrationResult, which invokes CalibrationFinishedEvent with the tool transform node as call data.
+  /// For auto-calibration, the event is only invoked if the calibration error is below the target error.
+  bool StartSessionPivotCalibration(vtkMRMLTransformNode* toolTransformNode, vtkMRMLTransformNode* outputTransformNode = nullptr, bool autoOrient = true);
+  bool StartSessionSpinCalibration(vtkMRMLTransformNode* toolTransformNode, vtkMRMLTransformNode* outputTransformNode = nullptr,
+    bool snapRotation = false, bool autoOrient = true);
+  void CancelSessionCalibration(vtkMRMLTransformNode* toolTransformNode);
+  bool GetSessionCalibrationRunning(vtkMRMLTransformNode* toolTransformNode);
+  double GetSessionCalibrationProgress(vtkMRMLTransformNode* toolTransformNode);
+  //@}
+
+  //@{
+  /// Get calibration results of a session
+  bool GetSessionToolTipToToolMatrix(vtkMRMLTransformNode* toolTransformNode, vtkMatrix4x4* matrix);
+  double GetSessionPivotRMSE(vtkMRMLTransformNode* toolTransformNode);
+  double GetSessionSpinRMSE(vtkMRMLTransformNode* toolTransformNode);
+  std::string GetSessionErrorText(vtkMRMLTransformNode* toolTransformNode);
+  //@}
+
   // Flip the direction of the shaft axis
   void FlipShaftDirection();
 
@@ -114,7 +206,7 @@ public:
   //@}
 
   //@{
-  /// Returns the current error code in the calibration algorithm
+  /// Returns the error code of the last pivot/spin calibration
   int GetPivotErrorCode();
   int GetSpinErrorCode();
   //@}
@@ -262,6 +354,8 @@ private:
   double SpinRMSE{ -1.0 };
   std::string ErrorText;
 
+  int MaximumNumberOfCalibrationThreads{ 4 };
+
   // Pivot/spin enabled flags
   bool   PivotCalibrationEnabled{ true };
   bool   SpinCalibrationEnabled{ true };
@@ -29,6 +29,10 @@ Care Ontario.
 #include <vtkMinimalStandardRandomSequence.h>
 #include <vtkTransform.h>
 
+// STD includes
+#include <chrono>
+#include <thread>
+
 int NUMBER_OF_POINTS = 100;
 double epsilon = 1.0e-6;
 
@@ -179,6 +183,298 @@ bool TestSpinCalibration(vtkSlicerPivotCalibrationLogic* logic, vtkMRMLTransform
   return true;
 }
 
+//----------------------------------------------------------------------------
+bool TestBackgroundPivotCalibration(vtkSlicerPivotCalibrationLogic* logic, vtkMRMLTransformNode* markerToReferenceTransform)
+{
+  std::cout << "=================================================================" << std::endl;
+  std::cout << "Starting background pivot calibration test..." << std::endl;
+
+  double expectedToolTipPosition_Marker[3] = { 5.0, 12.6, 3.3 };
+
+  vtkNew<vtkTransform> startTransform;
+  startTransform->Translate(-expectedToolTipPosition_Marker[0], -expectedToolTipPosition_Marker[1], -expectedToolTipPosition_Marker[2]);
+
+  vtkNew<vtkMRMLTransformNode> toolTipToToolTransform;
+  markerToReferenceTransform->GetScene()->AddNode(toolTipToToolTransform);
+
+  for (int cancel = 1; cancel >= 0; --cancel)
+  {
+    logic->ClearToolToReferenceMatrices();
+    logic->SetRecordingState(true);
+    for (int i = 0; i < NUMBER_OF_POINTS; ++i)
+    {
+      vtkNew<vtkTransform> transform;
+      transform->DeepCopy(startTransform);
+      transform->Translate(expectedToolTipPosition_Marker);
+      transform->RotateX(double(i) / NUMBER_OF_POINTS * 90.0);
+      transform->RotateY(double(i) / NUMBER_OF_POINTS * 90.0);
+      transform->RotateZ(double(i) / NUMBER_OF_POINTS * 90.0);
+      transform->Translate(-expectedToolTipPosition_Marker[0], -expectedToolTipPosition_Marker[1], -expectedToolTipPosition_Marker[2]);
+      markerToReferenceTransform->SetAndObserveTransformToParent(transform);
+    }
+    logic->SetRecordingState(false);
+    int numberOfPoses = logic->GetPivotNumberOfPoses();
+
+    if (!logic->StartPivotCalibration(toolTipToToolTransform))
+    {
+      std::cerr << "Could not start pivot calibration" << std::endl;
+      return false;
+    }
+    if (logic->GetPivotNumberOfPoses() != 0)
+    {
+      std::cerr << "Poses were not handed over to the background calibration" << std::endl;
+      return false;
+    }
+
+    if (cancel)
+    {
+      logic->CancelCalibration();
+      if (logic->GetCalibrationRunning() || logic->ProcessCalibrationResult())
+      {
+        std::cerr << "Cancelled calibration is still running" << std::endl;
+        return false;
+      }
+      // The poses of the cancelled calibration are given back when the worker thread is finished with them
+      for (int i = 0; i < 1000 && logic->GetPivotNumberOfPoses() != numberOfPoses; ++i)
+      {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        logic->ProcessCalibrationResult();
+      }
+      if (logic->GetPivotNumberOfPoses() != numberOfPoses)
+      {
+        std::cerr << "Poses of the cancelled calibration were not given back: " << logic->GetPivotNumberOfPoses()
+          << " poses instead of " << numberOfPoses << std::endl;
+        return false;
+      }
+      continue;
+    }
+
+    for (int i = 0; i < 1000 && !logic->ProcessCalibrationResult(); ++i)
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    if (logic->GetCalibrationRunning())
+    {
+      std::cerr << "Background pivot calibration did not finish" << std::endl;
+      return false;
+    }
+  }
+
+  if (!vtkSlicerPivotCalibrationLogic::GetErrorCodeAsString(logic->GetPivotErrorCode()).empty())
+  {
+    std::cerr << "Background pivot calibration error code was not stored: " << logic->GetPivotErrorCode() << std::endl;
+    return false;
+  }
+
+  if (logic->GetPivotRMSE() < 0.0 || logic->GetPivotRMSE() >= epsilon)
+  {
+    std::cerr << "Background pivot calibration error is too large: " << logic->GetPivotRMSE() << std::endl;
+    return false;
+  }
+
+  // The result must have been published to the output transform
+  vtkNew<vtkMatrix4x4> toolTipToToolMatrix;
+  toolTipToToolTransform->GetMatrixTransformToParent(toolTipToToolMatrix);
+  double actualToolTipPosition_Marker[3] =
+  {
+    toolTipToToolMatrix->GetElement(0, 3), toolTipToToolMatrix->GetElement(1, 3), toolTipToToolMatrix->GetElement(2, 3)
+  };
+  double distanceBetweenActualAndExpectedToolTipPosition =
+    std::sqrt(vtkMath::Distance2BetweenPoints(actualToolTipPosition_Marker, expectedToolTipPosition_Marker));
+  std::cout << "Position error: " << distanceBetweenActualAndExpectedToolTipPosition << " mm" << std::endl;
+  if (distanceBetweenActualAndExpectedToolTipPosition >= epsilon)
+  {
+    std::cerr << "Tool tip position error is larger than expected" << std::endl;
+    return false;
+  }
+
+  std::cout << "Background pivot calibration completed successfully." << std::endl;
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool TestMultiToolPivotCalibration(vtkSlicerPivotCalibrationLogic* logic, vtkMRMLScene* scene)
+{
+  std::cout << "=================================================================" << std::endl;
+  std::cout << "Starting multi-tool pivot calibration test..." << std::endl;
+
+  const int numberOfTools = 3;
+  double expectedToolTipPositions_Marker[numberOfTools][3] = { { 5.0, 12.6, 3.3 }, { -20.0, 4.1, 150.0 }, { 0.5, -7.3, 80.2 } };
+
+  vtkNew<vtkMRMLTransformNode> markerToReferenceTransforms[numberOfTools];
+  for (int toolIndex = 0; toolIndex < numberOfTools; ++toolIndex)
+  {
+    scene->AddNode(markerToReferenceTransforms[toolIndex]);
+    logic->AddCalibrationSession(markerToReferenceTransforms[toolIndex]);
+  }
+  if (logic->GetNumberOfCalibrationSessions() != numberOfTools)
+  {
+    std::cerr << "Unexpected number of calibration sessions: " << logic->GetNumberOfCalibrationSessions() << std::endl;
+    return false;
+  }
+
+  logic->SetRecordingState(true);
+  for (int i = 0; i < NUMBER_OF_POINTS; ++i)
+  {
+    for (int toolIndex = 0; toolIndex < numberOfTools; ++toolIndex)
+    {
+      double* expectedToolTipPosition_Marker = expectedToolTipPositions_Marker[toolIndex];
+      vtkNew<vtkTransform> transform;
+      transform->RotateX(double(i) / NUMBER_OF_POINTS * 90.0);
+      transform->RotateY(double(i) / NUMBER_OF_POINTS * 90.0);
+      transform->RotateZ(double(i) / NUMBER_OF_POINTS * 90.0);
+      transform->Translate(-expectedToolTipPosition_Marker[0], -expectedToolTipPosition_Marker[1], -expectedToolTipPosition_Marker[2]);
+      markerToReferenceTransforms[toolIndex]->SetAndObserveTransformToParent(transform);
+    }
+  }
+  logic->SetRecordingState(false);
+
+  for (int toolIndex = 0; toolIndex < numberOfTools; ++toolIndex)
+  {
+    if (!logic->StartSessionPivotCalibration(markerToReferenceTransforms[toolIndex]))
+    {
+      std::cerr << "Could not start pivot calibration of tool " << toolIndex << std::endl;
+      return false;
+    }
+  }
+
+  for (int i = 0; i < 1000; ++i)
+  {
+    logic->ProcessCalibrationResult();
+    bool calibrationRunning = false;
+    for (int toolIndex = 0; toolIndex < numberOfTools; ++toolIndex)
+    {
+      calibrationRunning |= logic->GetSessionCalibrationRunning(markerToReferenceTransforms[toolIndex]);
+    }
+    if (!calibrationRunning)
+    {
+      break;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+
+  for (int toolIndex = 0; toolIndex < numberOfTools; ++toolIndex)
+  {
+    vtkMRMLTransformNode* toolTransform = markerToReferenceTransforms[toolIndex];
+    if (logic->GetSessionCalibrationRunning(toolTransform))
+    {
+      std::cerr << "Pivot calibration of tool " << toolIndex << " did not finish" << std::endl;
+      return false;
+    }
+    if (logic->GetSessionPivotRMSE(toolTransform) < 0.0 || logic->GetSessionPivotRMSE(toolTransform) >= epsilon)
+    {
+      std::cerr << "Pivot calibration error of tool " << toolIndex << " is too large: " << logic->GetSessionPivotRMSE(toolTransform)
+        << " (" << logic->GetSessionErrorText(toolTransform) << ")" << std::endl;
+      return false;
+    }
+
+    vtkNew<vtkMatrix4x4> toolTipToToolMatrix;
+    logic->GetSessionToolTipToToolMatrix(toolTransform, toolTipToToolMatrix);
+    double actualToolTipPosition_Marker[3] =
+    {
+      toolTipToToolMatrix->GetElement(0, 3), toolTipToToolMatrix->GetElement(1, 3), toolTipToToolMatrix->GetElement(2, 3)
+    };
+    double distanceBetweenActualAndExpectedToolTipPosition =
+      std::sqrt(vtkMath::Distance2BetweenPoints(actualToolTipPosition_Marker, expectedToolTipPositions_Marker[toolIndex]));
+    std::cout << "Tool " << toolIndex << " position error: " << distanceBetweenActualAndExpectedToolTipPosition << " mm" << std::endl;
+    if (distanceBetweenActualAndExpectedToolTipPosition >= epsilon)
+    {
+      std::cerr << "Tool tip position error of tool " << toolIndex << " is larger than expected" << std::endl;
+      return false;
+    }
+  }
+
+  logic->RemoveAllCalibrationSessions();
+
+  std::cout << "Multi-tool pivot calibration completed successfully." << std::endl;
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool TestSessionPosesGivenBack(vtkSlicerPivotCalibrationLogic* logic, vtkMRMLScene* scene)
+{
+  std::cout << "=================================================================" << std::endl;
+  std::cout << "Starting failed and cancelled session calibration test..." << std::endl;
+
+  double expectedToolTipPosition_Marker[3] = { 5.0, 12.6, 3.3 };
+
+  vtkNew<vtkMRMLTransformNode> markerToReferenceTransform;
+  scene->AddNode(markerToReferenceTransform);
+  logic->AddCalibrationSession(markerToReferenceTransform);
+
+  logic->SetRecordingState(true);
+  for (int i = 0; i < NUMBER_OF_POINTS; ++i)
+  {
+    vtkNew<vtkTransform> transform;
+    transform->RotateX(double(i) / NUMBER_OF_POINTS * 90.0);
+    transform->RotateY(double(i) / NUMBER_OF_POINTS * 90.0);
+    transform->RotateZ(double(i) / NUMBER_OF_POINTS * 90.0);
+    transform->Translate(-expectedToolTipPosition_Marker[0], -expectedToolTipPosition_Marker[1], -expectedToolTipPosition_Marker[2]);
+    markerToReferenceTransform->SetAndObserveTransformToParent(transform);
+  }
+  logic->SetRecordingState(false);
+  int numberOfPoses = logic->GetSessionPivotNumberOfPoses(markerToReferenceTransform);
+  if (numberOfPoses <= 0)
+  {
+    std::cerr << "No poses were collected" << std::endl;
+    return false;
+  }
+
+  // The poses do not have enough orientation variation for this requirement, so the calibration fails
+  double minimumOrientationDifferenceDegrees = logic->GetPivotMinimumOrientationDifferenceDegrees();
+  logic->SetPivotMinimumOrientationDifferenceDegrees(180.0);
+  if (!logic->StartSessionPivotCalibration(markerToReferenceTransform))
+  {
+    std::cerr << "Could not start session pivot calibration" << std::endl;
+    return false;
+  }
+  for (int i = 0; i < 1000 && !logic->ProcessCalibrationResult(); ++i)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  logic->SetPivotMinimumOrientationDifferenceDegrees(minimumOrientationDifferenceDegrees);
+  if (logic->GetSessionCalibrationRunning(markerToReferenceTransform) || logic->GetSessionPivotRMSE(markerToReferenceTransform) >= 0.0)
+  {
+    std::cerr << "Session pivot calibration did not fail" << std::endl;
+    return false;
+  }
+  if (logic->GetSessionPivotNumberOfPoses(markerToReferenceTransform) != numberOfPoses)
+  {
+    std::cerr << "Poses of the failed session calibration were not given back: " << logic->GetSessionPivotNumberOfPoses(markerToReferenceTransform)
+      << " poses instead of " << numberOfPoses << std::endl;
+    return false;
+  }
+
+  if (!logic->StartSessionPivotCalibration(markerToReferenceTransform))
+  {
+    std::cerr << "Could not start session pivot calibration" << std::endl;
+    return false;
+  }
+  logic->CancelSessionCalibration(markerToReferenceTransform);
+  if (logic->GetSessionCalibrationRunning(markerToReferenceTransform))
+  {
+    std::cerr << "Cancelled session calibration is still running" << std::endl;
+    return false;
+  }
+  // The poses of the cancelled calibration are given back when the worker thread is finished with them
+  for (int i = 0; i < 1000 && logic->GetSessionPivotNumberOfPoses(markerToReferenceTransform) != numberOfPoses; ++i)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    logic->ProcessCalibrationResult();
+  }
+  if (logic->GetSessionPivotNumberOfPoses(markerToReferenceTransform) != numberOfPoses)
+  {
+    std::cerr << "Poses of the cancelled session calibration were not given back: " << logic->GetSessionPivotNumberOfPoses(markerToReferenceTransform)
+      << " poses instead of " << numberOfPoses << std::endl;
+    return false;
+  }
+
+  logic->RemoveAllCalibrationSessions();
+
+  std::cout << "Failed and cancelled session calibration completed successfully." << std::endl;
+  return true;
+}
+
 //----------------------------------------------------------------------------
 int vtkPivotCalibrationTest(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
 {
@@ -205,5 +501,20 @@ int vtkPivotCalibrationTest(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
     return EXIT_FAILURE;
   }
 
+  if (!TestBackgroundPivotCalibration(logic, markerToReferenceTransform))
+  {
+    return EXIT_FAILURE;
+  }
+
+  if (!TestMultiToolPivotCalibration(logic, scene))
+  {
+    return EXIT_FAILURE;
+  }
+
+  if (!TestSessionPosesGivenBack(logic, scene))
+  {
+    return EXIT_FAILURE;
+  }
+
   return EXIT_SUCCESS;
 }
@@ -82,6 +82,10 @@ qSlicerPivotCalibrationModuleWidget::qSlicerPivotCalibrationModuleWidget(QWidget
   this->spinSamplingTimer = new QTimer();
   this->spinSamplingTimer->setSingleShot(false);
   this->spinSamplingTimer->setInterval(1000); // 1 sec
+
+  this->calibrationTimer = new QTimer();
+  this->calibrationTimer->setSingleShot(false);
+  this->calibrationTimer->setInterval(100); // 0.1 sec
 }
 
 //-----------------------------------------------------------------------------
@@ -91,6 +95,7 @@ qSlicerPivotCalibrationModuleWidget::~qSlicerPivotCalibrationModuleWidget()
   delete this->pivotSamplingTimer;
   delete this->spinStartupTimer;
   delete this->spinSamplingTimer;
+  delete this->calibrationTimer;
 }
 
 //-----------------------------------------------------------------------------
@@ -124,6 +129,8 @@ void qSlicerPivotCalibrationModuleWidget::setup()
   connect(pivotSamplingTimer, SIGNAL(timeout()), this, SLOT(onPivotSamplingTimeout()));
   connect(spinStartupTimer, SIGNAL(timeout()), this, SLOT(onSpinStartupTimeout()));
   connect(spinSamplingTimer, SIGNAL(timeout()), this, SLOT(onSpinSamplingTimeout()));
+  connect(calibrationTimer, SIGNAL(timeout()), this, SLOT(onCalibrationTimeout()));
+  connect(d->cancelCalibrationButton, SIGNAL(clicked()), this, SLOT(onCancelCalibrationButtonClicked()));
 
   connect(d->InputComboBox, SIGNAL(currentNodeChanged(vtkMRMLNode*)), this, SLOT(initializeObserver(vtkMRMLNode*)));
 
@@ -176,6 +183,7 @@ void qSlicerPivotCalibrationModuleWidget::setup()
   qvtkConnect(this->logic(), vtkSlicerPivotCalibrationLogic::SpinInputTransformAdded, this, SLOT(updateWidgetFromLogic()));
   qvtkConnect(this->logic(), vtkSlicerPivotCalibrationLogic::PivotCalibrationCompleteEvent, this, SLOT(onPivotAutoCalibrationComplete()));
   qvtkConnect(this->logic(), vtkSlicerPivotCalibrationLogic::SpinCalibrationCompleteEvent, this, SLOT(onSpinAutoCalibrationComplete()));
+  qvtkConnect(this->logic(), vtkSlicerPivotCalibrationLogic::CalibrationFinishedEvent, this, SLOT(onCalibrationFinished(vtkObject*, void*)));
 
   this->updateWidgetFromLogic();
 }
@@ -306,27 +314,19 @@ void qSlicerPivotCalibrationModuleWidget::onPivotStop()
     return;
   }
 
-  vtkSmartPointer<vtkMatrix4x4> outputMatrix = vtkSmartPointer<vtkMatrix4x4>::New();
-  outputTransform->GetMatrixTransformToParent(outputMatrix);
-  d->logic()->SetToolTipToToolMatrix(outputMatrix); // Sync logic's matrix with the scene's matrix
-
-  if (d->logic()->ComputePivotCalibration())
-  {
-    d->logic()->GetToolTipToToolMatrix(outputMatrix);
-    outputTransform->SetMatrixTransformToParent(outputMatrix);
-    std::stringstream ss;
-    ss << d->logic()->GetPivotRMSE();
-    d->rmseLabel->setText(ss.str().c_str());
-  }
-  else
+  // The calibration is computed in the background, the result is written to the output transform when it is finished
+  if (!d->logic()->StartPivotCalibration(outputTransform))
   {
-    qWarning() << "qSlicerPivotCalibrationModuleWidget::onPivotStop failed: ComputePivotCalibration returned with error: " << d->logic()->GetErrorText().c_str();
-    std::string fullMessage = std::string("Pivot calibration failed: ") + d->logic()->GetErrorText();
-    d->CountdownLabel->setText(fullMessage.c_str());
-    d->rmseLabel->setText("N/A");
+    qCritical("qSlicerPivotCalibrationModuleWidget::onPivotStop failed: cannot start pivot calibration");
+    return;
   }
+  this->backgroundCalibrationIsSpin = false;
+  this->calibrationName = tr("Pivot");
+  d->CountdownLabel->setText(tr("Computing pivot calibration..."));
+  this->calibrationTimer->start();
 
   d->logic()->ClearToolToReferenceMatrices();
+  this->updateWidgetFromLogic();
 }
 
 //-----------------------------------------------------------------------------
@@ -343,29 +343,19 @@ void qSlicerPivotCalibrationModuleWidget::onSpinStop()
     return;
   }
 
-  vtkSmartPointer<vtkMatrix4x4> outputMatrix = vtkSmartPointer<vtkMatrix4x4>::New();
-  outputTransform->GetMatrixTransformToParent(outputMatrix);
-  d->logic()->SetToolTipToToolMatrix(outputMatrix); // Sync logic's matrix with the scene's matrix
-
-  if (d->logic()->ComputeSpinCalibration(d->snapCheckBox->checkState() == Qt::Checked))
+  // The calibration is computed in the background, the result is written to the output transform when it is finished
+  if (!d->logic()->StartSpinCalibration(outputTransform, d->snapCheckBox->checkState() == Qt::Checked))
   {
-    d->logic()->GetToolTipToToolMatrix(outputMatrix);
-    outputTransform->SetMatrixTransformToParent(outputMatrix);
-
-    // Set the rmse label for the circle fitting rms error
-    std::stringstream ss;
-    ss << d->logic()->GetSpinRMSE();
-    d->rmseLabel->setText(ss.str().c_str());
-  }
-  else
-  {
-    qWarning() << "qSlicerPivotCalibrationModuleWidget::onSpinStop failed: ComputeSpinCalibration returned with error: " << d->logic()->GetErrorText().c_str();
-    std::string fullMessage = std::string("Spin calibration failed: ") + d->logic()->GetErrorText();
-    d->CountdownLabel->setText(fullMessage.c_str());
-    d->rmseLabel->setText("N/A");
+    qCritical("qSlicerPivotCalibrationModuleWidget::onSpinStop failed: cannot start spin calibration");
+    return;
   }
+  this->backgroundCalibrationIsSpin = true;
+  this->calibrationName = tr("Spin");
+  d->CountdownLabel->setText(tr("Computing spin calibration..."));
+  this->calibrationTimer->start();
 
   d->logic()->ClearToolToReferenceMatrices();
+  this->updateWidgetFromLogic();
 }
 
 //-----------------------------------------------------------------------------
@@ -467,7 +457,8 @@ void qSlicerPivotCalibrationModuleWidget::updateWidgetFromLogic()
     || this->pivotSamplingTimer->isActive()
     || this->pivotStartupTimer->isActive()
     || this->spinSamplingTimer->isActive()
-    || this->spinStartupTimer->isActive();
+    || this->spinStartupTimer->isActive()
+    || d->logic()->GetCalibrationRunning();
 
   vtkMRMLNode* inputTransformNode = d->InputComboBox->currentNode();
 
@@ -477,6 +468,11 @@ void qSlicerPivotCalibrationModuleWidget::updateWidgetFromLogic()
   d->startupTimerEdit->setEnabled(!calibrationRunning);
   d->durationTimerEdit->setEnabled(!calibrationRunning);
 
+  bool backgroundCalibrationRunning = d->logic()->GetCalibrationRunning();
+  d->calibrationProgressBar->setEnabled(backgroundCalibrationRunning);
+  d->calibrationProgressBar->setValue(backgroundCalibrationRunning ? 100.0 * d->logic()->GetCalibrationProgress() : 0);
+  d->cancelCalibrationButton->setEnabled(backgroundCalibrationRunning);
+
   bool wasBlocking = false;
 
   // Pivot auto-calibration settings
@@ -640,3 +636,71 @@ void qSlicerPivotCalibrationModuleWidget::onSpinResetButtonClicked()
   d->logic()->ClearSpinToolToReferenceMatrices();
   this->updateWidgetFromLogic();
 }
+
+//-----------------------------------------------------------------------------
+void qSlicerPivotCalibrationModuleWidget::onCalibrationTimeout()
+{
+  Q_D(qSlicerPivotCalibrationModuleWidget);
+
+  if (d->logic()->ProcessCalibrationResult())
+  {
+    // Result has been published, onCalibrationFinished updated the widget
+    return;
+  }
+  if (!d->logic()->GetCalibrationRunning())
+  {
+    this->calibrationTimer->stop();
+    this->updateWidgetFromLogic();
+    return;
+  }
+
+  d->calibrationProgressBar->setValue(100.0 * d->logic()->GetCalibrationProgress());
+  double intermediateRMSE = d->logic()->GetCalibrationIntermediateRMSE();
+  if (intermediateRMSE >= 0.0)
+  {
+    d->rmseLabel->setText(QString::number(intermediateRMSE));
+  }
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerPivotCalibrationModuleWidget::onCalibrationFinished(vtkObject* vtkNotUsed(caller), void* callData)
+{
+  Q_D(qSlicerPivotCalibrationModuleWidget);
+
+  if (callData)
+  {
+    // Calibration of a multi-tool calibration session, not shown in the widget
+    return;
+  }
+
+  this->calibrationTimer->stop();
+
+  double rmse = this->backgroundCalibrationIsSpin ? d->logic()->GetSpinRMSE() : d->logic()->GetPivotRMSE();
+  if (rmse >= 0.0)
+  {
+    d->CountdownLabel->setText(tr("%1 calibration complete").arg(this->calibrationName));
+    std::stringstream ss;
+    ss << rmse;
+    d->rmseLabel->setText(ss.str().c_str());
+  }
+  else
+  {
+    qWarning() << "qSlicerPivotCalibrationModuleWidget::onCalibrationFinished:" << this->calibrationName << "calibration returned with error: " << d->logic()->GetErrorText().c_str();
+    std::string fullMessage = this->calibrationName.toStdString() + std::string(" calibration failed: ") + d->logic()->GetErrorText();
+    d->CountdownLabel->setText(fullMessage.c_str());
+    d->rmseLabel->setText("N/A");
+  }
+
+  this->updateWidgetFromLogic();
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerPivotCalibrationModuleWidget::onCancelCalibrationButtonClicked()
+{
+  Q_D(qSlicerPivotCalibrationModuleWidget);
+
+  d->logic()->CancelCalibration();
+  this->calibrationTimer->stop();
+  d->CountdownLabel->setText(tr("%1 calibration cancelled").arg(this->calibrationName));
+  this->updateWidgetFromLogic();
+}
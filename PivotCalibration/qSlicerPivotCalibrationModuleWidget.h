@@ -70,6 +70,10 @@ protected slots:
   void onPivotAutoCalibrationComplete();
   void onSpinAutoCalibrationComplete();
 
+  void onCalibrationTimeout();
+  void onCalibrationFinished(vtkObject* caller, void* callData);
+  void onCancelCalibrationButtonClicked();
+
 protected:
   QScopedPointer<qSlicerPivotCalibrationModuleWidgetPrivate> d_ptr;
 
@@ -90,6 +94,13 @@ protected:
   QTimer* spinSamplingTimer;
   int spinSamplingRemainingTimerPeriodCount{ 0 };
 
+  // Polls the calibration that is computed in the background
+  QTimer* calibrationTimer;
+  // True if the background calibration is a spin calibration, false if it is a pivot calibration
+  bool backgroundCalibrationIsSpin{ false };
+  // Translated name of the background calibration, only used in messages
+  QString calibrationName;
+
 private:
   Q_DECLARE_PRIVATE(qSlicerPivotCalibrationModuleWidget);
   Q_DISABLE_COPY(qSlicerPivotCalibrationModuleWidget);
@@ -42,6 +42,9 @@ Care Ontario.
 // vtkAddon includes
 #include <vtkStreamingVolumeCodecFactory.h>
 
+// vtksys includes
+#include <vtksys/SystemTools.hxx>
+
 // VolumeReconstructor MRML includes
 #include "vtkMRMLVolumeReconstructionNode.h"
 
@@ -49,48 +52,2190 @@ Care Ontario.
 #include "vtkSlicerVolumeReconstructionLogic.h"
 
 // VTK includes
+#include <vtkImageCast.h>
+#include <vtkDataArray.h>
+#include <vtkImageData.h>
+#include <vtkMath.h>
 #include <vtkMatrix4x4.h>
 #include <vtkObjectFactory.h>
+#include <vtkPointData.h>
 #include <vtkTimerLog.h>
 #include <vtkTransform.h>
 #include <vtkSmartPointer.h>
 
+// STD includes
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Memory-mapped scratch files
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
 //---------------------------------------------------------------------------
 vtkStandardNewMacro(vtkSlicerVolumeReconstructionLogic);
 
+//---------------------------------------------------------------------------
+/// Volume reconstructor that gives access to the volume that the frames are pasted into, so that
+/// regions of the reconstruction can be published without extracting the whole volume.
+class vtkSlicerLiveVolumeReconstructor : public vtkIGSIOVolumeReconstructor
+{
+public:
+  static vtkSlicerLiveVolumeReconstructor* New();
+  vtkTypeMacro(vtkSlicerLiveVolumeReconstructor, vtkIGSIOVolumeReconstructor);
+
+  /// Pasted volume, the first component contains the gray levels and the second component the alpha channel
+  vtkImageData* GetPastedVolume() { return this->ReconstructedVolume; }
+  /// Number of pastes into each voxel of the pasted volume, used for filling holes
+  vtkImageData* GetAccumulationBuffer() { return this->AccumulationBuffer; }
+
+protected:
+  vtkSlicerLiveVolumeReconstructor() = default;
+  ~vtkSlicerLiveVolumeReconstructor() override = default;
+};
+vtkStandardNewMacro(vtkSlicerLiveVolumeReconstructor);
+
+/// Cached transform from the image parent transform node to the ROI.
+/// Only the image parent (leaf) transform and the IJKToRAS matrix are expected to change between frames,
+/// so the rest of the chain is recomputed only if the hierarchy or one of the other transforms is modified.
+struct ImageToROITransformChain
+{
+  bool Valid{false};
+  vtkMRMLTransformableNode* ROINode{nullptr};
+  std::vector<vtkMRMLTransformNode*> TransformNodes;
+  vtkMTimeType TransformMTime{0};
+  vtkSmartPointer<vtkMatrix4x4> ParentToROIMatrix{vtkSmartPointer<vtkMatrix4x4>::New()};
+};
+
+//---------------------------------------------------------------------------
+/// Brick of a sparse reconstruction. Each brick has its own reconstructor, so accumulation and weight
+/// buffers are only allocated for the extent of the bricks that frames are pasted into.
+/// The reconstructor covers the brick with a padding, same way as the slabs of the pipeline, and only the voxels
+/// of the brick are used from it. Holes are filled after the bricks are densified.
+struct SparseBrick
+{
+  /// Extent of the brick, in output volume voxels
+  int Extent[6]{0, 0, 0, 0, 0, 0};
+  /// Extent of the reconstructor of the brick, in output volume voxels
+  int PaddedExtent[6]{0, 0, 0, 0, 0, 0};
+  vtkSmartPointer<vtkIGSIOVolumeReconstructor> Reconstructor{vtkSmartPointer<vtkIGSIOVolumeReconstructor>::New()};
+  /// The buffers of the reconstructor are allocated by the first paste, on the thread that owns the brick
+  bool Allocated{false};
+  int WorkerIndex{0};
+};
+
+/// Paste of a frame into a sparse brick, restricted to the rectangle of frame pixels that may reach the brick
+struct SparseBrickPaste
+{
+  SparseBrick* Brick{nullptr};
+  int ClipRectangleOrigin[2]{0, 0};
+  int ClipRectangleSize[2]{0, 0};
+};
+
 struct ReconstructionInfo
 {
   vtkSmartPointer<vtkIGSIOVolumeReconstructor> Reconstructor{nullptr};
   double LastUpdateTimeSeconds{0.0};
+  int OutputScalarType{VTK_VOID};
+
+  vtkSmartPointer<vtkIGSIOTransformRepository> TransformRepository{vtkSmartPointer<vtkIGSIOTransformRepository>::New()};
+  ImageToROITransformChain TransformChain;
+  vtkSmartPointer<vtkMatrix4x4> IJKToRASMatrix{vtkSmartPointer<vtkMatrix4x4>::New()};
+  vtkSmartPointer<vtkMatrix4x4> LeafToParentMatrix{vtkSmartPointer<vtkMatrix4x4>::New()};
+  vtkSmartPointer<vtkMatrix4x4> ImageToROIMatrix{vtkSmartPointer<vtkMatrix4x4>::New()};
+
+  // Geometry of the reconstructed volume, in ROI coordinates
+  int OutputExtent[6]{0, 0, 0, 0, 0, 0};
+  double OutputOrigin[3]{0.0, 0.0, 0.0};
+  double OutputSpacing[3]{1.0, 1.0, 1.0};
+
+  /// Coarse reconstruction of live reconstruction, that frames are pasted into before the full resolution reconstructor.
+  /// It is read into the preview volume node more often than the full resolution volume is read into the output volume node.
+  vtkSmartPointer<vtkIGSIOVolumeReconstructor> PreviewReconstructor{nullptr};
+  double LastPreviewUpdateTimeSeconds{0.0};
+
+  /// Result of the last multi-threaded offline reconstruction, which is not stored in the reconstructor
+  vtkSmartPointer<vtkImageData> MergedReconstructedVolume{nullptr};
+
+  /// Bricks of the output volume that frames have been pasted into since the output volume was last published.
+  /// Only these bricks are copied to the output volume during live reconstruction.
+  int BrickGridSize[3]{0, 0, 0};
+  std::vector<unsigned char> DirtyBricks;
+  bool OutputVolumePublished{false};
+
+  /// Bricks of the sparse reconstruction, indexed by their position in the sparse brick grid.
+  /// Bricks are only created when the first frame that may touch them is pasted.
+  int SparseBrickGridSize[3]{0, 0, 0};
+  std::unordered_map<vtkIdType, std::unique_ptr<SparseBrick>> SparseBricks;
+
+  /// Image and pose of the last pasted frame, to skip unchanged frames and frames that moved less than the thresholds.
+  /// The image is only compared, never accessed.
+  bool LastPastedFrameValid{false};
+  vtkImageData* LastPastedImage{nullptr};
+  vtkMTimeType LastPastedImageMTime{0};
+  double LastPastedImageToROIMatrix[16]{1.0, 0.0, 0.0, 0.0, 0.0, 1.0, 0.0, 0.0, 0.0, 0.0, 1.0, 0.0, 0.0, 0.0, 0.0, 1.0};
+  double LastPastedFrameCenter[3]{0.0, 0.0, 0.0};
+
+  /// Input image that was last pasted by live reconstruction, shared by all nodes that use the same input volume.
+  /// The image is only compared, never accessed.
+  vtkImageData* IngestedImage{nullptr};
+  vtkMTimeType IngestedImageMTime{0};
 };
 
 typedef std::map<vtkMRMLVolumeReconstructionNode*, ReconstructionInfo> VolumeReconstuctorMap;
 
-//---------------------------------------------------------------------------
-class vtkSlicerVolumeReconstructionLogic::vtkInternal
-{
-public:
-  //---------------------------------------------------------------------------
-  vtkInternal(vtkSlicerVolumeReconstructionLogic* external);
-  ~vtkInternal();
+//---------------------------------------------------------------------------
+/// Expand the bounds with the corners of the image extent (including the full extent of the edge voxels),
+/// transformed by the image to ROI matrix.
+static void ExpandBoundsWithImageCorners(const int extent[6], const double imageToROIMatrix[16], double bounds[6])
+{
+  for (int corner = 0; corner < 8; ++corner)
+  {
+    double cornerIJK[4] = {
+      (corner & 1) ? extent[1] + 0.5 : extent[0] - 0.5,
+      (corner & 2) ? extent[3] + 0.5 : extent[2] - 0.5,
+      (corner & 4) ? extent[5] + 0.5 : extent[4] - 0.5,
+      1.0 };
+    double cornerROI[4] = { 0.0, 0.0, 0.0, 1.0 };
+    vtkMatrix4x4::MultiplyPoint(imageToROIMatrix, cornerIJK, cornerROI);
+    for (int axis = 0; axis < 3; ++axis)
+    {
+      bounds[2 * axis] = std::min(bounds[2 * axis], cornerROI[axis]);
+      bounds[2 * axis + 1] = std::max(bounds[2 * axis + 1], cornerROI[axis]);
+    }
+  }
+}
+
+//---------------------------------------------------------------------------
+/// Restrict the image extent to the clip rectangle. A clip rectangle with zero size does not clip the image.
+static void ClipImageExtent(int extent[6], const int clipRectangleOrigin[2], const int clipRectangleSize[2])
+{
+  if (!clipRectangleOrigin || !clipRectangleSize)
+  {
+    return;
+  }
+  for (int axis = 0; axis < 2; ++axis)
+  {
+    if (clipRectangleSize[axis] <= 0)
+    {
+      continue;
+    }
+    extent[2 * axis] = std::max(extent[2 * axis], clipRectangleOrigin[axis]);
+    extent[2 * axis + 1] = std::min(extent[2 * axis + 1], clipRectangleOrigin[axis] + clipRectangleSize[axis] - 1);
+  }
+}
+
+//---------------------------------------------------------------------------
+/// Bounds of all frame corners in ROI coordinates. The corners are transformed in parallel chunks of frames,
+/// each with its own bounds that are combined at the end.
+static void ComputeFrameCornerBounds(const std::vector<int>& frameExtents, const std::vector<double>& frameImageToROIMatrices, double bounds[6])
+{
+  const int numberOfFrames = static_cast<int>(frameExtents.size() / 6);
+  const int minimumFramesPerChunk = 256;
+  int numberOfChunks = std::min(static_cast<int>(std::thread::hardware_concurrency()), numberOfFrames / minimumFramesPerChunk);
+  numberOfChunks = std::max(numberOfChunks, 1);
+
+  std::vector<std::array<double, 6>> chunkBounds(numberOfChunks);
+  auto computeChunkBounds = [&](int chunk)
+  {
+    std::array<double, 6>& currentBounds = chunkBounds[chunk];
+    currentBounds = { VTK_DOUBLE_MAX, VTK_DOUBLE_MIN, VTK_DOUBLE_MAX, VTK_DOUBLE_MIN, VTK_DOUBLE_MAX, VTK_DOUBLE_MIN };
+    const int firstFrame = (numberOfFrames * chunk) / numberOfChunks;
+    const int lastFrame = (numberOfFrames * (chunk + 1)) / numberOfChunks;
+    for (int frame = firstFrame; frame < lastFrame; ++frame)
+    {
+      ExpandBoundsWithImageCorners(&frameExtents[6 * frame], &frameImageToROIMatrices[16 * frame], currentBounds.data());
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (int chunk = 1; chunk < numberOfChunks; ++chunk)
+  {
+    threads.push_back(std::thread(computeChunkBounds, chunk));
+  }
+  computeChunkBounds(0);
+  for (std::thread& thread : threads)
+  {
+    thread.join();
+  }
+
+  for (const std::array<double, 6>& currentBounds : chunkBounds)
+  {
+    for (int axis = 0; axis < 3; ++axis)
+    {
+      bounds[2 * axis] = std::min(bounds[2 * axis], currentBounds[2 * axis]);
+      bounds[2 * axis + 1] = std::max(bounds[2 * axis + 1], currentBounds[2 * axis + 1]);
+    }
+  }
+}
+
+//---------------------------------------------------------------------------
+/// Reads the image and transform items of the sequences in a sequence browser directly, without changing
+/// the selected item of the browser. Changing the selected item would update every proxy node in the scene
+/// and trigger all of their observers.
+///
+/// Each transform in the image and ROI transform hierarchies whose proxy node is synchronized by the browser
+/// is read from its sequence; the remaining transforms are read from the scene.
+/// The transform item of a frame is looked up by the index value of the frame with a binary search,
+/// the same way as the browser selects the items of synchronized sequences.
+class SequenceFrameReader
+{
+public:
+  bool Initialize(vtkMRMLSequenceBrowserNode* inputSequenceBrowser, vtkMRMLVolumeNode* inputVolumeNode, vtkMRMLTransformableNode* roiNode);
+
+  int GetNumberOfFrames();
+
+  /// Returns the volume node of the specified frame, and the transform from the IJK coordinates of the frame
+  /// to the ROI coordinates.
+  vtkMRMLVolumeNode* GetFrame(int frameIndex, vtkMatrix4x4* imageToROIMatrix);
+
+protected:
+  void AddTransformSequences(vtkMRMLSequenceBrowserNode* inputSequenceBrowser, vtkMRMLTransformNode* transformNode,
+    std::vector<vtkMRMLTransformNode*>& transformNodes);
+  void GetMatrixTransformToWorld(const std::vector<vtkMRMLTransformNode*>& transformNodes, int frameIndex, vtkMatrix4x4* toWorldMatrix);
+
+  vtkMRMLSequenceNode* ImageSequenceNode{nullptr};
+  bool NumericIndex{true};
+  vtkMRMLTransformableNode* ROINode{nullptr};
+
+  /// Transform nodes above the image and the ROI, ordered from the node to the root of the hierarchy
+  std::vector<vtkMRMLTransformNode*> ImageTransformNodes;
+  std::vector<vtkMRMLTransformNode*> ROITransformNodes;
+  std::map<vtkMRMLTransformNode*, vtkMRMLSequenceNode*> TransformSequenceNodes;
+
+  vtkNew<vtkMatrix4x4> IJKToRASMatrix;
+  vtkNew<vtkMatrix4x4> TransformToParentMatrix;
+  vtkNew<vtkMatrix4x4> ImageToWorldMatrix;
+  vtkNew<vtkMatrix4x4> ROIToWorldMatrix;
+  vtkNew<vtkMatrix4x4> WorldToROIMatrix;
+};
+
+//---------------------------------------------------------------------------
+bool SequenceFrameReader::Initialize(vtkMRMLSequenceBrowserNode* inputSequenceBrowser, vtkMRMLVolumeNode* inputVolumeNode, vtkMRMLTransformableNode* roiNode)
+{
+  this->ImageSequenceNode = nullptr;
+  this->ImageTransformNodes.clear();
+  this->ROITransformNodes.clear();
+  this->TransformSequenceNodes.clear();
+  this->ROINode = roiNode;
+  if (!inputSequenceBrowser || !inputVolumeNode || !roiNode)
+  {
+    return false;
+  }
+
+  vtkMRMLSequenceNode* imageSequenceNode = inputSequenceBrowser->GetSequenceNode(inputVolumeNode);
+  if (!imageSequenceNode || imageSequenceNode->GetNumberOfDataNodes() < 1)
+  {
+    return false;
+  }
+
+  // Compressed video frames can only be decoded in order through the proxy node
+  vtkMRMLNode* firstDataNode = imageSequenceNode->GetNthDataNode(0);
+  if (!vtkMRMLVolumeNode::SafeDownCast(firstDataNode) || firstDataNode->IsA("vtkMRMLStreamingVolumeNode"))
+  {
+    return false;
+  }
+
+  this->ImageSequenceNode = imageSequenceNode;
+  this->NumericIndex = (imageSequenceNode->GetIndexType() == vtkMRMLSequenceNode::NumericIndex);
+
+  this->AddTransformSequences(inputSequenceBrowser, inputVolumeNode->GetParentTransformNode(), this->ImageTransformNodes);
+  this->AddTransformSequences(inputSequenceBrowser, roiNode->GetParentTransformNode(), this->ROITransformNodes);
+  return true;
+}
+
+//---------------------------------------------------------------------------
+void SequenceFrameReader::AddTransformSequences(vtkMRMLSequenceBrowserNode* inputSequenceBrowser, vtkMRMLTransformNode* transformNode,
+  std::vector<vtkMRMLTransformNode*>& transformNodes)
+{
+  for (; transformNode; transformNode = transformNode->GetParentTransformNode())
+  {
+    transformNodes.push_back(transformNode);
+
+    vtkMRMLSequenceNode* transformSequenceNode = inputSequenceBrowser->GetSequenceNode(transformNode);
+    if (transformSequenceNode && transformSequenceNode->GetNumberOfDataNodes() > 0)
+    {
+      this->TransformSequenceNodes[transformNode] = transformSequenceNode;
+    }
+  }
+}
+
+//---------------------------------------------------------------------------
+int SequenceFrameReader::GetNumberOfFrames()
+{
+  return this->ImageSequenceNode ? this->ImageSequenceNode->GetNumberOfDataNodes() : 0;
+}
+
+//---------------------------------------------------------------------------
+void SequenceFrameReader::GetMatrixTransformToWorld(const std::vector<vtkMRMLTransformNode*>& transformNodes, int frameIndex, vtkMatrix4x4* toWorldMatrix)
+{
+  toWorldMatrix->Identity();
+  for (vtkMRMLTransformNode* transformNode : transformNodes)
+  {
+    vtkMRMLTransformNode* itemTransformNode = transformNode;
+    std::map<vtkMRMLTransformNode*, vtkMRMLSequenceNode*>::iterator sequenceIt = this->TransformSequenceNodes.find(transformNode);
+    if (sequenceIt != this->TransformSequenceNodes.end())
+    {
+      // Numeric indices use the closest preceding item, text indices require an exact match
+      int itemNumber = sequenceIt->second->GetItemNumberFromIndexValue(this->ImageSequenceNode->GetNthIndexValue(frameIndex), !this->NumericIndex);
+      vtkMRMLTransformNode* dataTransformNode = vtkMRMLTransformNode::SafeDownCast(sequenceIt->second->GetNthDataNode(itemNumber));
+      if (dataTransformNode)
+      {
+        itemTransformNode = dataTransformNode;
+      }
+    }
+    itemTransformNode->GetMatrixTransformToParent(this->TransformToParentMatrix);
+    vtkMatrix4x4::Multiply4x4(this->TransformToParentMatrix, toWorldMatrix, toWorldMatrix);
+  }
+}
+
+//---------------------------------------------------------------------------
+vtkMRMLVolumeNode* SequenceFrameReader::GetFrame(int frameIndex, vtkMatrix4x4* imageToROIMatrix)
+{
+  if (frameIndex < 0 || frameIndex >= this->GetNumberOfFrames())
+  {
+    return nullptr;
+  }
+
+  vtkMRMLVolumeNode* frameVolumeNode = vtkMRMLVolumeNode::SafeDownCast(this->ImageSequenceNode->GetNthDataNode(frameIndex));
+  if (!frameVolumeNode)
+  {
+    return nullptr;
+  }
+
+  // ImageToROI = NodeToObject * WorldToROIParent * ImageParentToWorld * IJKToRAS
+  frameVolumeNode->GetIJKToRASMatrix(this->IJKToRASMatrix);
+  this->GetMatrixTransformToWorld(this->ImageTransformNodes, frameIndex, this->ImageToWorldMatrix);
+  vtkMatrix4x4::Multiply4x4(this->ImageToWorldMatrix, this->IJKToRASMatrix, imageToROIMatrix);
+
+  this->GetMatrixTransformToWorld(this->ROITransformNodes, frameIndex, this->ROIToWorldMatrix);
+  vtkMatrix4x4::Invert(this->ROIToWorldMatrix, this->WorldToROIMatrix);
+  vtkMatrix4x4::Multiply4x4(this->WorldToROIMatrix, imageToROIMatrix, imageToROIMatrix);
+
+  vtkMRMLMarkupsROINode* markupsROINode = vtkMRMLMarkupsROINode::SafeDownCast(this->ROINode);
+  if (markupsROINode)
+  {
+    vtkMatrix4x4::Invert(markupsROINode->GetObjectToNodeMatrix(), this->WorldToROIMatrix);
+    vtkMatrix4x4::Multiply4x4(this->WorldToROIMatrix, imageToROIMatrix, imageToROIMatrix);
+  }
+  return frameVolumeNode;
+}
+
+//---------------------------------------------------------------------------
+/// Paste of a frame into the reconstructor of one reconstruction node.
+/// The image of the frame is shared by all the pastes of the frame, and is not modified by the paste.
+struct ReconstructorFramePaste
+{
+  vtkMRMLVolumeReconstructionNode* Node{nullptr};
+  ReconstructionInfo* Info{nullptr};
+  vtkMatrix4x4* ImageToROIMatrix{nullptr};
+  bool IsFirst{false};
+  bool IsLast{false};
+
+  bool SparseAccumulation{false};
+  std::vector<SparseBrickPaste> BrickPastes;
+  igsioTrackedFrame TrackedFrame;
+  bool Skipped{false};
+  bool Success{true};
+};
+
+//---------------------------------------------------------------------------
+/// Memory-mapped scratch file that backs the scalars of an out-of-core volume.
+/// The file is removed when the mapping is released.
+class ScratchFileMapping
+{
+public:
+  ~ScratchFileMapping()
+  {
+#ifdef _WIN32
+    if (this->Data)
+    {
+      UnmapViewOfFile(this->Data);
+    }
+    if (this->MappingHandle)
+    {
+      CloseHandle(this->MappingHandle);
+    }
+    if (this->FileHandle != INVALID_HANDLE_VALUE)
+    {
+      CloseHandle(this->FileHandle);
+    }
+#else
+    if (this->Data)
+    {
+      munmap(this->Data, this->Size);
+    }
+#endif
+  }
+
+  bool Create(const std::string& directory, size_t size)
+  {
+    this->Size = size;
+#ifdef _WIN32
+    char fileName[MAX_PATH];
+    if (!GetTempFileNameA(directory.c_str(), "svr", 0, fileName))
+    {
+      return false;
+    }
+    this->FileHandle = CreateFileA(fileName, GENERIC_READ | GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS,
+      FILE_ATTRIBUTE_TEMPORARY | FILE_FLAG_DELETE_ON_CLOSE, nullptr);
+    if (this->FileHandle == INVALID_HANDLE_VALUE)
+    {
+      DeleteFileA(fileName);
+      return false;
+    }
+    unsigned long long mappingSize = size;
+    this->MappingHandle = CreateFileMappingA(this->FileHandle, nullptr, PAGE_READWRITE,
+      static_cast<DWORD>(mappingSize >> 32), static_cast<DWORD>(mappingSize & 0xFFFFFFFF), nullptr);
+    if (!this->MappingHandle)
+    {
+      return false;
+    }
+    this->Data = MapViewOfFile(this->MappingHandle, FILE_MAP_ALL_ACCESS, 0, 0, size);
+    return this->Data != nullptr;
+#else
+    std::string fileName = directory + "/SlicerVolumeReconstruction-XXXXXX";
+    std::vector<char> fileNameBuffer(fileName.begin(), fileName.end());
+    fileNameBuffer.push_back('\0');
+    int fileDescriptor = mkstemp(fileNameBuffer.data());
+    if (fileDescriptor < 0)
+    {
+      return false;
+    }
+    // The file is only accessed through the mapping, and is deleted when it is unmapped
+    unlink(fileNameBuffer.data());
+    if (ftruncate(fileDescriptor, static_cast<off_t>(size)) != 0)
+    {
+      close(fileDescriptor);
+      return false;
+    }
+    void* data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fileDescriptor, 0);
+    close(fileDescriptor);
+    if (data == MAP_FAILED)
+    {
+      return false;
+    }
+    this->Data = data;
+    return true;
+#endif
+  }
+
+  void* GetData() { return this->Data; }
+
+protected:
+  void* Data{nullptr};
+  size_t Size{0};
+#ifdef _WIN32
+  HANDLE FileHandle{INVALID_HANDLE_VALUE};
+  HANDLE MappingHandle{nullptr};
+#endif
+};
+
+/// Mappings of the scalar arrays that are backed by scratch files, released when the array frees its memory
+static std::mutex ScratchFileMappingsMutex;
+static std::map<void*, std::unique_ptr<ScratchFileMapping>> ScratchFileMappings;
+
+//---------------------------------------------------------------------------
+static void ReleaseScratchFileArray(void* data)
+{
+  std::lock_guard<std::mutex> lock(ScratchFileMappingsMutex);
+  ScratchFileMappings.erase(data);
+}
+
+//---------------------------------------------------------------------------
+/// A frame of the offline reconstruction pipeline, queued for one paste worker.
+/// The image shares the scalars of the sequence item, and is only read by the worker.
+struct PipelineFrame
+{
+  int FrameIndex{0};
+  vtkSmartPointer<vtkImageData> Image;
+  double ImageToROIMatrix[16];
+  /// Number of workers that still need to paste the frame
+  std::shared_ptr<std::atomic<int>> RemainingWorkers;
+  /// Bricks of a sparse reconstruction that the worker pastes the frame into.
+  /// Empty if the worker pastes the frame into its slab.
+  std::vector<SparseBrickPaste> SparseBrickPastes;
+};
+
+//---------------------------------------------------------------------------
+/// Paste worker of the offline reconstruction pipeline.
+/// Each worker owns a slab of the output volume along the slab axis, and pastes every frame that intersects
+/// the slab into its own reconstructor. The reconstructor covers the slab with a padding on both sides, so that
+/// the interpolation kernel of pixels pasted next to the slab boundary is not clipped by the slab extent.
+/// Each voxel of the slab receives the same contributions as in a single reconstructor, so only the slab is
+/// merged, without merging compounding weights, and the result is the same with any compounding mode.
+/// For sparse reconstruction, each worker owns a subset of the bricks instead of a slab.
+struct PipelineSlabWorker
+{
+  int SlabStart{0};
+  int SlabEnd{0};
+  /// Range of the reconstructor along the slab axis, the slab with the padding
+  int PaddedSlabStart{0};
+  int PaddedSlabEnd{0};
+  vtkSmartPointer<vtkIGSIOVolumeReconstructor> Reconstructor{vtkSmartPointer<vtkIGSIOVolumeReconstructor>::New()};
+  vtkSmartPointer<vtkIGSIOTransformRepository> TransformRepository{vtkSmartPointer<vtkIGSIOTransformRepository>::New()};
+  vtkSmartPointer<vtkMatrix4x4> ImageToROIMatrix{vtkSmartPointer<vtkMatrix4x4>::New()};
+
+  std::mutex QueueMutex;
+  std::condition_variable QueueCondition;
+  std::deque<PipelineFrame> Queue;
+  bool EndOfFrames{false};
+  bool Failed{false};
+  std::thread Thread;
+};
+
+//---------------------------------------------------------------------------
+/// Copy the voxels of a block that was reconstructed with a zero based extent into the volume, where the voxel
+/// (i, j, k) of the block is at volume index (i, j, k) + blockOffset. Only the voxels inside the volume extent,
+/// and inside the volume index extent limitExtent if it is specified, are copied.
+static void CopyBlockIntoVolume(vtkImageData* blockImageData, const int blockOffset[3], vtkImageData* volumeImageData,
+  const int* limitExtent = nullptr)
+{
+  int* blockExtent = blockImageData->GetExtent();
+  int* volumeExtent = volumeImageData->GetExtent();
+  int copyExtent[6] = { 0, 0, 0, 0, 0, 0 };
+  for (int axis = 0; axis < 3; ++axis)
+  {
+    copyExtent[2 * axis] = std::max(blockExtent[2 * axis] + blockOffset[axis], volumeExtent[2 * axis]);
+    copyExtent[2 * axis + 1] = std::min(blockExtent[2 * axis + 1] + blockOffset[axis], volumeExtent[2 * axis + 1]);
+    if (limitExtent)
+    {
+      copyExtent[2 * axis] = std::max(copyExtent[2 * axis], limitExtent[2 * axis]);
+      copyExtent[2 * axis + 1] = std::min(copyExtent[2 * axis + 1], limitExtent[2 * axis + 1]);
+    }
+    if (copyExtent[2 * axis] > copyExtent[2 * axis + 1])
+    {
+      return;
+    }
+  }
+
+  const size_t rowSize = static_cast<size_t>(copyExtent[1] - copyExtent[0] + 1)
+    * blockImageData->GetScalarSize() * blockImageData->GetNumberOfScalarComponents();
+  for (int z = copyExtent[4]; z <= copyExtent[5]; ++z)
+  {
+    for (int y = copyExtent[2]; y <= copyExtent[3]; ++y)
+    {
+      memcpy(volumeImageData->GetScalarPointer(copyExtent[0], y, z),
+        blockImageData->GetScalarPointer(copyExtent[0] - blockOffset[0], y - blockOffset[1], z - blockOffset[2]), rowSize);
+    }
+  }
+}
+
+//---------------------------------------------------------------------------
+/// Compute the rectangle of frame pixels that may be pasted into the block of the output volume.
+/// The corners of the block, extended by one voxel for the interpolation kernel, are transformed into frame pixel
+/// coordinates and the resulting rectangle is intersected with the frame extent and the optional clip rectangle.
+/// Returns false if no pixel of the frame can reach the block.
+static bool GetBlockClipRectangle(const int blockExtent[6], const double outputOrigin[3], const double outputSpacing[3],
+  const double roiToImageMatrix[16], const int frameExtent[6], const int* clipRectangleOrigin, const int* clipRectangleSize,
+  int blockClipRectangleOrigin[2], int blockClipRectangleSize[2])
+{
+  double imageBounds[6] = { VTK_DOUBLE_MAX, VTK_DOUBLE_MIN, VTK_DOUBLE_MAX, VTK_DOUBLE_MIN, VTK_DOUBLE_MAX, VTK_DOUBLE_MIN };
+  for (int corner = 0; corner < 8; ++corner)
+  {
+    double point[4] = { 0.0, 0.0, 0.0, 1.0 };
+    for (int axis = 0; axis < 3; ++axis)
+    {
+      int voxel = (corner & (1 << axis)) ? blockExtent[2 * axis + 1] + 1 : blockExtent[2 * axis] - 1;
+      point[axis] = outputOrigin[axis] + voxel * outputSpacing[axis];
+    }
+    vtkMatrix4x4::MultiplyPoint(roiToImageMatrix, point, point);
+    for (int axis = 0; axis < 3; ++axis)
+    {
+      imageBounds[2 * axis] = std::min(imageBounds[2 * axis], point[axis]);
+      imageBounds[2 * axis + 1] = std::max(imageBounds[2 * axis + 1], point[axis]);
+    }
+  }
+  if (imageBounds[5] < frameExtent[4] - 0.5 || imageBounds[4] > frameExtent[5] + 0.5)
+  {
+    // The block is entirely in front of or behind the frame
+    return false;
+  }
+
+  for (int axis = 0; axis < 2; ++axis)
+  {
+    int firstPixel = std::max(static_cast<int>(std::floor(imageBounds[2 * axis])), frameExtent[2 * axis]);
+    int lastPixel = std::min(static_cast<int>(std::ceil(imageBounds[2 * axis + 1])), frameExtent[2 * axis + 1]);
+    if (clipRectangleOrigin && clipRectangleSize && clipRectangleSize[0] > 0 && clipRectangleSize[1] > 0)
+    {
+      firstPixel = std::max(firstPixel, clipRectangleOrigin[axis]);
+      lastPixel = std::min(lastPixel, clipRectangleOrigin[axis] + clipRectangleSize[axis] - 1);
+    }
+    if (firstPixel > lastPixel)
+    {
+      return false;
+    }
+    blockClipRectangleOrigin[axis] = firstPixel;
+    blockClipRectangleSize[axis] = lastPixel - firstPixel + 1;
+  }
+  return true;
+}
+
+//---------------------------------------------------------------------------
+class vtkSlicerVolumeReconstructionLogic::vtkInternal
+{
+public:
+  //---------------------------------------------------------------------------
+  vtkInternal(vtkSlicerVolumeReconstructionLogic* external);
+  ~vtkInternal();
+
+  /// Make the input image available to the tracked frame for the duration of a paste.
+  /// The scalars of the input image are shared (reference counted) rather than copied; a
+  /// converted copy is only made if the scalar type differs from the reconstructed volume.
+  bool SetTrackedFrameImage(igsioTrackedFrame& trackedFrame, vtkImageData* inputImageData, int outputScalarType);
+
+  /// Release the borrowed input image from the tracked frame.
+  void ReleaseTrackedFrameImage(igsioTrackedFrame& trackedFrame);
+
+  /// Update info.ImageToROIMatrix for the current frame.
+  /// The part of the chain above the image parent transform is only recomputed if it has been invalidated.
+  /// If the image to image parent matrix of the frame is specified, it is used instead of being computed.
+  void UpdateImageToROITransform(ReconstructionInfo& info, vtkMRMLVolumeNode* inputVolumeNode, vtkMRMLTransformableNode* roiNode,
+    vtkMatrix4x4* imageToParentMatrix = nullptr);
+
+  /// Compute the per-frame part of the chain: ImageToParent = LeafToParent * IJKToRAS
+  static void ComputeImageToParentMatrix(vtkMRMLVolumeNode* inputVolumeNode, vtkMatrix4x4* leafToParentMatrix,
+    vtkMatrix4x4* ijkToRASMatrix, vtkMatrix4x4* imageToParentMatrix);
+
+  /// Paste the input image into the reconstructors of all the frame pastes. The image is shared by all pastes,
+  /// and the independent reconstructors are pasted into in parallel. Returns false if any of the pastes failed.
+  bool AddImageToReconstructors(std::deque<ReconstructorFramePaste>& framePastes, vtkImageData* inputImageData);
+  static void PasteFrameIntoReconstructor(ReconstructorFramePaste* framePaste);
+
+  /// Add the current frame of the input volume to all the live reconstructions that use the input volume.
+  /// The frame and its transform to the image parent are read once, and the frame is pasted into all of their reconstructors.
+  void AddInputVolumeFrameToLiveReconstructions(vtkMRMLVolumeNode* inputVolumeNode);
+
+  /// Collect the transform nodes above the image parent transform and above the ROI, and the latest modified time of their transforms.
+  void GetTransformChainNodes(vtkMRMLVolumeNode* inputVolumeNode, vtkMRMLTransformableNode* roiNode,
+    std::vector<vtkMRMLTransformNode*>& transformNodes, vtkMTimeType& transformMTime);
+
+  /// Create a scalar volume node for a reconstructed volume and add it to the scene.
+  /// The node is named after the input volume node, followed by the name suffix.
+  vtkSmartPointer<vtkMRMLVolumeNode> AddReconstructedVolumeNode(vtkMRMLVolumeReconstructionNode* volumeReconstructionNode, const char* nameSuffix);
+
+  /// Move the origin and spacing of the image data of a reconstructed volume node to the node,
+  /// and place the node in the coordinate system of the input ROI
+  static void UpdateReconstructedVolumeNodeGeometry(vtkMRMLVolumeReconstructionNode* volumeReconstructionNode, vtkMRMLVolumeNode* volumeNode);
+
+  /// Apply the reconstruction parameters of the node that do not depend on the output geometry
+  void ConfigureReconstructor(vtkIGSIOVolumeReconstructor* reconstructor, vtkMRMLVolumeReconstructionNode* volumeReconstructionNode);
+  static void ConfigureHoleFiller(vtkIGSIOFillHolesInVolume* holeFiller);
+
+  /// Maximum distance, in voxels, of the voxels that the hole filling kernel configured in ConfigureHoleFiller reads
+  static const int HoleFillingHalo = 9;
+
+  /// Number of paste workers used for offline reconstruction. Returns 1 if the frames should be pasted sequentially.
+  int GetNumberOfPipelineWorkers(vtkMRMLVolumeReconstructionNode* volumeReconstructionNode);
+
+  /// Reconstruct all frames of the sequence using a pipeline: the calling thread reads the frames and resolves
+  /// their poses ahead, while paste workers reconstruct slabs of the output volume that are merged at the end.
+  bool ReconstructVolumeWithPipeline(vtkMRMLVolumeReconstructionNode* volumeReconstructionNode, SequenceFrameReader& frameReader, int numberOfWorkers);
+  /// Read all frames of the sequence and paste them using the workers. For out-of-core reconstruction, this is done once for each pass.
+  bool RunPipelinePass(vtkMRMLVolumeReconstructionNode* volumeReconstructionNode, SequenceFrameReader& frameReader,
+    std::vector<std::unique_ptr<PipelineSlabWorker>>& workers, int slabAxis, int passIndex, int numberOfPasses);
+  static void PipelineWorkerMain(PipelineSlabWorker* worker, std::atomic<int>* numberOfFramesCompleted, std::condition_variable* progressCondition);
+
+  /// Maximum number of frames waiting in the queue of each paste worker
+  static const size_t MaximumPipelineQueueSize = 16;
+
+  /// Padding of the slabs of the pipeline along the slab axis, in voxels.
+  /// Linear interpolation spreads each pixel over the voxels within one voxel, and a pixel is only pasted if all of them are in the extent.
+  static const int PipelineSlabPadding = 1;
+
+  /// Returns true if the output volume of the reconstruction from a sequence is backed by scratch files
+  static bool IsOutOfCoreReconstruction(vtkMRMLVolumeReconstructionNode* volumeReconstructionNode);
+
+  /// Allocate the buffers of the reconstructor for the whole volume, if out-of-core reconstruction has to paste the frames
+  /// into the reconstructor instead of the pipeline
+  void AllocateReconstructorVolume(vtkMRMLVolumeReconstructionNode* volumeReconstructionNode);
+
+  /// Allocate the scalars of the image, backed by a memory-mapped scratch file for out-of-core reconstruction
+  void AllocateVolumeScalars(vtkMRMLVolumeReconstructionNode* volumeReconstructionNode, vtkImageData* imageData, int scalarType, int numberOfComponents);
+
+  /// Approximate memory used by the slab reconstructors of an out-of-core reconstruction pass, in bytes
+  static constexpr double OutOfCorePassSizeBytes = 1024.0 * 1024.0 * 1024.0;
+
+  /// Returns true if the frame should not be pasted, because its image and pose are unchanged since the last pasted frame,
+  /// or because its pose is within the translation and rotation thresholds of the node. Otherwise the frame is recorded
+  /// as the last pasted frame.
+  bool ShouldSkipFrame(ReconstructionInfo& info, vtkMRMLVolumeReconstructionNode* volumeReconstructionNode,
+    vtkImageData* imageData, const double imageToROIMatrix[16]);
+
+  /// Mark the bricks of the output volume that the frame may touch as modified
+  void MarkFrameBricksModified(ReconstructionInfo& info, const int frameExtent[6], const double imageToROIMatrix[16]);
+
+  /// Copy the gray levels of the bricks modified since the last publish into the output image.
+  /// If holes are filled incrementally, the modified bricks and their neighbors are hole-filled instead of copied.
+  /// Returns false if the whole volume must be published instead.
+  bool PublishModifiedBricks(ReconstructionInfo& info, vtkMRMLVolumeReconstructionNode* volumeReconstructionNode,
+    vtkImageData* outputImageData, int updatedExtent[6]);
+
+  /// Fill holes in the bricks of the pasted volume and write the gray levels into the output image.
+  /// Each brick is filled from a block that includes the halo of the hole filling kernel, and the bricks are filled in parallel.
+  static void FillHolesInBricks(vtkImageData* pastedVolume, vtkImageData* accumulationBuffer, vtkImageData* outputImageData,
+    const std::vector<std::array<int, 6>>& brickExtents, int numberOfThreads);
+
+  /// Size of the bricks that modifications of the reconstructed volume are tracked in, in voxels
+  static const int BrickSize = 16;
+
+  /// Find the bricks of the sparse reconstruction that the frame may touch, and the frame pixels that may reach them.
+  /// Bricks that do not exist yet are created, and assigned to one of the paste workers by brick index.
+  void GetFrameSparseBrickPastes(ReconstructionInfo& info, vtkMRMLVolumeReconstructionNode* volumeReconstructionNode,
+    const int frameExtent[6], const double imageToROIMatrix[16], int numberOfWorkers, std::vector<SparseBrickPaste>& brickPastes);
+
+  /// Paste the frame into a brick of the sparse reconstruction. Must only be called from the thread that owns the brick.
+  static bool PasteFrameIntoSparseBrick(const SparseBrickPaste& brickPaste, igsioTrackedFrame& trackedFrame, vtkIGSIOTransformRepository* transformRepository);
+
+  /// Densify the bricks of the sparse reconstruction that intersect the extent of the output image.
+  /// Voxels that no frame was pasted into are set to zero. If holes are filled, the bricks within the halo of the
+  /// hole filling kernel around the extent are densified too, and the holes are filled the same way as in FillHolesInBricks.
+  void CopySparseBricksIntoImage(ReconstructionInfo& info, vtkMRMLVolumeReconstructionNode* volumeReconstructionNode, vtkImageData* outputImageData);
+
+  /// Size of the bricks of the sparse reconstruction, in voxels
+  static const int SparseBrickSize = 64;
+
+  vtkSlicerVolumeReconstructionLogic* External;
+
+  VolumeReconstuctorMap Reconstructors;
+
+  igsioTransformName ImageToROITransformName{"ImageToROI"};
+  std::vector<vtkMRMLTransformNode*> CurrentTransformNodes;
+};
+
+//----------------------------------------------------------------------------
+// vtkInternal methods
+
+//---------------------------------------------------------------------------
+vtkSlicerVolumeReconstructionLogic::vtkInternal::vtkInternal(vtkSlicerVolumeReconstructionLogic* external)
+  : External(external)
+{
+}
+
+//---------------------------------------------------------------------------
+vtkSlicerVolumeReconstructionLogic::vtkInternal::~vtkInternal()
+{
+}
+
+//---------------------------------------------------------------------------
+bool vtkSlicerVolumeReconstructionLogic::vtkInternal::SetTrackedFrameImage(igsioTrackedFrame& trackedFrame, vtkImageData* inputImageData, int outputScalarType)
+{
+  vtkImageData* frameImageData = trackedFrame.GetImageData()->GetImage();
+  if (!inputImageData || !frameImageData)
+  {
+    return false;
+  }
+
+  if (inputImageData->GetScalarType() == outputScalarType)
+  {
+    // The paster only reads the frame, so the tracked frame can reference the input scalars directly.
+    // The clip rectangle is applied by the paster, so it does not require a copy either.
+    frameImageData->ShallowCopy(inputImageData);
+    return true;
+  }
+
+  // Only voxels of the same scalar type can be pasted into the volume
+  vtkNew<vtkImageCast> imageCast;
+  imageCast->SetInputData(inputImageData);
+  imageCast->SetOutputScalarType(outputScalarType);
+  imageCast->Update();
+  frameImageData->ShallowCopy(imageCast->GetOutput());
+  return true;
+}
+
+//---------------------------------------------------------------------------
+void vtkSlicerVolumeReconstructionLogic::vtkInternal::ReleaseTrackedFrameImage(igsioTrackedFrame& trackedFrame)
+{
+  vtkImageData* frameImageData = trackedFrame.GetImageData()->GetImage();
+  if (frameImageData)
+  {
+    frameImageData->Initialize();
+  }
+}
+
+//---------------------------------------------------------------------------
+void vtkSlicerVolumeReconstructionLogic::vtkInternal::GetTransformChainNodes(vtkMRMLVolumeNode* inputVolumeNode, vtkMRMLTransformableNode* roiNode,
+  std::vector<vtkMRMLTransformNode*>& transformNodes, vtkMTimeType& transformMTime)
+{
+  transformNodes.clear();
+  transformMTime = 0;
+
+  vtkMRMLTransformNode* leafTransformNode = inputVolumeNode->GetParentTransformNode();
+  transformNodes.push_back(leafTransformNode);
+  for (vtkMRMLTransformNode* transformNode = leafTransformNode ? leafTransformNode->GetParentTransformNode() : nullptr;
+    transformNode; transformNode = transformNode->GetParentTransformNode())
+  {
+    transformNodes.push_back(transformNode);
+    if (transformNode->GetTransformToParent())
+    {
+      transformMTime = std::max(transformMTime, transformNode->GetTransformToParent()->GetMTime());
+    }
+  }
+
+  // Separates the image and ROI branches of the chain
+  transformNodes.push_back(nullptr);
+  for (vtkMRMLTransformNode* transformNode = roiNode->GetParentTransformNode();
+    transformNode; transformNode = transformNode->GetParentTransformNode())
+  {
+    transformNodes.push_back(transformNode);
+    if (transformNode->GetTransformToParent())
+    {
+      transformMTime = std::max(transformMTime, transformNode->GetTransformToParent()->GetMTime());
+    }
+  }
+
+  vtkMRMLMarkupsROINode* markupsROINode = vtkMRMLMarkupsROINode::SafeDownCast(roiNode);
+  if (markupsROINode && markupsROINode->GetObjectToNodeMatrix())
+  {
+    transformMTime = std::max(transformMTime, markupsROINode->GetObjectToNodeMatrix()->GetMTime());
+  }
+}
+
+//---------------------------------------------------------------------------
+void vtkSlicerVolumeReconstructionLogic::vtkInternal::UpdateImageToROITransform(ReconstructionInfo& info, vtkMRMLVolumeNode* inputVolumeNode,
+  vtkMRMLTransformableNode* roiNode, vtkMatrix4x4* imageToParentMatrix/*=nullptr*/)
+{
+  ImageToROITransformChain& chain = info.TransformChain;
+
+  vtkMTimeType transformMTime = 0;
+  this->GetTransformChainNodes(inputVolumeNode, roiNode, this->CurrentTransformNodes, transformMTime);
+  if (!chain.Valid || chain.ROINode != roiNode || chain.TransformMTime != transformMTime || chain.TransformNodes != this->CurrentTransformNodes)
+  {
+    vtkNew<vtkTransform> parentToROITransform;
+    parentToROITransform->PostMultiply();
+
+    vtkMRMLTransformNode* leafTransformNode = inputVolumeNode->GetParentTransformNode();
+    vtkMRMLTransformNode* imageParentTransformNode = leafTransformNode ? leafTransformNode->GetParentTransformNode() : nullptr;
+    if (imageParentTransformNode)
+    {
+      vtkNew<vtkMatrix4x4> parentToWorldMatrix;
+      imageParentTransformNode->GetMatrixTransformToWorld(parentToWorldMatrix);
+      parentToROITransform->Concatenate(parentToWorldMatrix);
+    }
+
+    vtkMRMLTransformNode* roiParentTransformNode = roiNode->GetParentTransformNode();
+    if (roiParentTransformNode)
+    {
+      vtkNew<vtkMatrix4x4> worldToParentMatrix;
+      roiParentTransformNode->GetMatrixTransformFromWorld(worldToParentMatrix);
+      parentToROITransform->Concatenate(worldToParentMatrix);
+    }
+
+    vtkMRMLMarkupsROINode* markupsROINode = vtkMRMLMarkupsROINode::SafeDownCast(roiNode);
+    if (markupsROINode)
+    {
+      vtkNew<vtkMatrix4x4> nodeToObjectMatrix;
+      vtkMatrix4x4::Invert(markupsROINode->GetObjectToNodeMatrix(), nodeToObjectMatrix);
+      parentToROITransform->Concatenate(nodeToObjectMatrix);
+    }
+
+    chain.ParentToROIMatrix->DeepCopy(parentToROITransform->GetMatrix());
+    chain.ROINode = roiNode;
+    chain.TransformMTime = transformMTime;
+    chain.TransformNodes = this->CurrentTransformNodes;
+    chain.Valid = true;
+  }
+
+  // Per-frame part of the chain: ImageToROI = ParentToROI * LeafToParent * IJKToRAS
+  if (imageToParentMatrix)
+  {
+    vtkMatrix4x4::Multiply4x4(chain.ParentToROIMatrix, imageToParentMatrix, info.ImageToROIMatrix);
+    return;
+  }
+  ComputeImageToParentMatrix(inputVolumeNode, info.LeafToParentMatrix, info.IJKToRASMatrix, info.ImageToROIMatrix);
+  vtkMatrix4x4::Multiply4x4(chain.ParentToROIMatrix, info.ImageToROIMatrix, info.ImageToROIMatrix);
+}
+
+//---------------------------------------------------------------------------
+void vtkSlicerVolumeReconstructionLogic::vtkInternal::ComputeImageToParentMatrix(vtkMRMLVolumeNode* inputVolumeNode,
+  vtkMatrix4x4* leafToParentMatrix, vtkMatrix4x4* ijkToRASMatrix, vtkMatrix4x4* imageToParentMatrix)
+{
+  vtkMRMLTransformNode* leafTransformNode = inputVolumeNode->GetParentTransformNode();
+  if (leafTransformNode)
+  {
+    leafTransformNode->GetMatrixTransformToParent(leafToParentMatrix);
+  }
+  else
+  {
+    leafToParentMatrix->Identity();
+  }
+  inputVolumeNode->GetIJKToRASMatrix(ijkToRASMatrix);
+  vtkMatrix4x4::Multiply4x4(leafToParentMatrix, ijkToRASMatrix, imageToParentMatrix);
+}
+
+//---------------------------------------------------------------------------
+vtkSmartPointer<vtkMRMLVolumeNode> vtkSlicerVolumeReconstructionLogic::vtkInternal::AddReconstructedVolumeNode(
+  vtkMRMLVolumeReconstructionNode* volumeReconstructionNode, const char* nameSuffix)
+{
+  vtkMRMLScene* scene = this->External->GetMRMLScene();
+  vtkSmartPointer<vtkMRMLVolumeNode> volumeNode;
+  if (scene)
+  {
+    volumeNode = vtkSmartPointer<vtkMRMLVolumeNode>::Take(vtkMRMLVolumeNode::SafeDownCast(scene->CreateNodeByClass("vtkMRMLScalarVolumeNode")));
+  }
+  if (!volumeNode)
+  {
+    volumeNode = vtkSmartPointer<vtkMRMLScalarVolumeNode>::New();
+  }
+
+  vtkMRMLVolumeNode* inputVolumeNode = volumeReconstructionNode->GetInputVolumeNode();
+  if (inputVolumeNode && inputVolumeNode->GetName())
+  {
+    std::string volumeNodeName = inputVolumeNode->GetName();
+    volumeNodeName += "_";
+    volumeNodeName += nameSuffix;
+    volumeNode->SetName(volumeNodeName.c_str());
+  }
+  else
+  {
+    volumeNode->SetName(nameSuffix);
+  }
+
+  if (scene)
+  {
+    scene->AddNode(volumeNode);
+  }
+  return volumeNode;
+}
+
+//---------------------------------------------------------------------------
+void vtkSlicerVolumeReconstructionLogic::vtkInternal::UpdateReconstructedVolumeNodeGeometry(vtkMRMLVolumeReconstructionNode* volumeReconstructionNode,
+  vtkMRMLVolumeNode* volumeNode)
+{
+  double spacing[3] = { 0.0, 0.0, 0.0 };
+  volumeNode->GetImageData()->GetSpacing(spacing);
+  volumeNode->GetImageData()->SetSpacing(1.0, 1.0, 1.0);
+  volumeNode->SetSpacing(spacing);
+
+  double origin[3] = { 0.0, 0.0, 0.0 };
+  volumeNode->GetImageData()->GetOrigin(origin);
+  volumeNode->GetImageData()->SetOrigin(0.0, 0.0, 0.0);
+  volumeNode->SetOrigin(origin);
+
+  const char* parentTransformNodeID = nullptr;
+  vtkMRMLTransformableNode* inputROINode = vtkMRMLTransformableNode::SafeDownCast(volumeReconstructionNode->GetInputROINode());
+  if (inputROINode && inputROINode->GetParentTransformNode())
+  {
+    parentTransformNodeID = inputROINode->GetParentTransformNode()->GetID();
+  }
+  volumeNode->SetAndObserveTransformNodeID(parentTransformNodeID);
+
+  vtkMRMLMarkupsROINode* markupsROINode = vtkMRMLMarkupsROINode::SafeDownCast(inputROINode);
+  if (markupsROINode)
+  {
+    vtkMatrix4x4* objectToNodeMatrix = markupsROINode->GetObjectToNodeMatrix();
+    volumeNode->SetIJKToRASDirectionMatrix(objectToNodeMatrix);
+
+    // Reconstructed volume origin is in ROI coordinates. Need to convert to Node
+    vtkNew<vtkTransform> objectToNodeTransform;
+    objectToNodeTransform->SetMatrix(objectToNodeMatrix);
+    objectToNodeTransform->TransformPoint(origin, origin);
+    volumeNode->SetOrigin(origin);
+  }
+}
+
+//---------------------------------------------------------------------------
+void vtkSlicerVolumeReconstructionLogic::vtkInternal::ConfigureReconstructor(vtkIGSIOVolumeReconstructor* reconstructor, vtkMRMLVolumeReconstructionNode* volumeReconstructionNode)
+{
+  reconstructor->SetCompoundingMode(vtkIGSIOPasteSliceIntoVolume::CompoundingType(volumeReconstructionNode->GetCompoundingMode()));
+  reconstructor->SetOptimization(vtkIGSIOPasteSliceIntoVolume::OptimizationType(volumeReconstructionNode->GetOptimizationMode()));
+  reconstructor->SetInterpolation(vtkIGSIOPasteSliceIntoVolume::InterpolationType(volumeReconstructionNode->GetInterpolationMode()));
+  reconstructor->SetNumberOfThreads(volumeReconstructionNode->GetNumberOfThreads());
+  reconstructor->SetFillHoles(volumeReconstructionNode->GetFillHoles());
+  if (volumeReconstructionNode->GetFillHoles())
+  {
+    vtkSlicerVolumeReconstructionLogic::vtkInternal::ConfigureHoleFiller(reconstructor->GetHoleFiller());
+  }
+  reconstructor->SetImageCoordinateFrame("Image");
+  reconstructor->SetReferenceCoordinateFrame("ROI");
+  reconstructor->SetClipRectangleOrigin(volumeReconstructionNode->GetClipRectangleOrigin());
+  reconstructor->SetClipRectangleSize(volumeReconstructionNode->GetClipRectangleSize());
+}
+
+//---------------------------------------------------------------------------
+void vtkSlicerVolumeReconstructionLogic::vtkInternal::ConfigureHoleFiller(vtkIGSIOFillHolesInVolume* holeFiller)
+{
+  holeFiller->SetNumHFElements(1);
+  holeFiller->AllocateHFElements();
+  FillHolesInVolumeElement hfElement;
+  hfElement.setupAsStick(9, 1);
+  holeFiller->SetHFElement(0, hfElement);
+}
+
+//---------------------------------------------------------------------------
+int vtkSlicerVolumeReconstructionLogic::vtkInternal::GetNumberOfPipelineWorkers(vtkMRMLVolumeReconstructionNode* volumeReconstructionNode)
+{
+  if (volumeReconstructionNode->GetOptimizationMode() == vtkMRMLVolumeReconstructionNode::GPU_ACCELERATION_OPENCL)
+  {
+    // The GPU paster is not shared between threads
+    return 1;
+  }
+
+  int numberOfWorkers = volumeReconstructionNode->GetNumberOfThreads();
+  if (numberOfWorkers <= 0)
+  {
+    numberOfWorkers = static_cast<int>(std::thread::hardware_concurrency());
+  }
+  return std::max(numberOfWorkers, 1);
+}
+
+//---------------------------------------------------------------------------
+bool vtkSlicerVolumeReconstructionLogic::vtkInternal::IsOutOfCoreReconstruction(vtkMRMLVolumeReconstructionNode* volumeReconstructionNode)
+{
+  // Live reconstruction pastes into the volume of the reconstructor, which is always in memory
+  return volumeReconstructionNode->GetOutOfCoreReconstruction() && !volumeReconstructionNode->GetLiveVolumeReconstruction();
+}
+
+//---------------------------------------------------------------------------
+void vtkSlicerVolumeReconstructionLogic::vtkInternal::AllocateReconstructorVolume(vtkMRMLVolumeReconstructionNode* volumeReconstructionNode)
+{
+  if (!IsOutOfCoreReconstruction(volumeReconstructionNode) || volumeReconstructionNode->GetSparseAccumulation())
+  {
+    return;
+  }
+  ReconstructionInfo& info = this->Reconstructors[volumeReconstructionNode];
+  vtkWarningWithObjectMacro(this->External, "Out-of-core reconstruction requires reading the frames from a sequence with multiple frames,"
+    " the volume is reconstructed in memory");
+  info.Reconstructor->SetOutputExtent(info.OutputExtent);
+  info.Reconstructor->Reset();
+}
+
+//---------------------------------------------------------------------------
+void vtkSlicerVolumeReconstructionLogic::vtkInternal::AllocateVolumeScalars(vtkMRMLVolumeReconstructionNode* volumeReconstructionNode,
+  vtkImageData* imageData, int scalarType, int numberOfComponents)
+{
+  vtkIdType numberOfValues = imageData->GetNumberOfPoints() * numberOfComponents;
+  if (!IsOutOfCoreReconstruction(volumeReconstructionNode) || numberOfValues <= 0)
+  {
+    imageData->AllocateScalars(scalarType, numberOfComponents);
+    return;
+  }
+
+  std::string scratchDirectory;
+  if (volumeReconstructionNode->GetScratchDirectory() && strlen(volumeReconstructionNode->GetScratchDirectory()) > 0)
+  {
+    scratchDirectory = volumeReconstructionNode->GetScratchDirectory();
+  }
+  else
+  {
+#ifdef _WIN32
+    const char* temporaryDirectoryVariables[] = { "TMP", "TEMP" };
+#else
+    const char* temporaryDirectoryVariables[] = { "TMPDIR", "TMP" };
+#endif
+    for (const char* variable : temporaryDirectoryVariables)
+    {
+      if (vtksys::SystemTools::GetEnv(variable, scratchDirectory) && !scratchDirectory.empty())
+      {
+        break;
+      }
+    }
+    if (scratchDirectory.empty())
+    {
+      scratchDirectory = vtksys::SystemTools::GetCurrentWorkingDirectory();
+    }
+  }
+
+  vtkSmartPointer<vtkDataArray> scalars = vtkSmartPointer<vtkDataArray>::Take(vtkDataArray::CreateDataArray(scalarType));
+  std::unique_ptr<ScratchFileMapping> mapping(new ScratchFileMapping());
+  if (!scalars || !mapping->Create(scratchDirectory, static_cast<size_t>(numberOfValues) * scalars->GetDataTypeSize()))
+  {
+    vtkErrorWithObjectMacro(this->External, "AllocateVolumeScalars: Could not create a scratch file in " << scratchDirectory
+      << ", the volume is allocated in memory");
+    imageData->AllocateScalars(scalarType, numberOfComponents);
+    return;
+  }
+
+  void* data = mapping->GetData();
+  {
+    std::lock_guard<std::mutex> lock(ScratchFileMappingsMutex);
+    ScratchFileMappings[data] = std::move(mapping);
+  }
+  scalars->SetNumberOfComponents(numberOfComponents);
+  scalars->SetVoidArray(data, numberOfValues, 0, vtkAbstractArray::VTK_DATA_ARRAY_USER_DEFINED);
+  scalars->SetArrayFreeFunction(&ReleaseScratchFileArray);
+  imageData->GetPointData()->SetScalars(scalars);
+}
+
+//---------------------------------------------------------------------------
+void vtkSlicerVolumeReconstructionLogic::vtkInternal::GetFrameSparseBrickPastes(ReconstructionInfo& info,
+  vtkMRMLVolumeReconstructionNode* volumeReconstructionNode, const int frameExtent[6], const double imageToROIMatrix[16],
+  int numberOfWorkers, std::vector<SparseBrickPaste>& brickPastes)
+{
+  brickPastes.clear();
+
+  double frameBounds[6] = { VTK_DOUBLE_MAX, VTK_DOUBLE_MIN, VTK_DOUBLE_MAX, VTK_DOUBLE_MIN, VTK_DOUBLE_MAX, VTK_DOUBLE_MIN };
+  ExpandBoundsWithImageCorners(frameExtent, imageToROIMatrix, frameBounds);
+
+  int firstBrick[3] = { 0, 0, 0 };
+  int lastBrick[3] = { 0, 0, 0 };
+  for (int axis = 0; axis < 3; ++axis)
+  {
+    // One voxel margin for the interpolation kernel
+    int firstVoxel = static_cast<int>(std::floor((frameBounds[2 * axis] - info.OutputOrigin[axis]) / info.OutputSpacing[axis])) - 1;
+    int lastVoxel = static_cast<int>(std::ceil((frameBounds[2 * axis + 1] - info.OutputOrigin[axis]) / info.OutputSpacing[axis])) + 1;
+    firstVoxel = std::max(firstVoxel, info.OutputExtent[2 * axis]);
+    lastVoxel = std::min(lastVoxel, info.OutputExtent[2 * axis + 1]);
+    if (firstVoxel > lastVoxel)
+    {
+      // The frame is outside of the volume
+      return;
+    }
+    firstBrick[axis] = (firstVoxel - info.OutputExtent[2 * axis]) / SparseBrickSize;
+    lastBrick[axis] = (lastVoxel - info.OutputExtent[2 * axis]) / SparseBrickSize;
+  }
+
+  double roiToImageMatrix[16];
+  vtkMatrix4x4::Invert(imageToROIMatrix, roiToImageMatrix);
+
+  for (int k = firstBrick[2]; k <= lastBrick[2]; ++k)
+  {
+    for (int j = firstBrick[1]; j <= lastBrick[1]; ++j)
+    {
+      for (int i = firstBrick[0]; i <= lastBrick[0]; ++i)
+      {
+        int brick[3] = { i, j, k };
+        int brickExtent[6] = { 0, 0, 0, 0, 0, 0 };
+        int paddedBrickExtent[6] = { 0, 0, 0, 0, 0, 0 };
+        for (int axis = 0; axis < 3; ++axis)
+        {
+          brickExtent[2 * axis] = info.OutputExtent[2 * axis] + brick[axis] * SparseBrickSize;
+          brickExtent[2 * axis + 1] = std::min(brickExtent[2 * axis] + SparseBrickSize - 1, info.OutputExtent[2 * axis + 1]);
+          paddedBrickExtent[2 * axis] = std::max(brickExtent[2 * axis] - PipelineSlabPadding, info.OutputExtent[2 * axis]);
+          paddedBrickExtent[2 * axis + 1] = std::min(brickExtent[2 * axis + 1] + PipelineSlabPadding, info.OutputExtent[2 * axis + 1]);
+        }
+
+        // Frames of a sweep are usually oblique to the brick grid, most bricks in their bounding box are not touched
+        SparseBrickPaste brickPaste;
+        if (!GetBlockClipRectangle(paddedBrickExtent, info.OutputOrigin, info.OutputSpacing, roiToImageMatrix, frameExtent,
+          volumeReconstructionNode->GetClipRectangleOrigin(), volumeReconstructionNode->GetClipRectangleSize(),
+          brickPaste.ClipRectangleOrigin, brickPaste.ClipRectangleSize))
+        {
+          continue;
+        }
+
+        vtkIdType brickIndex = (static_cast<vtkIdType>(k) * info.SparseBrickGridSize[1] + j) * info.SparseBrickGridSize[0] + i;
+        std::unique_ptr<SparseBrick>& sparseBrick = info.SparseBricks[brickIndex];
+        if (!sparseBrick)
+        {
+          sparseBrick.reset(new SparseBrick());
+          std::copy(brickExtent, brickExtent + 6, sparseBrick->Extent);
+          std::copy(paddedBrickExtent, paddedBrickExtent + 6, sparseBrick->PaddedExtent);
+          sparseBrick->WorkerIndex = static_cast<int>(brickIndex % std::max(numberOfWorkers, 1));
+
+          int reconstructorExtent[6] = { 0, 0, 0, 0, 0, 0 };
+          double reconstructorOrigin[3] = { 0.0, 0.0, 0.0 };
+          for (int axis = 0; axis < 3; ++axis)
+          {
+            reconstructorExtent[2 * axis + 1] = paddedBrickExtent[2 * axis + 1] - paddedBrickExtent[2 * axis];
+            reconstructorOrigin[axis] = info.OutputOrigin[axis] + paddedBrickExtent[2 * axis] * info.OutputSpacing[axis];
+          }
+          this->ConfigureReconstructor(sparseBrick->Reconstructor, volumeReconstructionNode);
+          sparseBrick->Reconstructor->SetNumberOfThreads(1);
+          // Holes are filled once the bricks are densified, with the pasted voxels of the neighboring bricks
+          sparseBrick->Reconstructor->SetFillHoles(false);
+          sparseBrick->Reconstructor->SetOutputExtent(reconstructorExtent);
+          sparseBrick->Reconstructor->SetOutputOrigin(reconstructorOrigin);
+          sparseBrick->Reconstructor->SetOutputSpacing(info.OutputSpacing);
+          sparseBrick->Reconstructor->SetOutputScalarType(info.OutputScalarType);
+        }
+        brickPaste.Brick = sparseBrick.get();
+        brickPastes.push_back(brickPaste);
+      }
+    }
+  }
+}
+
+//---------------------------------------------------------------------------
+bool vtkSlicerVolumeReconstructionLogic::vtkInternal::PasteFrameIntoSparseBrick(const SparseBrickPaste& brickPaste,
+  igsioTrackedFrame& trackedFrame, vtkIGSIOTransformRepository* transformRepository)
+{
+  SparseBrick* sparseBrick = brickPaste.Brick;
+  bool isFirst = !sparseBrick->Allocated;
+  if (!sparseBrick->Allocated)
+  {
+    sparseBrick->Reconstructor->Reset();
+    sparseBrick->Allocated = true;
+  }
+  // Only the pixels that may reach the brick are pasted
+  int clipRectangleOrigin[2] = { brickPaste.ClipRectangleOrigin[0], brickPaste.ClipRectangleOrigin[1] };
+  int clipRectangleSize[2] = { brickPaste.ClipRectangleSize[0], brickPaste.ClipRectangleSize[1] };
+  sparseBrick->Reconstructor->SetClipRectangleOrigin(clipRectangleOrigin);
+  sparseBrick->Reconstructor->SetClipRectangleSize(clipRectangleSize);
+  bool insertedIntoVolume = false;
+  return sparseBrick->Reconstructor->AddTrackedFrame(&trackedFrame, transformRepository, isFirst, false, &insertedIntoVolume) == IGSIO_SUCCESS;
+}
+
+//---------------------------------------------------------------------------
+void vtkSlicerVolumeReconstructionLogic::vtkInternal::CopySparseBricksIntoImage(ReconstructionInfo& info,
+  vtkMRMLVolumeReconstructionNode* volumeReconstructionNode, vtkImageData* outputImageData)
+{
+  int* outputExtent = outputImageData->GetExtent();
+  const bool fillHoles = volumeReconstructionNode->GetFillHoles();
+
+  // The pasted voxels are densified into the output image, or into a block with the hole filling halo around the output extent
+  vtkSmartPointer<vtkImageData> pastedImageData = outputImageData;
+  vtkSmartPointer<vtkImageData> accumulationImageData;
+  if (fillHoles)
+  {
+    int blockExtent[6] = { 0, 0, 0, 0, 0, 0 };
+    for (int axis = 0; axis < 3; ++axis)
+    {
+      blockExtent[2 * axis] = std::max(outputExtent[2 * axis] - HoleFillingHalo, info.OutputExtent[2 * axis]);
+      blockExtent[2 * axis + 1] = std::min(outputExtent[2 * axis + 1] + HoleFillingHalo, info.OutputExtent[2 * axis + 1]);
+    }
+    pastedImageData = vtkSmartPointer<vtkImageData>::New();
+    pastedImageData->SetExtent(blockExtent);
+    this->AllocateVolumeScalars(volumeReconstructionNode, pastedImageData, outputImageData->GetScalarType(), 1);
+    accumulationImageData = vtkSmartPointer<vtkImageData>::New();
+    accumulationImageData->SetExtent(blockExtent);
+    this->AllocateVolumeScalars(volumeReconstructionNode, accumulationImageData, VTK_UNSIGNED_SHORT, 1);
+    memset(accumulationImageData->GetScalarPointer(), 0,
+      static_cast<size_t>(accumulationImageData->GetNumberOfPoints()) * accumulationImageData->GetScalarSize());
+  }
+  memset(pastedImageData->GetScalarPointer(), 0,
+    static_cast<size_t>(pastedImageData->GetNumberOfPoints()) * pastedImageData->GetScalarSize() * pastedImageData->GetNumberOfScalarComponents());
+
+  int* pastedExtent = pastedImageData->GetExtent();
+  vtkNew<vtkImageData> brickImageData;
+  for (auto& indexAndBrick : info.SparseBricks)
+  {
+    SparseBrick* sparseBrick = indexAndBrick.second.get();
+    if (!sparseBrick->Allocated)
+    {
+      continue;
+    }
+    bool intersects = true;
+    for (int axis = 0; axis < 3; ++axis)
+    {
+      intersects = intersects && sparseBrick->Extent[2 * axis] <= pastedExtent[2 * axis + 1]
+        && sparseBrick->Extent[2 * axis + 1] >= pastedExtent[2 * axis];
+    }
+    if (!intersects)
+    {
+      continue;
+    }
+    // The padding of the brick is owned by the neighboring bricks
+    int brickOffset[3] = { sparseBrick->PaddedExtent[0], sparseBrick->PaddedExtent[2], sparseBrick->PaddedExtent[4] };
+    if (sparseBrick->Reconstructor->GetReconstructedVolume(brickImageData, false) == IGSIO_SUCCESS)
+    {
+      CopyBlockIntoVolume(brickImageData, brickOffset, pastedImageData, sparseBrick->Extent);
+    }
+    if (accumulationImageData && sparseBrick->Reconstructor->ExtractAccumulation(brickImageData) == IGSIO_SUCCESS)
+    {
+      CopyBlockIntoVolume(brickImageData, brickOffset, accumulationImageData, sparseBrick->Extent);
+    }
+  }
+
+  if (!fillHoles)
+  {
+    return;
+  }
+
+  // Fill the holes of the output extent in blocks of the size of the sparse bricks
+  std::vector<std::array<int, 6>> blockExtents;
+  for (int k = outputExtent[4]; k <= outputExtent[5]; k += SparseBrickSize)
+  {
+    for (int j = outputExtent[2]; j <= outputExtent[3]; j += SparseBrickSize)
+    {
+      for (int i = outputExtent[0]; i <= outputExtent[1]; i += SparseBrickSize)
+      {
+        std::array<int, 6> blockExtent =
+        {
+          i, std::min(i + SparseBrickSize - 1, outputExtent[1]),
+          j, std::min(j + SparseBrickSize - 1, outputExtent[3]),
+          k, std::min(k + SparseBrickSize - 1, outputExtent[5])
+        };
+        blockExtents.push_back(blockExtent);
+      }
+    }
+  }
+  int numberOfThreads = volumeReconstructionNode->GetNumberOfThreads();
+  if (numberOfThreads <= 0)
+  {
+    numberOfThreads = static_cast<int>(std::thread::hardware_concurrency());
+  }
+  FillHolesInBricks(pastedImageData, accumulationImageData, outputImageData, blockExtents, std::max(numberOfThreads, 1));
+}
+
+//---------------------------------------------------------------------------
+void vtkSlicerVolumeReconstructionLogic::vtkInternal::PipelineWorkerMain(PipelineSlabWorker* worker,
+  std::atomic<int>* numberOfFramesCompleted, std::condition_variable* progressCondition)
+{
+  bool isFirst = true;
+  igsioTrackedFrame trackedFrame;
+  igsioTransformName imageToROITransformName("ImageToROI");
+  while (true)
+  {
+    PipelineFrame frame;
+    {
+      std::unique_lock<std::mutex> lock(worker->QueueMutex);
+      worker->QueueCondition.wait(lock, [worker] { return !worker->Queue.empty() || worker->EndOfFrames; });
+      if (worker->Queue.empty())
+      {
+        break;
+      }
+      frame = worker->Queue.front();
+      worker->Queue.pop_front();
+    }
+    // Let the reader know that there is room in the queue
+    worker->QueueCondition.notify_all();
+
+    worker->ImageToROIMatrix->DeepCopy(frame.ImageToROIMatrix);
+    worker->TransformRepository->SetTransform(imageToROITransformName, worker->ImageToROIMatrix);
+    trackedFrame.GetImageData()->GetImage()->ShallowCopy(frame.Image);
+    if (!frame.SparseBrickPastes.empty())
+    {
+      for (const SparseBrickPaste& brickPaste : frame.SparseBrickPastes)
+      {
+        if (!vtkInternal::PasteFrameIntoSparseBrick(brickPaste, trackedFrame, worker->TransformRepository))
+        {
+          worker->Failed = true;
+        }
+      }
+    }
+    else
+    {
+      bool insertedIntoVolume = false;
+      if (worker->Reconstructor->AddTrackedFrame(&trackedFrame, worker->TransformRepository, isFirst, false, &insertedIntoVolume) != IGSIO_SUCCESS)
+      {
+        worker->Failed = true;
+      }
+    }
+    trackedFrame.GetImageData()->GetImage()->Initialize();
+    frame.Image = nullptr;
+    isFirst = false;
+
+    if (--(*frame.RemainingWorkers) == 0)
+    {
+      ++(*numberOfFramesCompleted);
+      progressCondition->notify_all();
+    }
+  }
+}
+
+//---------------------------------------------------------------------------
+bool vtkSlicerVolumeReconstructionLogic::vtkInternal::ReconstructVolumeWithPipeline(vtkMRMLVolumeReconstructionNode* volumeReconstructionNode,
+  SequenceFrameReader& frameReader, int numberOfWorkers)
+{
+  ReconstructionInfo& info = this->Reconstructors[volumeReconstructionNode];
+
+  vtkNew<vtkMatrix4x4> imageToROIMatrix;
+  vtkMRMLVolumeNode* firstFrameVolumeNode = frameReader.GetFrame(0, imageToROIMatrix);
+  if (!firstFrameVolumeNode || !firstFrameVolumeNode->GetImageData())
+  {
+    return false;
+  }
+  info.OutputScalarType = firstFrameVolumeNode->GetImageData()->GetScalarType();
+  const bool sparseAccumulation = volumeReconstructionNode->GetSparseAccumulation();
+  const bool outOfCore = !sparseAccumulation && this->IsOutOfCoreReconstruction(volumeReconstructionNode);
+
+  // Split the output volume into slabs along its longest axis, which is usually the sweep direction.
+  // For out-of-core reconstruction, the slabs are along the slowest varying axis instead, so that each slab
+  // is a contiguous range of the scratch file and merging the slabs writes the file sequentially.
+  int slabAxis = 0;
+  for (int axis = 1; axis < 3; ++axis)
+  {
+    if (info.OutputExtent[2 * axis + 1] - info.OutputExtent[2 * axis] > info.OutputExtent[2 * slabAxis + 1] - info.OutputExtent[2 * slabAxis])
+    {
+      slabAxis = axis;
+    }
+  }
+  if (outOfCore)
+  {
+    slabAxis = 2;
+  }
+  const int slabAxisStart = info.OutputExtent[2 * slabAxis];
+  const int slabAxisLength = info.OutputExtent[2 * slabAxis + 1] - slabAxisStart + 1;
+  numberOfWorkers = std::min(numberOfWorkers, slabAxisLength);
+  if (numberOfWorkers < 2 && !outOfCore)
+  {
+    return false;
+  }
+
+  // For out-of-core reconstruction, only the slabs of one pass are in memory at a time
+  int numberOfPasses = 1;
+  if (outOfCore)
+  {
+    double numberOfVoxels = 1.0;
+    for (int axis = 0; axis < 3; ++axis)
+    {
+      numberOfVoxels *= info.OutputExtent[2 * axis + 1] - info.OutputExtent[2 * axis] + 1;
+    }
+    // Gray level and alpha of the pasted volume, and the accumulation buffer
+    double bytesPerVoxel = 2.0 * vtkDataArray::GetDataTypeSize(info.OutputScalarType) + sizeof(unsigned short);
+    numberOfPasses = static_cast<int>(std::ceil(numberOfVoxels * bytesPerVoxel / OutOfCorePassSizeBytes));
+    numberOfPasses = std::max(1, std::min(numberOfPasses, slabAxisLength / numberOfWorkers));
+  }
+
+  vtkSmartPointer<vtkImageData> mergedVolume;
+  vtkSmartPointer<vtkImageData> mergedAccumulation;
+  if (!sparseAccumulation)
+  {
+    mergedVolume = vtkSmartPointer<vtkImageData>::New();
+    mergedVolume->SetExtent(info.OutputExtent);
+    mergedVolume->SetOrigin(info.OutputOrigin);
+    mergedVolume->SetSpacing(info.OutputSpacing);
+    this->AllocateVolumeScalars(volumeReconstructionNode, mergedVolume, info.OutputScalarType, 1);
+
+    // Out-of-core reconstruction fills the holes within each slab, the accumulation of the whole volume is not kept
+    if (volumeReconstructionNode->GetFillHoles() && !outOfCore)
+    {
+      mergedAccumulation = vtkSmartPointer<vtkImageData>::New();
+      mergedAccumulation->SetExtent(info.OutputExtent);
+      mergedAccumulation->SetOrigin(info.OutputOrigin);
+      mergedAccumulation->SetSpacing(info.OutputSpacing);
+      mergedAccumulation->AllocateScalars(VTK_UNSIGNED_SHORT, 1);
+    }
+  }
+
+  bool success = true;
+  for (int passIndex = 0; passIndex < numberOfPasses; ++passIndex)
+  {
+    const int passStart = slabAxisStart + (slabAxisLength * passIndex) / numberOfPasses;
+    const int passLength = slabAxisStart + (slabAxisLength * (passIndex + 1)) / numberOfPasses - passStart;
+    const int numberOfPassWorkers = std::min(numberOfWorkers, passLength);
+    // Out-of-core slabs fill their own holes, so they are padded by the hole filling halo too
+    const int slabPadding = PipelineSlabPadding + ((outOfCore && volumeReconstructionNode->GetFillHoles()) ? HoleFillingHalo : 0);
+
+    std::vector<std::unique_ptr<PipelineSlabWorker>> workers;
+    for (int workerIndex = 0; workerIndex < numberOfPassWorkers; ++workerIndex)
+    {
+      std::unique_ptr<PipelineSlabWorker> worker(new PipelineSlabWorker());
+      if (sparseAccumulation)
+      {
+        // The worker pastes into the bricks that are assigned to it, instead of into a slab
+        worker->Reconstructor = nullptr;
+        workers.push_back(std::move(worker));
+        continue;
+      }
+      worker->SlabStart = passStart + (passLength * workerIndex) / numberOfPassWorkers;
+      worker->SlabEnd = passStart + (passLength * (workerIndex + 1)) / numberOfPassWorkers - 1;
+      // The padding is not extended beyond the volume, where a single reconstructor clips the interpolation kernel too
+      worker->PaddedSlabStart = std::max(worker->SlabStart - slabPadding, info.OutputExtent[2 * slabAxis]);
+      worker->PaddedSlabEnd = std::min(worker->SlabEnd + slabPadding, info.OutputExtent[2 * slabAxis + 1]);
+
+      int slabExtent[6] = { 0, 0, 0, 0, 0, 0 };
+      double slabOrigin[3] = { 0.0, 0.0, 0.0 };
+      for (int axis = 0; axis < 3; ++axis)
+      {
+        slabExtent[2 * axis + 1] = info.OutputExtent[2 * axis + 1] - info.OutputExtent[2 * axis];
+        slabOrigin[axis] = info.OutputOrigin[axis] + info.OutputExtent[2 * axis] * info.OutputSpacing[axis];
+      }
+      slabExtent[2 * slabAxis + 1] = worker->PaddedSlabEnd - worker->PaddedSlabStart;
+      slabOrigin[slabAxis] = info.OutputOrigin[slabAxis] + worker->PaddedSlabStart * info.OutputSpacing[slabAxis];
+
+      this->ConfigureReconstructor(worker->Reconstructor, volumeReconstructionNode);
+      // Parallelism comes from the workers. Holes are filled once the slabs are merged, or within each
+      // slab for out-of-core reconstruction, where the halo of the slab is pasted but not merged.
+      worker->Reconstructor->SetNumberOfThreads(1);
+      worker->Reconstructor->SetFillHoles(outOfCore && volumeReconstructionNode->GetFillHoles());
+      worker->Reconstructor->SetOutputExtent(slabExtent);
+      worker->Reconstructor->SetOutputOrigin(slabOrigin);
+      worker->Reconstructor->SetOutputSpacing(info.OutputSpacing);
+      worker->Reconstructor->SetOutputScalarType(info.OutputScalarType);
+      worker->Reconstructor->Reset();
+      workers.push_back(std::move(worker));
+    }
+
+    if (!this->RunPipelinePass(volumeReconstructionNode, frameReader, workers, slabAxis, passIndex, numberOfPasses))
+    {
+      success = false;
+    }
+    if (sparseAccumulation)
+    {
+      // The bricks are kept, and only densified when the output volume is updated
+      info.MergedReconstructedVolume = nullptr;
+      return success;
+    }
+
+    // Merge the slabs of the pass into the full volume, the padding is owned by the neighboring slabs
+    vtkNew<vtkImageData> slabImageData;
+    for (std::unique_ptr<PipelineSlabWorker>& worker : workers)
+    {
+      int slabOffset[3] = { info.OutputExtent[0], info.OutputExtent[2], info.OutputExtent[4] };
+      slabOffset[slabAxis] = worker->PaddedSlabStart;
+      int slabExtent[6] = { info.OutputExtent[0], info.OutputExtent[1], info.OutputExtent[2], info.OutputExtent[3], info.OutputExtent[4], info.OutputExtent[5] };
+      slabExtent[2 * slabAxis] = worker->SlabStart;
+      slabExtent[2 * slabAxis + 1] = worker->SlabEnd;
+      if (worker->Reconstructor->GetReconstructedVolume(slabImageData, false) == IGSIO_SUCCESS)
+      {
+        CopyBlockIntoVolume(slabImageData, slabOffset, mergedVolume, slabExtent);
+      }
+      if (mergedAccumulation && worker->Reconstructor->ExtractAccumulation(slabImageData) == IGSIO_SUCCESS)
+      {
+        CopyBlockIntoVolume(slabImageData, slabOffset, mergedAccumulation, slabExtent);
+      }
+      // Release the slab buffers as soon as they are merged
+      worker->Reconstructor = nullptr;
+    }
+  }
+
+  if (mergedAccumulation)
+  {
+    vtkNew<vtkIGSIOFillHolesInVolume> holeFiller;
+    vtkSlicerVolumeReconstructionLogic::vtkInternal::ConfigureHoleFiller(holeFiller);
+    holeFiller->SetReconstructedVolume(mergedVolume);
+    holeFiller->SetAccumulationBuffer(mergedAccumulation);
+    holeFiller->Update();
+    mergedVolume = holeFiller->GetOutput();
+  }
+
+  info.MergedReconstructedVolume = mergedVolume;
+  return success;
+}
+
+//---------------------------------------------------------------------------
+bool vtkSlicerVolumeReconstructionLogic::vtkInternal::RunPipelinePass(vtkMRMLVolumeReconstructionNode* volumeReconstructionNode,
+  SequenceFrameReader& frameReader, std::vector<std::unique_ptr<PipelineSlabWorker>>& workers, int slabAxis, int passIndex, int numberOfPasses)
+{
+  ReconstructionInfo& info = this->Reconstructors[volumeReconstructionNode];
+  const int numberOfFrames = frameReader.GetNumberOfFrames();
+  const int numberOfWorkers = static_cast<int>(workers.size());
+  const bool sparseAccumulation = volumeReconstructionNode->GetSparseAccumulation();
+
+  std::atomic<int> numberOfFramesCompleted(0);
+  int numberOfFramesSkipped = 0;
+  std::mutex progressMutex;
+  std::condition_variable progressCondition;
+  for (std::unique_ptr<PipelineSlabWorker>& worker : workers)
+  {
+    worker->Thread = std::thread(&vtkInternal::PipelineWorkerMain, worker.get(), &numberOfFramesCompleted, &progressCondition);
+  }
+
+  int numberOfFramesReported = -1;
+  auto reportProgress = [&]()
+  {
+    // Each pass reads all frames, the progress is reported over all passes
+    int completed = (passIndex * numberOfFrames + numberOfFramesCompleted) / numberOfPasses;
+    if (completed != numberOfFramesReported)
+    {
+      numberOfFramesReported = completed;
+      volumeReconstructionNode->SetNumberOfFramesSkipped(numberOfFramesSkipped);
+      volumeReconstructionNode->SetNumberOfVolumesAddedToReconstruction(std::max(completed - numberOfFramesSkipped, 0));
+      volumeReconstructionNode->InvokeEvent(vtkMRMLVolumeReconstructionNode::VolumeAddedToReconstruction);
+    }
+  };
+
+  // Reader stage: resolve the pose of each frame and queue it for every slab or brick that it may touch.
+  // MRML nodes, the brick map and the last pasted frame are only accessed from this thread.
+  info.LastPastedFrameValid = false;
+  vtkNew<vtkMatrix4x4> imageToROIMatrix;
+  double frameBounds[6] = { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+  std::vector<SparseBrickPaste> brickPastes;
+  std::vector<std::vector<SparseBrickPaste>> workerBrickPastes(numberOfWorkers);
+  for (int frameIndex = 0; frameIndex < numberOfFrames; ++frameIndex)
+  {
+    vtkMRMLVolumeNode* frameVolumeNode = frameReader.GetFrame(frameIndex, imageToROIMatrix);
+    vtkImageData* frameImageData = frameVolumeNode ? frameVolumeNode->GetImageData() : nullptr;
+    if (!frameImageData)
+    {
+      ++numberOfFramesCompleted;
+      continue;
+    }
+    if (this->ShouldSkipFrame(info, volumeReconstructionNode, frameImageData, &imageToROIMatrix->Element[0][0]))
+    {
+      ++numberOfFramesSkipped;
+      ++numberOfFramesCompleted;
+      continue;
+    }
+
+    std::vector<int> frameWorkers;
+    if (sparseAccumulation)
+    {
+      this->GetFrameSparseBrickPastes(info, volumeReconstructionNode, frameImageData->GetExtent(), &imageToROIMatrix->Element[0][0],
+        numberOfWorkers, brickPastes);
+      for (std::vector<SparseBrickPaste>& pastes : workerBrickPastes)
+      {
+        pastes.clear();
+      }
+      for (const SparseBrickPaste& brickPaste : brickPastes)
+      {
+        workerBrickPastes[brickPaste.Brick->WorkerIndex].push_back(brickPaste);
+      }
+      for (int workerIndex = 0; workerIndex < numberOfWorkers; ++workerIndex)
+      {
+        if (!workerBrickPastes[workerIndex].empty())
+        {
+          frameWorkers.push_back(workerIndex);
+        }
+      }
+    }
+    else
+    {
+      for (int i = 0; i < 3; ++i)
+      {
+        frameBounds[2 * i] = VTK_DOUBLE_MAX;
+        frameBounds[2 * i + 1] = VTK_DOUBLE_MIN;
+      }
+      ExpandBoundsWithImageCorners(frameImageData->GetExtent(), &imageToROIMatrix->Element[0][0], frameBounds);
+      // One voxel margin, for interpolation kernels that reach into the neighboring slab
+      int firstVoxel = static_cast<int>(std::floor((frameBounds[2 * slabAxis] - info.OutputOrigin[slabAxis]) / info.OutputSpacing[slabAxis])) - 1;
+      int lastVoxel = static_cast<int>(std::ceil((frameBounds[2 * slabAxis + 1] - info.OutputOrigin[slabAxis]) / info.OutputSpacing[slabAxis])) + 1;
+      for (int workerIndex = 0; workerIndex < numberOfWorkers; ++workerIndex)
+      {
+        if (lastVoxel >= workers[workerIndex]->PaddedSlabStart && firstVoxel <= workers[workerIndex]->PaddedSlabEnd)
+        {
+          frameWorkers.push_back(workerIndex);
+        }
+      }
+    }
+    if (frameWorkers.empty())
+    {
+      ++numberOfFramesCompleted;
+      continue;
+    }
+
+    PipelineFrame frame;
+    frame.FrameIndex = frameIndex;
+    frame.RemainingWorkers = std::make_shared<std::atomic<int>>(static_cast<int>(frameWorkers.size()));
+    std::copy(&imageToROIMatrix->Element[0][0], &imageToROIMatrix->Element[0][0] + 16, frame.ImageToROIMatrix);
+    vtkSmartPointer<vtkImageData> castImageData;
+    if (frameImageData->GetScalarType() != info.OutputScalarType)
+    {
+      // Only voxels of the same scalar type can be pasted into the volume
+      vtkNew<vtkImageCast> imageCast;
+      imageCast->SetInputData(frameImageData);
+      imageCast->SetOutputScalarType(info.OutputScalarType);
+      imageCast->Update();
+      castImageData = imageCast->GetOutput();
+      frameImageData = castImageData;
+    }
+
+    for (int workerIndex : frameWorkers)
+    {
+      PipelineSlabWorker* worker = workers[workerIndex].get();
+      // Each worker gets its own image object, only the scalars are shared
+      frame.Image = vtkSmartPointer<vtkImageData>::New();
+      frame.Image->ShallowCopy(frameImageData);
+      if (sparseAccumulation)
+      {
+        frame.SparseBrickPastes = workerBrickPastes[workerIndex];
+      }
+
+      std::unique_lock<std::mutex> lock(worker->QueueMutex);
+      worker->QueueCondition.wait(lock, [worker] { return worker->Queue.size() < MaximumPipelineQueueSize; });
+      worker->Queue.push_back(frame);
+      lock.unlock();
+      worker->QueueCondition.notify_all();
+    }
+    reportProgress();
+  }
+
+  for (std::unique_ptr<PipelineSlabWorker>& worker : workers)
+  {
+    {
+      std::lock_guard<std::mutex> lock(worker->QueueMutex);
+      worker->EndOfFrames = true;
+    }
+    worker->QueueCondition.notify_all();
+  }
+
+  while (numberOfFramesCompleted < numberOfFrames)
+  {
+    std::unique_lock<std::mutex> lock(progressMutex);
+    progressCondition.wait_for(lock, std::chrono::milliseconds(50));
+    lock.unlock();
+    reportProgress();
+  }
+
+  bool success = true;
+  for (std::unique_ptr<PipelineSlabWorker>& worker : workers)
+  {
+    worker->Thread.join();
+    success = success && !worker->Failed;
+  }
+  reportProgress();
+  if (!success)
+  {
+    vtkErrorWithObjectMacro(this->External, "ReconstructVolumeWithPipeline: Failed to add frames to the reconstructed volume");
+  }
+  return success;
+}
+
+//---------------------------------------------------------------------------
+bool vtkSlicerVolumeReconstructionLogic::vtkInternal::AddImageToReconstructors(std::deque<ReconstructorFramePaste>& framePastes, vtkImageData* inputImageData)
+{
+  // Prepare the pastes on the calling thread, which is the only one that accesses MRML nodes
+  std::vector<ReconstructorFramePaste*> activeFramePastes;
+  for (ReconstructorFramePaste& framePaste : framePastes)
+  {
+    vtkMRMLVolumeReconstructionNode* volumeReconstructionNode = framePaste.Node;
+    ReconstructionInfo& info = *framePaste.Info;
+    const double* imageToROIMatrix = &framePaste.ImageToROIMatrix->Element[0][0];
+    if (framePaste.IsFirst)
+    {
+      info.LastPastedFrameValid = false;
+    }
+    if (this->ShouldSkipFrame(info, volumeReconstructionNode, inputImageData, imageToROIMatrix))
+    {
+      framePaste.Skipped = true;
+      volumeReconstructionNode->SetNumberOfFramesSkipped(volumeReconstructionNode->GetNumberOfFramesSkipped() + 1);
+      continue;
+    }
+
+    info.TransformRepository->SetTransform(this->ImageToROITransformName, framePaste.ImageToROIMatrix);
+
+    // Ensure that output scalar type matches input (only same scalar type can be added to the volume).
+    // Once frames have been added, the scalar type of the reconstructed volume is fixed and frames are converted instead.
+    if (framePaste.IsFirst || volumeReconstructionNode->GetNumberOfVolumesAddedToReconstruction() == 0 || info.OutputScalarType == VTK_VOID)
+    {
+      info.OutputScalarType = inputImageData->GetScalarType();
+      info.Reconstructor->SetOutputScalarType(info.OutputScalarType);
+      if (info.PreviewReconstructor)
+      {
+        info.PreviewReconstructor->SetOutputScalarType(info.OutputScalarType);
+      }
+    }
+
+    if (!this->SetTrackedFrameImage(framePaste.TrackedFrame, inputImageData, info.OutputScalarType))
+    {
+      vtkErrorWithObjectMacro(this->External, "Could not set tracked frame image!");
+      framePaste.Success = false;
+      continue;
+    }
+
+    framePaste.SparseAccumulation = volumeReconstructionNode->GetSparseAccumulation();
+    if (framePaste.SparseAccumulation)
+    {
+      this->GetFrameSparseBrickPastes(info, volumeReconstructionNode, inputImageData->GetExtent(), imageToROIMatrix, 1, framePaste.BrickPastes);
+    }
+    activeFramePastes.push_back(&framePaste);
+  }
+
+  // The reconstructors of different nodes are independent, so they can be pasted into at the same time
+  std::vector<std::thread> pasteThreads;
+  for (size_t i = 1; i < activeFramePastes.size(); ++i)
+  {
+    pasteThreads.emplace_back(&vtkInternal::PasteFrameIntoReconstructor, activeFramePastes[i]);
+  }
+  if (!activeFramePastes.empty())
+  {
+    PasteFrameIntoReconstructor(activeFramePastes[0]);
+  }
+  for (std::thread& pasteThread : pasteThreads)
+  {
+    pasteThread.join();
+  }
+
+  bool success = true;
+  for (ReconstructorFramePaste& framePaste : framePastes)
+  {
+    if (framePaste.Skipped)
+    {
+      continue;
+    }
+    this->ReleaseTrackedFrameImage(framePaste.TrackedFrame);
+    if (!framePaste.Success)
+    {
+      success = false;
+      continue;
+    }
+
+    vtkMRMLVolumeReconstructionNode* volumeReconstructionNode = framePaste.Node;
+    int frameExtent[6] = { 0, -1, 0, -1, 0, -1 };
+    inputImageData->GetExtent(frameExtent);
+    ClipImageExtent(frameExtent, volumeReconstructionNode->GetClipRectangleOrigin(), volumeReconstructionNode->GetClipRectangleSize());
+    this->MarkFrameBricksModified(*framePaste.Info, frameExtent, &framePaste.ImageToROIMatrix->Element[0][0]);
+
+    int numberOfVolumesAddedToReconstruction = volumeReconstructionNode->GetNumberOfVolumesAddedToReconstruction();
+    volumeReconstructionNode->SetNumberOfVolumesAddedToReconstruction(numberOfVolumesAddedToReconstruction + 1);
+    volumeReconstructionNode->InvokeEvent(vtkMRMLVolumeReconstructionNode::VolumeAddedToReconstruction);
+  }
+  return success;
+}
+
+//---------------------------------------------------------------------------
+void vtkSlicerVolumeReconstructionLogic::vtkInternal::PasteFrameIntoReconstructor(ReconstructorFramePaste* framePaste)
+{
+  ReconstructionInfo& info = *framePaste->Info;
+  if (info.PreviewReconstructor)
+  {
+    // The coarse preview is pasted first, it is much faster to paste into and publish than the full resolution volume
+    bool insertedIntoPreview = false;
+    if (info.PreviewReconstructor->AddTrackedFrame(&framePaste->TrackedFrame, info.TransformRepository,
+      framePaste->IsFirst, framePaste->IsLast, &insertedIntoPreview) != IGSIO_SUCCESS)
+    {
+      framePaste->Success = false;
+    }
+  }
+
+  if (framePaste->SparseAccumulation)
+  {
+    for (const SparseBrickPaste& brickPaste : framePaste->BrickPastes)
+    {
+      if (!PasteFrameIntoSparseBrick(brickPaste, framePaste->TrackedFrame, info.TransformRepository))
+      {
+        framePaste->Success = false;
+      }
+    }
+    return;
+  }
+
+  bool insertedIntoVolume = false;
+  framePaste->Success = info.Reconstructor->AddTrackedFrame(&framePaste->TrackedFrame, info.TransformRepository,
+    framePaste->IsFirst, framePaste->IsLast, &insertedIntoVolume) == IGSIO_SUCCESS;
+}
+
+//---------------------------------------------------------------------------
+void vtkSlicerVolumeReconstructionLogic::vtkInternal::AddInputVolumeFrameToLiveReconstructions(vtkMRMLVolumeNode* inputVolumeNode)
+{
+  vtkImageData* inputImageData = inputVolumeNode->GetImageData();
+  if (!inputImageData)
+  {
+    return;
+  }
+
+  // Read the frame once: the image is shared and the transform from the image to the image parent is common to all nodes
+  vtkNew<vtkMatrix4x4> leafToParentMatrix;
+  vtkNew<vtkMatrix4x4> ijkToRASMatrix;
+  vtkNew<vtkMatrix4x4> imageToParentMatrix;
+  ComputeImageToParentMatrix(inputVolumeNode, leafToParentMatrix, ijkToRASMatrix, imageToParentMatrix);
+
+  std::deque<ReconstructorFramePaste> framePastes;
+  for (VolumeReconstuctorMap::iterator it = this->Reconstructors.begin(); it != this->Reconstructors.end(); ++it)
+  {
+    vtkMRMLVolumeReconstructionNode* volumeReconstructionNode = it->first;
+    ReconstructionInfo& info = it->second;
+    vtkMRMLTransformableNode* roiNode = volumeReconstructionNode ?
+      vtkMRMLTransformableNode::SafeDownCast(volumeReconstructionNode->GetInputROINode()) : nullptr;
+    if (!volumeReconstructionNode || !info.Reconstructor || !roiNode
+      || !volumeReconstructionNode->GetLiveVolumeReconstructionInProgress()
+      || volumeReconstructionNode->GetInputVolumeNode() != inputVolumeNode)
+    {
+      continue;
+    }
+    if (info.IngestedImage == inputImageData && info.IngestedImageMTime == inputImageData->GetMTime())
+    {
+      // The frame has already been pasted when the image modified event was processed for another node
+      continue;
+    }
+    info.IngestedImage = inputImageData;
+    info.IngestedImageMTime = inputImageData->GetMTime();
+
+    this->UpdateImageToROITransform(info, inputVolumeNode, roiNode, imageToParentMatrix);
+    framePastes.emplace_back();
+    ReconstructorFramePaste& framePaste = framePastes.back();
+    framePaste.Node = volumeReconstructionNode;
+    framePaste.Info = &info;
+    framePaste.ImageToROIMatrix = info.ImageToROIMatrix;
+    framePaste.IsFirst = volumeReconstructionNode->GetNumberOfVolumesAddedToReconstruction() == 0;
+  }
+
+  if (!framePastes.empty())
+  {
+    this->AddImageToReconstructors(framePastes, inputImageData);
+  }
+}
+
+//---------------------------------------------------------------------------
+/// Angle of the rotation between the orientations of two image to ROI matrices, ignoring the spacing of the images
+static double GetRotationAngleDegrees(const double matrix1[16], const double matrix2[16])
+{
+  double trace = 0.0;
+  for (int column = 0; column < 3; ++column)
+  {
+    double axis1[3] = { matrix1[column], matrix1[4 + column], matrix1[8 + column] };
+    double axis2[3] = { matrix2[column], matrix2[4 + column], matrix2[8 + column] };
+    vtkMath::Normalize(axis1);
+    vtkMath::Normalize(axis2);
+    trace += vtkMath::Dot(axis1, axis2);
+  }
+  double cosAngle = std::max(-1.0, std::min(1.0, (trace - 1.0) / 2.0));
+  return vtkMath::DegreesFromRadians(std::acos(cosAngle));
+}
+
+//---------------------------------------------------------------------------
+bool vtkSlicerVolumeReconstructionLogic::vtkInternal::ShouldSkipFrame(ReconstructionInfo& info,
+  vtkMRMLVolumeReconstructionNode* volumeReconstructionNode, vtkImageData* imageData, const double imageToROIMatrix[16])
+{
+  int* extent = imageData->GetExtent();
+  double frameCenter[4] = { (extent[0] + extent[1]) / 2.0, (extent[2] + extent[3]) / 2.0, (extent[4] + extent[5]) / 2.0, 1.0 };
+  vtkMatrix4x4::MultiplyPoint(imageToROIMatrix, frameCenter, frameCenter);
+
+  if (info.LastPastedFrameValid)
+  {
+    if (imageData == info.LastPastedImage && imageData->GetMTime() == info.LastPastedImageMTime
+      && std::equal(imageToROIMatrix, imageToROIMatrix + 16, info.LastPastedImageToROIMatrix))
+    {
+      // Neither the image nor its pose changed since the frame was pasted
+      return true;
+    }
+
+    double minimumTranslation = volumeReconstructionNode->GetMinimumFrameTranslation();
+    double minimumRotationDegrees = volumeReconstructionNode->GetMinimumFrameRotationDegrees();
+    if (minimumTranslation > 0.0 || minimumRotationDegrees > 0.0)
+    {
+      bool withinThresholds = true;
+      if (minimumTranslation > 0.0)
+      {
+        withinThresholds = std::sqrt(vtkMath::Distance2BetweenPoints(frameCenter, info.LastPastedFrameCenter)) < minimumTranslation;
+      }
+      if (withinThresholds && minimumRotationDegrees > 0.0)
+      {
+        withinThresholds = GetRotationAngleDegrees(imageToROIMatrix, info.LastPastedImageToROIMatrix) < minimumRotationDegrees;
+      }
+      if (withinThresholds)
+      {
+        return true;
+      }
+    }
+  }
+
+  info.LastPastedFrameValid = true;
+  info.LastPastedImage = imageData;
+  info.LastPastedImageMTime = imageData->GetMTime();
+  std::copy(imageToROIMatrix, imageToROIMatrix + 16, info.LastPastedImageToROIMatrix);
+  std::copy(frameCenter, frameCenter + 3, info.LastPastedFrameCenter);
+  return false;
+}
+
+//---------------------------------------------------------------------------
+void vtkSlicerVolumeReconstructionLogic::vtkInternal::MarkFrameBricksModified(ReconstructionInfo& info, const int frameExtent[6], const double imageToROIMatrix[16])
+{
+  if (info.DirtyBricks.empty())
+  {
+    return;
+  }
+
+  double frameBounds[6] = { VTK_DOUBLE_MAX, VTK_DOUBLE_MIN, VTK_DOUBLE_MAX, VTK_DOUBLE_MIN, VTK_DOUBLE_MAX, VTK_DOUBLE_MIN };
+  ExpandBoundsWithImageCorners(frameExtent, imageToROIMatrix, frameBounds);
+
+  int firstBrick[3] = { 0, 0, 0 };
+  int lastBrick[3] = { 0, 0, 0 };
+  for (int axis = 0; axis < 3; ++axis)
+  {
+    // One voxel margin for the interpolation kernel
+    int firstVoxel = static_cast<int>(std::floor((frameBounds[2 * axis] - info.OutputOrigin[axis]) / info.OutputSpacing[axis])) - 1;
+    int lastVoxel = static_cast<int>(std::ceil((frameBounds[2 * axis + 1] - info.OutputOrigin[axis]) / info.OutputSpacing[axis])) + 1;
+    firstVoxel = std::max(firstVoxel, info.OutputExtent[2 * axis]);
+    lastVoxel = std::min(lastVoxel, info.OutputExtent[2 * axis + 1]);
+    if (firstVoxel > lastVoxel)
+    {
+      // The frame is outside of the volume
+      return;
+    }
+    firstBrick[axis] = (firstVoxel - info.OutputExtent[2 * axis]) / BrickSize;
+    lastBrick[axis] = (lastVoxel - info.OutputExtent[2 * axis]) / BrickSize;
+  }
+
+  for (int k = firstBrick[2]; k <= lastBrick[2]; ++k)
+  {
+    for (int j = firstBrick[1]; j <= lastBrick[1]; ++j)
+    {
+      unsigned char* brickRow = &info.DirtyBricks[(static_cast<size_t>(k) * info.BrickGridSize[1] + j) * info.BrickGridSize[0]];
+      std::fill(brickRow + firstBrick[0], brickRow + lastBrick[0] + 1, 1);
+    }
+  }
+}
+
+//---------------------------------------------------------------------------
+template <class T>
+static void CopyGrayLevelsInExtent(vtkImageData* pastedVolume, vtkImageData* outputImageData, const int extent[6])
+{
+  const int numberOfPastedComponents = pastedVolume->GetNumberOfScalarComponents();
+  for (int k = extent[4]; k <= extent[5]; ++k)
+  {
+    for (int j = extent[2]; j <= extent[3]; ++j)
+    {
+      const T* pastedVoxel = static_cast<const T*>(pastedVolume->GetScalarPointer(extent[0], j, k));
+      T* outputVoxel = static_cast<T*>(outputImageData->GetScalarPointer(extent[0], j, k));
+      for (int i = extent[0]; i <= extent[1]; ++i)
+      {
+        *outputVoxel++ = *pastedVoxel;
+        pastedVoxel += numberOfPastedComponents;
+      }
+    }
+  }
+}
+
+//---------------------------------------------------------------------------
+bool vtkSlicerVolumeReconstructionLogic::vtkInternal::PublishModifiedBricks(ReconstructionInfo& info, vtkMRMLVolumeReconstructionNode* volumeReconstructionNode,
+  vtkImageData* outputImageData, int updatedExtent[6])
+{
+  vtkSlicerLiveVolumeReconstructor* reconstructor = vtkSlicerLiveVolumeReconstructor::SafeDownCast(info.Reconstructor);
+  vtkImageData* pastedVolume = reconstructor ? reconstructor->GetPastedVolume() : nullptr;
+  if (!info.OutputVolumePublished || info.DirtyBricks.empty() || !pastedVolume || !outputImageData
+    || info.MergedReconstructedVolume)
+  {
+    return false;
+  }
+  const bool fillHoles = reconstructor->GetFillHoles();
+  vtkImageData* accumulationBuffer = reconstructor->GetAccumulationBuffer();
+  if (fillHoles && (!volumeReconstructionNode->GetIncrementalHoleFilling() || !accumulationBuffer))
+  {
+    return false;
+  }
+
+  int* pastedExtent = pastedVolume->GetExtent();
+  int* outputExtent = outputImageData->GetExtent();
+  for (int i = 0; i < 6; ++i)
+  {
+    if (pastedExtent[i] != info.OutputExtent[i] || outputExtent[i] != info.OutputExtent[i])
+    {
+      return false;
+    }
+  }
+  if (pastedVolume->GetScalarType() != outputImageData->GetScalarType() || outputImageData->GetNumberOfScalarComponents() != 1)
+  {
+    return false;
+  }
 
-  vtkSlicerVolumeReconstructionLogic* External;
+  std::vector<unsigned char> updatedBricks;
+  if (fillHoles)
+  {
+    // Filled voxels depend on the pasted voxels within the kernel halo, so the neighbors of the modified bricks are filled again too
+    updatedBricks.assign(info.DirtyBricks.size(), 0);
+    size_t brickIndex = 0;
+    for (int k = 0; k < info.BrickGridSize[2]; ++k)
+    {
+      for (int j = 0; j < info.BrickGridSize[1]; ++j)
+      {
+        for (int i = 0; i < info.BrickGridSize[0]; ++i, ++brickIndex)
+        {
+          if (!info.DirtyBricks[brickIndex])
+          {
+            continue;
+          }
+          for (int nk = std::max(k - 1, 0); nk <= std::min(k + 1, info.BrickGridSize[2] - 1); ++nk)
+          {
+            for (int nj = std::max(j - 1, 0); nj <= std::min(j + 1, info.BrickGridSize[1] - 1); ++nj)
+            {
+              unsigned char* brickRow = &updatedBricks[(static_cast<size_t>(nk) * info.BrickGridSize[1] + nj) * info.BrickGridSize[0]];
+              std::fill(brickRow + std::max(i - 1, 0), brickRow + std::min(i + 1, info.BrickGridSize[0] - 1) + 1, 1);
+            }
+          }
+        }
+      }
+    }
+  }
+  else
+  {
+    updatedBricks = info.DirtyBricks;
+  }
+  std::fill(info.DirtyBricks.begin(), info.DirtyBricks.end(), 0);
 
-  VolumeReconstuctorMap Reconstructors;
-};
+  updatedExtent[0] = updatedExtent[2] = updatedExtent[4] = VTK_INT_MAX;
+  updatedExtent[1] = updatedExtent[3] = updatedExtent[5] = -VTK_INT_MAX;
+  std::vector<std::array<int, 6>> brickExtents;
+  size_t brickIndex = 0;
+  for (int k = 0; k < info.BrickGridSize[2]; ++k)
+  {
+    for (int j = 0; j < info.BrickGridSize[1]; ++j)
+    {
+      for (int i = 0; i < info.BrickGridSize[0]; ++i, ++brickIndex)
+      {
+        if (!updatedBricks[brickIndex])
+        {
+          continue;
+        }
+
+        int brick[3] = { i, j, k };
+        std::array<int, 6> brickExtent = { 0, 0, 0, 0, 0, 0 };
+        for (int axis = 0; axis < 3; ++axis)
+        {
+          brickExtent[2 * axis] = info.OutputExtent[2 * axis] + brick[axis] * BrickSize;
+          brickExtent[2 * axis + 1] = std::min(brickExtent[2 * axis] + BrickSize - 1, info.OutputExtent[2 * axis + 1]);
+          updatedExtent[2 * axis] = std::min(updatedExtent[2 * axis], brickExtent[2 * axis]);
+          updatedExtent[2 * axis + 1] = std::max(updatedExtent[2 * axis + 1], brickExtent[2 * axis + 1]);
+        }
+        brickExtents.push_back(brickExtent);
+      }
+    }
+  }
 
-//----------------------------------------------------------------------------
-// vtkInternal methods
+  if (fillHoles)
+  {
+    int numberOfThreads = volumeReconstructionNode->GetNumberOfThreads();
+    if (numberOfThreads <= 0)
+    {
+      numberOfThreads = static_cast<int>(std::thread::hardware_concurrency());
+    }
+    FillHolesInBricks(pastedVolume, accumulationBuffer, outputImageData, brickExtents, std::max(numberOfThreads, 1));
+    return true;
+  }
 
-//---------------------------------------------------------------------------
-vtkSlicerVolumeReconstructionLogic::vtkInternal::vtkInternal(vtkSlicerVolumeReconstructionLogic* external)
-  : External(external)
-{
+  for (const std::array<int, 6>& brickExtent : brickExtents)
+  {
+    switch (pastedVolume->GetScalarType())
+    {
+      vtkTemplateMacro(CopyGrayLevelsInExtent<VTK_TT>(pastedVolume, outputImageData, brickExtent.data()));
+    }
+  }
+  return true;
 }
 
 //---------------------------------------------------------------------------
-vtkSlicerVolumeReconstructionLogic::vtkInternal::~vtkInternal()
+void vtkSlicerVolumeReconstructionLogic::vtkInternal::FillHolesInBricks(vtkImageData* pastedVolume, vtkImageData* accumulationBuffer,
+  vtkImageData* outputImageData, const std::vector<std::array<int, 6>>& brickExtents, int numberOfThreads)
 {
+  // Bricks are taken from a shared counter, each thread reuses its blocks for the bricks that it fills.
+  // Only the voxels of its own brick are written by a thread, the pasted volume is only read.
+  std::atomic<size_t> nextBrickIndex(0);
+  auto fillBricks = [&]()
+  {
+    vtkNew<vtkImageData> pastedBlock;
+    vtkNew<vtkImageData> accumulationBlock;
+    for (size_t brickIndex = nextBrickIndex++; brickIndex < brickExtents.size(); brickIndex = nextBrickIndex++)
+    {
+      const std::array<int, 6>& brickExtent = brickExtents[brickIndex];
+      int* pastedExtent = pastedVolume->GetExtent();
+      int blockExtent[6] = { 0, 0, 0, 0, 0, 0 };
+      for (int axis = 0; axis < 3; ++axis)
+      {
+        blockExtent[2 * axis] = std::max(brickExtent[2 * axis] - HoleFillingHalo, pastedExtent[2 * axis]);
+        blockExtent[2 * axis + 1] = std::min(brickExtent[2 * axis + 1] + HoleFillingHalo, pastedExtent[2 * axis + 1]);
+      }
+
+      pastedBlock->SetExtent(blockExtent);
+      pastedBlock->AllocateScalars(pastedVolume->GetScalarType(), pastedVolume->GetNumberOfScalarComponents());
+      pastedBlock->CopyAndCastFrom(pastedVolume, blockExtent);
+      accumulationBlock->SetExtent(blockExtent);
+      accumulationBlock->AllocateScalars(accumulationBuffer->GetScalarType(), accumulationBuffer->GetNumberOfScalarComponents());
+      accumulationBlock->CopyAndCastFrom(accumulationBuffer, blockExtent);
+
+      vtkNew<vtkIGSIOFillHolesInVolume> holeFiller;
+      ConfigureHoleFiller(holeFiller);
+      holeFiller->SetNumberOfThreads(1);
+      holeFiller->SetReconstructedVolume(pastedBlock);
+      holeFiller->SetAccumulationBuffer(accumulationBlock);
+      holeFiller->Update();
+
+      vtkImageData* filledBlock = holeFiller->GetOutput();
+      switch (filledBlock->GetScalarType())
+      {
+        vtkTemplateMacro(CopyGrayLevelsInExtent<VTK_TT>(filledBlock, outputImageData, brickExtent.data()));
+      }
+    }
+  };
+
+  numberOfThreads = std::min(numberOfThreads, static_cast<int>(brickExtents.size()));
+  std::vector<std::thread> fillThreads;
+  for (int threadIndex = 1; threadIndex < numberOfThreads; ++threadIndex)
+  {
+    fillThreads.emplace_back(fillBricks);
+  }
+  fillBricks();
+  for (std::thread& fillThread : fillThreads)
+  {
+    fillThread.join();
+  }
 }
 
 //----------------------------------------------------------------------------
@@ -141,10 +2286,10 @@ void vtkSlicerVolumeReconstructionLogic::OnMRMLSceneNodeAdded(vtkMRMLNode* node)
   }
 
   ReconstructionInfo info;
-  info.Reconstructor = vtkSmartPointer<vtkIGSIOVolumeReconstructor>::New();
+  info.Reconstructor = vtkSmartPointer<vtkSlicerLiveVolumeReconstructor>::New();
   info.LastUpdateTimeSeconds = vtkTimerLog::GetUniversalTime();
 
-  this->Internal->Reconstructors[volumeReconstructionNode] = info;
+  this->Internal->Reconstructors[volumeReconstructionNode] = std::move(info);
 }
 
 //---------------------------------------------------------------------------
@@ -167,9 +2312,11 @@ void vtkSlicerVolumeReconstructionLogic::OnMRMLSceneNodeRemoved(vtkMRMLNode* nod
 void vtkSlicerVolumeReconstructionLogic::ProcessMRMLNodesEvents(vtkObject* caller, unsigned long event, void* callData)
 {
   vtkMRMLVolumeReconstructionNode* volumeReconstructionNode = vtkMRMLVolumeReconstructionNode::SafeDownCast(caller);
-  if (volumeReconstructionNode && event == vtkMRMLVolumeReconstructionNode::InputVolumeModified && volumeReconstructionNode->GetLiveVolumeReconstructionInProgress())
+  if (volumeReconstructionNode && event == vtkMRMLVolumeReconstructionNode::InputVolumeModified && volumeReconstructionNode->GetLiveVolumeReconstructionInProgress()
+    && volumeReconstructionNode->GetInputVolumeNode())
   {
-    this->AddVolumeNodeToReconstructedVolume(volumeReconstructionNode, volumeReconstructionNode->GetNumberOfVolumesAddedToReconstruction() == 0, false);
+    // The frame is pasted into all the live reconstructions that use the same input volume at once
+    this->Internal->AddInputVolumeFrameToLiveReconstructions(volumeReconstructionNode->GetInputVolumeNode());
   }
 }
 
@@ -188,6 +2335,13 @@ void vtkSlicerVolumeReconstructionLogic::UpdateLiveVolumeReconstruction()
     }
 
     double currentTime = timer->GetUniversalTime();
+    if (info->PreviewReconstructor
+      && currentTime - info->LastPreviewUpdateTimeSeconds >= volumeReconstructionNode->GetPreviewUpdateIntervalSeconds())
+    {
+      this->GetPreviewVolume(volumeReconstructionNode);
+      info->LastPreviewUpdateTimeSeconds = currentTime;
+    }
+
     if (currentTime - info->LastUpdateTimeSeconds < volumeReconstructionNode->GetLiveUpdateIntervalSeconds())
     {
       continue;
@@ -258,28 +2412,56 @@ void vtkSlicerVolumeReconstructionLogic::StartVolumeReconstruction(vtkMRMLVolume
   reconstructor->SetOutputExtent(outputExtent);
   reconstructor->SetOutputOrigin(outputOrigin);
   reconstructor->SetOutputSpacing(outputSpacing);
-  reconstructor->SetCompoundingMode(vtkIGSIOPasteSliceIntoVolume::CompoundingType(volumeReconstructionNode->GetCompoundingMode()));
-  reconstructor->SetOptimization(vtkIGSIOPasteSliceIntoVolume::OptimizationType(volumeReconstructionNode->GetOptimizationMode()));
-  reconstructor->SetInterpolation(vtkIGSIOPasteSliceIntoVolume::InterpolationType(volumeReconstructionNode->GetInterpolationMode()));
-  reconstructor->SetNumberOfThreads(volumeReconstructionNode->GetNumberOfThreads());
-  reconstructor->SetFillHoles(volumeReconstructionNode->GetFillHoles());
-  if (volumeReconstructionNode->GetFillHoles())
+  this->Internal->ConfigureReconstructor(reconstructor, volumeReconstructionNode);
+
+  ReconstructionInfo& info = this->Internal->Reconstructors[volumeReconstructionNode];
+  std::copy(outputExtent, outputExtent + 6, info.OutputExtent);
+  std::copy(outputOrigin, outputOrigin + 3, info.OutputOrigin);
+  std::copy(outputSpacing, outputSpacing + 3, info.OutputSpacing);
+  info.MergedReconstructedVolume = nullptr;
+  for (int axis = 0; axis < 3; ++axis)
   {
-    vtkIGSIOFillHolesInVolume* holeFiller = reconstructor->GetHoleFiller();
-    holeFiller->SetNumHFElements(1);
-    holeFiller->AllocateHFElements();
-    FillHolesInVolumeElement hfElement;
-    hfElement.setupAsStick(9, 1);
-    holeFiller->SetHFElement(0, hfElement);
+    info.BrickGridSize[axis] = (outputExtent[2 * axis + 1] - outputExtent[2 * axis]) / vtkInternal::BrickSize + 1;
+  }
+  info.DirtyBricks.assign(static_cast<size_t>(info.BrickGridSize[0]) * info.BrickGridSize[1] * info.BrickGridSize[2], 0);
+  for (int axis = 0; axis < 3; ++axis)
+  {
+    info.SparseBrickGridSize[axis] = (outputExtent[2 * axis + 1] - outputExtent[2 * axis]) / vtkInternal::SparseBrickSize + 1;
+  }
+  if (volumeReconstructionNode->GetSparseAccumulation() || vtkInternal::IsOutOfCoreReconstruction(volumeReconstructionNode))
+  {
+    // Frames are pasted into the sparse bricks or into the slabs of the pipeline,
+    // the reconstructor does not need buffers for the whole volume
+    int emptyExtent[6] = { 0, 0, 0, 0, 0, 0 };
+    reconstructor->SetOutputExtent(emptyExtent);
+  }
+
+  info.PreviewReconstructor = nullptr;
+  const int previewSpacingFactor = volumeReconstructionNode->GetPreviewSpacingFactor();
+  if (volumeReconstructionNode->GetLiveVolumeReconstruction() && previewSpacingFactor > 1)
+  {
+    // The preview covers the same region as the output volume, with coarser voxels
+    double previewSpacing[3] = { 0.0, 0.0, 0.0 };
+    int previewExtent[6] = { 0, 0, 0, 0, 0, 0 };
+    for (int axis = 0; axis < 3; ++axis)
+    {
+      previewSpacing[axis] = outputSpacing[axis] * previewSpacingFactor;
+      previewExtent[2 * axis + 1] = static_cast<int>(std::ceil((bounds[2 * axis + 1] - bounds[2 * axis]) / previewSpacing[axis]));
+    }
+    info.PreviewReconstructor = vtkSmartPointer<vtkIGSIOVolumeReconstructor>::New();
+    info.PreviewReconstructor->SetOutputExtent(previewExtent);
+    info.PreviewReconstructor->SetOutputOrigin(outputOrigin);
+    info.PreviewReconstructor->SetOutputSpacing(previewSpacing);
+    this->Internal->ConfigureReconstructor(info.PreviewReconstructor, volumeReconstructionNode);
+    // Coarse voxels have few holes, and filling them would delay the preview
+    info.PreviewReconstructor->SetFillHoles(false);
   }
-  reconstructor->SetImageCoordinateFrame("Image");
-  reconstructor->SetReferenceCoordinateFrame("ROI");
-  reconstructor->SetClipRectangleOrigin(volumeReconstructionNode->GetClipRectangleOrigin());
-  reconstructor->SetClipRectangleSize(volumeReconstructionNode->GetClipRectangleSize());
 
+  info.TransformChain.Valid = false;
   this->ResetVolumeReconstruction(volumeReconstructionNode);
 
   volumeReconstructionNode->SetNumberOfVolumesAddedToReconstruction(0);
+  volumeReconstructionNode->SetNumberOfFramesSkipped(0);
   volumeReconstructionNode->InvokeEvent(vtkMRMLVolumeReconstructionNode::VolumeReconstructionStarted);
 }
 
@@ -351,61 +2533,43 @@ bool vtkSlicerVolumeReconstructionLogic::AddVolumeNodeToReconstructedVolume(vtkM
     return false;
   }
 
-  vtkNew<vtkTransform> imageToROITransform;
-  imageToROITransform->PostMultiply();
-
-  vtkNew<vtkMatrix4x4> ijkToRASMatrix;
-  inputVolumeNode->GetIJKToRASMatrix(ijkToRASMatrix);
-  imageToROITransform->Concatenate(ijkToRASMatrix);
-
-  vtkMRMLTransformNode* imageParentTransformNode = inputVolumeNode->GetParentTransformNode();
-  if (imageParentTransformNode)
-  {
-    vtkNew<vtkMatrix4x4> parentToWorldMatrix;
-    imageParentTransformNode->GetMatrixTransformToWorld(parentToWorldMatrix);
-    imageToROITransform->Concatenate(parentToWorldMatrix);
-  }
-
-  vtkMRMLTransformNode* roiParentTransformNode = vtkMRMLTransformableNode::SafeDownCast(volumeReconstructionNode->GetInputROINode())->GetParentTransformNode();
-  if (roiParentTransformNode)
-  {
-    vtkNew<vtkMatrix4x4> worldToParentMatrix;
-    roiParentTransformNode->GetMatrixTransformFromWorld(worldToParentMatrix);
-    imageToROITransform->Concatenate(worldToParentMatrix);
-  }
+  ReconstructionInfo& info = this->Internal->Reconstructors[volumeReconstructionNode];
+  this->Internal->UpdateImageToROITransform(info, inputVolumeNode, vtkMRMLTransformableNode::SafeDownCast(volumeReconstructionNode->GetInputROINode()));
+  return this->AddImageToReconstructedVolume(volumeReconstructionNode, inputVolumeNode->GetImageData(), info.ImageToROIMatrix, isFirst, isLast);
+}
 
-  if (markupsInputROINode)
+//---------------------------------------------------------------------------
+bool vtkSlicerVolumeReconstructionLogic::AddImageToReconstructedVolume(vtkMRMLVolumeReconstructionNode* volumeReconstructionNode,
+  vtkImageData* inputImageData, vtkMatrix4x4* imageToROIMatrix, bool isFirst, bool isLast)
+{
+  if (!volumeReconstructionNode)
   {
-    vtkNew<vtkMatrix4x4> nodeToObjectMatrix;
-    vtkMatrix4x4::Invert(markupsInputROINode->GetObjectToNodeMatrix(), nodeToObjectMatrix);
-    imageToROITransform->Concatenate(nodeToObjectMatrix);
+    vtkErrorMacro("Invalid volume reconstruction node!");
+    return false;
   }
 
-  vtkNew<vtkIGSIOTransformRepository> transformRepository;
-  transformRepository->SetTransform(igsioTransformName("ImageToROI"), imageToROITransform->GetMatrix());
-
-  vtkImageData* inputImageData = inputVolumeNode->GetImageData();
-
-  // Ensure that output scalar type matches input (only same scalar type can be added to the volume)
-  if (inputImageData)
+  if (!inputImageData)
   {
-    reconstructor->SetOutputScalarType(inputImageData->GetScalarType());
+    vtkErrorMacro("Invalid input image data!");
+    return false;
   }
 
-  std::string errorDetail;
-  igsioTrackedFrame trackedFrame;
-  trackedFrame.GetImageData()->DeepCopyFrom(inputImageData);
-
-  bool insertedIntoVolume = false;
-  if (reconstructor->AddTrackedFrame(&trackedFrame, transformRepository, isFirst, isLast, &insertedIntoVolume) != IGSIO_SUCCESS)
+  ReconstructionInfo& info = this->Internal->Reconstructors[volumeReconstructionNode];
+  vtkIGSIOVolumeReconstructor* reconstructor = info.Reconstructor;
+  if (!reconstructor)
   {
+    vtkErrorMacro("Invalid volume reconstructor!");
     return false;
   }
 
-  int numberOfVolumesAddedToReconstruction = volumeReconstructionNode->GetNumberOfVolumesAddedToReconstruction();
-  volumeReconstructionNode->SetNumberOfVolumesAddedToReconstruction(numberOfVolumesAddedToReconstruction + 1);
-  volumeReconstructionNode->InvokeEvent(vtkMRMLVolumeReconstructionNode::VolumeAddedToReconstruction);
-  return  true;
+  std::deque<ReconstructorFramePaste> framePastes(1);
+  ReconstructorFramePaste& framePaste = framePastes.front();
+  framePaste.Node = volumeReconstructionNode;
+  framePaste.Info = &info;
+  framePaste.ImageToROIMatrix = imageToROIMatrix;
+  framePaste.IsFirst = isFirst;
+  framePaste.IsLast = isLast;
+  return this->Internal->AddImageToReconstructors(framePastes, inputImageData);
 }
 
 //---------------------------------------------------------------------------
@@ -432,43 +2596,253 @@ void vtkSlicerVolumeReconstructionLogic::GetReconstructedVolume(vtkMRMLVolumeRec
     outputVolumeNode->SetAndObserveImageData(imageData);
   }
 
-  if (reconstructor->GetReconstructedVolume(outputVolumeNode->GetImageData(), deepCopy) != IGSIO_SUCCESS)
+  ReconstructionInfo& info = this->Internal->Reconstructors[volumeReconstructionNode];
+  int updatedExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  if (!deepCopy && this->Internal->PublishModifiedBricks(info, volumeReconstructionNode, outputVolumeNode->GetImageData(), updatedExtent))
+  {
+    // Only the regions that frames were pasted into since the last update are copied, the geometry is unchanged
+    if (updatedExtent[0] <= updatedExtent[1])
+    {
+      outputVolumeNode->GetImageData()->Modified();
+      volumeReconstructionNode->InvokeEvent(vtkMRMLVolumeReconstructionNode::OutputVolumeRegionModified, updatedExtent);
+    }
+    volumeReconstructionNode->InvokeEvent(vtkMRMLVolumeReconstructionNode::VolumeReconstructionFinished);
+    return;
+  }
+  std::fill(info.DirtyBricks.begin(), info.DirtyBricks.end(), 0);
+  info.OutputVolumePublished = true;
+
+  vtkImageData* mergedReconstructedVolume = info.MergedReconstructedVolume;
+  if (volumeReconstructionNode->GetSparseAccumulation())
+  {
+    // Densify the bricks that frames were pasted into
+    vtkImageData* outputImageData = outputVolumeNode->GetImageData();
+    outputImageData->SetExtent(info.OutputExtent);
+    outputImageData->SetOrigin(info.OutputOrigin);
+    outputImageData->SetSpacing(info.OutputSpacing);
+    this->Internal->AllocateVolumeScalars(volumeReconstructionNode, outputImageData,
+      info.OutputScalarType != VTK_VOID ? info.OutputScalarType : VTK_UNSIGNED_CHAR, 1);
+    this->Internal->CopySparseBricksIntoImage(info, volumeReconstructionNode, outputImageData);
+  }
+  else if (mergedReconstructedVolume)
+  {
+    // For out-of-core reconstruction, the scratch file is shared with the output volume instead of copied into memory
+    if (deepCopy && !vtkInternal::IsOutOfCoreReconstruction(volumeReconstructionNode))
+    {
+      outputVolumeNode->GetImageData()->DeepCopy(mergedReconstructedVolume);
+    }
+    else
+    {
+      outputVolumeNode->GetImageData()->ShallowCopy(mergedReconstructedVolume);
+    }
+  }
+  else if (reconstructor->GetReconstructedVolume(outputVolumeNode->GetImageData(), deepCopy) != IGSIO_SUCCESS)
   {
     vtkErrorMacro("Could not retrieve reconstructed image");
   }
 
-  double spacing[3] = { 0.0, 0.0, 0.0 };
-  outputVolumeNode->GetImageData()->GetSpacing(spacing);
-  outputVolumeNode->GetImageData()->SetSpacing(1.0, 1.0, 1.0);
-  outputVolumeNode->SetSpacing(spacing);
+  vtkInternal::UpdateReconstructedVolumeNodeGeometry(volumeReconstructionNode, outputVolumeNode);
 
-  double origin[3] = { 0.0, 0.0, 0.0 };
-  outputVolumeNode->GetImageData()->GetOrigin(origin);
-  outputVolumeNode->GetImageData()->SetOrigin(0.0, 0.0, 0.0);
-  outputVolumeNode->SetOrigin(origin);
+  volumeReconstructionNode->InvokeEvent(vtkMRMLVolumeReconstructionNode::VolumeReconstructionFinished);
+}
 
-  const char* parentTransformNodeID = nullptr;
-  vtkMRMLTransformableNode* inputROINode = vtkMRMLTransformableNode::SafeDownCast(volumeReconstructionNode->GetInputROINode());
-  if (inputROINode && inputROINode->GetParentTransformNode())
+//---------------------------------------------------------------------------
+void vtkSlicerVolumeReconstructionLogic::GetPreviewVolume(vtkMRMLVolumeReconstructionNode* volumeReconstructionNode)
+{
+  if (!volumeReconstructionNode)
   {
-    parentTransformNodeID = inputROINode->GetParentTransformNode()->GetID();
+    vtkErrorMacro("Invalid volume reconstruction node!");
+    return;
   }
-  outputVolumeNode->SetAndObserveTransformNodeID(parentTransformNodeID);
 
-  vtkMRMLMarkupsROINode* markupsROINode = vtkMRMLMarkupsROINode::SafeDownCast(inputROINode);
-  if (markupsROINode)
+  vtkIGSIOVolumeReconstructor* previewReconstructor = this->Internal->Reconstructors[volumeReconstructionNode].PreviewReconstructor;
+  if (!previewReconstructor)
   {
-    vtkMatrix4x4* objectToNodeMatrix = markupsROINode->GetObjectToNodeMatrix();
-    outputVolumeNode->SetIJKToRASDirectionMatrix(objectToNodeMatrix);
+    vtkErrorMacro("GetPreviewVolume: Preview is only available during live reconstruction with a preview spacing factor greater than 1");
+    return;
+  }
 
-    // Reconstructed volume origin is in ROI coordinates. Need to convert to Node
-    vtkNew<vtkTransform> objectToNodeTransform;
-    objectToNodeTransform->SetMatrix(objectToNodeMatrix);
-    objectToNodeTransform->TransformPoint(origin, origin);
-    outputVolumeNode->SetOrigin(origin);
+  vtkMRMLVolumeNode* previewVolumeNode = this->GetOrAddPreviewVolumeNode(volumeReconstructionNode);
+  if (!previewVolumeNode)
+  {
+    vtkErrorMacro("Invalid preview volume node!");
+    return;
   }
 
-  volumeReconstructionNode->InvokeEvent(vtkMRMLVolumeReconstructionNode::VolumeReconstructionFinished);
+  MRMLNodeModifyBlocker blocker(previewVolumeNode);
+  if (!previewVolumeNode->GetImageData())
+  {
+    vtkSmartPointer<vtkImageData> imageData = vtkSmartPointer<vtkImageData>::New();
+    previewVolumeNode->SetAndObserveImageData(imageData);
+  }
+  if (previewReconstructor->GetReconstructedVolume(previewVolumeNode->GetImageData(), false) != IGSIO_SUCCESS)
+  {
+    vtkErrorMacro("Could not retrieve preview image");
+  }
+  vtkInternal::UpdateReconstructedVolumeNodeGeometry(volumeReconstructionNode, previewVolumeNode);
+}
+
+//---------------------------------------------------------------------------
+bool vtkSlicerVolumeReconstructionLogic::GetReconstructedVolumeRegion(vtkMRMLVolumeReconstructionNode* volumeReconstructionNode,
+  const int extent[6], vtkImageData* outputImageData)
+{
+  if (!volumeReconstructionNode)
+  {
+    vtkErrorMacro("Invalid volume reconstruction node!");
+    return false;
+  }
+
+  if (!outputImageData)
+  {
+    vtkErrorMacro("Invalid output image data!");
+    return false;
+  }
+
+  ReconstructionInfo& info = this->Internal->Reconstructors[volumeReconstructionNode];
+  if (!info.Reconstructor)
+  {
+    vtkErrorMacro("Invalid volume reconstructor!");
+    return false;
+  }
+
+  int regionExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  for (int axis = 0; axis < 3; ++axis)
+  {
+    regionExtent[2 * axis] = std::max(extent[2 * axis], info.OutputExtent[2 * axis]);
+    regionExtent[2 * axis + 1] = std::min(extent[2 * axis + 1], info.OutputExtent[2 * axis + 1]);
+    if (regionExtent[2 * axis] > regionExtent[2 * axis + 1])
+    {
+      vtkErrorMacro("GetReconstructedVolumeRegion: The extent does not intersect the reconstructed volume");
+      return false;
+    }
+  }
+
+  outputImageData->SetExtent(regionExtent);
+  outputImageData->SetOrigin(info.OutputOrigin);
+  outputImageData->SetSpacing(info.OutputSpacing);
+  outputImageData->AllocateScalars(info.OutputScalarType != VTK_VOID ? info.OutputScalarType : VTK_UNSIGNED_CHAR, 1);
+  if (volumeReconstructionNode->GetSparseAccumulation())
+  {
+    this->Internal->CopySparseBricksIntoImage(info, volumeReconstructionNode, outputImageData);
+    return true;
+  }
+
+  vtkSmartPointer<vtkImageData> reconstructedVolume = info.MergedReconstructedVolume;
+  if (!reconstructedVolume)
+  {
+    reconstructedVolume = vtkSmartPointer<vtkImageData>::New();
+    if (info.Reconstructor->GetReconstructedVolume(reconstructedVolume, false) != IGSIO_SUCCESS)
+    {
+      vtkErrorMacro("Could not retrieve reconstructed image");
+      return false;
+    }
+  }
+  int volumeOffset[3] = { 0, 0, 0 };
+  CopyBlockIntoVolume(reconstructedVolume, volumeOffset, outputImageData);
+  return true;
+}
+
+//---------------------------------------------------------------------------
+static const char* GetNRRDTypeName(int scalarType)
+{
+  switch (scalarType)
+  {
+    case VTK_CHAR:
+    case VTK_SIGNED_CHAR: return "int8";
+    case VTK_UNSIGNED_CHAR: return "uint8";
+    case VTK_SHORT: return "int16";
+    case VTK_UNSIGNED_SHORT: return "uint16";
+    case VTK_INT: return "int32";
+    case VTK_UNSIGNED_INT: return "uint32";
+    case VTK_FLOAT: return "float";
+    case VTK_DOUBLE: return "double";
+    default: return nullptr;
+  }
+}
+
+//---------------------------------------------------------------------------
+bool vtkSlicerVolumeReconstructionLogic::WriteReconstructedVolumeToNRRD(vtkMRMLVolumeReconstructionNode* volumeReconstructionNode, const char* fileName)
+{
+  if (!volumeReconstructionNode)
+  {
+    vtkErrorMacro("Invalid volume reconstruction node!");
+    return false;
+  }
+
+  if (!fileName)
+  {
+    vtkErrorMacro("Invalid file name!");
+    return false;
+  }
+
+  vtkMRMLVolumeNode* outputVolumeNode = volumeReconstructionNode->GetOutputVolumeNode();
+  vtkImageData* outputImageData = outputVolumeNode ? outputVolumeNode->GetImageData() : nullptr;
+  if (!outputImageData || !outputImageData->GetPointData()->GetScalars())
+  {
+    vtkErrorMacro("WriteReconstructedVolumeToNRRD: Invalid output volume!");
+    return false;
+  }
+
+  const char* typeName = GetNRRDTypeName(outputImageData->GetScalarType());
+  if (!typeName || outputImageData->GetNumberOfScalarComponents() != 1)
+  {
+    vtkErrorMacro("WriteReconstructedVolumeToNRRD: Unsupported scalar type");
+    return false;
+  }
+
+  std::ofstream file(fileName, std::ios::out | std::ios::binary);
+  if (!file)
+  {
+    vtkErrorMacro("WriteReconstructedVolumeToNRRD: Could not open " << fileName);
+    return false;
+  }
+
+  int dimensions[3] = { 0, 0, 0 };
+  outputImageData->GetDimensions(dimensions);
+  vtkNew<vtkMatrix4x4> ijkToRASMatrix;
+  outputVolumeNode->GetIJKToRASMatrix(ijkToRASMatrix);
+
+  file.precision(17);
+  file << "NRRD0004\n";
+  file << "type: " << typeName << "\n";
+  file << "dimension: 3\n";
+  file << "space: right-anterior-superior\n";
+  file << "sizes: " << dimensions[0] << " " << dimensions[1] << " " << dimensions[2] << "\n";
+  file << "space directions:";
+  for (int column = 0; column < 3; ++column)
+  {
+    file << " (" << ijkToRASMatrix->GetElement(0, column) << "," << ijkToRASMatrix->GetElement(1, column)
+      << "," << ijkToRASMatrix->GetElement(2, column) << ")";
+  }
+  file << "\n";
+  file << "kinds: domain domain domain\n";
+#ifdef VTK_WORDS_BIGENDIAN
+  file << "endian: big\n";
+#else
+  file << "endian: little\n";
+#endif
+  file << "encoding: raw\n";
+  file << "space origin: (" << ijkToRASMatrix->GetElement(0, 3) << "," << ijkToRASMatrix->GetElement(1, 3)
+    << "," << ijkToRASMatrix->GetElement(2, 3) << ")\n";
+  file << "\n";
+
+  // Stream the voxels in chunks, so that only the pages of a scratch file that are being written are resident
+  const char* data = static_cast<const char*>(outputImageData->GetScalarPointer());
+  size_t remainingSize = static_cast<size_t>(outputImageData->GetNumberOfPoints()) * outputImageData->GetScalarSize();
+  const size_t chunkSize = 64 * 1024 * 1024;
+  while (remainingSize > 0 && file)
+  {
+    size_t writeSize = std::min(remainingSize, chunkSize);
+    file.write(data, writeSize);
+    data += writeSize;
+    remainingSize -= writeSize;
+  }
+  if (!file)
+  {
+    vtkErrorMacro("WriteReconstructedVolumeToNRRD: Failed to write " << fileName);
+    return false;
+  }
+  return true;
 }
 
 //---------------------------------------------------------------------------
@@ -546,12 +2920,43 @@ void vtkSlicerVolumeReconstructionLogic::ReconstructVolumeFromSequence(vtkMRMLVo
       volumeReconstructionNode->SetAndObserveInputROINode(vtkMRMLMarkupsROINode::SafeDownCast(inputROINode));
     }
 
-    this->CalculateROIFromVolumeSequenceInternal(inputSequenceBrowser, inputVolumeNode, inputROINode);
+    this->CalculateROIFromVolumeSequenceInternal(inputSequenceBrowser, inputVolumeNode, inputROINode,
+      volumeReconstructionNode->GetClipRectangleOrigin(), volumeReconstructionNode->GetClipRectangleSize());
   }
 
   // Begin volume reconstruction
   this->StartVolumeReconstruction(volumeReconstructionNode);
 
+  SequenceFrameReader frameReader;
+  if (frameReader.Initialize(inputSequenceBrowser, inputVolumeNode, inputROINode))
+  {
+    // Read the frames directly from the sequences, the scene is not modified
+    int numberOfWorkers = this->Internal->GetNumberOfPipelineWorkers(volumeReconstructionNode);
+    if ((numberOfWorkers > 1 || vtkInternal::IsOutOfCoreReconstruction(volumeReconstructionNode)) && frameReader.GetNumberOfFrames() > 1
+      && this->Internal->ReconstructVolumeWithPipeline(volumeReconstructionNode, frameReader, numberOfWorkers))
+    {
+      this->GetReconstructedVolume(volumeReconstructionNode, true);
+      return;
+    }
+    this->Internal->AllocateReconstructorVolume(volumeReconstructionNode);
+
+    vtkNew<vtkMatrix4x4> imageToROIMatrix;
+    const int numberOfFrames = frameReader.GetNumberOfFrames();
+    for (int i = 0; i < numberOfFrames; ++i)
+    {
+      vtkMRMLVolumeNode* frameVolumeNode = frameReader.GetFrame(i, imageToROIMatrix);
+      if (!frameVolumeNode)
+      {
+        continue;
+      }
+      this->AddImageToReconstructedVolume(volumeReconstructionNode, frameVolumeNode->GetImageData(), imageToROIMatrix, i == 0, i == numberOfFrames - 1);
+    }
+    this->GetReconstructedVolume(volumeReconstructionNode, true);
+    return;
+  }
+
+  // The input volume is not read directly from a sequence, step through the browser instead
+  this->Internal->AllocateReconstructorVolume(volumeReconstructionNode);
   // Save the currently selected item to restore later
   int selectedItemNumber = inputSequenceBrowser->GetSelectedItemNumber();
 
@@ -583,7 +2988,7 @@ void vtkSlicerVolumeReconstructionLogic::CalculateROIFromVolumeSequence(vtkMRMLS
 
 //---------------------------------------------------------------------------
 void vtkSlicerVolumeReconstructionLogic::CalculateROIFromVolumeSequenceInternal(vtkMRMLSequenceBrowserNode* inputSequenceBrowser,
-  vtkMRMLVolumeNode* inputVolumeNode, vtkMRMLNode* outputROINodeRAS)
+  vtkMRMLVolumeNode* inputVolumeNode, vtkMRMLNode* outputROINodeRAS, const int* clipRectangleOrigin/*=nullptr*/, const int* clipRectangleSize/*=nullptr*/)
 {
   if (!inputSequenceBrowser)
   {
@@ -611,7 +3016,40 @@ void vtkSlicerVolumeReconstructionLogic::CalculateROIFromVolumeSequenceInternal(
                           VTK_DOUBLE_MAX, VTK_DOUBLE_MIN,
                           VTK_DOUBLE_MAX, VTK_DOUBLE_MIN };
 
-  const int numberOfFrames = masterSequence->GetNumberOfDataNodes();
+  SequenceFrameReader frameReader;
+  bool framesReadFromSequences = frameReader.Initialize(inputSequenceBrowser, inputVolumeNode, vtkMRMLTransformableNode::SafeDownCast(outputROINodeRAS));
+  if (framesReadFromSequences)
+  {
+    // Read the frames directly from the sequences, the scene is not modified.
+    // All poses are resolved in a single pass, then the corners are transformed in parallel.
+    const int numberOfFrames = frameReader.GetNumberOfFrames();
+    std::vector<int> frameExtents;
+    frameExtents.reserve(6 * numberOfFrames);
+    std::vector<double> frameImageToROIMatrices;
+    frameImageToROIMatrices.reserve(16 * numberOfFrames);
+    vtkNew<vtkMatrix4x4> imageToROIMatrix;
+    for (int i = 0; i < numberOfFrames; ++i)
+    {
+      vtkMRMLVolumeNode* frameVolumeNode = frameReader.GetFrame(i, imageToROIMatrix);
+      if (!frameVolumeNode || !frameVolumeNode->GetImageData())
+      {
+        continue;
+      }
+      int frameExtent[6] = { 0, -1, 0, -1, 0, -1 };
+      frameVolumeNode->GetImageData()->GetExtent(frameExtent);
+      ClipImageExtent(frameExtent, clipRectangleOrigin, clipRectangleSize);
+      if (frameExtent[0] > frameExtent[1] || frameExtent[2] > frameExtent[3] || frameExtent[4] > frameExtent[5])
+      {
+        continue;
+      }
+      frameExtents.insert(frameExtents.end(), frameExtent, frameExtent + 6);
+      frameImageToROIMatrices.insert(frameImageToROIMatrices.end(), &imageToROIMatrix->Element[0][0], &imageToROIMatrix->Element[0][0] + 16);
+    }
+    ComputeFrameCornerBounds(frameExtents, frameImageToROIMatrices, roiBounds);
+  }
+
+  // If the input volume is not read directly from a sequence, step through the browser instead
+  const int numberOfFrames = framesReadFromSequences ? 0 : masterSequence->GetNumberOfDataNodes();
   int selectedItemNumber = inputSequenceBrowser->GetSelectedItemNumber();
   for (int i = 0; i < numberOfFrames; ++i)
   {
@@ -673,7 +3111,10 @@ void vtkSlicerVolumeReconstructionLogic::CalculateROIFromVolumeSequenceInternal(
       roiBounds[2 * i + 1] = std::max(selectedROIBounds[2 * i + 1], roiBounds[2 * i + 1]);
     }
   }
-  inputSequenceBrowser->SetSelectedItemNumber(selectedItemNumber);
+  if (!framesReadFromSequences)
+  {
+    inputSequenceBrowser->SetSelectedItemNumber(selectedItemNumber);
+  }
 
   double radius[3] = { 0.0, 0.0, 0.0 };
   double size[3] = { 0.0, 0.0, 0.0 };
@@ -720,33 +3161,29 @@ vtkMRMLVolumeNode* vtkSlicerVolumeReconstructionLogic::GetOrAddOutputVolumeNode(
     return outputVolumeNode;
   }
 
-  if (this->GetMRMLScene())
-  {
-    outputVolumeNode = vtkSmartPointer<vtkMRMLVolumeNode>::Take(vtkMRMLVolumeNode::SafeDownCast(this->GetMRMLScene()->CreateNodeByClass("vtkMRMLScalarVolumeNode")));
-  }
-  if (!outputVolumeNode)
-  {
-    outputVolumeNode = vtkSmartPointer<vtkMRMLScalarVolumeNode>::New();
-  }
+  outputVolumeNode = this->Internal->AddReconstructedVolumeNode(volumeReconstructionNode, "ReconstructedVolume");
+  volumeReconstructionNode->SetAndObserveOutputVolumeNode(outputVolumeNode);
+  return outputVolumeNode;
+}
 
-  vtkMRMLVolumeNode* inputVolumeNode = volumeReconstructionNode->GetInputVolumeNode();
-  if (inputVolumeNode && inputVolumeNode->GetName())
-  {
-    std::string roiNodeName = inputVolumeNode->GetName();
-    roiNodeName += "_ReconstructedVolume";
-    outputVolumeNode->SetName(roiNodeName.c_str());
-  }
-  else
+//---------------------------------------------------------------------------
+vtkMRMLVolumeNode* vtkSlicerVolumeReconstructionLogic::GetOrAddPreviewVolumeNode(vtkMRMLVolumeReconstructionNode* volumeReconstructionNode)
+{
+  if (!volumeReconstructionNode)
   {
-    outputVolumeNode->SetName("ReconstructedVolume");
+    vtkErrorMacro("Invalid volume reconstructor node!");
+    return nullptr;
   }
 
-  if (this->GetMRMLScene())
+  vtkSmartPointer<vtkMRMLVolumeNode> previewVolumeNode = volumeReconstructionNode->GetPreviewVolumeNode();
+  if (previewVolumeNode)
   {
-    this->GetMRMLScene()->AddNode(outputVolumeNode);
+    return previewVolumeNode;
   }
-  volumeReconstructionNode->SetAndObserveOutputVolumeNode(outputVolumeNode);
-  return outputVolumeNode;
+
+  previewVolumeNode = this->Internal->AddReconstructedVolumeNode(volumeReconstructionNode, "PreviewVolume");
+  volumeReconstructionNode->SetAndObservePreviewVolumeNode(previewVolumeNode);
+  return previewVolumeNode;
 }
 
 //---------------------------------------------------------------------------
@@ -761,8 +3198,19 @@ void vtkSlicerVolumeReconstructionLogic::ResetVolumeReconstruction(vtkMRMLVolume
   }
 
   reconstructor->Reset();
+  this->Internal->Reconstructors[volumeReconstructionNode].MergedReconstructedVolume = nullptr;
+  this->Internal->Reconstructors[volumeReconstructionNode].SparseBricks.clear();
+  this->Internal->Reconstructors[volumeReconstructionNode].OutputVolumePublished = false;
+  this->Internal->Reconstructors[volumeReconstructionNode].LastPastedFrameValid = false;
+  this->Internal->Reconstructors[volumeReconstructionNode].IngestedImage = nullptr;
   this->GetReconstructedVolume(volumeReconstructionNode);
+  if (this->Internal->Reconstructors[volumeReconstructionNode].PreviewReconstructor)
+  {
+    this->Internal->Reconstructors[volumeReconstructionNode].PreviewReconstructor->Reset();
+    this->GetPreviewVolume(volumeReconstructionNode);
+  }
   volumeReconstructionNode->SetNumberOfVolumesAddedToReconstruction(0);
+  volumeReconstructionNode->SetNumberOfFramesSkipped(0);
 }
 
 //---------------------------------------------------------------------------
@@ -39,6 +39,8 @@ Care Ontario.
 // MRML includes
 #include <vtkMRMLVolumeNode.h>
 
+class vtkImageData;
+class vtkMatrix4x4;
 class vtkMRMLAnnotationROINode;
 class vtkMRMLIGTLConnectorNode;
 class vtkMRMLMarkupsROINode;
@@ -62,7 +64,19 @@ public:
   void ResumeLiveVolumeReconstruction(vtkMRMLVolumeReconstructionNode* volumeReconstructionNode);
   void StopLiveVolumeReconstruction(vtkMRMLVolumeReconstructionNode* volumeReconstructionNode);
   bool AddVolumeNodeToReconstructedVolume(vtkMRMLVolumeReconstructionNode* volumeReconstructionNode, bool isFirst, bool isLast);
+  /// Paste an image into the reconstructed volume using the specified transform from image IJK to ROI coordinates
+  bool AddImageToReconstructedVolume(vtkMRMLVolumeReconstructionNode* volumeReconstructionNode,
+    vtkImageData* inputImageData, vtkMatrix4x4* imageToROIMatrix, bool isFirst, bool isLast);
   void GetReconstructedVolume(vtkMRMLVolumeReconstructionNode* volumeReconstructionNode, bool deepCopy=true);
+  /// Copy the part of the reconstructed volume inside the extent (in output volume voxels) into the output image.
+  /// For sparse reconstruction, only the bricks that intersect the extent are densified.
+  bool GetReconstructedVolumeRegion(vtkMRMLVolumeReconstructionNode* volumeReconstructionNode, const int extent[6], vtkImageData* outputImageData);
+  /// Write the output volume to a NRRD file, in the coordinate system of the output volume node.
+  /// The voxels are streamed from the output volume, which may be backed by scratch files, without a copy in memory.
+  bool WriteReconstructedVolumeToNRRD(vtkMRMLVolumeReconstructionNode* volumeReconstructionNode, const char* fileName);
+  /// Read the coarse preview of live reconstruction into the preview volume node.
+  /// The preview is only available if the preview spacing factor of the node is greater than 1.
+  void GetPreviewVolume(vtkMRMLVolumeReconstructionNode* volumeReconstructionNode);
 
   void ReconstructVolumeFromSequence(vtkMRMLVolumeReconstructionNode* volumeReconstructionNode);
 
@@ -70,10 +84,13 @@ public:
     vtkMRMLVolumeNode* inputVolumeNode, vtkMRMLAnnotationROINode* outputROINodeRAS);
   void CalculateROIFromVolumeSequence(vtkMRMLSequenceBrowserNode* inputSequenceBrowser,
     vtkMRMLVolumeNode* inputVolumeNode, vtkMRMLMarkupsROINode* outputROINodeRAS);
+  /// If a clip rectangle is specified (in pixels), only the clipped part of the frames is included in the ROI
   void CalculateROIFromVolumeSequenceInternal(vtkMRMLSequenceBrowserNode* inputSequenceBrowser,
-    vtkMRMLVolumeNode* inputVolumeNode, vtkMRMLNode* outputROINodeRAS);
+    vtkMRMLVolumeNode* inputVolumeNode, vtkMRMLNode* outputROINodeRAS,
+    const int* clipRectangleOrigin = nullptr, const int* clipRectangleSize = nullptr);
 
   vtkMRMLVolumeNode* GetOrAddOutputVolumeNode(vtkMRMLVolumeReconstructionNode* volumeReconstructionNode);
+  vtkMRMLVolumeNode* GetOrAddPreviewVolumeNode(vtkMRMLVolumeReconstructionNode* volumeReconstructionNode);
 
   void ResetVolumeReconstruction(vtkMRMLVolumeReconstructionNode* volumeReconstructionNode);
 
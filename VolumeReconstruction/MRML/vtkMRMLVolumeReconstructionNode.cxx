@@ -41,6 +41,8 @@ vtkMRMLVolumeReconstructionNode::vtkMRMLVolumeReconstructionNode()
   this->LiveVolumeReconstruction = false;
 
   this->LiveUpdateIntervalSeconds = 1.0;
+  this->PreviewSpacingFactor = 1;
+  this->PreviewUpdateIntervalSeconds = 0.1;
 
   this->ClipRectangleOrigin[0] = 0;
   this->ClipRectangleOrigin[1] = 0;
@@ -56,14 +58,22 @@ vtkMRMLVolumeReconstructionNode::vtkMRMLVolumeReconstructionNode()
   this->OptimizationMode = FULL_OPTIMIZATION;
   this->CompoundingMode = MAXIMUM_COMPOUNDING_MODE;
   this->FillHoles = false;
+  this->IncrementalHoleFilling = false;
   this->NumberOfThreads = 0;
+  this->SparseAccumulation = false;
+  this->OutOfCoreReconstruction = false;
+  this->ScratchDirectory = nullptr;
+  this->MinimumFrameTranslation = 0.0;
+  this->MinimumFrameRotationDegrees = 0.0;
 
   this->NumberOfVolumesAddedToReconstruction = 0;
+  this->NumberOfFramesSkipped = 0;
   this->LiveVolumeReconstructionInProgress = false;
 
   this->AddNodeReferenceRole(this->GetInputSequenceBrowserNodeReferenceRole(), this->GetInputSequenceBrowserNodeReferenceMRMLAttributeName());
   this->AddNodeReferenceRole(this->GetInputROINodeReferenceRole(), this->GetInputROINodeReferenceMRMLAttributeName());
   this->AddNodeReferenceRole(this->GetOutputVolumeNodeReferenceRole(), this->GetOutputVolumeNodeReferenceMRMLAttributeName());
+  this->AddNodeReferenceRole(this->GetPreviewVolumeNodeReferenceRole(), this->GetPreviewVolumeNodeReferenceMRMLAttributeName());
 
   vtkNew<vtkIntArray> inputVolumeEvents;
   inputVolumeEvents->InsertNextTuple1(vtkMRMLVolumeNode::ImageDataModifiedEvent);
@@ -71,7 +81,10 @@ vtkMRMLVolumeReconstructionNode::vtkMRMLVolumeReconstructionNode()
 }
 
 //----------------------------------------------------------------------------
-vtkMRMLVolumeReconstructionNode::~vtkMRMLVolumeReconstructionNode() = default;
+vtkMRMLVolumeReconstructionNode::~vtkMRMLVolumeReconstructionNode()
+{
+  this->SetScratchDirectory(nullptr);
+}
 
 //----------------------------------------------------------------------------
 void vtkMRMLVolumeReconstructionNode::WriteXML(ostream& of, int nIndent)
@@ -80,6 +93,8 @@ void vtkMRMLVolumeReconstructionNode::WriteXML(ostream& of, int nIndent)
   vtkMRMLWriteXMLBeginMacro(of);
   vtkMRMLWriteXMLBooleanMacro(liveVolumeReconstruction, LiveVolumeReconstruction);
   vtkMRMLWriteXMLFloatMacro(liveUpdateIntervalSeconds, LiveUpdateIntervalSeconds);
+  vtkMRMLWriteXMLIntMacro(previewSpacingFactor, PreviewSpacingFactor);
+  vtkMRMLWriteXMLFloatMacro(previewUpdateIntervalSeconds, PreviewUpdateIntervalSeconds);
   vtkMRMLWriteXMLVectorMacro(clipRectangleOrigin, ClipRectangleOrigin, int, 2);
   vtkMRMLWriteXMLVectorMacro(clipRectangleSize, ClipRectangleSize, int, 2);
   vtkMRMLWriteXMLVectorMacro(outputSpacing, OutputSpacing, double, 3);
@@ -87,7 +102,13 @@ void vtkMRMLVolumeReconstructionNode::WriteXML(ostream& of, int nIndent)
   vtkMRMLWriteXMLEnumMacro(optimizationMode, OptimizationMode);
   vtkMRMLWriteXMLEnumMacro(compoundingMode, CompoundingMode);
   vtkMRMLWriteXMLBooleanMacro(fillHoles, FillHoles);
+  vtkMRMLWriteXMLBooleanMacro(incrementalHoleFilling, IncrementalHoleFilling);
   vtkMRMLWriteXMLIntMacro(numberOfThreads, NumberOfThreads);
+  vtkMRMLWriteXMLBooleanMacro(sparseAccumulation, SparseAccumulation);
+  vtkMRMLWriteXMLBooleanMacro(outOfCoreReconstruction, OutOfCoreReconstruction);
+  vtkMRMLWriteXMLStringMacro(scratchDirectory, ScratchDirectory);
+  vtkMRMLWriteXMLFloatMacro(minimumFrameTranslation, MinimumFrameTranslation);
+  vtkMRMLWriteXMLFloatMacro(minimumFrameRotationDegrees, MinimumFrameRotationDegrees);
   vtkMRMLWriteXMLEndMacro();
 }
 
@@ -99,6 +120,8 @@ void vtkMRMLVolumeReconstructionNode::ReadXMLAttributes(const char** atts)
   vtkMRMLReadXMLBeginMacro(atts);
   vtkMRMLReadXMLBooleanMacro(liveVolumeReconstruction, LiveVolumeReconstruction);
   vtkMRMLReadXMLFloatMacro(liveUpdateIntervalSeconds, LiveUpdateIntervalSeconds);
+  vtkMRMLReadXMLIntMacro(previewSpacingFactor, PreviewSpacingFactor);
+  vtkMRMLReadXMLFloatMacro(previewUpdateIntervalSeconds, PreviewUpdateIntervalSeconds);
   vtkMRMLReadXMLVectorMacro(clipRectangleOrigin, ClipRectangleOrigin, int, 2);
   vtkMRMLReadXMLVectorMacro(clipRectangleSize, ClipRectangleSize, int, 2);
   vtkMRMLReadXMLVectorMacro(outputSpacing, OutputSpacing, double, 3);
@@ -106,7 +129,13 @@ void vtkMRMLVolumeReconstructionNode::ReadXMLAttributes(const char** atts)
   vtkMRMLReadXMLEnumMacro(optimizationMode, OptimizationMode);
   vtkMRMLReadXMLEnumMacro(compoundingMode, CompoundingMode);
   vtkMRMLReadXMLBooleanMacro(fillHoles, FillHoles);
+  vtkMRMLReadXMLBooleanMacro(incrementalHoleFilling, IncrementalHoleFilling);
   vtkMRMLReadXMLIntMacro(numberOfThreads, NumberOfThreads);
+  vtkMRMLReadXMLBooleanMacro(sparseAccumulation, SparseAccumulation);
+  vtkMRMLReadXMLBooleanMacro(outOfCoreReconstruction, OutOfCoreReconstruction);
+  vtkMRMLReadXMLStringMacro(scratchDirectory, ScratchDirectory);
+  vtkMRMLReadXMLFloatMacro(minimumFrameTranslation, MinimumFrameTranslation);
+  vtkMRMLReadXMLFloatMacro(minimumFrameRotationDegrees, MinimumFrameRotationDegrees);
   vtkMRMLReadXMLEndMacro();
 }
 
@@ -119,6 +148,8 @@ void vtkMRMLVolumeReconstructionNode::Copy(vtkMRMLNode* anode)
   vtkMRMLCopyBeginMacro(anode);
   vtkMRMLCopyBooleanMacro(LiveVolumeReconstruction);
   vtkMRMLCopyFloatMacro(LiveUpdateIntervalSeconds);
+  vtkMRMLCopyIntMacro(PreviewSpacingFactor);
+  vtkMRMLCopyFloatMacro(PreviewUpdateIntervalSeconds);
   vtkMRMLCopyVectorMacro(ClipRectangleOrigin, int, 2);
   vtkMRMLCopyVectorMacro(ClipRectangleSize, int, 2);
   vtkMRMLCopyVectorMacro(OutputSpacing, double, 3);
@@ -126,7 +157,13 @@ void vtkMRMLVolumeReconstructionNode::Copy(vtkMRMLNode* anode)
   vtkMRMLCopyEnumMacro(OptimizationMode);
   vtkMRMLCopyEnumMacro(CompoundingMode);
   vtkMRMLCopyBooleanMacro(FillHoles);
+  vtkMRMLCopyBooleanMacro(IncrementalHoleFilling);
   vtkMRMLCopyIntMacro(NumberOfThreads);
+  vtkMRMLCopyBooleanMacro(SparseAccumulation);
+  vtkMRMLCopyBooleanMacro(OutOfCoreReconstruction);
+  vtkMRMLCopyStringMacro(ScratchDirectory);
+  vtkMRMLCopyFloatMacro(MinimumFrameTranslation);
+  vtkMRMLCopyFloatMacro(MinimumFrameRotationDegrees);
   vtkMRMLCopyEndMacro();
 }
 
@@ -138,6 +175,8 @@ void vtkMRMLVolumeReconstructionNode::PrintSelf(ostream& os, vtkIndent indent)
   vtkMRMLPrintBooleanMacro(LiveVolumeReconstruction);
   vtkMRMLPrintFloatMacro(LiveUpdateIntervalSeconds);
   vtkMRMLPrintFloatMacro(LiveUpdateIntervalSeconds);
+  vtkMRMLPrintIntMacro(PreviewSpacingFactor);
+  vtkMRMLPrintFloatMacro(PreviewUpdateIntervalSeconds);
   vtkMRMLPrintVectorMacro(ClipRectangleOrigin, int, 2);
   vtkMRMLPrintVectorMacro(ClipRectangleSize, int, 2);
   vtkMRMLPrintVectorMacro(OutputSpacing, double, 3);
@@ -145,8 +184,15 @@ void vtkMRMLVolumeReconstructionNode::PrintSelf(ostream& os, vtkIndent indent)
   vtkMRMLPrintEnumMacro(OptimizationMode);
   vtkMRMLPrintEnumMacro(CompoundingMode);
   vtkMRMLPrintBooleanMacro(FillHoles);
+  vtkMRMLPrintBooleanMacro(IncrementalHoleFilling);
   vtkMRMLPrintIntMacro(NumberOfThreads);
+  vtkMRMLPrintBooleanMacro(SparseAccumulation);
+  vtkMRMLPrintBooleanMacro(OutOfCoreReconstruction);
+  vtkMRMLPrintStringMacro(ScratchDirectory);
+  vtkMRMLPrintFloatMacro(MinimumFrameTranslation);
+  vtkMRMLPrintFloatMacro(MinimumFrameRotationDegrees);
   vtkMRMLPrintIntMacro(NumberOfVolumesAddedToReconstruction);
+  vtkMRMLPrintIntMacro(NumberOfFramesSkipped);
   vtkMRMLPrintIntMacro(LiveVolumeReconstructionInProgress);
   vtkMRMLPrintEndMacro();
 }
@@ -232,6 +278,12 @@ void vtkMRMLVolumeReconstructionNode::SetNumberOfVolumesAddedToReconstruction(in
   this->NumberOfVolumesAddedToReconstruction = numberOfVolumesAddedToReconstruction;
 };
 
+//----------------------------------------------------------------------------
+void vtkMRMLVolumeReconstructionNode::SetNumberOfFramesSkipped(int numberOfFramesSkipped)
+{
+  this->NumberOfFramesSkipped = numberOfFramesSkipped;
+}
+
 //----------------------------------------------------------------------------
 void vtkMRMLVolumeReconstructionNode::SetAndObserveInputSequenceBrowserNode(vtkMRMLSequenceBrowserNode* node)
 {
@@ -262,6 +314,12 @@ void vtkMRMLVolumeReconstructionNode::SetAndObserveOutputVolumeNode(vtkMRMLVolum
   this->SetNodeReferenceID(this->GetOutputVolumeNodeReferenceRole(), (node ? node->GetID() : NULL));
 }
 
+//----------------------------------------------------------------------------
+void vtkMRMLVolumeReconstructionNode::SetAndObservePreviewVolumeNode(vtkMRMLVolumeNode* node)
+{
+  this->SetNodeReferenceID(this->GetPreviewVolumeNodeReferenceRole(), (node ? node->GetID() : NULL));
+}
+
 //----------------------------------------------------------------------------
 vtkMRMLSequenceBrowserNode* vtkMRMLVolumeReconstructionNode::GetInputSequenceBrowserNode()
 {
@@ -285,3 +343,9 @@ vtkMRMLVolumeNode* vtkMRMLVolumeReconstructionNode::GetOutputVolumeNode()
 {
   return vtkMRMLVolumeNode::SafeDownCast(this->GetNodeReference(this->GetOutputVolumeNodeReferenceRole()));
 }
+
+//----------------------------------------------------------------------------
+vtkMRMLVolumeNode* vtkMRMLVolumeReconstructionNode::GetPreviewVolumeNode()
+{
+  return vtkMRMLVolumeNode::SafeDownCast(this->GetNodeReference(this->GetPreviewVolumeNodeReferenceRole()));
+}
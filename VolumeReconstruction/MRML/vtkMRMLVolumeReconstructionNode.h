@@ -72,6 +72,9 @@ public:
     VolumeAddedToReconstruction,
     VolumeReconstructionFinished,
     InputVolumeModified,
+    /// Invoked during live reconstruction when only a region of the output volume was updated.
+    /// The call data is the updated extent (int[6]) of the output image.
+    OutputVolumeRegionModified,
   };
 
   enum InterpolationType
@@ -135,6 +138,14 @@ public:
   vtkMRMLVolumeNode* GetOutputVolumeNode();
   virtual void SetAndObserveOutputVolumeNode(vtkMRMLVolumeNode* volumeNode);
 
+  /*!
+  PreviewVolumeNode is the volume node that the coarse preview of live reconstruction will be read into.
+  */
+  const char* GetPreviewVolumeNodeReferenceRole() { return "previewVolumeNode"; };
+  const char* GetPreviewVolumeNodeReferenceMRMLAttributeName() { return "previewVolumeNodeRef"; };
+  vtkMRMLVolumeNode* GetPreviewVolumeNode();
+  virtual void SetAndObservePreviewVolumeNode(vtkMRMLVolumeNode* volumeNode);
+
   /*!
   LiveVolumeReconstruction is true if the node is intended for live volume reconstruction.
   */
@@ -147,6 +158,17 @@ public:
   vtkSetMacro(LiveUpdateIntervalSeconds, double);
   vtkGetMacro(LiveUpdateIntervalSeconds, double);
 
+  /*!
+  If greater than 1, live reconstruction also pastes the frames into a coarse preview volume, whose spacing is
+  PreviewSpacingFactor times the output spacing (typically 2 or 4). Frames are pasted into the preview first,
+  and the preview is read into the PreviewVolumeNode every PreviewUpdateIntervalSeconds, while the full resolution
+  output volume is updated every LiveUpdateIntervalSeconds.
+  */
+  vtkSetClampMacro(PreviewSpacingFactor, int, 1, 8);
+  vtkGetMacro(PreviewSpacingFactor, int);
+  vtkSetMacro(PreviewUpdateIntervalSeconds, double);
+  vtkGetMacro(PreviewUpdateIntervalSeconds, double);
+
   /*!
   The clip rectangle origin to apply to the image in pixel coordinates.
   Pixels outside the clip rectangle will not be pasted into the volume.
@@ -220,6 +242,15 @@ public:
   vtkSetMacro(FillHoles, bool);
   vtkGetMacro(FillHoles, bool);
 
+  /*!
+  If enabled, holes are only filled during live reconstruction in the regions of the output volume that frames
+  have been pasted into since the output volume was last updated, with a margin for the hole filling kernel.
+  The rest of the previously hole-filled output volume is left unchanged.
+  */
+  vtkSetMacro(IncrementalHoleFilling, bool);
+  vtkGetMacro(IncrementalHoleFilling, bool);
+  vtkBooleanMacro(IncrementalHoleFilling, bool);
+
   /*!
   Number of threads used for processing the data.
   The reconstruction result is slightly different if more than one thread is used
@@ -227,16 +258,62 @@ public:
   are processed.
   Choose 0 (this is the default) for maximum speed, in this case the default number of
   used threads equals the number of processors. Choose 1 for reproducible results.
+  For reconstruction from a sequence, the threads are used as paste workers that each
+  reconstruct a slab of the output volume while the frames are read ahead.
   */
   vtkSetMacro(NumberOfThreads, int);
   vtkGetMacro(NumberOfThreads, int);
 
+  /*!
+  If enabled, the volume is reconstructed from a sequence into fixed size bricks that are only
+  allocated when the first frame is pasted into them, instead of into dense buffers that cover the whole ROI.
+  This greatly reduces the memory usage for large ROIs at fine spacing, where most voxels are never hit.
+  The bricks are only combined into a dense volume when the output volume is updated.
+  */
+  vtkSetMacro(SparseAccumulation, bool);
+  vtkGetMacro(SparseAccumulation, bool);
+  vtkBooleanMacro(SparseAccumulation, bool);
+
+  /*!
+  If enabled, the output volume of reconstruction from a sequence is backed by memory-mapped files in the
+  scratch directory instead of by memory, so that volumes larger than the physical memory can be reconstructed.
+  The volume is reconstructed in passes of slabs along the slowest varying axis, so that the files are written
+  mostly sequentially. Holes are filled within each slab, with the neighboring voxels of the adjacent slabs.
+  */
+  vtkSetMacro(OutOfCoreReconstruction, bool);
+  vtkGetMacro(OutOfCoreReconstruction, bool);
+  vtkBooleanMacro(OutOfCoreReconstruction, bool);
+
+  /*!
+  Directory of the memory-mapped files used for out-of-core reconstruction.
+  If not set, the temporary directory of the system is used.
+  */
+  vtkSetStringMacro(ScratchDirectory);
+  vtkGetStringMacro(ScratchDirectory);
+
+  /*!
+  Frames are skipped if their pose differs from the pose of the last pasted frame by less than
+  MinimumFrameTranslation (in mm, measured at the center of the frame) and MinimumFrameRotationDegrees.
+  A threshold of 0 (this is the default) disables the check of the translation or rotation.
+  */
+  vtkSetMacro(MinimumFrameTranslation, double);
+  vtkGetMacro(MinimumFrameTranslation, double);
+  vtkSetMacro(MinimumFrameRotationDegrees, double);
+  vtkGetMacro(MinimumFrameRotationDegrees, double);
+
   /*!
   The number of individual volumes that have been added to the reconstruction.
   */
   void SetNumberOfVolumesAddedToReconstruction(int numberOfVolumesAddedToReconstruction);
   vtkGetMacro(NumberOfVolumesAddedToReconstruction, int);
 
+  /*!
+  The number of frames that were not added to the reconstruction, because their image and pose were
+  unchanged since the last frame or because their pose was too close to the last pasted frame.
+  */
+  void SetNumberOfFramesSkipped(int numberOfFramesSkipped);
+  vtkGetMacro(NumberOfFramesSkipped, int);
+
   /*!
   The state of live volume reconstrction.
   True if a reconstruction is currently in progress, false otherwise.
@@ -248,6 +325,8 @@ public:
 protected:
   bool LiveVolumeReconstruction;
   double LiveUpdateIntervalSeconds;
+  int PreviewSpacingFactor;
+  double PreviewUpdateIntervalSeconds;
   int ClipRectangleOrigin[2];
   int ClipRectangleSize[2];
   double OutputSpacing[3];
@@ -255,8 +334,15 @@ protected:
   int OptimizationMode;
   int CompoundingMode;
   bool FillHoles;
+  bool IncrementalHoleFilling;
   int NumberOfThreads;
+  bool SparseAccumulation;
+  bool OutOfCoreReconstruction;
+  char* ScratchDirectory;
+  double MinimumFrameTranslation;
+  double MinimumFrameRotationDegrees;
   int NumberOfVolumesAddedToReconstruction;
+  int NumberOfFramesSkipped;
   bool LiveVolumeReconstructionInProgress;
 };
 
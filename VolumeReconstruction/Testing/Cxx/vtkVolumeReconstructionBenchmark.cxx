@@ -0,0 +1,411 @@
+/*==============================================================================
+
+  Copyright (c) Laboratory for Percutaneous Surgery (PerkLab)
+  Queen's University, Kingston, ON, Canada. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// Throughput benchmark for the volume reconstruction logic.
+//
+// A tracked ultrasound sweep of an analytic phantom (bright spheres in a textured background) is synthesized
+// into an image sequence and a transform sequence, with the known pose of each frame. For each frame size,
+// output spacing, interpolation mode, compounding mode and number of threads the following are timed:
+// - ROI: calculation of the ROI from the sequence
+// - Live: live reconstruction, the frames are pushed one by one into the proxy nodes
+// - Offline: reconstruction from the sequence
+// - OfflineFillHoles: reconstruction from the sequence with hole filling
+// - HoleFilling: difference between OfflineFillHoles and Offline
+// Results are printed as CSV, one row per phase. Peak memory is the peak resident set size of the process
+// at the end of the phase, so it only increases from row to row.
+//
+// Usage:
+//   qSlicerVolumeReconstructionModuleCxxTests vtkVolumeReconstructionBenchmark [numberOfFrames [frameSize ...]]
+// Without arguments a short run is performed (50 frames of 64x64 pixels), for example:
+//   qSlicerVolumeReconstructionModuleCxxTests vtkVolumeReconstructionBenchmark 500 128 256 512
+
+// VolumeReconstruction includes
+#include <vtkMRMLVolumeReconstructionNode.h>
+#include <vtkSlicerVolumeReconstructionLogic.h>
+
+// IGSIO includes
+#include <vtkIGSIOPasteSliceIntoVolume.h>
+
+// Slicer MRML includes
+#include <vtkMRMLCoreTestingMacros.h>
+#include <vtkMRMLLinearTransformNode.h>
+#include <vtkMRMLMarkupsROINode.h>
+#include <vtkMRMLScalarVolumeNode.h>
+#include <vtkMRMLScene.h>
+
+// Sequences includes
+#include <vtkMRMLSequenceBrowserNode.h>
+#include <vtkMRMLSequenceNode.h>
+
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkMath.h>
+#include <vtkMatrix4x4.h>
+#include <vtkTransform.h>
+
+// STD includes
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Peak memory
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace
+{
+  const double FIELD_OF_VIEW_MM = 40.0;
+  const double SWEEP_LENGTH_MM = 40.0;
+  const double TILT_AMPLITUDE_DEG = 10.0;
+  const double FRAME_INTERVAL_SEC = 0.05;
+
+  //----------------------------------------------------------------------------
+  struct Sphere
+  {
+    double Center[3];
+    double Radius;
+  };
+
+  const Sphere PHANTOM_SPHERES[] =
+  {
+    { { -8.0, -10.0, 12.0 }, 5.0 },
+    { { 6.0, 0.0, 20.0 }, 7.0 },
+    { { -2.0, 12.0, 30.0 }, 4.0 },
+  };
+
+  //----------------------------------------------------------------------------
+  unsigned char GetPhantomValue(const double point[3])
+  {
+    for (const Sphere& sphere : PHANTOM_SPHERES)
+    {
+      if (vtkMath::Distance2BetweenPoints(point, sphere.Center) < sphere.Radius * sphere.Radius)
+      {
+        return 220;
+      }
+    }
+    // Textured background, so that compounding and interpolation have something to work on
+    return static_cast<unsigned char>(60.0 + 30.0 * std::sin(point[0] * 0.7) * std::cos(point[1] * 0.5) * std::sin(point[2] * 0.3));
+  }
+
+  //----------------------------------------------------------------------------
+  double GetPeakMemoryMB()
+  {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS memoryCounters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &memoryCounters, sizeof(memoryCounters)))
+    {
+      return memoryCounters.PeakWorkingSetSize / (1024.0 * 1024.0);
+    }
+    return -1.0;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+    {
+      return -1.0;
+    }
+#ifdef __APPLE__
+    return usage.ru_maxrss / (1024.0 * 1024.0);
+#else
+    return usage.ru_maxrss / 1024.0;
+#endif
+#endif
+  }
+
+  //----------------------------------------------------------------------------
+  /// Synthetic sweep: the frames are stored in the sequences, and the proxy nodes are the input of the reconstruction
+  struct Sweep
+  {
+    int FrameSize{ 0 };
+    std::vector<vtkSmartPointer<vtkImageData>> Frames;
+    std::vector<vtkSmartPointer<vtkMatrix4x4>> ImageToReferenceMatrices;
+
+    vtkMRMLScalarVolumeNode* ImageNode{ nullptr };
+    vtkMRMLLinearTransformNode* ImageToReferenceNode{ nullptr };
+    vtkMRMLSequenceNode* ImageSequenceNode{ nullptr };
+    vtkMRMLSequenceNode* ImageToReferenceSequenceNode{ nullptr };
+    vtkMRMLSequenceBrowserNode* SequenceBrowserNode{ nullptr };
+  };
+
+  //----------------------------------------------------------------------------
+  void GenerateSweep(vtkMRMLScene* scene, int numberOfFrames, int frameSize, Sweep& sweep)
+  {
+    sweep.FrameSize = frameSize;
+    sweep.Frames.clear();
+    sweep.ImageToReferenceMatrices.clear();
+
+    const double pixelSpacing = FIELD_OF_VIEW_MM / frameSize;
+    vtkNew<vtkMatrix4x4> ijkToRASMatrix;
+    ijkToRASMatrix->SetElement(0, 0, pixelSpacing);
+    ijkToRASMatrix->SetElement(1, 1, pixelSpacing);
+    ijkToRASMatrix->SetElement(0, 3, -FIELD_OF_VIEW_MM / 2.0);
+
+    sweep.ImageNode = vtkMRMLScalarVolumeNode::SafeDownCast(scene->AddNewNodeByClass("vtkMRMLScalarVolumeNode", "Image"));
+    sweep.ImageNode->SetIJKToRASMatrix(ijkToRASMatrix);
+    sweep.ImageToReferenceNode = vtkMRMLLinearTransformNode::SafeDownCast(scene->AddNewNodeByClass("vtkMRMLLinearTransformNode", "ImageToReference"));
+    sweep.ImageNode->SetAndObserveTransformNodeID(sweep.ImageToReferenceNode->GetID());
+    sweep.ImageSequenceNode = vtkMRMLSequenceNode::SafeDownCast(scene->AddNewNodeByClass("vtkMRMLSequenceNode", "Image-Sequence"));
+    sweep.ImageToReferenceSequenceNode = vtkMRMLSequenceNode::SafeDownCast(scene->AddNewNodeByClass("vtkMRMLSequenceNode", "ImageToReference-Sequence"));
+
+    vtkNew<vtkMatrix4x4> ijkToReferenceMatrix;
+    for (int frameIndex = 0; frameIndex < numberOfFrames; ++frameIndex)
+    {
+      // The image plane is vertical, the depth axis of the image is along Z and the sweep is along Y,
+      // with a periodic tilt of the probe
+      double fraction = numberOfFrames > 1 ? static_cast<double>(frameIndex) / (numberOfFrames - 1) : 0.5;
+      vtkNew<vtkTransform> imageToReference;
+      imageToReference->PostMultiply();
+      imageToReference->RotateX(90.0 + TILT_AMPLITUDE_DEG * std::sin(2.0 * vtkMath::Pi() * fraction * 3.0));
+      imageToReference->Translate(0.0, (fraction - 0.5) * SWEEP_LENGTH_MM, 0.0);
+      vtkSmartPointer<vtkMatrix4x4> imageToReferenceMatrix = vtkSmartPointer<vtkMatrix4x4>::New();
+      imageToReferenceMatrix->DeepCopy(imageToReference->GetMatrix());
+      sweep.ImageToReferenceMatrices.push_back(imageToReferenceMatrix);
+
+      // Sample the phantom at the position of each pixel
+      vtkMatrix4x4::Multiply4x4(imageToReferenceMatrix, ijkToRASMatrix, ijkToReferenceMatrix);
+      vtkSmartPointer<vtkImageData> frame = vtkSmartPointer<vtkImageData>::New();
+      frame->SetDimensions(frameSize, frameSize, 1);
+      frame->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
+      unsigned char* pixel = static_cast<unsigned char*>(frame->GetScalarPointer());
+      for (int j = 0; j < frameSize; ++j)
+      {
+        for (int i = 0; i < frameSize; ++i)
+        {
+          double ijk[4] = { static_cast<double>(i), static_cast<double>(j), 0.0, 1.0 };
+          double point[4] = { 0.0, 0.0, 0.0, 1.0 };
+          ijkToReferenceMatrix->MultiplyPoint(ijk, point);
+          *pixel++ = GetPhantomValue(point);
+        }
+      }
+      sweep.Frames.push_back(frame);
+
+      std::ostringstream indexValue;
+      indexValue << frameIndex * FRAME_INTERVAL_SEC;
+      sweep.ImageNode->SetAndObserveImageData(frame);
+      sweep.ImageSequenceNode->SetDataNodeAtValue(sweep.ImageNode, indexValue.str());
+      sweep.ImageToReferenceNode->SetMatrixTransformToParent(imageToReferenceMatrix);
+      sweep.ImageToReferenceSequenceNode->SetDataNodeAtValue(sweep.ImageToReferenceNode, indexValue.str());
+    }
+
+    sweep.SequenceBrowserNode = vtkMRMLSequenceBrowserNode::SafeDownCast(scene->AddNewNodeByClass("vtkMRMLSequenceBrowserNode", "Sweep"));
+    sweep.SequenceBrowserNode->SetAndObserveMasterSequenceNodeID(sweep.ImageSequenceNode->GetID());
+    sweep.SequenceBrowserNode->AddSynchronizedSequenceNodeID(sweep.ImageToReferenceSequenceNode->GetID());
+    sweep.SequenceBrowserNode->AddProxyNode(sweep.ImageNode, sweep.ImageSequenceNode, false);
+    sweep.SequenceBrowserNode->AddProxyNode(sweep.ImageToReferenceNode, sweep.ImageToReferenceSequenceNode, false);
+  }
+
+  //----------------------------------------------------------------------------
+  void RemoveSweep(vtkMRMLScene* scene, Sweep& sweep)
+  {
+    scene->RemoveNode(sweep.SequenceBrowserNode);
+    scene->RemoveNode(sweep.ImageToReferenceSequenceNode);
+    scene->RemoveNode(sweep.ImageSequenceNode);
+    scene->RemoveNode(sweep.ImageNode);
+    scene->RemoveNode(sweep.ImageToReferenceNode);
+    sweep.Frames.clear();
+    sweep.ImageToReferenceMatrices.clear();
+  }
+
+  //----------------------------------------------------------------------------
+  struct BenchmarkParameters
+  {
+    double OutputSpacing{ 1.0 };
+    int InterpolationMode{ vtkMRMLVolumeReconstructionNode::NEAREST_NEIGHBOR_INTERPOLATION };
+    int CompoundingMode{ vtkMRMLVolumeReconstructionNode::MAXIMUM_COMPOUNDING_MODE };
+    int NumberOfThreads{ 1 };
+  };
+
+  //----------------------------------------------------------------------------
+  void PrintResult(const char* phase, const Sweep& sweep, const BenchmarkParameters& parameters, double timeSec, double framesPerSecond)
+  {
+    std::cout << phase
+      << "," << sweep.FrameSize
+      << "," << parameters.OutputSpacing
+      << "," << vtkIGSIOPasteSliceIntoVolume::GetInterpolationModeAsString(
+        static_cast<vtkIGSIOPasteSliceIntoVolume::InterpolationType>(parameters.InterpolationMode))
+      << "," << vtkIGSIOPasteSliceIntoVolume::GetCompoundingModeAsString(
+        static_cast<vtkIGSIOPasteSliceIntoVolume::CompoundingType>(parameters.CompoundingMode))
+      << "," << parameters.NumberOfThreads
+      << "," << sweep.Frames.size()
+      << "," << timeSec
+      << "," << framesPerSecond
+      << "," << GetPeakMemoryMB()
+      << std::endl;
+  }
+
+  //----------------------------------------------------------------------------
+  vtkMRMLVolumeReconstructionNode* AddVolumeReconstructionNode(vtkMRMLScene* scene, const Sweep& sweep,
+    vtkMRMLMarkupsROINode* roiNode, vtkMRMLScalarVolumeNode* outputVolumeNode, const BenchmarkParameters& parameters)
+  {
+    vtkMRMLVolumeReconstructionNode* volumeReconstructionNode = vtkMRMLVolumeReconstructionNode::SafeDownCast(
+      scene->AddNewNodeByClass("vtkMRMLVolumeReconstructionNode"));
+    volumeReconstructionNode->SetAndObserveInputSequenceBrowserNode(sweep.SequenceBrowserNode);
+    volumeReconstructionNode->SetAndObserveInputVolumeNode(sweep.ImageNode);
+    volumeReconstructionNode->SetAndObserveInputROINode(roiNode);
+    volumeReconstructionNode->SetAndObserveOutputVolumeNode(outputVolumeNode);
+    volumeReconstructionNode->SetOutputSpacing(parameters.OutputSpacing, parameters.OutputSpacing, parameters.OutputSpacing);
+    volumeReconstructionNode->SetInterpolationMode(parameters.InterpolationMode);
+    volumeReconstructionNode->SetCompoundingMode(parameters.CompoundingMode);
+    volumeReconstructionNode->SetNumberOfThreads(parameters.NumberOfThreads);
+    return volumeReconstructionNode;
+  }
+
+  //----------------------------------------------------------------------------
+  double GetElapsedSec(std::chrono::steady_clock::time_point startTime)
+  {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+  }
+
+  //----------------------------------------------------------------------------
+  int RunBenchmark(vtkMRMLScene* scene, vtkSlicerVolumeReconstructionLogic* logic, Sweep& sweep, const BenchmarkParameters& parameters)
+  {
+    const double numberOfFrames = static_cast<double>(sweep.Frames.size());
+    vtkMRMLScalarVolumeNode* outputVolumeNode = vtkMRMLScalarVolumeNode::SafeDownCast(scene->AddNewNodeByClass("vtkMRMLScalarVolumeNode", "ReconstructedVolume"));
+
+    // ROI calculation
+    vtkMRMLMarkupsROINode* roiNode = vtkMRMLMarkupsROINode::SafeDownCast(scene->AddNewNodeByClass("vtkMRMLMarkupsROINode", "ReconstructionROI"));
+    auto startTime = std::chrono::steady_clock::now();
+    logic->CalculateROIFromVolumeSequence(sweep.SequenceBrowserNode, sweep.ImageNode, roiNode);
+    double roiTimeSec = GetElapsedSec(startTime);
+    PrintResult("ROI", sweep, parameters, roiTimeSec, numberOfFrames / roiTimeSec);
+
+    // Live reconstruction: each frame is ingested when the image of the proxy node is modified
+    vtkMRMLVolumeReconstructionNode* liveNode = AddVolumeReconstructionNode(scene, sweep, roiNode, outputVolumeNode, parameters);
+    liveNode->SetLiveVolumeReconstruction(true);
+    logic->StartLiveVolumeReconstruction(liveNode);
+    startTime = std::chrono::steady_clock::now();
+    for (size_t frameIndex = 0; frameIndex < sweep.Frames.size(); ++frameIndex)
+    {
+      sweep.ImageToReferenceNode->SetMatrixTransformToParent(sweep.ImageToReferenceMatrices[frameIndex]);
+      sweep.ImageNode->SetAndObserveImageData(sweep.Frames[frameIndex]);
+    }
+    logic->GetReconstructedVolume(liveNode, false);
+    double liveTimeSec = GetElapsedSec(startTime);
+    logic->StopLiveVolumeReconstruction(liveNode);
+    PrintResult("Live", sweep, parameters, liveTimeSec, numberOfFrames / liveTimeSec);
+    if (liveNode->GetNumberOfVolumesAddedToReconstruction() + liveNode->GetNumberOfFramesSkipped() != static_cast<int>(sweep.Frames.size()))
+    {
+      std::cerr << "Live reconstruction ingested " << liveNode->GetNumberOfVolumesAddedToReconstruction()
+        << " of " << sweep.Frames.size() << " frames" << std::endl;
+      return EXIT_FAILURE;
+    }
+    scene->RemoveNode(liveNode);
+
+    // Offline reconstruction from the sequence, without and with hole filling
+    double offlineTimeSec[2] = { 0.0, 0.0 };
+    for (int fillHoles = 0; fillHoles < 2; ++fillHoles)
+    {
+      vtkMRMLVolumeReconstructionNode* offlineNode = AddVolumeReconstructionNode(scene, sweep, roiNode, outputVolumeNode, parameters);
+      offlineNode->SetFillHoles(fillHoles != 0);
+      startTime = std::chrono::steady_clock::now();
+      logic->ReconstructVolumeFromSequence(offlineNode);
+      offlineTimeSec[fillHoles] = GetElapsedSec(startTime);
+      PrintResult(fillHoles ? "OfflineFillHoles" : "Offline", sweep, parameters, offlineTimeSec[fillHoles], numberOfFrames / offlineTimeSec[fillHoles]);
+      if (!outputVolumeNode->GetImageData() || outputVolumeNode->GetImageData()->GetNumberOfPoints() == 0)
+      {
+        std::cerr << "Offline reconstruction did not produce an output volume" << std::endl;
+        return EXIT_FAILURE;
+      }
+      scene->RemoveNode(offlineNode);
+    }
+    PrintResult("HoleFilling", sweep, parameters, std::max(offlineTimeSec[1] - offlineTimeSec[0], 0.0), -1.0);
+
+    scene->RemoveNode(roiNode);
+    scene->RemoveNode(outputVolumeNode);
+    return EXIT_SUCCESS;
+  }
+}
+
+//----------------------------------------------------------------------------
+int vtkVolumeReconstructionBenchmark(int argc, char* argv[])
+{
+  int numberOfFrames = 50;
+  std::vector<int> frameSizes;
+  if (argc > 1)
+  {
+    numberOfFrames = std::max(2, atoi(argv[1]));
+  }
+  for (int i = 2; i < argc; ++i)
+  {
+    frameSizes.push_back(atoi(argv[i]));
+  }
+  if (frameSizes.empty())
+  {
+    frameSizes.push_back(64);
+  }
+
+  const double outputSpacings[] = { 1.0, 0.5 };
+  const int interpolationModes[] =
+  {
+    vtkMRMLVolumeReconstructionNode::NEAREST_NEIGHBOR_INTERPOLATION,
+    vtkMRMLVolumeReconstructionNode::LINEAR_INTERPOLATION
+  };
+  const int compoundingModes[] =
+  {
+    vtkMRMLVolumeReconstructionNode::MAXIMUM_COMPOUNDING_MODE,
+    vtkMRMLVolumeReconstructionNode::MEAN_COMPOUNDING_MODE
+  };
+  const int numberOfThreadsOptions[] = { 1, std::max(static_cast<int>(std::thread::hardware_concurrency()), 2) };
+
+  vtkNew<vtkMRMLScene> scene;
+  scene->RegisterNodeClass(vtkNew<vtkMRMLMarkupsROINode>());
+  scene->RegisterNodeClass(vtkNew<vtkMRMLSequenceNode>());
+  scene->RegisterNodeClass(vtkNew<vtkMRMLSequenceBrowserNode>());
+
+  vtkNew<vtkSlicerVolumeReconstructionLogic> logic;
+  logic->SetMRMLScene(scene);
+
+  std::cout << "Phase,FrameSize,OutputSpacingMm,Interpolation,Compounding,NumberOfThreads,NumberOfFrames,TimeSec,FramesPerSecond,PeakMemoryMB" << std::endl;
+  for (int frameSize : frameSizes)
+  {
+    if (frameSize <= 0)
+    {
+      std::cerr << "Invalid frame size: " << frameSize << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    Sweep sweep;
+    GenerateSweep(scene, numberOfFrames, frameSize, sweep);
+    for (double outputSpacing : outputSpacings)
+    {
+      for (int interpolationMode : interpolationModes)
+      {
+        for (int compoundingMode : compoundingModes)
+        {
+          for (int numberOfThreads : numberOfThreadsOptions)
+          {
+            BenchmarkParameters parameters;
+            parameters.OutputSpacing = outputSpacing;
+            parameters.InterpolationMode = interpolationMode;
+            parameters.CompoundingMode = compoundingMode;
+            parameters.NumberOfThreads = numberOfThreads;
+            CHECK_EXIT_SUCCESS(RunBenchmark(scene, logic, sweep, parameters));
+          }
+        }
+      }
+    }
+    RemoveSweep(scene, sweep);
+  }
+
+  return EXIT_SUCCESS;
+}
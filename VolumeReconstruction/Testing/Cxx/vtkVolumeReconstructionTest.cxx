@@ -0,0 +1,365 @@
+/*==============================================================================
+
+  Copyright (c) Laboratory for Percutaneous Surgery (PerkLab)
+  Queen's University, Kingston, ON, Canada. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// Checks that the accelerated ways of reconstructing a volume from a sequence produce the same volume
+// as the sequential reconstruction into a single reconstructor, voxel by voxel.
+// A tracked sweep of an analytic phantom is synthesized into an image sequence and a transform sequence.
+
+// VolumeReconstruction includes
+#include <vtkMRMLVolumeReconstructionNode.h>
+#include <vtkSlicerVolumeReconstructionLogic.h>
+
+// Slicer MRML includes
+#include <vtkMRMLCoreTestingMacros.h>
+#include <vtkMRMLLinearTransformNode.h>
+#include <vtkMRMLMarkupsROINode.h>
+#include <vtkMRMLScalarVolumeNode.h>
+#include <vtkMRMLScene.h>
+
+// Sequences includes
+#include <vtkMRMLSequenceBrowserNode.h>
+#include <vtkMRMLSequenceNode.h>
+
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkMath.h>
+#include <vtkMatrix4x4.h>
+#include <vtkTransform.h>
+
+// STD includes
+#include <cmath>
+#include <sstream>
+
+namespace
+{
+  const int NUMBER_OF_FRAMES = 40;
+  const int FRAME_SIZE = 48;
+  const double FIELD_OF_VIEW_MM = 40.0;
+  const double SWEEP_LENGTH_MM = 30.0;
+  const double TILT_AMPLITUDE_DEG = 10.0;
+  const double OUTPUT_SPACING_MM = 0.7;
+  // Fine enough for the output volume to span several bricks of the sparse reconstruction along each axis
+  const double SPARSE_OUTPUT_SPACING_MM = 0.25;
+  const int NUMBER_OF_PIPELINE_THREADS = 4;
+
+  //----------------------------------------------------------------------------
+  unsigned char GetPhantomValue(const double point[3])
+  {
+    const double sphereCenter[3] = { 4.0, 0.0, 20.0 };
+    if (vtkMath::Distance2BetweenPoints(point, sphereCenter) < 8.0 * 8.0)
+    {
+      return 220;
+    }
+    return static_cast<unsigned char>(60.0 + 30.0 * std::sin(point[0] * 0.7) * std::cos(point[1] * 0.5) * std::sin(point[2] * 0.3));
+  }
+
+  //----------------------------------------------------------------------------
+  /// Synthetic sweep, the image and transform proxy nodes are the input of the reconstruction
+  struct Sweep
+  {
+    vtkMRMLScalarVolumeNode* ImageNode{ nullptr };
+    vtkMRMLSequenceBrowserNode* SequenceBrowserNode{ nullptr };
+    vtkMRMLMarkupsROINode* ROINode{ nullptr };
+  };
+
+  //----------------------------------------------------------------------------
+  void GenerateSweep(vtkMRMLScene* scene, vtkSlicerVolumeReconstructionLogic* logic, Sweep& sweep)
+  {
+    const double pixelSpacing = FIELD_OF_VIEW_MM / FRAME_SIZE;
+    vtkNew<vtkMatrix4x4> ijkToRASMatrix;
+    ijkToRASMatrix->SetElement(0, 0, pixelSpacing);
+    ijkToRASMatrix->SetElement(1, 1, pixelSpacing);
+    ijkToRASMatrix->SetElement(0, 3, -FIELD_OF_VIEW_MM / 2.0);
+
+    sweep.ImageNode = vtkMRMLScalarVolumeNode::SafeDownCast(scene->AddNewNodeByClass("vtkMRMLScalarVolumeNode", "Image"));
+    sweep.ImageNode->SetIJKToRASMatrix(ijkToRASMatrix);
+    vtkMRMLLinearTransformNode* imageToReferenceNode = vtkMRMLLinearTransformNode::SafeDownCast(
+      scene->AddNewNodeByClass("vtkMRMLLinearTransformNode", "ImageToReference"));
+    sweep.ImageNode->SetAndObserveTransformNodeID(imageToReferenceNode->GetID());
+    vtkMRMLSequenceNode* imageSequenceNode = vtkMRMLSequenceNode::SafeDownCast(scene->AddNewNodeByClass("vtkMRMLSequenceNode", "Image-Sequence"));
+    vtkMRMLSequenceNode* imageToReferenceSequenceNode = vtkMRMLSequenceNode::SafeDownCast(
+      scene->AddNewNodeByClass("vtkMRMLSequenceNode", "ImageToReference-Sequence"));
+
+    vtkNew<vtkMatrix4x4> ijkToReferenceMatrix;
+    for (int frameIndex = 0; frameIndex < NUMBER_OF_FRAMES; ++frameIndex)
+    {
+      // The image plane is vertical and the sweep is along Y, with a periodic tilt of the probe
+      double fraction = static_cast<double>(frameIndex) / (NUMBER_OF_FRAMES - 1);
+      vtkNew<vtkTransform> imageToReference;
+      imageToReference->PostMultiply();
+      imageToReference->RotateX(90.0 + TILT_AMPLITUDE_DEG * std::sin(2.0 * vtkMath::Pi() * fraction * 2.0));
+      imageToReference->Translate(0.0, (fraction - 0.5) * SWEEP_LENGTH_MM, 0.0);
+
+      vtkMatrix4x4::Multiply4x4(imageToReference->GetMatrix(), ijkToRASMatrix, ijkToReferenceMatrix);
+      vtkNew<vtkImageData> frame;
+      frame->SetDimensions(FRAME_SIZE, FRAME_SIZE, 1);
+      frame->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
+      unsigned char* pixel = static_cast<unsigned char*>(frame->GetScalarPointer());
+      for (int j = 0; j < FRAME_SIZE; ++j)
+      {
+        for (int i = 0; i < FRAME_SIZE; ++i)
+        {
+          double ijk[4] = { static_cast<double>(i), static_cast<double>(j), 0.0, 1.0 };
+          double point[4] = { 0.0, 0.0, 0.0, 1.0 };
+          ijkToReferenceMatrix->MultiplyPoint(ijk, point);
+          *pixel++ = GetPhantomValue(point);
+        }
+      }
+
+      std::ostringstream indexValue;
+      indexValue << frameIndex;
+      sweep.ImageNode->SetAndObserveImageData(frame);
+      imageSequenceNode->SetDataNodeAtValue(sweep.ImageNode, indexValue.str());
+      imageToReferenceNode->SetMatrixTransformToParent(imageToReference->GetMatrix());
+      imageToReferenceSequenceNode->SetDataNodeAtValue(imageToReferenceNode, indexValue.str());
+    }
+
+    sweep.SequenceBrowserNode = vtkMRMLSequenceBrowserNode::SafeDownCast(scene->AddNewNodeByClass("vtkMRMLSequenceBrowserNode", "Sweep"));
+    sweep.SequenceBrowserNode->SetAndObserveMasterSequenceNodeID(imageSequenceNode->GetID());
+    sweep.SequenceBrowserNode->AddSynchronizedSequenceNodeID(imageToReferenceSequenceNode->GetID());
+    sweep.SequenceBrowserNode->AddProxyNode(sweep.ImageNode, imageSequenceNode, false);
+    sweep.SequenceBrowserNode->AddProxyNode(imageToReferenceNode, imageToReferenceSequenceNode, false);
+
+    sweep.ROINode = vtkMRMLMarkupsROINode::SafeDownCast(scene->AddNewNodeByClass("vtkMRMLMarkupsROINode", "ReconstructionROI"));
+    logic->CalculateROIFromVolumeSequence(sweep.SequenceBrowserNode, sweep.ImageNode, sweep.ROINode);
+  }
+
+  //----------------------------------------------------------------------------
+  struct ReconstructionParameters
+  {
+    int InterpolationMode{ vtkMRMLVolumeReconstructionNode::NEAREST_NEIGHBOR_INTERPOLATION };
+    int CompoundingMode{ vtkMRMLVolumeReconstructionNode::MEAN_COMPOUNDING_MODE };
+    int NumberOfThreads{ 1 };
+    bool FillHoles{ false };
+    double OutputSpacing{ OUTPUT_SPACING_MM };
+    bool SparseAccumulation{ false };
+    bool OutOfCoreReconstruction{ false };
+  };
+
+  //----------------------------------------------------------------------------
+  /// Reconstruct the sweep from the sequence and copy the output volume into the reconstructed volume
+  int ReconstructVolume(vtkMRMLScene* scene, vtkSlicerVolumeReconstructionLogic* logic, const Sweep& sweep,
+    const ReconstructionParameters& parameters, vtkImageData* reconstructedVolume)
+  {
+    vtkMRMLScalarVolumeNode* outputVolumeNode = vtkMRMLScalarVolumeNode::SafeDownCast(scene->AddNewNodeByClass("vtkMRMLScalarVolumeNode", "ReconstructedVolume"));
+    vtkMRMLVolumeReconstructionNode* volumeReconstructionNode = vtkMRMLVolumeReconstructionNode::SafeDownCast(
+      scene->AddNewNodeByClass("vtkMRMLVolumeReconstructionNode"));
+    volumeReconstructionNode->SetAndObserveInputSequenceBrowserNode(sweep.SequenceBrowserNode);
+    volumeReconstructionNode->SetAndObserveInputVolumeNode(sweep.ImageNode);
+    volumeReconstructionNode->SetAndObserveInputROINode(sweep.ROINode);
+    volumeReconstructionNode->SetAndObserveOutputVolumeNode(outputVolumeNode);
+    volumeReconstructionNode->SetOutputSpacing(parameters.OutputSpacing, parameters.OutputSpacing, parameters.OutputSpacing);
+    volumeReconstructionNode->SetInterpolationMode(parameters.InterpolationMode);
+    volumeReconstructionNode->SetCompoundingMode(parameters.CompoundingMode);
+    volumeReconstructionNode->SetNumberOfThreads(parameters.NumberOfThreads);
+    volumeReconstructionNode->SetFillHoles(parameters.FillHoles);
+    volumeReconstructionNode->SetSparseAccumulation(parameters.SparseAccumulation);
+    volumeReconstructionNode->SetOutOfCoreReconstruction(parameters.OutOfCoreReconstruction);
+
+    logic->ReconstructVolumeFromSequence(volumeReconstructionNode);
+    CHECK_NOT_NULL(outputVolumeNode->GetImageData());
+    reconstructedVolume->DeepCopy(outputVolumeNode->GetImageData());
+
+    scene->RemoveNode(volumeReconstructionNode);
+    scene->RemoveNode(outputVolumeNode);
+    return EXIT_SUCCESS;
+  }
+
+  //----------------------------------------------------------------------------
+  int CompareVolumes(const char* description, vtkImageData* expectedVolume, vtkImageData* actualVolume)
+  {
+    int* expectedExtent = expectedVolume->GetExtent();
+    int* actualExtent = actualVolume->GetExtent();
+    for (int i = 0; i < 6; ++i)
+    {
+      if (expectedExtent[i] != actualExtent[i])
+      {
+        std::cerr << description << ": extent of the volume is different from the expected extent" << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+    CHECK_INT(actualVolume->GetScalarType(), expectedVolume->GetScalarType());
+    CHECK_INT(actualVolume->GetNumberOfScalarComponents(), 1);
+
+    int numberOfDifferentVoxels = 0;
+    int numberOfNonZeroVoxels = 0;
+    for (int k = expectedExtent[4]; k <= expectedExtent[5]; ++k)
+    {
+      for (int j = expectedExtent[2]; j <= expectedExtent[3]; ++j)
+      {
+        for (int i = expectedExtent[0]; i <= expectedExtent[1]; ++i)
+        {
+          double expectedValue = expectedVolume->GetScalarComponentAsDouble(i, j, k, 0);
+          if (expectedValue != actualVolume->GetScalarComponentAsDouble(i, j, k, 0))
+          {
+            if (numberOfDifferentVoxels == 0)
+            {
+              std::cerr << description << ": voxel (" << i << ", " << j << ", " << k << ") is "
+                << actualVolume->GetScalarComponentAsDouble(i, j, k, 0) << " instead of " << expectedValue << std::endl;
+            }
+            ++numberOfDifferentVoxels;
+          }
+          if (expectedValue != 0.0)
+          {
+            ++numberOfNonZeroVoxels;
+          }
+        }
+      }
+    }
+    if (numberOfNonZeroVoxels == 0)
+    {
+      std::cerr << description << ": the expected volume is empty" << std::endl;
+      return EXIT_FAILURE;
+    }
+    if (numberOfDifferentVoxels > 0)
+    {
+      std::cerr << description << ": " << numberOfDifferentVoxels << " voxels are different" << std::endl;
+      return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+  }
+
+  //----------------------------------------------------------------------------
+  /// The slabs of the multi-threaded pipeline must be merged without seams
+  int TestPipelineReconstruction(vtkMRMLScene* scene, vtkSlicerVolumeReconstructionLogic* logic, const Sweep& sweep)
+  {
+    const int interpolationModes[] =
+    {
+      vtkMRMLVolumeReconstructionNode::NEAREST_NEIGHBOR_INTERPOLATION,
+      vtkMRMLVolumeReconstructionNode::LINEAR_INTERPOLATION
+    };
+    const int compoundingModes[] =
+    {
+      vtkMRMLVolumeReconstructionNode::MEAN_COMPOUNDING_MODE,
+      vtkMRMLVolumeReconstructionNode::MAXIMUM_COMPOUNDING_MODE
+    };
+    for (int interpolationMode : interpolationModes)
+    {
+      for (int compoundingMode : compoundingModes)
+      {
+        for (int fillHoles = 0; fillHoles < 2; ++fillHoles)
+        {
+          ReconstructionParameters parameters;
+          parameters.InterpolationMode = interpolationMode;
+          parameters.CompoundingMode = compoundingMode;
+          parameters.FillHoles = (fillHoles != 0);
+
+          vtkNew<vtkImageData> sequentialVolume;
+          parameters.NumberOfThreads = 1;
+          CHECK_EXIT_SUCCESS(ReconstructVolume(scene, logic, sweep, parameters, sequentialVolume));
+
+          vtkNew<vtkImageData> pipelineVolume;
+          parameters.NumberOfThreads = NUMBER_OF_PIPELINE_THREADS;
+          CHECK_EXIT_SUCCESS(ReconstructVolume(scene, logic, sweep, parameters, pipelineVolume));
+
+          std::ostringstream description;
+          description << "Pipeline reconstruction (interpolation " << interpolationMode << ", compounding " << compoundingMode
+            << ", fill holes " << fillHoles << ")";
+          CHECK_EXIT_SUCCESS(CompareVolumes(description.str().c_str(), sequentialVolume, pipelineVolume));
+        }
+      }
+    }
+    return EXIT_SUCCESS;
+  }
+
+  //----------------------------------------------------------------------------
+  /// The bricks of the sparse reconstruction must be densified without seams, and holes filled across brick faces
+  int TestSparseReconstruction(vtkMRMLScene* scene, vtkSlicerVolumeReconstructionLogic* logic, const Sweep& sweep)
+  {
+    const int interpolationModes[] =
+    {
+      vtkMRMLVolumeReconstructionNode::NEAREST_NEIGHBOR_INTERPOLATION,
+      vtkMRMLVolumeReconstructionNode::LINEAR_INTERPOLATION
+    };
+    for (int interpolationMode : interpolationModes)
+    {
+      for (int fillHoles = 0; fillHoles < 2; ++fillHoles)
+      {
+        ReconstructionParameters parameters;
+        parameters.InterpolationMode = interpolationMode;
+        parameters.FillHoles = (fillHoles != 0);
+        parameters.OutputSpacing = SPARSE_OUTPUT_SPACING_MM;
+
+        vtkNew<vtkImageData> denseVolume;
+        CHECK_EXIT_SUCCESS(ReconstructVolume(scene, logic, sweep, parameters, denseVolume));
+
+        vtkNew<vtkImageData> sparseVolume;
+        parameters.SparseAccumulation = true;
+        CHECK_EXIT_SUCCESS(ReconstructVolume(scene, logic, sweep, parameters, sparseVolume));
+
+        std::ostringstream description;
+        description << "Sparse reconstruction (interpolation " << interpolationMode << ", fill holes " << fillHoles << ")";
+        CHECK_EXIT_SUCCESS(CompareVolumes(description.str().c_str(), denseVolume, sparseVolume));
+      }
+    }
+    return EXIT_SUCCESS;
+  }
+
+  //----------------------------------------------------------------------------
+  /// The slabs of out-of-core reconstruction fill their own holes, the result must be the same as in memory
+  int TestOutOfCoreReconstruction(vtkMRMLScene* scene, vtkSlicerVolumeReconstructionLogic* logic, const Sweep& sweep)
+  {
+    const int interpolationModes[] =
+    {
+      vtkMRMLVolumeReconstructionNode::NEAREST_NEIGHBOR_INTERPOLATION,
+      vtkMRMLVolumeReconstructionNode::LINEAR_INTERPOLATION
+    };
+    for (int interpolationMode : interpolationModes)
+    {
+      for (int fillHoles = 0; fillHoles < 2; ++fillHoles)
+      {
+        ReconstructionParameters parameters;
+        parameters.InterpolationMode = interpolationMode;
+        parameters.FillHoles = (fillHoles != 0);
+
+        vtkNew<vtkImageData> inMemoryVolume;
+        CHECK_EXIT_SUCCESS(ReconstructVolume(scene, logic, sweep, parameters, inMemoryVolume));
+
+        // Each worker reconstructs a slab, so the volume has slab boundaries even if it is reconstructed in a single pass
+        vtkNew<vtkImageData> outOfCoreVolume;
+        parameters.OutOfCoreReconstruction = true;
+        parameters.NumberOfThreads = NUMBER_OF_PIPELINE_THREADS;
+        CHECK_EXIT_SUCCESS(ReconstructVolume(scene, logic, sweep, parameters, outOfCoreVolume));
+
+        std::ostringstream description;
+        description << "Out-of-core reconstruction (interpolation " << interpolationMode << ", fill holes " << fillHoles << ")";
+        CHECK_EXIT_SUCCESS(CompareVolumes(description.str().c_str(), inMemoryVolume, outOfCoreVolume));
+      }
+    }
+    return EXIT_SUCCESS;
+  }
+}
+
+//----------------------------------------------------------------------------
+int vtkVolumeReconstructionTest(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
+{
+  vtkNew<vtkMRMLScene> scene;
+  scene->RegisterNodeClass(vtkNew<vtkMRMLMarkupsROINode>());
+  scene->RegisterNodeClass(vtkNew<vtkMRMLSequenceNode>());
+  scene->RegisterNodeClass(vtkNew<vtkMRMLSequenceBrowserNode>());
+
+  vtkNew<vtkSlicerVolumeReconstructionLogic> logic;
+  logic->SetMRMLScene(scene);
+
+  Sweep sweep;
+  GenerateSweep(scene, logic, sweep);
+
+  CHECK_EXIT_SUCCESS(TestPipelineReconstruction(scene, logic, sweep));
+  CHECK_EXIT_SUCCESS(TestSparseReconstruction(scene, logic, sweep));
+  CHECK_EXIT_SUCCESS(TestOutOfCoreReconstruction(scene, logic, sweep));
+
+  return EXIT_SUCCESS;
+}
@@ -259,7 +259,8 @@ void qSlicerVolumeReconstructionModuleWidget::updateReconstructionProgress()
   }
 
   int numberOfFrames = masterSequence->GetNumberOfDataNodes();
-  int progress = std::floor((100.0 * d->VolumeReconstructionNode->GetNumberOfVolumesAddedToReconstruction()) / numberOfFrames);
+  int numberOfFramesProcessed = d->VolumeReconstructionNode->GetNumberOfVolumesAddedToReconstruction() + d->VolumeReconstructionNode->GetNumberOfFramesSkipped();
+  int progress = std::floor((100.0 * numberOfFramesProcessed) / numberOfFrames);
   d->ReconstructionProgressDialog->setValue(progress);
   qApp->processEvents();
 }
@@ -456,6 +457,7 @@ void qSlicerVolumeReconstructionModuleWidget::updateMRMLFromWidget()
   if (liveVolumeReconstruction != d->VolumeReconstructionNode->GetLiveVolumeReconstruction())
   {
     d->VolumeReconstructionNode->SetNumberOfVolumesAddedToReconstruction(0);
+    d->VolumeReconstructionNode->SetNumberOfFramesSkipped(0);
   }
   d->VolumeReconstructionNode->SetLiveVolumeReconstruction(liveVolumeReconstruction);
   d->VolumeReconstructionNode->SetLiveUpdateIntervalSeconds(d->LiveUpdateIntervalSpinBox->value());